@@ -0,0 +1,129 @@
+#include "fakes.hpp"
+#include "simulated_module.hpp"
+
+#include "user_core.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <functional>
+#include <thread>
+
+namespace
+{
+// Каждый запрос со своим id: команду движения с тем же id и текстом RequestJournal считает повтором
+// и отвечает запомненным результатом, не выполняя ее
+std::string command(const std::string &name, const std::string &message)
+{
+    static int nextId = 1;
+    NetworkSerializer serializer;
+    return serializer.serialize(pkg::Message{nextId++, serializer.serialize(mms::Manager{name, message})});
+}
+
+std::string movingCommand(size_t motors, uint32_t acceleration = 2000)
+{
+    mms::MotorsSettings settings{"synchronous", {}};
+    for (size_t i = 0; i < motors; ++i)
+        settings.motors.push_back(mms::Motor{static_cast<int>(i + 1), acceleration, 5000, 100});
+    return command("moving", NetworkSerializer().serialize(settings));
+}
+
+std::unique_ptr<UserCore> makeCore()
+{
+    auto module = std::make_unique<SimulatedModule>();
+    return std::make_unique<UserCore>(std::move(module), std::make_unique<DiscardSocket>());
+}
+
+// Запросы собираются до замера и идут по кругу. Их больше емкости RequestJournal: к повтору id
+// прежняя запись уже вытеснена, и команда выполняется заново, а не отвечается из журнала
+void runProcess(benchmark::State &state, const std::function<std::string()> &make)
+{
+    std::vector<std::string> messages(2 * RequestJournal::DEFAULT_CAPACITY);
+    std::generate(messages.begin(), messages.end(), make);
+
+    auto core = makeCore();
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        core->Process(1, "bench", messages[next]);
+        next = (next + 1) % messages.size();
+    }
+}
+
+// Команды, которые не ждут MCU: разбор, проверка и ответ клиенту
+void BM_ProcessListConnect(benchmark::State &state)
+{
+    runProcess(state, [] { return command("listconnect", ""); });
+}
+
+void BM_ProcessUnknownCommand(benchmark::State &state)
+{
+    runProcess(state, [] { return command("no-such-command", ""); });
+}
+
+void BM_ProcessVersionRejected(benchmark::State &state)
+{
+    runProcess(state, [] { return command("version", "not empty"); });
+}
+
+// moving отбивается проверкой параметров (acceleration = 0 -> 40504), до MCU не доходит
+void BM_ProcessMovingRejected(benchmark::State &state)
+{
+    const auto motors = static_cast<size_t>(state.range(0));
+    runProcess(state, [motors] { return movingCommand(motors, 0); });
+}
+
+// Полный moving через мгновенную плату: время определяется паузами опроса MCU в UserCore
+void BM_ProcessMoving(benchmark::State &state)
+{
+    const auto motors = static_cast<size_t>(state.range(0));
+    runProcess(state, [motors] { return movingCommand(motors); });
+}
+
+// От stop() до ответа на прерванный moving и на state.range(0) команд, ждущих в очереди платы.
+// Плата в реальном времени двигает моторы минутами, поток платы ждет завершения в паузе опроса
+void BM_StopLatency(benchmark::State &state)
+{
+    const auto queued = static_cast<size_t>(state.range(0));
+    auto module = std::make_unique<SimulatedModule>();
+    module->setMotionModel(MotionModel(), 1.0);
+    auto *socket = new CountingSocket();
+    UserCore core(std::move(module), std::unique_ptr<ISocket>(socket));
+    core.Init();
+
+    mms::MotorsSettings settings{"synchronous", {mms::Motor{1, 2000, 5000, 1000000}}};
+    const std::string longMove = NetworkSerializer().serialize(settings);
+    const std::string stop = command("stop", "");
+
+    size_t replies = 0;
+    IClock::Duration worst{};
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i <= queued; ++i)
+            core.Process(1, "bench", command("moving", longMove));
+        replies += queued + 1;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2)); // плата успевает уйти в ожидание
+
+        const auto started = SystemClock::instance().now();
+        core.Process(2, "bench", stop);
+        if (!socket->waitFor(1, replies))
+        {
+            state.SkipWithError("not every queued moving was answered after stop");
+            break;
+        }
+        const auto elapsed = SystemClock::instance().now() - started;
+
+        worst = std::max(worst, elapsed);
+        state.SetIterationTime(std::chrono::duration<double>(elapsed).count());
+    }
+    core.Stop();
+
+    state.counters["worst_us"] = std::chrono::duration<double, std::micro>(worst).count();
+}
+} // namespace
+
+BENCHMARK(BM_ProcessListConnect);
+BENCHMARK(BM_ProcessUnknownCommand);
+BENCHMARK(BM_ProcessVersionRejected);
+BENCHMARK(BM_ProcessMovingRejected)->Arg(1)->Arg(10);
+BENCHMARK(BM_ProcessMoving)->Arg(1)->Arg(10)->Iterations(5)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StopLatency)->Arg(0)->Arg(8)->Iterations(200)->UseManualTime()->Unit(benchmark::kMicrosecond);
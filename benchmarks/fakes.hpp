@@ -0,0 +1,161 @@
+#ifndef BENCHMARKS_FAKES_HPP_
+#define BENCHMARKS_FAKES_HPP_
+
+#include "i_socket.hpp"
+#include "network_serializer.hpp"
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * @brief MemorySocket - ISocket поверх строки в памяти: read отдает данные порциями по chunk байт,
+ * после конца данных возвращает 0. rewind() позволяет прочитать те же данные снова.
+ * */
+class MemorySocket : public ISocket
+{
+public:
+    MemorySocket(std::string data, size_t chunk)
+        : m_data(std::move(data))
+        , m_chunk(chunk)
+    {}
+
+    void rewind()
+    {
+        m_offset = 0;
+    }
+
+    size_t write(int, const void *, size_t count) override
+    {
+        return count;
+    }
+
+    size_t read(int, void *buf, size_t count) override
+    {
+        const size_t n = std::min({count, m_chunk, m_data.size() - m_offset});
+        std::memcpy(buf, m_data.data() + m_offset, n);
+        m_offset += n;
+        return n;
+    }
+
+private:
+    std::string m_data;
+    size_t m_chunk;
+    size_t m_offset = 0;
+};
+
+/*
+ * @brief DiscardSocket - запись в никуда, ответы ядра не влияют на замер
+ * */
+class DiscardSocket : public ISocket
+{
+public:
+    size_t write(int, const void *, size_t count) override
+    {
+        return count;
+    }
+
+    size_t read(int, void *, size_t) override
+    {
+        return 0;
+    }
+};
+
+/*
+ * @brief CountingSocket - считает записи по дескрипторам, ответ из потока платы можно дождаться
+ * */
+class CountingSocket : public ISocket
+{
+public:
+    size_t write(int fd, const void *, size_t count) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_writes[fd];
+        }
+        m_cv.notify_all();
+        return count;
+    }
+
+    size_t read(int, void *, size_t) override
+    {
+        return 0;
+    }
+
+    size_t writes(int fd)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_writes[fd];
+    }
+
+    /*
+     * @brief Дождаться count записей в fd
+     * @return false, если за timeout их не набралось
+     * */
+    bool waitFor(int fd, size_t count, std::chrono::milliseconds timeout = std::chrono::seconds(10))
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_cv.wait_for(lock, timeout, [this, fd, count]() { return m_writes[fd] >= count; });
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::map<int, size_t> m_writes;
+};
+
+/*
+ * @brief LoopbackClient - блокирующий TCP-клиент: представляется серверу и шлет pkg::Message
+ * */
+class LoopbackClient : public NetworkSerializer
+{
+public:
+    LoopbackClient(int port, const std::string &name)
+    {
+        m_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (m_fd < 0)
+            throw std::runtime_error("socket");
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        if (::connect(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+        {
+            close(m_fd);
+            throw std::runtime_error("connect");
+        }
+
+        writeToSock(m_fd, serialize(pkg::WhoWantsToTalkToMe{name}));
+    }
+
+    ~LoopbackClient()
+    {
+        close(m_fd);
+    }
+
+    void send(int id, const std::string &text)
+    {
+        writeToSock(m_fd, serialize(pkg::Message{id, text}));
+    }
+
+    std::string receive()
+    {
+        return readFromSock(m_fd);
+    }
+
+private:
+    int m_fd = -1;
+};
+
+#endif // BENCHMARKS_FAKES_HPP_
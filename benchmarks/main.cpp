@@ -0,0 +1,17 @@
+#include "logger.hpp"
+
+#include <benchmark/benchmark.h>
+
+int main(int argc, char **argv)
+{
+    // Логи сервера и ядра не должны попадать в замер и в вывод бенчмарков
+    Logger::instance().setLevel(LogLevel::Off);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
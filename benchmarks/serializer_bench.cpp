@@ -0,0 +1,177 @@
+#include "fakes.hpp"
+
+#include "dataframe.hpp"
+#include "network_serializer.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+mms::MotorsSettings makeSettings(size_t motors)
+{
+    mms::MotorsSettings settings{"synchronous", {}};
+    for (size_t i = 0; i < motors; ++i)
+        settings.motors.push_back(mms::Motor{static_cast<int>(i + 1), 2000, 5000, 100});
+    return settings;
+}
+
+// count сообщений version, каждое с \n\n в конце
+std::string versionBurst(int64_t count)
+{
+    NetworkSerializer serializer;
+    const std::string one = serializer.serialize(pkg::Message{1, serializer.serialize(mms::Manager{"version", ""})});
+    std::string burst;
+    for (int64_t i = 0; i < count; ++i)
+        burst += one + "\n\n";
+    return burst;
+}
+
+template <typename T>
+T sample();
+
+template <>
+pkg::WhoWantsToTalkToMe sample()
+{
+    return pkg::WhoWantsToTalkToMe{"loadgen-client"};
+}
+
+template <>
+pkg::Message sample()
+{
+    return {42, NetworkSerializer().serialize(mms::Manager{"version", ""})};
+}
+
+template <>
+pkg::Status sample()
+{
+    return {"[cli][40511]: Timeout waiting for MCU response", "", 40511};
+}
+
+template <>
+mms::Motor sample()
+{
+    return {1, 2000, 5000, -100};
+}
+
+template <>
+mms::MotorsSettings sample()
+{
+    return makeSettings(10);
+}
+
+template <>
+mms::Version sample()
+{
+    return {2.0f, "Squid"};
+}
+
+template <>
+mms::Device sample()
+{
+    return mms::Device{1};
+}
+
+template <>
+mms::ListConnect sample()
+{
+    return mms::ListConnect{{"FT232R USB UART A10KZP45", "FT232R USB UART A50285BI"}};
+}
+
+template <>
+mms::Manager sample()
+{
+    return {"moving", NetworkSerializer().serialize(makeSettings(10))};
+}
+
+template <typename T>
+void BM_Serialize(benchmark::State &state)
+{
+    NetworkSerializer serializer;
+    const T value = sample<T>();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(serializer.serialize(value));
+}
+
+template <typename T>
+void BM_Deserialize(benchmark::State &state)
+{
+    NetworkSerializer serializer;
+    const std::string json = serializer.serialize(sample<T>());
+    for (auto _ : state)
+        benchmark::DoNotOptimize(serializer.deserialize<T>(json));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * json.size()));
+}
+
+// Полный путь moving: pkg::Message -> mms::Manager -> mms::MotorsSettings с N моторами
+void BM_DeserializeMovingChain(benchmark::State &state)
+{
+    NetworkSerializer serializer;
+    const auto settings = makeSettings(static_cast<size_t>(state.range(0)));
+    const std::string json = serializer.serialize(
+        pkg::Message{1, serializer.serialize(mms::Manager{"moving", serializer.serialize(settings)})});
+
+    for (auto _ : state)
+    {
+        const auto message = serializer.deserialize<pkg::Message>(json);
+        const auto manager = serializer.deserialize<mms::Manager>(message.text);
+        benchmark::DoNotOptimize(serializer.deserialize<mms::MotorsSettings>(manager.message));
+    }
+}
+
+// Пачка из N сообщений, пришедших одним read
+void BM_Split(benchmark::State &state)
+{
+    NetworkSerializer serializer;
+    const std::string burst = versionBurst(state.range(0));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(serializer.split(burst));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * burst.size()));
+}
+
+// readFromSock собирает пачку из N сообщений, сокет отдает данные порциями по range(1) байт
+void BM_ReadFromSock(benchmark::State &state)
+{
+    const std::string burst = versionBurst(state.range(0));
+
+    auto socket = std::make_unique<MemorySocket>(burst, static_cast<size_t>(state.range(1)));
+    MemorySocket &memory = *socket;
+    NetworkSerializer serializer(std::move(socket));
+
+    // readFromSock останавливается на порции, оканчивающейся на \n\n, поэтому считаем реально прочитанное
+    int64_t bytes = 0;
+    for (auto _ : state)
+    {
+        memory.rewind();
+        bytes += static_cast<int64_t>(serializer.readFromSock(0).size());
+    }
+    state.SetBytesProcessed(bytes);
+}
+} // namespace
+
+BENCHMARK(BM_Serialize<pkg::WhoWantsToTalkToMe>);
+BENCHMARK(BM_Serialize<pkg::Message>);
+BENCHMARK(BM_Serialize<pkg::Status>);
+BENCHMARK(BM_Serialize<mms::Motor>);
+BENCHMARK(BM_Serialize<mms::MotorsSettings>);
+BENCHMARK(BM_Serialize<mms::Version>);
+BENCHMARK(BM_Serialize<mms::Device>);
+BENCHMARK(BM_Serialize<mms::ListConnect>);
+BENCHMARK(BM_Serialize<mms::Manager>);
+
+BENCHMARK(BM_Deserialize<pkg::WhoWantsToTalkToMe>);
+BENCHMARK(BM_Deserialize<pkg::Message>);
+BENCHMARK(BM_Deserialize<pkg::Status>);
+BENCHMARK(BM_Deserialize<mms::Motor>);
+BENCHMARK(BM_Deserialize<mms::MotorsSettings>);
+BENCHMARK(BM_Deserialize<mms::Version>);
+BENCHMARK(BM_Deserialize<mms::Device>);
+BENCHMARK(BM_Deserialize<mms::ListConnect>);
+BENCHMARK(BM_Deserialize<mms::Manager>);
+
+BENCHMARK(BM_DeserializeMovingChain)->Arg(1)->Arg(4)->Arg(10);
+
+BENCHMARK(BM_Split)->RangeMultiplier(4)->Range(1, 256);
+
+BENCHMARK(BM_ReadFromSock)->ArgsProduct({{1, 16, 128}, {64, 1024}});
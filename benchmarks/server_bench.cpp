@@ -0,0 +1,120 @@
+#include "fakes.hpp"
+#include "simulated_module.hpp"
+
+#include "server.hpp"
+#include "user_core.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <thread>
+
+namespace
+{
+/*
+ * @brief EchoCore - ядро, возвращающее клиенту текст сообщения: замеряется только путь Server
+ * */
+class EchoCore : public ICore, public NetworkSerializer
+{
+public:
+    EchoCore() : ICore("EchoCore") {}
+
+    void Init() override {}
+    void Process(const int fd, const std::string &, const std::string &message) override
+    {
+        writeToSock(fd, message);
+    }
+    void Launch() override {}
+    void Stop() override {}
+};
+
+/*
+ * @brief Сервер в отдельном потоке на случайном свободном порту, останавливается в деструкторе
+ * */
+class RunningServer
+{
+public:
+    explicit RunningServer(std::unique_ptr<ICore> core)
+    {
+        static std::mt19937 gen(std::random_device{}());
+        std::uniform_int_distribution<> ports(49152, 65535);
+
+        for (int attempt = 0; !m_server; ++attempt)
+        {
+            try
+            {
+                m_port = ports(gen);
+                m_server = std::make_unique<Server>("127.0.0.1", m_port, std::move(core));
+            }
+            catch (const BindFailure &)
+            {
+                if (attempt == 16)
+                    throw;
+            }
+        }
+        m_thread = std::thread([this]() { m_server->run(); });
+    }
+
+    ~RunningServer()
+    {
+        m_server->stop();
+        m_thread.join();
+    }
+
+    // listen() выполняется в run(), поэтому первые попытки подключения могут не пройти
+    std::unique_ptr<LoopbackClient> connect(const std::string &name) const
+    {
+        for (int attempt = 0;; ++attempt)
+        {
+            try
+            {
+                return std::make_unique<LoopbackClient>(m_port, name);
+            }
+            catch (const std::runtime_error &)
+            {
+                if (attempt == 100)
+                    throw;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+    }
+
+private:
+    int m_port = 0;
+    std::unique_ptr<Server> m_server;
+    std::thread m_thread;
+};
+
+void roundTrips(benchmark::State &state, std::unique_ptr<ICore> core, const std::string &text)
+{
+    RunningServer server(std::move(core));
+    auto client = server.connect("bench");
+
+    int id = 0;
+    for (auto _ : state)
+    {
+        client->send(++id, text);
+        benchmark::DoNotOptimize(client->receive());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Чтение, разбор pkg::Message и ответ без ядра, длина текста - range(0) байт
+void BM_ServerEchoRoundTrip(benchmark::State &state)
+{
+    roundTrips(state, std::make_unique<EchoCore>(), std::string(static_cast<size_t>(state.range(0)), 'x'));
+}
+
+// Полный путь listconnect: Server -> UserCore -> ответ в сокет
+void BM_ServerListConnectRoundTrip(benchmark::State &state)
+{
+    NetworkSerializer serializer;
+    roundTrips(
+        state,
+        std::make_unique<UserCore>(std::make_unique<SimulatedModule>()),
+        serializer.serialize(mms::Manager{"listconnect", ""}));
+}
+} // namespace
+
+BENCHMARK(BM_ServerEchoRoundTrip)->Arg(16)->Arg(256)->Arg(4096)->UseRealTime();
+BENCHMARK(BM_ServerListConnectRoundTrip)->UseRealTime();
@@ -0,0 +1,207 @@
+#ifndef DEVICE_CHANNEL_HPP_
+#define DEVICE_CHANNEL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fair_queue.hpp"
+#include "i_module.hpp"
+#include "mcu_transaction.hpp"
+#include "metrics.hpp"
+
+/*
+ * @brief DeviceChannel - одна плата управления моторами: модуль связи, свой поток ввода-вывода и
+ * очередь заданий к нему.
+ *
+ * Все обращения к модулю идут через post(): задания одной платы выполняются по одному в ее потоке,
+ * задания разных плат - параллельно. Очередь раздельная по клиентам (FairQueue): задания одного клиента
+ * идут по порядку, клиенты чередуются по весам, и частый клиент не занимает плату целиком. Пока поток
+ * не запущен (start() не вызывался, например в unit-тестах без Server), задание выполняется сразу в
+ * вызывающем потоке.
+ *
+ * Плата отвечает за непрерывный диапазон "глобальных" номеров моторов [firstMotor, lastMotor],
+ * для MCU номера пересчитываются в локальные 1..10.
+ *
+ * Экстренная остановка (emergencyStop()) - единственное обращение к модулю в обход очереди: байт STOP
+ * пишется из вызывающего потока, записи в модуль сериализуются m_writeMutex.
+ * */
+class DeviceChannel
+{
+public:
+    using Job = std::function<void(DeviceChannel &)>;
+
+    DeviceChannel() = delete;
+    DeviceChannel(std::unique_ptr<IModule> module, int deviceId, int firstMotor, int lastMotor);
+    DeviceChannel(const DeviceChannel &) = delete;
+    DeviceChannel(DeviceChannel &&) = delete;
+    ~DeviceChannel();
+
+    DeviceChannel &operator=(const DeviceChannel &) = delete;
+    DeviceChannel &operator=(DeviceChannel &&) = delete;
+
+    /*
+     * @brief Запуск потока ввода-вывода платы
+     * */
+    void start();
+
+    /*
+     * @brief Остановка потока, задания, которые уже в очереди, выполняются до конца
+     * */
+    void stop();
+
+    /*
+     * @brief Поставить задание в очередь платы
+     * @param client имя клиента, от которого пришла команда; пустое - служебные задания сервиса
+     * */
+    void post(Job job, const std::string &client = {});
+
+    /*
+     * @brief Количество заданий, ожидающих выполнения
+     * */
+    size_t pending() const;
+
+    /*
+     * @brief Количество заданий клиента, ожидающих выполнения
+     * */
+    size_t pending(const std::string &client) const;
+
+    /*
+     * @brief Вес клиента в очереди платы (FairQueue::setWeight)
+     * */
+    void setClientWeight(const std::string &client, uint32_t weight);
+
+    /*
+     * @brief Очередь пуста и поток платы не выполняет задание
+     * */
+    bool idle() const;
+
+    IModule &module()
+    {
+        return *m_module;
+    }
+
+    const IModule &module() const
+    {
+        return *m_module;
+    }
+
+    /*
+     * @brief ID устройства FT232RL, к которому привязана плата, -1 если еще не привязана
+     * */
+    int deviceId() const
+    {
+        return m_deviceId;
+    }
+
+    void setDeviceId(int deviceId)
+    {
+        m_deviceId = deviceId;
+    }
+
+    int firstMotor() const
+    {
+        return m_firstMotor;
+    }
+
+    int lastMotor() const
+    {
+        return m_lastMotor;
+    }
+
+    bool owns(int motor) const
+    {
+        return motor >= m_firstMotor && motor <= m_lastMotor;
+    }
+
+    /*
+     * @brief Номер мотора на стороне MCU (1..10)
+     * */
+    int localNumber(int motor) const
+    {
+        return motor - m_firstMotor + 1;
+    }
+
+    /*
+     * @brief Глобальный номер мотора по номеру на стороне MCU
+     * */
+    int globalNumber(int local) const
+    {
+        return local + m_firstMotor - 1;
+    }
+
+    /*
+     * @brief Запись кадра в модуль через переиспользуемый буфер платы
+     * @param keepOpen - MCU ждет продолжения кадра (заголовок без параметров): экстренная остановка
+     * откладывается до следующего writeFrame() или closeFrame()
+     * */
+    void writeFrame(std::span<const uint8_t> frame, bool keepOpen = false);
+
+    /*
+     * @brief Продолжения кадра не будет (MCU отказал в готовности), отложенный STOP уходит сейчас
+     * */
+    void closeFrame();
+
+    /*
+     * @brief Экстренная остановка в обход очереди заданий: байт STOP уходит в MCU сразу из вызывающего
+     * потока и увеличивается stopEpoch(). Задания, принятые до остановки, по ней видят, что их отменили
+     * */
+    void emergencyStop();
+
+    uint64_t stopEpoch() const
+    {
+        return m_stopEpoch.load(std::memory_order_acquire);
+    }
+
+    /*
+     * @brief Версия прошивки и возможности платы, прочитанные при подключении
+     * */
+    struct Firmware
+    {
+        float version = 0.0f;
+        bool coalesced = false; // прошивка принимает заголовок и параметры одной записью
+        bool known = false;     // версия прочитана после последнего подключения
+    };
+
+    /*
+     * @brief Версия прошивки без обращения к MCU: читается из любого потока
+     * */
+    Firmware firmware() const;
+
+    /*
+     * @brief Запомнить прочитанную версию, Firmware{} - забыть (плата отключена)
+     * */
+    void setFirmware(const Firmware &firmware);
+
+private:
+    std::unique_ptr<IModule> m_module;
+    int m_deviceId;
+    int m_firstMotor;
+    int m_lastMotor;
+
+    std::mutex m_writeMutex; // записи в модуль: поток платы и emergencyStop()
+    std::vector<uchar> m_txFrame;
+    bool m_frameOpen = false;
+    bool m_stopDeferred = false;
+    std::atomic<uint64_t> m_stopEpoch{0};
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    FairQueue<Job> m_jobs;
+    Firmware m_firmware;
+    MetricGauge &m_queueDepth; // mms_board_queue_depth{board="FIRST-LAST"}
+    bool m_running = false;
+    bool m_busy = false; // поток выполняет задание
+    std::thread m_thread;
+
+    void workerLoop();
+    void execute(Job &job);
+};
+
+#endif // DEVICE_CHANNEL_HPP_
@@ -0,0 +1,101 @@
+#ifndef DEVICE_MANAGER_HPP_
+#define DEVICE_MANAGER_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "device_channel.hpp"
+
+/*
+ * @brief DeviceManager - набор плат управления моторами, с которыми работает один сервис.
+ *
+ * Каждая плата (DeviceChannel) открывается своим модулем и обслуживается своим потоком, поэтому
+ * команды на разные платы выполняются параллельно. Команды moving() раскладываются по платам по
+ * диапазонам номеров моторов:
+ *
+ *   --board 0:1-10 --board 2:11-20  ->  моторы 1..10 на устройстве 0, 11..20 на устройстве 2
+ *
+ * Конструктор от одного модуля дает прежнее поведение: одна плата, моторы 1..10, устройство
+ * выбирается командой reconnect.
+ * */
+class DeviceManager
+{
+public:
+    DeviceManager() = default;
+    explicit DeviceManager(std::unique_ptr<IModule> module);
+    DeviceManager(const DeviceManager &) = delete;
+    DeviceManager(DeviceManager &&) = default;
+    ~DeviceManager();
+
+    DeviceManager &operator=(const DeviceManager &) = delete;
+    DeviceManager &operator=(DeviceManager &&) = default;
+
+    /*
+     * @brief Добавить плату
+     * @param module модуль связи с платой
+     * @param deviceId ID устройства FT232RL, -1 - привязать позже через reconnect
+     * @param firstMotor первый глобальный номер мотора платы
+     * @param lastMotor последний глобальный номер мотора платы
+     * @return false, если диапазон пустой, шире McuTransaction::MAX_MOTORS, пересекается с уже
+     * добавленной платой или deviceId уже занят
+     * */
+    bool add(std::unique_ptr<IModule> module, int deviceId, int firstMotor, int lastMotor);
+
+    size_t size() const
+    {
+        return m_channels.size();
+    }
+
+    bool empty() const
+    {
+        return m_channels.empty();
+    }
+
+    /*
+     * @brief Первая добавленная плата: через нее идут version() и listconnect()
+     * */
+    DeviceChannel &primary()
+    {
+        return *m_channels.front();
+    }
+
+    DeviceChannel &operator[](size_t i)
+    {
+        return *m_channels[i];
+    }
+
+    DeviceChannel *findByDevice(int deviceId);
+    DeviceChannel *findByMotor(int motor);
+
+    /*
+     * @brief Наименьший и наибольший глобальный номер мотора среди всех плат
+     * */
+    int firstMotor() const;
+    int lastMotor() const;
+
+    /*
+     * @brief Суммарное количество моторов всех плат
+     * */
+    size_t motorCount() const;
+
+    /*
+     * @brief Подключить все платы, у которых задан deviceId. Ошибки подключения только логируются,
+     * плату можно подключить позже командой reconnect
+     * */
+    void connectAll();
+
+    void start();
+    void stop();
+
+    /*
+     * @brief Разбор описания платы "ID:FIRST-LAST"
+     * @return false, если строка не соответствует формату
+     * */
+    static bool parseBoard(const std::string &text, int &deviceId, int &firstMotor, int &lastMotor);
+
+private:
+    std::vector<std::unique_ptr<DeviceChannel>> m_channels;
+};
+
+#endif // DEVICE_MANAGER_HPP_
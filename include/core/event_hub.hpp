@@ -0,0 +1,107 @@
+#ifndef EVENT_HUB_HPP_
+#define EVENT_HUB_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include "metrics.hpp"
+
+/*
+ * @brief EventHub - рассылка событий подписанным соединениям (команда subscribe()).
+ *
+ * Событие сериализуется один раз, в очередь каждого подписчика кладется указатель на общий кадр.
+ * Очереди разбирает поток рассылки, поэтому публикация из Process() и потоков плат не ждет медленных
+ * клиентов. Очередь подписчика ограничена MAX_QUEUED: при переполнении теряются самые старые события.
+ * Пока поток не запущен (start() не вызывался, например в unit-тестах), кадр пишется сразу в
+ * вызывающем потоке.
+ *
+ * После unsubscribe() в соединение больше ничего не пишется, дескриптор можно закрывать.
+ * */
+class EventHub
+{
+public:
+    /*
+     * @brief Запись кадра в соединение, false - соединение не принимает данные и отписывается
+     * */
+    using Sink = std::function<bool(int fd, std::string_view frame)>;
+
+    static constexpr size_t MAX_QUEUED = 1024;
+
+    EventHub() = delete;
+    explicit EventHub(Sink sink);
+    EventHub(const EventHub &) = delete;
+    EventHub(EventHub &&) = delete;
+    ~EventHub();
+
+    EventHub &operator=(const EventHub &) = delete;
+    EventHub &operator=(EventHub &&) = delete;
+
+    void start();
+
+    /*
+     * @brief Остановка потока рассылки, события, которые уже в очередях, дописываются
+     * */
+    void stop();
+
+    /*
+     * @return false, если соединение уже подписано
+     * */
+    bool subscribe(int fd, const std::string &name);
+
+    /*
+     * @return false, если соединение не было подписано
+     * */
+    bool unsubscribe(int fd);
+
+    /*
+     * @brief Нет ни одного подписчика: события можно не собирать
+     * */
+    bool empty() const
+    {
+        return m_count.load(std::memory_order_relaxed) == 0;
+    }
+
+    /*
+     * @brief Разослать кадр всем подписчикам
+     * @param frame Сериализованное сообщение вместе с завершающим \n\n
+     * @param except Соединение, которому событие не отправляется (инициатор команды), -1 - всем
+     * */
+    void publish(std::string frame, int except = -1);
+
+private:
+    using Frame = std::shared_ptr<const std::string>;
+
+    struct Subscriber
+    {
+        std::string name;
+        std::deque<Frame> queue;
+    };
+
+    Sink m_sink;
+    std::unordered_map<int, Subscriber> m_subscribers;
+    std::atomic<size_t> m_count{0};
+    size_t m_queued = 0; // кадров во всех очередях
+
+    mutable std::mutex m_mutex;
+    std::mutex m_deliveryMutex; // держится, пока кадры пишутся в соединения
+    std::condition_variable m_cv;
+    bool m_running = false;
+    std::thread m_thread;
+
+    MetricGauge &m_subscribersGauge;
+    MetricCounter &m_published;
+    MetricCounter &m_dropped;
+
+    void workerLoop();
+    void deliver(std::unordered_map<int, std::deque<Frame>> &batch);
+};
+
+#endif // EVENT_HUB_HPP_
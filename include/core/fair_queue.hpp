@@ -0,0 +1,139 @@
+#ifndef FAIR_QUEUE_HPP_
+#define FAIR_QUEUE_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+/*
+ * @brief FairQueue - очередь заданий платы с раздельными очередями клиентов и обходом deficit round
+ * robin (DRR).
+ *
+ * Каждое задание стоит одну единицу, клиент с весом W получает за круг до W заданий подряд, затем
+ * очередь переходит к следующему клиенту, у которого есть задания. Клиент, приславший сто команд, не
+ * задерживает одну команду другого клиента дольше чем на W своих заданий: время ожидания легкого
+ * клиента ограничено суммой весов активных клиентов, а не длиной чужой очереди.
+ *
+ * Внутри очереди одного клиента порядок сохраняется. Потокобезопасность - на стороне владельца
+ * (DeviceChannel держит очередь под своим мьютексом).
+ * */
+template <typename T>
+class FairQueue
+{
+public:
+    static constexpr uint32_t DEFAULT_WEIGHT = 1;
+
+    /*
+     * @brief Вес клиента: сколько его заданий подряд выполняется за круг, не меньше 1
+     * */
+    void setWeight(const std::string &client, uint32_t weight)
+    {
+        m_weights[client] = std::max<uint32_t>(weight, 1);
+        auto it = m_flows.find(client);
+        if (it != m_flows.end())
+            it->second.weight = m_weights[client];
+    }
+
+    void push(const std::string &client, T item)
+    {
+        auto [it, inserted] = m_flows.try_emplace(client);
+        Flow &flow = it->second;
+        if (inserted)
+        {
+            auto weight = m_weights.find(client);
+            flow.weight = (weight != m_weights.end()) ? weight->second : DEFAULT_WEIGHT;
+        }
+
+        if (flow.items.empty())
+            m_active.push_back(&it->first);
+        flow.items.push_back(std::move(item));
+        ++m_size;
+    }
+
+    /*
+     * @brief Следующее задание по DRR
+     * @return false, если очередь пуста
+     * */
+    bool pop(T &out)
+    {
+        if (m_active.empty())
+            return false;
+
+        auto head = m_flows.find(*m_active.front());
+        Flow &flow = head->second;
+        if (!m_headCharged)
+        {
+            // Клиент в начале круга: квант по весу
+            flow.deficit += flow.weight;
+            m_headCharged = true;
+        }
+
+        out = std::move(flow.items.front());
+        flow.items.pop_front();
+        --flow.deficit;
+        --m_size;
+
+        if (flow.items.empty())
+        {
+            // Клиент без заданий удаляется вместе с остатком кванта: простаивавший клиент не получит
+            // очередь целиком, а m_flows не растет от разовых клиентов. Вес остается в m_weights
+            m_active.pop_front();
+            m_headCharged = false;
+            m_flows.erase(head);
+        }
+        else if (flow.deficit == 0)
+        {
+            m_active.push_back(m_active.front());
+            m_active.pop_front();
+            m_headCharged = false;
+        }
+        return true;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    /*
+     * @brief Заданий клиента в очереди
+     * */
+    size_t size(const std::string &client) const
+    {
+        auto it = m_flows.find(client);
+        return (it != m_flows.end()) ? it->second.items.size() : 0;
+    }
+
+    /*
+     * @brief Клиентов с заданиями в очереди
+     * */
+    size_t clients() const
+    {
+        return m_flows.size();
+    }
+
+private:
+    struct Flow
+    {
+        std::deque<T> items;
+        uint32_t weight = DEFAULT_WEIGHT;
+        uint32_t deficit = 0;
+    };
+
+    // Узлы unordered_map не переезжают при рехеше: m_active хранит указатели на ключи m_flows.
+    // В m_flows только клиенты с заданиями, и все они в m_active
+    std::unordered_map<std::string, Flow> m_flows;
+    std::unordered_map<std::string, uint32_t> m_weights;
+    std::deque<const std::string *> m_active; // клиенты с заданиями в порядке обхода
+    bool m_headCharged = false;                // клиент в начале m_active уже получил квант этого круга
+    size_t m_size = 0;
+};
+
+#endif // FAIR_QUEUE_HPP_
@@ -0,0 +1,137 @@
+#ifndef LINK_SUPERVISOR_HPP_
+#define LINK_SUPERVISOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "clock.hpp"
+#include "device_manager.hpp"
+#include "metrics.hpp"
+
+/*
+ * @brief LinkSupervisor - надзор за связью с платами: дешевая проверка простаивающих плат и
+ * переподключение к последнему deviceId с нарастающей паузой.
+ *
+ * Проверка не обращается к MCU: задание в очереди платы спрашивает у модуля isConnected() и размер
+ * приемной очереди (checkRXChannel(), у FT232RL это FT_GetQueueStatus, который падает на выдернутом
+ * кабеле). Платы, у которых есть задания, не проверяются: связь с ними проверяют сами команды.
+ *
+ * Потерянная плата переподключается заданием в ее же очереди. Первые RECONNECT_GRACE попытки идут
+ * подряд в одном задании, и команды, пришедшие за это время, ждут в очереди за ним (reconnecting()).
+ * Дальше попытки ставятся по одной с паузой MIN_BACKOFF, 2 * MIN_BACKOFF, ... до MAX_BACKOFF, а
+ * команды к плате отклоняются сразу.
+ *
+ * Надзор за платой включает watch() (плата подключена при запуске или командой reconnect) и снимает
+ * release() (команда disconnect): отключенную пользователем плату супервизор не трогает. Пока поток
+ * не запущен (start() не вызывался, например в unit-тестах), обход плат делает tick().
+ * */
+class LinkSupervisor
+{
+public:
+    using Callback = std::function<void(DeviceChannel &)>;
+
+    static constexpr std::chrono::milliseconds HEARTBEAT_INTERVAL{500}; // проверка простаивающей платы
+    static constexpr std::chrono::milliseconds RECONNECT_GRACE{2000};   // команды ждут переподключения
+    static constexpr std::chrono::milliseconds MIN_BACKOFF{100};
+    static constexpr std::chrono::milliseconds MAX_BACKOFF{5000};
+
+    LinkSupervisor() = delete;
+
+    /*
+     * @param onLost вызывается в потоке платы, когда связь пропала
+     * @param onRestored вызывается в потоке платы после переподключения
+     * */
+    LinkSupervisor(DeviceManager &devices, Callback onLost, Callback onRestored);
+    LinkSupervisor(const LinkSupervisor &) = delete;
+    LinkSupervisor(LinkSupervisor &&) = delete;
+    ~LinkSupervisor();
+
+    LinkSupervisor &operator=(const LinkSupervisor &) = delete;
+    LinkSupervisor &operator=(LinkSupervisor &&) = delete;
+
+    /*
+     * @brief Источник времени для расписания проверок и пауз между попытками, задается до start()
+     * */
+    void setClock(IClock &clock)
+    {
+        m_clock = &clock;
+    }
+
+    void start();
+    void stop();
+
+    /*
+     * @brief Один обход плат: проверка тех, чей срок подошел, и очередные попытки переподключения
+     * */
+    void tick();
+
+    /*
+     * @brief Следить за связью с платой (она подключена к channel.deviceId())
+     * */
+    void watch(DeviceChannel &channel);
+
+    /*
+     * @brief Плата отключена пользователем: не проверять и не переподключать
+     * */
+    void release(DeviceChannel &channel);
+
+    /*
+     * @brief Связь с платой пропала меньше RECONNECT_GRACE назад: команды к ней ставятся в очередь,
+     * а не отклоняются
+     * */
+    bool reconnecting(const DeviceChannel &channel) const;
+
+private:
+    enum class LinkState
+    {
+        Released,
+        Healthy,
+        Lost
+    };
+
+    struct Link
+    {
+        LinkState state = LinkState::Released;
+        bool queued = false;        // задание проверки или переподключения уже в очереди платы
+        IClock::TimePoint due{};    // следующая проверка или попытка
+        IClock::TimePoint lostAt{};
+        IClock::Duration backoff{};
+    };
+
+    DeviceManager &m_devices;
+    Callback m_onLost;
+    Callback m_onRestored;
+    IClock *m_clock = &SystemClock::instance();
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::unordered_map<const DeviceChannel *, Link> m_links;
+    bool m_running = false;
+    std::atomic<bool> m_stopping{false}; // прерывает паузу между попытками в потоке платы
+    std::thread m_thread;
+
+    MetricCounter &m_losses;
+    MetricCounter &m_reconnects;
+
+    void workerLoop();
+
+    /*
+     * @brief Задание проверки: при потере связи сразу переходит к переподключению
+     * */
+    void check(DeviceChannel &channel);
+
+    /*
+     * @brief Попытки переподключения до срока until, затем следующая попытка планируется через tick()
+     * */
+    void reconnect(DeviceChannel &channel, IClock::TimePoint until);
+
+    static bool linkAlive(DeviceChannel &channel);
+    static bool tryConnect(DeviceChannel &channel);
+};
+
+#endif // LINK_SUPERVISOR_HPP_
@@ -0,0 +1,117 @@
+#ifndef MCU_TRANSACTION_HPP_
+#define MCU_TRANSACTION_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "dataframe.hpp"
+
+/*
+ * @brief McuTransaction - кодирование команды moving() в байты протокола MCU.
+ *
+ * Заголовок (0x8N | 0x4N) и параметры моторов пишутся в один заранее выделенный буфер фиксированного
+ * размера: 1 байт заголовка + до 10 моторов по 16 байт. Каждый параметр мотора - uint32_t в
+ * little-endian, записывается побайтно, без reinterpret_cast и без зависимости от порядка байт хоста.
+ *
+ * +--------+-----------------------------------------------------------+
+ * | байт 0 | 0x8N / 0x4N - режим и количество моторов                  |
+ * +--------+-----------------------------------------------------------+
+ * | 1..16  | number | acceleration | maxSpeed | step  (мотор 1, LE)    |
+ * | ...    | ...                                                       |
+ * +--------+-----------------------------------------------------------+
+ *
+ * Кадр целиком (frame()) отправляется одной записью, если прошивка поддерживает объединенный режим
+ * (см. supportsCoalesced), иначе заголовок (header()) и параметры (payload()) уходят по отдельности.
+ * */
+class McuTransaction
+{
+public:
+    static constexpr size_t MAX_MOTORS = 10;
+    static constexpr size_t MOTOR_FRAME_SIZE = 16;
+    static constexpr size_t MAX_FRAME_SIZE = 1 + MAX_MOTORS * MOTOR_FRAME_SIZE;
+
+    static constexpr uint8_t SYNCHRONOUS = 0x80;
+    static constexpr uint8_t ASYNCHRONOUS = 0x40;
+    static constexpr uint8_t VERSION_REQUEST = 0x20;
+    static constexpr uint8_t EMERGENCY_STOP = 0x10;
+    static constexpr uint8_t STOPPED = 0x0B; // код завершения движения, прерванного EMERGENCY_STOP
+
+    // Первая версия прошивки (x.y -> 0xXY), принимающая заголовок и параметры одной USB-записью
+    static constexpr uint8_t COALESCED_MIN_VERSION = 0x20;
+
+    using Frame = std::array<uint8_t, MAX_FRAME_SIZE>;
+
+    McuTransaction() = default;
+
+    /*
+     * @brief Кодирует настройки моторов в буфер. Настройки должны быть уже проверены
+     * (checkMode/checkMotors), количество моторов больше MAX_MOTORS обрезается
+     * @param settings - настройки моторов
+     * */
+    void encode(const mms::MotorsSettings &settings);
+
+    uint8_t header() const
+    {
+        return m_frame[0];
+    }
+
+    size_t motorCount() const
+    {
+        return (m_size - 1) / MOTOR_FRAME_SIZE;
+    }
+
+    /*
+     * @brief Заголовок и параметры моторов одним куском
+     * */
+    std::span<const uint8_t> frame() const
+    {
+        return {m_frame.data(), m_size};
+    }
+
+    /*
+     * @brief Только параметры моторов, без заголовка
+     * */
+    std::span<const uint8_t> payload() const
+    {
+        return {m_frame.data() + 1, m_size - 1};
+    }
+
+    /*
+     * @brief Поддерживает ли прошивка прием заголовка и параметров одной записью
+     * @param versionByte - байт версии, как его вернул MCU на 0x20
+     * */
+    static bool supportsCoalesced(uint8_t versionByte)
+    {
+        return versionByte >= COALESCED_MIN_VERSION;
+    }
+
+    /*
+     * @brief Запись uint32_t в little-endian
+     * */
+    static void storeLE32(uint8_t *dst, uint32_t value)
+    {
+        dst[0] = static_cast<uint8_t>(value);
+        dst[1] = static_cast<uint8_t>(value >> 8);
+        dst[2] = static_cast<uint8_t>(value >> 16);
+        dst[3] = static_cast<uint8_t>(value >> 24);
+    }
+
+    /*
+     * @brief Чтение uint32_t из little-endian
+     * */
+    static uint32_t loadLE32(const uint8_t *src)
+    {
+        return static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8)
+            | (static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[3]) << 24);
+    }
+
+private:
+    Frame m_frame{};
+    size_t m_size = 1;
+};
+
+#endif // MCU_TRANSACTION_HPP_
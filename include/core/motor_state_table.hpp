@@ -0,0 +1,75 @@
+#ifndef MOTOR_STATE_TABLE_HPP_
+#define MOTOR_STATE_TABLE_HPP_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "dataframe.hpp"
+
+/*
+ * @brief MotorStateTable - последнее известное состояние каждого мотора сервиса.
+ *
+ * Запись идет из Process() (команда принята) и из потоков плат (команда завершена), под общим мьютексом
+ * записи. Чтение не блокируется: каждая запись мотора защищена счетчиком версий (seqlock), читатель
+ * повторяет чтение, если во время него запись изменилась, и всегда видит состояние целиком.
+ *
+ * Позиция - сумма шагов успешно выполненных команд с запуска сервиса. После ошибки или таймаута
+ * позиция не меняется: сколько шагов мотор успел пройти, сервис не знает.
+ * */
+class MotorStateTable
+{
+public:
+    MotorStateTable() = delete;
+    MotorStateTable(int firstMotor, int lastMotor);
+    MotorStateTable(const MotorStateTable &) = delete;
+    MotorStateTable(MotorStateTable &&) = delete;
+
+    MotorStateTable &operator=(const MotorStateTable &) = delete;
+    MotorStateTable &operator=(MotorStateTable &&) = delete;
+
+    bool contains(int motor) const
+    {
+        return motor >= m_firstMotor && motor < m_firstMotor + m_size;
+    }
+
+    /*
+     * @brief Команда для мотора принята: запоминает ее параметры, мотор занят до complete()
+     * @param motor Глобальный номер и параметры мотора из moving()
+     * */
+    void accept(const mms::Motor &motor);
+
+    /*
+     * @brief Команда для мотора завершена
+     * @param motor Те же параметры, что и в accept()
+     * @param status Код ответа клиенту, 0 - успех: позиция сдвигается на motor.step
+     * */
+    void complete(const mms::Motor &motor, uint32_t status);
+
+    /*
+     * @brief Состояние одного мотора, без блокировок
+     * */
+    mms::MotorState get(int motor) const;
+
+private:
+    struct Entry
+    {
+        std::atomic<uint32_t> sequence{0}; // нечетное - идет запись
+        std::atomic<int64_t> position{0};
+        std::atomic<int32_t> step{0};
+        std::atomic<uint32_t> acceleration{0};
+        std::atomic<uint32_t> maxSpeed{0};
+        std::atomic<uint32_t> inFlight{0}; // принятые, но не завершенные команды
+        std::atomic<uint32_t> error{0};
+    };
+
+    int m_firstMotor;
+    int m_size;
+    std::unique_ptr<Entry[]> m_entries;
+    std::mutex m_writeMutex;
+
+    template <typename Update>
+    void write(int motor, Update update);
+};
+
+#endif // MOTOR_STATE_TABLE_HPP_
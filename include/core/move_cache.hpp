@@ -0,0 +1,85 @@
+#ifndef MOVE_CACHE_HPP_
+#define MOVE_CACHE_HPP_
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "dataframe.hpp"
+#include "mcu_transaction.hpp"
+#include "metrics.hpp"
+
+class DeviceChannel;
+
+/*
+ * @brief Проверенная и закодированная команда движения: части по платам с готовыми кадрами MCU
+ * */
+struct CompiledMove
+{
+    struct Part
+    {
+        DeviceChannel *channel;
+        std::vector<mms::Motor> motors; // номера глобальные, для MotorStateTable и событий
+        McuTransaction transaction;     // номера локальные для MCU платы
+    };
+
+    std::vector<mms::Motor> motors; // все моторы команды в порядке запроса
+    std::vector<Part> parts;
+};
+
+/*
+ * @brief MoveCache - кэш скомпилированных moving() и именованные рецепты.
+ *
+ * Ключ кэша - текст mms::MotorsSettings из запроса байт в байт: повторный запрос не разбирает JSON,
+ * не проверяет моторы и не кодирует кадры заново. Результат проверки зависит только от текста и
+ * раскладки моторов по платам, которая не меняется после запуска, поэтому записи не устаревают;
+ * при переполнении вытесняется самая давно использованная (LRU). Подключение плат проверяется
+ * на каждый запрос отдельно.
+ *
+ * Рецепты - скомпилированные команды, сохраненные клиентом под именем (save_recipe) и запускаемые
+ * по имени (run_recipe). Рецепты не вытесняются, их число ограничено MAX_RECIPES.
+ * */
+class MoveCache
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 256;
+    static constexpr size_t MAX_RECIPES = 64;
+    static constexpr size_t MAX_RECIPE_NAME = 64;
+
+    explicit MoveCache(size_t capacity = DEFAULT_CAPACITY);
+    MoveCache(const MoveCache &) = delete;
+    MoveCache &operator=(const MoveCache &) = delete;
+
+    /*
+     * @brief Скомпилированная команда для текста MotorsSettings, nullptr если ее нет в кэше
+     * */
+    std::shared_ptr<const CompiledMove> find(std::string_view settings);
+
+    void insert(std::string_view settings, std::shared_ptr<const CompiledMove> move);
+
+    /*
+     * @brief Сохранить рецепт, рецепт с тем же именем заменяется
+     * @return false, если рецептов уже MAX_RECIPES
+     * */
+    bool storeRecipe(const std::string &name, std::shared_ptr<const CompiledMove> move);
+
+    std::shared_ptr<const CompiledMove> recipe(const std::string &name) const;
+
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const CompiledMove>>;
+
+    size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::list<Entry> m_lru; // в начале - последняя использованная
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> m_index; // ключи - строки из m_lru
+    std::unordered_map<std::string, std::shared_ptr<const CompiledMove>> m_recipes;
+
+    MetricCounter &m_hits;
+    MetricCounter &m_misses;
+};
+
+#endif // MOVE_CACHE_HPP_
@@ -0,0 +1,129 @@
+#ifndef REQUEST_JOURNAL_HPP_
+#define REQUEST_JOURNAL_HPP_
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "network_serializer.hpp"
+#include "metrics.hpp"
+#include "clock.hpp"
+
+/*
+ * @brief RequestJournal - последние команды движения по ключу идемпотентности, чтобы повтор запроса
+ * клиентом (таймаут сокета на его стороне) не запускал движение второй раз.
+ *
+ * Ключ - имя клиента и pkg::Message::id (id > 0), повтор должен совпадать с исходным запросом и по тексту
+ * mms::Manager. Тот же id с другим текстом - новая команда, она заменяет прежнюю запись.
+ *
+ * - Команда еще выполняется: соединение повтора добавляется к ожидающим, ответ исходной команды уходит
+ *   и ему. Соединения различаются по номеру, а не по дескриптору: повтор после переподключения обычно
+ *   приходит с тем же дескриптором.
+ * - Команда завершена: повтор получает запомненный ответ без обращения к MCU.
+ *
+ * Завершенная запись отвечает на повторы retention после ответа: клиенты начинают id заново после
+ * перезапуска (mms_loadgen) или берут случайные (UI), и старый ответ на новую команду означал бы
+ * движение, которое молча не выполнилось. Завершенных записей хранится не больше capacity,
+ * вытесняются самые старые. Выполняющиеся записи не вытесняются.
+ * */
+class RequestJournal
+{
+public:
+    enum class State
+    {
+        New,      // команду нужно выполнить, ее ответ передается в complete(token, ...)
+        InFlight, // исходная команда выполняется, соединение повтора получит ее ответ
+        Done      // ответ уже есть в result
+    };
+
+    /*
+     * @brief Соединение клиента: дескриптор и номер, который UserCore выдает каждому новому соединению
+     * */
+    struct Connection
+    {
+        int fd = -1;
+        uint64_t id = 0;
+
+        bool operator==(const Connection &) const = default;
+    };
+
+    struct Claim
+    {
+        State state;
+        uint64_t token = 0;  // для New
+        pkg::Status result{}; // для Done
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    // Несколько таймаутов ответа UI (5 с): повтор после таймаута успевает застать запись
+    static constexpr std::chrono::seconds DEFAULT_RETENTION{30};
+
+    explicit RequestJournal(
+        size_t capacity = DEFAULT_CAPACITY, IClock::Duration retention = DEFAULT_RETENTION);
+    RequestJournal(const RequestJournal &) = delete;
+    RequestJournal &operator=(const RequestJournal &) = delete;
+
+    /*
+     * @brief Источник времени для срока записей, по умолчанию SystemClock. Задается до первого запроса
+     * */
+    void setClock(IClock &clock)
+    {
+        m_clock = &clock;
+    }
+
+    /*
+     * @brief Зарегистрировать запрос или найти исходный
+     * @param from соединение, с которого пришел запрос
+     * */
+    Claim claim(const std::string &client, int id, const std::string &text, Connection from);
+
+    /*
+     * @brief Ответ на команду token отправлен автору: запомнить его
+     * @return соединения повторов, которым нужно отправить тот же ответ
+     * */
+    std::vector<Connection> complete(uint64_t token, const pkg::Status &result);
+
+    /*
+     * @brief Соединение закрыто: дескриптор может достаться другому клиенту, ответы ему не отправляются.
+     * Исходный запрос тоже отвязывается от соединения, и повтор с нового соединения станет ожидающим
+     * */
+    void forget(int fd);
+
+private:
+    using Key = std::pair<std::string, int>;
+
+    struct Entry
+    {
+        Entry(uint64_t claimToken, std::string requestText, Connection requester)
+            : token(claimToken)
+            , text(std::move(requestText))
+            , from(requester)
+        {}
+
+        uint64_t token;
+        std::string text;
+        Connection from; // соединение исходного запроса, пустое после forget()
+        bool done = false;
+        pkg::Status result{};
+        IClock::TimePoint completedAt{};
+        std::vector<Connection> waiters;
+    };
+
+    size_t m_capacity;
+    IClock::Duration m_retention;
+    IClock *m_clock = &SystemClock::instance();
+    std::mutex m_mutex;
+    uint64_t m_nextToken = 1;
+    std::map<Key, Entry> m_entries;
+    std::unordered_map<uint64_t, Key> m_tokens;
+    std::deque<std::pair<uint64_t, Key>> m_completed; // порядок вытеснения
+
+    MetricCounter &m_replays;
+};
+
+#endif // REQUEST_JOURNAL_HPP_
@@ -2,10 +2,22 @@
 #define TRANSFORMATIONCORE_HPP_
 
 #include <bit>
+#include <mutex>
 
 #include "i_module.hpp"
 #include "network_serializer.hpp"
 #include "dataframe.hpp"
+#include "mcu_transaction.hpp"
+#include "device_manager.hpp"
+#include "motor_state_table.hpp"
+#include "event_hub.hpp"
+#include "device_inventory.hpp"
+#include "link_supervisor.hpp"
+#include "move_cache.hpp"
+#include "request_journal.hpp"
+#include "latency_histogram.hpp"
+#include "metrics.hpp"
+#include "clock.hpp"
 
 /*
  * +-+-+-+-+-+-+-+-+---------------------------------------------------------+
@@ -17,25 +29,56 @@
  * +-+-+-+-+-+-+-+-+---------------------------------------------------------+
  * |0|0|1|0|X|X|X|X|Запросить информацию о версии прошивки                   |
  * +-+-+-+-+-+-+-+-+---------------------------------------------------------+
- * command: [] version()
+ * |0|0|0|1|0|0|0|0|Экстренная остановка, движение завершается с кодом 0x0B  |
+ * +-+-+-+-+-+-+-+-+---------------------------------------------------------+
+ * Начиная с прошивки 2.0 (байт версии >= 0x20) заголовок 0x8N/0x4N и параметры моторов принимаются
+ * одной записью, без ожидания байта готовности между ними (см. McuTransaction).
+ *
+ * Сервис может управлять несколькими платами (см. DeviceManager): moving() раскладывается по платам
+ * по номерам моторов, части выполняются параллельно в потоках плат, клиент получает один ответ.
+ *
+ * command: [] version(), [refresh] version()
  *          [] moving(MotorsSettings)
+ *          [] program(Program)
+ *          [] save_recipe(Recipe), [name] run_recipe()
  *          [] reconnect(id)
  *          [] disconnect()
  *          [] listconnect()
+ *          [] status()
+ *          [] subscribe()
+ *          [] unsubscribe()
+ *          [] stop()
+ *
+ * stop() не встает в очередь платы: байт остановки пишется в MCU сразу из Process(), ожидание
+ * завершения текущего движения прерывается, а moving(), еще не начатые платой, отменяются.
+ *
+ * Повтор команды движения (moving, program, run_recipe) с тем же pkg::Message::id (> 0) и текстом от того
+ * же клиента не выполняется: клиент получает ответ исходной команды (см. RequestJournal).
+ *
+ * Подписанные соединения получают события (mms::Event) через EventHub: изменения состояния моторов,
+ * подключение и отключение плат, завершение команд других клиентов и ошибки.
  * */
 
 class UserCore : public ICore, public NetworkSerializer
 {
 public:
     UserCore() = delete;
-    UserCore(std::unique_ptr<IModule> module, std::unique_ptr<ISocket> socket)
+    UserCore(DeviceManager devices, std::unique_ptr<ISocket> socket)
         : ICore("MotorManagerService")
         , NetworkSerializer(std::move(socket))
-        , m_module(std::move(module))
-        , m_version(0.0f)
+        , m_devices(std::move(devices))
+        , m_motors(m_devices.firstMotor(), m_devices.lastMotor())
+    {
+        registerStats();
+    }
+    explicit UserCore(DeviceManager devices)
+        : UserCore(std::move(devices), std::make_unique<Socket>())
+    {}
+    UserCore(std::unique_ptr<IModule> module, std::unique_ptr<ISocket> socket)
+        : UserCore(DeviceManager(std::move(module)), std::move(socket))
     {}
     explicit UserCore(std::unique_ptr<IModule> module)
-        : UserCore(std::move(module), std::make_unique<Socket>())
+        : UserCore(DeviceManager(std::move(module)), std::make_unique<Socket>())
     {}
     UserCore(const UserCore &) = delete;
     UserCore(UserCore &&) = delete;
@@ -46,7 +89,8 @@ public:
 
     /**
      * @brief Инициализация ядра сервиса
-     * Выполняет начальный запрос версии устройства для верификации связи.
+     * Подключает платы с заданным deviceId, запускает их потоки ввода-вывода, дожидается чтения
+     * версий прошивок подключенных плат и запускает надзор за связью с ними (LinkSupervisor).
      */
     void Init() override;
     /**
@@ -56,38 +100,168 @@ public:
      * @param message Сериализованное сообщение `pkg::Message`
      */
     void Process(const int fd, const std::string &name, const std::string &message) override;
+    /**
+     * @brief Клиент отключился: соединение снимается с подписки на события, а ответы на его команды,
+     * которые еще выполняются, больше не пишутся в этот дескриптор
+     */
+    void Disconnected(const int fd) override;
     /**
      * @brief Запуск сервиса (при наличии фоновой логики)
      */
     void Launch() override;
     /**
-     * @brief Остановка сервиса (освобождение ресурсов)
+     * @brief Остановка сервиса: дожидается заданий плат, останавливает их потоки и выводит в лог
+     * сводку задержек по этапам (LatencyRegistry)
      */
     void Stop() override;
 
+    /**
+     * @brief Источник времени для таймаутов и пауз опроса MCU, по умолчанию SystemClock.
+     * Задается до Init() и первой команды, clock должен жить дольше ядра
+     */
+    void setClock(IClock &clock)
+    {
+        m_clock = &clock;
+        m_supervisor.setClock(clock);
+        m_journal.setClock(clock);
+    }
+
+    /**
+     * @brief Вес клиента в очередях плат: за круг обхода выполняется до weight его команд подряд
+     * (по умолчанию 1, см. FairQueue). Задается до Launch()
+     */
+    void setClientWeight(const std::string &client, uint32_t weight);
+    /**
+     * @brief Сколько команд одного клиента может ждать в очереди платы, сверх этого - ошибка `40520`.
+     * Задается до Launch()
+     */
+    void setClientQueueLimit(size_t limit)
+    {
+        m_clientQueueLimit = limit;
+    }
+
+    static constexpr std::chrono::milliseconds MCU_TIMEOUT{5000};       // ожидание готовности/завершения
+    static constexpr std::chrono::milliseconds MCU_POLL_INTERVAL{100};  // шаг опроса checkRXChannel()
+    static constexpr std::chrono::milliseconds MOVE_SETTLE_DELAY{200};  // пауза после записи параметров
+    static constexpr std::chrono::milliseconds VERSION_REPLY_DELAY{100}; // предел ожидания ответа на версию
+    static constexpr std::chrono::milliseconds PROGRAM_POLL_INTERVAL{5}; // шаг опроса MCU в шагах program()
+    static constexpr size_t MAX_PROGRAM_STEPS = 1000;
+    static constexpr size_t DEFAULT_CLIENT_QUEUE = 16; // команд клиента в очереди одной платы
+
 private:
-    using uinfo = std::pair<int, std::string>;
+    /*
+     * @brief Клиент запроса: дескриптор, имя и номер соединения. Номер выдается при первом запросе с
+     * дескриптора и снимается в Disconnected(): ответ, досчитанный после закрытия, не уйдет клиенту,
+     * которому accept() отдал тот же дескриптор
+     * */
+    struct uinfo
+    {
+        int fd;
+        std::string name;
+        uint64_t connection = 0;
+    };
     using MethodPtr = void (UserCore::*)(const uinfo &, const std::string &);
+    using Shard = std::pair<DeviceChannel *, mms::MotorsSettings>; // часть moving() для одной платы
+
+    /*
+     * @brief Ответ, собираемый из частей, выполняемых на разных платах. Отправляется, когда
+     * завершится последняя часть: первая ошибка или успех
+     * */
+    struct PendingReply
+    {
+        PendingReply(const uinfo &u, size_t parts)
+            : user(u)
+            , remaining(parts)
+        {}
+
+        uinfo user;
+        std::mutex mutex;
+        size_t remaining;
+        pkg::Status result{"", "", 0};
+    };
 
-    std::unique_ptr<IModule> m_module;
-    float m_version;
+    /*
+     * @brief Выполняемая program(): шаги идут один за другим без обмена с клиентом между ними. Шаг
+     * раскладывается по платам как moving(), следующий начинается, когда последняя плата завершила
+     * свою часть. Первая ошибка останавливает программу
+     * */
+    struct ProgramRun
+    {
+        explicit ProgramRun(const uinfo &u)
+            : user(u)
+        {}
+
+        uinfo user;
+        std::vector<std::shared_ptr<const CompiledMove>> steps;
+        std::unordered_map<const DeviceChannel *, uint64_t> stopEpochs; // на момент приема команды
+        std::mutex mutex;
+        size_t step = 0;
+        size_t remaining = 0; // части текущего шага, которые еще выполняются
+        pkg::Status result{"", "", 0};
+    };
+
+    DeviceManager m_devices;
+    MotorStateTable m_motors; // состояние моторов для status(), обновляется moving()
+    IClock *m_clock = &SystemClock::instance();
+    size_t m_clientQueueLimit = DEFAULT_CLIENT_QUEUE;
+    std::mutex m_replyMutex; // ответы уходят и из Process(), и из потоков плат
+    std::unordered_map<int, uint64_t> m_connections; // дескриптор -> номер соединения, под m_replyMutex
+    uint64_t m_lastConnection = 0;
+    EventHub m_events{[this](int fd, std::string_view frame) { return pushFrame(fd, frame); }};
+
+    // Устройства для listconnect(): перечисляет фоновый поток, ответ пересобирается по generation
+    DeviceInventory m_inventory{[this]() { return m_devices.primary().module().listComs(); }};
+    uint64_t m_listGeneration = 0;
+    std::string m_listMessage; // serialize(mms::ListConnect) для m_listGeneration
+
+    // Ответы на последние команды движения по (клиент, pkg::Message::id): повтор не двигает моторы
+    RequestJournal m_journal;
+
+    // Скомпилированные moving() по тексту настроек и рецепты save_recipe()/run_recipe()
+    MoveCache m_moves;
+
+    // Проверка связи с платами в простое и переподключение к последнему deviceId
+    LinkSupervisor m_supervisor{
+        m_devices,
+        [this](DeviceChannel &channel) { linkLost(channel); },
+        [this](DeviceChannel &channel) { linkRestored(channel); }};
 
     std::unordered_map<std::string, MethodPtr> m_methods = {
         {"version", &UserCore::version},
         {"moving", &UserCore::moving},
+        {"program", &UserCore::program},
+        {"save_recipe", &UserCore::save_recipe},
+        {"run_recipe", &UserCore::run_recipe},
         {"reconnect", &UserCore::reconnect},
         {"disconnect", &UserCore::disconnect},
-        {"listconnect", &UserCore::listconnect}};
+        {"listconnect", &UserCore::listconnect},
+        {"status", &UserCore::status},
+        {"subscribe", &UserCore::subscribe},
+        {"unsubscribe", &UserCore::unsubscribe},
+        {"stop", &UserCore::stop}};
+
+    // Гистограммы задержек и счетчики вызовов для каждой команды из m_methods, см. registerStats()
+    struct CommandStats
+    {
+        LatencyRegistry::Stages *latency;
+        MetricCounter *calls;
+    };
+    std::unordered_map<std::string, CommandStats> m_commandStats;
+    MetricCounter *m_unknownCommands = nullptr;
+    std::unordered_map<uint32_t, MetricCounter *> m_errorCounters; // mms_errors_total по кодам
 
     /**
      * @brief Команда version()
      * 
-     * Отправляет запрос версии прошивки в микроконтроллер и возвращает
-     * структуру `mms::Version` (через `pkg::Status`). Версия кодируется одним байтом:
+     * Возвращает версию прошивки основной платы как структуру `mms::Version` (через `pkg::Status`).
+     * Версия читается из MCU один раз после подключения (Init(), reconnect()) и хранится в памяти,
+     * поэтому команда обычно отвечает без обращения к плате. С сообщением "refresh" версия
+     * перечитывается из MCU. Версия кодируется одним байтом:
      * старшие 4 бита — целая часть, младшие 4 бита — дробная часть (x.y).
+     * По байту версии выбирается режим отправки moving(): одной записью или в два этапа.
      * 
      * Правила и проверки:
-     * - Сообщение `message` обязано быть пустым, иначе ошибка `40506`.
+     * - Сообщение `message` обязано быть пустым или "refresh", иначе ошибка `40506`.
      * - Требуется активное соединение с модулем, иначе ошибка `40507`.
      * 
      * Ответ:
@@ -97,29 +271,98 @@ private:
      * @param message Должна быть пустой строкой
      */
     void version(const uinfo &u, const std::string &message);
+    void replyVersion(const uinfo &u, const DeviceChannel::Firmware &firmware);
+
+    /*
+     * @brief Запрос версии прошивки у MCU (в потоке платы), результат запоминается в канале
+     * */
+    DeviceChannel::Firmware readFirmware(DeviceChannel &channel);
+
+    /*
+     * @brief Чтение версии при подключении платы (Init, reconnect, LinkSupervisor): по ней moving()
+     * выбирает формат кадра. Ошибка только логируется, до следующего чтения кадры идут двумя записями
+     * */
+    void detectFirmware(DeviceChannel &channel);
     /**
      * @brief Команда moving(MotorsSettings)
      * 
      * Принимает сериализованные настройки двигателей `mms::MotorsSettings`,
      * валидирует режим работы ("synchronous"|"asynchronous") и параметры каждого двигателя
-     * (кол-во не более 10, номер 1..10, acceleration>0, maxSpeed>0). В дальнейшем
-     * выполняет соответствующую команду на модуле (реализация управления — отдельно).
+     * (кол-во не более 10 на плату, номер в диапазоне моторов плат, acceleration>0, maxSpeed>0).
+     * Моторы раскладываются по платам, на каждой плате команда выполняется в ее потоке.
+     * Проверенная и закодированная команда запоминается в MoveCache: повторный запрос с тем же
+     * текстом настроек не разбирается и не проверяется заново (кроме подключения плат).
      * 
      * Правила и проверки:
      * - Требуется активное соединение с модулем, иначе ошибка `40507`.
      * - Ошибка десериализации настроек — `40402`.
      * - Некорректный `mode` — `40501`.
      * - Нарушение ограничений по массиву/параметрам моторов — `40502..40505`.
+     * - У клиента уже setClientQueueLimit() команд в очереди платы — `40520`.
      * 
      * @param u Информация о пользователе
      * @param message Сериализованный `mms::MotorsSettings`
      */
     void moving(const uinfo &u, const std::string &message);
+    /**
+     * @brief Команда program(Program)
+     *
+     * Принимает сериализованный `mms::Program` - упорядоченный список шагов `mms::MotorsSettings`.
+     * Все шаги проверяются до первого обращения к MCU по тем же правилам, что и moving(), затем
+     * выполняются подряд: следующий шаг уходит в MCU сразу после завершения предыдущего, без паузы
+     * MOVE_SETTLE_DELAY и с опросом MCU раз в PROGRAM_POLL_INTERVAL.
+     *
+     * После каждого шага автор команды получает событие `mms::Event` с `type = "progress"`,
+     * `what = "step i/N"` и состоянием моторов шага (его же получают подписчики), в конце - один ответ.
+     *
+     * Правила и проверки:
+     * - Требуется активное соединение с модулем, иначе ошибка `40507`.
+     * - Ошибка десериализации программы — `40404`.
+     * - Нет шагов или их больше MAX_PROGRAM_STEPS — `40517`.
+     * - Ошибки проверки шага — как у moving(), в `what` указан номер шага.
+     *
+     * Ответ: `status = 0` после последнего шага или первая ошибка выполнения с номером шага в `what`
+     * (остальные шаги не выполняются, stop() отменяет программу с `40516`).
+     *
+     * @param u Информация о пользователе
+     * @param message Сериализованный `mms::Program`
+     */
+    void program(const uinfo &u, const std::string &message);
+    /**
+     * @brief Команда save_recipe(Recipe)
+     *
+     * Проверяет и компилирует `settings` по правилам moving() и сохраняет под именем `name`
+     * (рецепт с тем же именем заменяется). К MCU не обращается, подключение плат не требуется.
+     *
+     * Правила и проверки:
+     * - Ошибка десериализации рецепта — `40405`.
+     * - Пустое имя или длиннее MoveCache::MAX_RECIPE_NAME, рецептов уже MoveCache::MAX_RECIPES — `40519`.
+     * - Ошибки проверки настроек — как у moving().
+     *
+     * @param u Информация о пользователе
+     * @param message Сериализованный `mms::Recipe`
+     */
+    void save_recipe(const uinfo &u, const std::string &message);
+    /**
+     * @brief Команда run_recipe(name)
+     *
+     * Выполняет сохраненный рецепт как moving() без разбора и проверки настроек. Ответ - как у moving().
+     *
+     * Правила и проверки:
+     * - Требуется активное соединение с модулем, иначе ошибка `40507`.
+     * - Рецепта с таким именем нет — `40518`.
+     *
+     * @param u Информация о пользователе
+     * @param message Имя рецепта
+     */
+    void run_recipe(const uinfo &u, const std::string &message);
     /**
      * @brief Команда reconnect(id)
      * 
      * Принимает сериализованный `mms::Device` с `deviceId` и пытается подключиться
-     * к указанному устройству.
+     * к указанному устройству. При одной плате подключается она, при нескольких - плата,
+     * для которой задан этот `deviceId`. После подключения из MCU читается версия прошивки
+     * (см. version()).
      * 
      * Правила и проверки:
      * - Ошибка десериализации `mms::Device` — `40403`.
@@ -136,7 +379,7 @@ private:
     /**
      * @brief Команда disconnect()
      * 
-     * Отключает текущее устройство от модуля.
+     * Отключает все платы.
      * 
      * Правила и проверки:
      * - Сообщение `message` обязано быть пустым, иначе ошибка `40506`.
@@ -152,7 +395,9 @@ private:
     /**
      * @brief Команда listconnect()
      * 
-     * Возвращает список доступных устройств. Подключение к модулю не требуется.
+     * Возвращает список доступных устройств. Подключение к модулю не требуется. Список берется из
+     * DeviceInventory без обращения к USB, готовый mms::ListConnect пересобирается только после
+     * изменения списка (таймер, hotplug, reconnect/disconnect).
      * 
      * Правила и проверки:
      * - Сообщение `message` обязано быть пустым, иначе ошибка `40506`.
@@ -164,11 +409,84 @@ private:
      * @param message Должна быть пустой строкой
      */
     void listconnect(const uinfo &u, const std::string &message);
+    /**
+     * @brief Команда status()
+     * 
+     * Возвращает состояние всех моторов плат из памяти сервиса: позицию, параметры последней команды,
+     * занятость и код последней ошибки. К платам не обращается и не ждет их потоков, поэтому
+     * отвечает и во время движения. Подключение к модулю не требуется.
+     * 
+     * Правила и проверки:
+     * - Сообщение `message` обязано быть пустым, иначе ошибка `40506`.
+     * 
+     * Ответ:
+     * - `status = 0`, `what = "mms::MotorsState"`, `subMessage = serialize(mms::MotorsState)`.
+     * 
+     * @param u Информация о пользователе
+     * @param message Должна быть пустой строкой
+     */
+    void status(const uinfo &u, const std::string &message);
+    /**
+     * @brief Команда subscribe()
+     * 
+     * Подписывает соединение на события сервиса. Каждое событие приходит отдельным сообщением
+     * `pkg::Status` с `what = "mms::Event"` и `subMessage = serialize(mms::Event)`:
+     * - `motors` - изменилось состояние моторов (команда принята или завершена), в `motors` их состояние;
+     * - `connected` / `disconnected` - плата подключена или отключена, `source = "device N"`;
+     * - `completed` / `error` - другой клиент (`source`) получил ответ на команду `command`.
+     * Повторная подписка не ошибка. Подключение к модулю не требуется.
+     * 
+     * Правила и проверки:
+     * - Сообщение `message` обязано быть пустым, иначе ошибка `40506`.
+     * 
+     * Ответ при успехе:
+     * - `status = 0`, `what = ""`, `subMessage = ""`.
+     * 
+     * @param u Информация о пользователе
+     * @param message Должна быть пустой строкой
+     */
+    void subscribe(const uinfo &u, const std::string &message);
+    /**
+     * @brief Команда unsubscribe()
+     * 
+     * Снимает соединение с подписки, события, которые уже в его очереди, не отправляются.
+     * 
+     * Правила и проверки:
+     * - Сообщение `message` обязано быть пустым, иначе ошибка `40506`.
+     * 
+     * Ответ при успехе:
+     * - `status = 0`, `what = ""`, `subMessage = ""`.
+     * 
+     * @param u Информация о пользователе
+     * @param message Должна быть пустой строкой
+     */
+    void unsubscribe(const uinfo &u, const std::string &message);
+    /**
+     * @brief Команда stop()
+     * 
+     * Экстренная остановка всех подключенных плат. Выполняется в обход очередей плат: байт `0x10`
+     * уходит в MCU сразу, поток платы, который ждет завершения движения, просыпается и читает ответ
+     * MCU без паузы опроса. Движение завершается ошибкой `40516`, команды moving(), которые стоят
+     * в очереди платы, отменяются с той же ошибкой без обращения к MCU.
+     * 
+     * Правила и проверки:
+     * - Сообщение `message` обязано быть пустым, иначе ошибка `40506`.
+     * - Ни одна плата не подключена - ошибка `40507`.
+     * 
+     * Ответ при успехе:
+     * - `status = 0`, `what = ""`, `subMessage = ""`.
+     * 
+     * @param u Информация о пользователе
+     * @param message Должна быть пустой строкой
+     */
+    void stop(const uinfo &u, const std::string &message);
 
     std::optional<pkg::Message> deserializeMessage(const uinfo &, const std::string &);
     std::optional<mms::Manager> deserializeManager(const uinfo &, const std::string &);
     std::optional<mms::MotorsSettings> deserializeMotorsSettings(const uinfo &, const std::string &);
     std::optional<mms::Device> deserializeDevice(const uinfo &, const std::string &);
+    std::optional<mms::Program> deserializeProgram(const uinfo &, const std::string &);
+    std::optional<mms::Recipe> deserializeRecipe(const uinfo &, const std::string &);
     bool checkMode(const uinfo &, const mms::MotorsSettings &);
     bool checkMotors(const uinfo &, const mms::MotorsSettings &);
     /**
@@ -201,6 +519,111 @@ private:
      * @return true если подключение не удалось (ошибка), false если успех (OK)
      */
     bool checkConnectResult(const uinfo &, int deviceId, bool ok);
+    /**
+     * @brief Проверяет, что плата еще не подключена (для reconnect)
+     * @return true если плата уже подключена (ошибка), false если нет (OK)
+     */
+    bool checkAlreadyConnected(const uinfo &, DeviceChannel &channel);
+    /**
+     * @brief Проверяет части moving(): на плату не более 10 моторов
+     * @return true если есть ошибка, false если OK
+     */
+    bool checkShards(const uinfo &, const std::vector<Shard> &);
+    /**
+     * @brief Проверяет, что дополнительные платы команды подключены (или переподключаются)
+     * @return true если есть ошибка, false если OK
+     */
+    bool checkBoards(const uinfo &, const CompiledMove &move);
+    /**
+     * @brief Проверяет, что у клиента не больше m_clientQueueLimit команд в очереди каждой платы команды
+     * @return true если есть ошибка, false если OK
+     */
+    bool checkBacklog(const uinfo &, const CompiledMove &move);
+    /**
+     * @brief Проверка настроек по правилам moving() и кодирование кадров MCU по платам
+     * @return nullptr, если настройки неверны (клиенту уже отправлена ошибка)
+     */
+    std::shared_ptr<const CompiledMove> compile(const uinfo &, const mms::MotorsSettings &settings);
+    /**
+     * @brief Поставить части скомпилированной команды в очереди плат, ответ - после последней части
+     */
+    void startMove(const uinfo &u, const std::shared_ptr<const CompiledMove> &move);
+    /**
+     * @brief Выполнение moving() на одной плате, кадр уже закодирован с локальными номерами (1..10)
+     * @param stopEpoch DeviceChannel::stopEpoch() на момент приема команды: если он изменился,
+     * команда отменена stop() и к MCU не обращается
+     * @param streamed шаг program(): без MOVE_SETTLE_DELAY, опрос MCU раз в PROGRAM_POLL_INTERVAL
+     * @return Статус для клиента
+     */
+    pkg::Status executeMove(
+        DeviceChannel &channel,
+        const McuTransaction &transaction,
+        const uinfo &u,
+        uint64_t stopEpoch,
+        bool streamed = false);
+    /**
+     * @brief Разложить моторы по платам, номера пересчитываются в локальные для MCU
+     */
+    std::vector<Shard> splitByBoard(const mms::MotorsSettings &settings);
+    /**
+     * @brief Учесть завершение одной части составного ответа
+     */
+    void finishPart(const std::shared_ptr<PendingReply> &pending, const pkg::Status &status);
+    /**
+     * @brief Поставить части текущего шага программы в очереди плат
+     */
+    void startStep(const std::shared_ptr<ProgramRun> &run);
+    /**
+     * @brief Учесть завершение части шага: после последней - событие "progress" и следующий шаг
+     * или итоговый ответ
+     */
+    void finishStep(const std::shared_ptr<ProgramRun> &run, const pkg::Status &status);
+    /**
+     * @brief Регистрация метрик и гистограмм задержек команд, вызывается из конструктора
+     */
+    void registerStats();
+    /**
+     * @brief Отправка статуса клиенту, замеряет сериализацию, запись в сокет и полное время запроса
+     */
+    void reply(const uinfo &, const pkg::Status &status);
+    /**
+     * @brief Разослать событие подписчикам, кроме соединения except. Без подписчиков ничего не делает
+     */
+    void publishEvent(const mms::Event &event, int except = -1);
+    /**
+     * @brief Кадр события: `pkg::Status` с `what = "mms::Event"` и разделителем в конце
+     */
+    std::string eventFrame(const mms::Event &event);
+    /**
+     * @brief Событие "motors" с текущим состоянием моторов (глобальные номера)
+     */
+    void publishMotors(const std::vector<mms::Motor> &motors, const std::string &source);
+    /**
+     * @brief Запись кадра события в соединение из потока рассылки EventHub
+     * @return false, если запись не удалась
+     */
+    bool pushFrame(int fd, std::string_view frame);
+    /**
+     * @brief Запись кадра клиенту запроса, если его соединение еще открыто
+     */
+    bool pushFrame(const uinfo &u, std::string_view frame);
+    /**
+     * @brief Номер соединения fd, выдается при первом запросе
+     */
+    uint64_t connectionOf(int fd);
+    /**
+     * @brief Соединение клиента еще открыто, вызывается под m_replyMutex
+     */
+    bool connected(const uinfo &u) const;
+    /**
+     * @brief LinkSupervisor потерял связь с платой: версия прошивки забывается, подписчики получают
+     * событие "disconnected"
+     */
+    void linkLost(DeviceChannel &channel);
+    /**
+     * @brief LinkSupervisor переподключил плату: событие "connected" и чтение версии прошивки
+     */
+    void linkRestored(DeviceChannel &channel);
 };
 
 #endif // TRANSFORMATIONCORE_HPP_
@@ -42,6 +42,52 @@
     "command": "version",
     "message": ""
 }
+
+7) mms::MotorState
+{
+    "number": 1,
+    "position": 150,
+    "step": -50,
+    "acceleration": 2000,
+    "maxSpeed": 5000,
+    "busy": false,
+    "error": 0
+}
+
+8) mms::MotorsState
+{
+    "motors": [
+        {"number": 1, "position": 150, "step": -50, "acceleration": 2000, "maxSpeed": 5000,
+         "busy": false, "error": 0}
+    ]
+}
+
+9) mms::Event
+{
+    "type": "completed",
+    "source": "dashboard",
+    "command": "moving",
+    "status": 0,
+    "what": "",
+    "motors": []
+}
+
+10) mms::Program
+{
+    "steps": [
+        {"mode": "synchronous",
+         "motors": [{"number": 1, "acceleration": 2000, "maxSpeed": 5000, "step": 100}]},
+        {"mode": "asynchronous",
+         "motors": [{"number": 2, "acceleration": 1500, "maxSpeed": 4500, "step": -50}]}
+    ]
+}
+
+11) mms::Recipe
+{
+    "name": "home",
+    "settings": {"mode": "synchronous",
+                 "motors": [{"number": 1, "acceleration": 2000, "maxSpeed": 5000, "step": -100}]}
+}
 */
 
 // clang-format off
@@ -93,11 +139,54 @@ BOOST_FUSION_DEFINE_STRUCT(
     (std::string, command)  // command
     (std::string, message)  // сообщение для команды
 )
+BOOST_FUSION_DEFINE_STRUCT(
+    (mms), MotorState,
+    (int, number)
+    (int64_t, position)       // сумма шагов успешно выполненных команд
+    (int32_t, step)           // шаги последней принятой команды
+    (uint32_t, acceleration)
+    (uint32_t, maxSpeed)
+    (bool, busy)              // есть принятые, но еще не завершенные команды
+    (uint32_t, error)         // код ошибки последней завершенной команды, 0 - успех
+)
+
+BOOST_FUSION_DEFINE_STRUCT(
+    (mms), MotorsState,
+    (std::vector<mms::MotorState>, motors)
+)
+
+BOOST_FUSION_DEFINE_STRUCT(
+    (mms), Event,
+    (std::string, type)       // "motors" | "connected" | "disconnected" | "completed" | "error" | "progress"
+    (std::string, source)     // имя клиента или "device N"
+    (std::string, command)    // команда, к которой относится событие
+    (uint32_t, status)        // код ответа на команду
+    (std::string, what)
+    (std::vector<mms::MotorState>, motors) // для "motors": моторы, состояние которых изменилось
+)
+
+BOOST_FUSION_DEFINE_STRUCT(
+    (mms), Program,
+    (std::vector<mms::MotorsSettings>, steps) // выполняются по порядку, каждый как moving()
+)
+
+BOOST_FUSION_DEFINE_STRUCT(
+    (mms), Recipe,
+    (std::string, name)
+    (mms::MotorsSettings, settings)
+)
+
 // command: version()
 //          moving(MotorsSettings)
+//          program(Program)
+//          save_recipe(Recipe)
+//          run_recipe(name)
 //          reconnect(id)
 //          disconnect()
 //          listconnect()
+//          status()
+//          subscribe()
+//          unsubscribe()
 // clang-format on
 
 #endif // DATAFRAME_HPP_
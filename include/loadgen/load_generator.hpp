@@ -0,0 +1,149 @@
+#ifndef LOAD_GENERATOR_HPP_
+#define LOAD_GENERATOR_HPP_
+
+#include "latency_histogram.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+ * @brief Команды, которые умеет посылать генератор нагрузки
+ * */
+enum class LoadCommand : uint8_t
+{
+    Version = 0,
+    ListConnect,
+    Moving,
+    Count
+};
+
+/*
+ * @brief Режим нагрузки
+ *
+ * Closed - у каждого соединения не больше одного запроса в полете, следующий уходит после ответа
+ * (при заданном rate - не раньше своего времени по расписанию).
+ * Open - запросы уходят по расписанию с частотой rate независимо от ответов, очередь соединения
+ * ограничена maxInFlight.
+ * */
+enum class LoadMode : uint8_t
+{
+    Closed = 0,
+    Open
+};
+
+/*
+ * @brief Доли команд в нагрузке, например "version=5,listconnect=3,moving=1"
+ * */
+struct CommandMix
+{
+    unsigned version = 1;
+    unsigned listconnect = 1;
+    unsigned moving = 0;
+
+    unsigned total() const
+    {
+        return version + listconnect + moving;
+    }
+
+    /*
+     * @brief Команда номер n в детерминированной последовательности: веса раскладываются равномерно
+     * (алгоритм smooth weighted round-robin), так что при любых n доли соблюдаются с точностью до 1
+     * */
+    LoadCommand pick(uint64_t n) const;
+
+    static std::optional<CommandMix> parse(const std::string &text);
+};
+
+struct LoadConfig
+{
+    std::string host = "127.0.0.1";
+    int port = 38000;
+    size_t connections = 1;
+    LoadMode mode = LoadMode::Closed;
+    double rate = 0.0; // запросов в секунду на все соединения, 0 - без расписания (только Closed)
+    size_t maxInFlight = 64;
+    std::chrono::milliseconds duration{10000};
+    std::chrono::milliseconds drainTimeout{6000}; // больше таймаута MCU в UserCore (5 с)
+    CommandMix mix;
+    size_t motors = 1; // моторов в moving, номера 1..motors
+    std::string name = "loadgen";
+};
+
+/*
+ * @brief Итоги прогона
+ *
+ * service - от фактической отправки до ответа.
+ * corrected - от времени отправки по расписанию до ответа: учитывает время, которое запрос
+ * провел бы в очереди, если бы клиент не ждал сервер (coordinated omission). Без расписания
+ * (Closed без rate) совпадает с service.
+ * */
+struct LoadReport
+{
+    uint64_t sent = 0;
+    uint64_t completed = 0;
+    uint64_t errors = 0;     // ответы со status != 0
+    uint64_t unanswered = 0; // не дождались ответа до конца drainTimeout
+    uint64_t late = 0;       // отправлены позже расписания, т.к. очередь соединения была полна
+    size_t connectionsFailed = 0;
+    double elapsedSec = 0.0;
+
+    LatencyHistogram::Snapshot service;
+    LatencyHistogram::Snapshot corrected;
+    uint64_t perCommand[static_cast<size_t>(LoadCommand::Count)]{};
+
+    double throughput() const
+    {
+        return elapsedSec > 0.0 ? static_cast<double>(completed) / elapsedSec : 0.0;
+    }
+
+    /*
+     * @brief Текстовый отчет: счетчики, пропускная способность и перцентили в мкс
+     * */
+    std::string format() const;
+};
+
+/*
+ * @brief LoadGenerator - клиент для нагрузочного тестирования сервиса.
+ *
+ * Открывает connections соединений, каждое представляется через pkg::WhoWantsToTalkToMe
+ * ("<name>-<i>"), и в одном потоке через poll() шлет pkg::Message с mms::Manager по смеси mix.
+ * В Open режиме расписание общее: запрос k уходит в t0 + k / rate по соединению k % connections.
+ *
+ * pkg::Status не несет id запроса, поэтому ответ сопоставляется по содержимому: "mms::Version" и
+ * "mms::ListConnect" - с самым старым запросом этой команды, успешный пустой ответ - с самым
+ * старым moving, ошибки - с самым старым запросом соединения. listconnect обслуживается в потоке
+ * Server и может обогнать version/moving, которые ждут поток платы.
+ * */
+class LoadGenerator
+{
+public:
+    explicit LoadGenerator(LoadConfig config);
+
+    /*
+     * @brief Прогон длительностью config.duration плюс ожидание ответов. Блокирует поток
+     * */
+    LoadReport run();
+
+    /*
+     * @brief Сериализованный pkg::Message для команды (без \n\n)
+     * */
+    static std::string request(LoadCommand command, int id, size_t motors);
+
+    /*
+     * @brief Команда, к которой относится ответ, если ее можно определить по содержимому
+     * */
+    static std::optional<LoadCommand> classify(
+        const std::string &what,
+        const std::string &subMessage,
+        uint32_t status);
+
+    static const char *commandName(LoadCommand command);
+
+private:
+    LoadConfig m_config;
+};
+
+#endif // LOAD_GENERATOR_HPP_
@@ -0,0 +1,111 @@
+#ifndef DEVICE_INVENTORY_HPP_
+#define DEVICE_INVENTORY_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics.hpp"
+
+/*
+ * @brief DeviceInventory - список USB-устройств в памяти, чтобы listconnect не перечислял шину на
+ * каждый запрос.
+ *
+ * Перечисление (FT_CreateDeviceInfoList + FT_GetDeviceInfoList у FT232RL) медленное и мешает открытому
+ * устройству, поэтому его делает фоновый поток по событиям hotplug. На Linux события приходят из
+ * netlink-сокета uevent ядра (add/remove в подсистемах usb и tty), и таймер только страхует от
+ * потерянных событий (hotplugInterval). На остальных платформах и без прав на сокет список
+ * перечисляется по таймеру (interval).
+ *
+ * snapshot() отдает последний список без обращения к устройствам. generation меняется, только когда
+ * список действительно изменился: по нему потребитель понимает, что готовый ответ можно не пересобирать.
+ * Пока поток не запущен (start() не вызывался, например в unit-тестах), список перечисляется при первом
+ * snapshot() и после invalidate().
+ * */
+class DeviceInventory
+{
+public:
+    using Source = std::function<std::vector<std::string>()>;
+
+    struct Snapshot
+    {
+        std::vector<std::string> devices;
+        uint64_t generation = 0;
+    };
+
+    static constexpr std::chrono::milliseconds DEFAULT_INTERVAL{2000};   // без hotplug-сокета
+    static constexpr std::chrono::milliseconds HOTPLUG_INTERVAL{60000};  // с ним: события могли потеряться
+    static constexpr std::chrono::milliseconds HOTPLUG_SETTLE{200}; // пачка uevent на одно устройство
+
+    DeviceInventory() = delete;
+    explicit DeviceInventory(
+        Source source,
+        std::chrono::milliseconds interval = DEFAULT_INTERVAL,
+        std::chrono::milliseconds hotplugInterval = HOTPLUG_INTERVAL);
+    DeviceInventory(const DeviceInventory &) = delete;
+    DeviceInventory(DeviceInventory &&) = delete;
+    ~DeviceInventory();
+
+    DeviceInventory &operator=(const DeviceInventory &) = delete;
+    DeviceInventory &operator=(DeviceInventory &&) = delete;
+
+    void start();
+    void stop();
+
+    /*
+     * @brief Последний список устройств
+     * */
+    std::shared_ptr<const Snapshot> snapshot();
+
+    /*
+     * @brief Перечислить устройства сейчас
+     * @return true, если список изменился
+     * */
+    bool refresh();
+
+    /*
+     * @brief Список мог устареть (устройство открыто или закрыто): перечислить при первой возможности
+     * */
+    void invalidate();
+
+    /*
+     * @brief Поток слушает hotplug-события ядра, таймер только страховочный
+     * */
+    bool hotplug() const;
+
+private:
+    Source m_source;
+    std::chrono::milliseconds m_interval;
+    std::chrono::milliseconds m_hotplugInterval;
+
+    std::mutex m_refreshMutex; // одно перечисление за раз
+    mutable std::mutex m_mutex;
+    std::shared_ptr<const Snapshot> m_current;
+    bool m_stale = true;
+    bool m_running = false;
+    std::thread m_thread;
+    int m_wakePipe[2] = {-1, -1}; // будит поток из stop() и invalidate()
+    int m_hotplugFd = -1;
+
+    MetricCounter &m_enumerations;
+
+    /*
+     * @brief Перечисление под m_refreshMutex
+     * */
+    bool enumerate();
+    void workerLoop();
+    void wake();
+
+    /*
+     * @brief Ждать до timeout, события hotplug или wake()
+     * @return true, если пришло событие hotplug
+     * */
+    bool waitForChange(std::chrono::milliseconds timeout);
+};
+
+#endif // DEVICE_INVENTORY_HPP_
@@ -4,6 +4,8 @@
 #include "i_module.hpp"
 #include "exceptions.hpp"
 
+#include <atomic>
+
 extern "C"
 {
 #include "ftd2xx.h"
@@ -49,6 +51,14 @@ public:
         const uchar stopbit = FT_STOP_BITS_1,
         const uchar parity = FT_PARITY_NONE) override;
 
+    /* @brief setLinkProfile - задание профиля канала (таймер задержки, размеры USB-транзакций,
+     * управление потоком, event char, таймауты). Если устройство уже подключено, профиль применяется
+     * сразу, иначе - при следующем connect
+     * @param profile - профиль, см. LinkProfile::lowLatency() и LinkProfile::bulk()
+     * */
+    void setLinkProfile(const LinkProfile &profile) override;
+    LinkProfile getLinkProfile() const override;
+
     void waitWriteSuccess() override;
     size_t checkRXChannel() const override;
 
@@ -74,13 +84,16 @@ public:
 private:
     unsigned int m_deviceId;
     int m_baudrate;
-    bool m_connected;
+    std::atomic<bool> m_connected; // пишет поток платы, isConnected() читает поток Process
+    LinkProfile m_profile;
 
     // http://microsin.net/programming/pc/ftdi-d2xx-functions-api.html - ds
     FT_HANDLE ftHandle;
     DWORD BytesReceived;
     DWORD BytesWritten;
 
+    // Информация только о подключенном устройстве: раньше это был массив [3] с индексом по deviceId,
+    // который переполнялся на четвертом и следующих устройствах
     struct DeviceInfo
     {
         DWORD flags_;
@@ -92,10 +105,11 @@ private:
         char description_[64];
 
         FT_HANDLE ftHandleTemp_;
-    } device_info_[3];
+    } device_info_{};
 
-    std::mutex mutex_;
+    mutable std::mutex mutex_;
 
+    void applyLinkProfile(const LinkProfile &);
     void getDeviceInfo(const int);
     static std::vector<FT_DEVICE_LIST_INFO_NODE> getDeviceList();
 };
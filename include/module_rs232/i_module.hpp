@@ -11,6 +11,8 @@
 #include <stdlib.h>
 #include <thread>
 
+#include "link_profile.hpp"
+
 using uchar = unsigned char;
 
 class IModule
@@ -27,6 +29,8 @@ public:
     virtual int getBaudRate() = 0;
     virtual void setUSBParameters(const int, const int) = 0;
     virtual void setCharacteristics(const uchar, const uchar, const uchar) = 0;
+    virtual void setLinkProfile(const LinkProfile&) = 0;
+    virtual LinkProfile getLinkProfile() const = 0;
     virtual void waitWriteSuccess() = 0;
     virtual size_t checkRXChannel() const = 0;
     virtual void writeData(const std::vector<uchar>& data) = 0;
@@ -0,0 +1,108 @@
+#ifndef LINK_PROFILE_HPP_
+#define LINK_PROFILE_HPP_
+
+#include <cstdint>
+#include <string>
+
+/*
+ * @brief Управление потоком на линии USART. Значения не зависят от D2XX, перевод в FT_FLOW_* делает
+ * конкретный модуль
+ * */
+enum class FlowControl : uint8_t
+{
+    None,
+    RtsCts,
+    DtrDsr,
+    XonXoff
+};
+
+/*
+ * @brief LinkProfile - набор параметров USB/USART канала, которые применяются к модулю при подключении.
+ *
+ * По умолчанию значения совпадают с тем, что раньше было зашито в FT232RL::connect. Таймер задержки
+ * у D2XX по умолчанию 16 мс: пока приемный буфер не заполнен, короткий ответ (например, 1 байт версии
+ * на 0x20) лежит в чипе до истечения этого таймера. Для коротких команд/ответов это и есть основная
+ * задержка, поэтому есть отдельный профиль lowLatency().
+ * */
+struct LinkProfile
+{
+    std::string name = "default";
+
+    // FT_SetLatencyTimer, 2..255 мс
+    uint8_t latencyTimerMs = 16;
+
+    // FT_SetUSBParameters, кратно 64, 64..65536
+    uint32_t rxTransferSize = 256;
+    uint32_t txTransferSize = 256;
+
+    // FT_SetFlowControl, xon/xoff используются только при FlowControl::XonXoff
+    FlowControl flowControl = FlowControl::None;
+    uint8_t xonChar = 0x11;
+    uint8_t xoffChar = 0x13;
+
+    // FT_SetChars, при приеме eventChar чип отдает буфер хосту сразу, не дожидаясь таймера
+    bool eventCharEnabled = false;
+    uint8_t eventChar = 0x00;
+
+    // FT_SetTimeouts
+    uint32_t readTimeoutMs = 1000;
+    uint32_t writeTimeoutMs = 1000;
+
+    /*
+     * @brief Профиль, совпадающий с прежними зашитыми параметрами
+     * */
+    static LinkProfile defaults()
+    {
+        return LinkProfile{};
+    }
+
+    /*
+     * @brief Профиль для коротких посылок команда/ответ: минимальный таймер задержки и минимальный
+     * размер USB-транзакции, чтобы чип отдавал байты хосту без ожидания
+     * */
+    static LinkProfile lowLatency()
+    {
+        LinkProfile profile;
+        profile.name = "low-latency";
+        profile.latencyTimerMs = 2;
+        profile.rxTransferSize = 64;
+        profile.txTransferSize = 64;
+        profile.readTimeoutMs = 100;
+        profile.writeTimeoutMs = 100;
+        return profile;
+    }
+
+    /*
+     * @brief Профиль для больших потоков данных: крупные USB-транзакции, таймер по умолчанию
+     * */
+    static LinkProfile bulk()
+    {
+        LinkProfile profile;
+        profile.name = "bulk";
+        profile.latencyTimerMs = 16;
+        profile.rxTransferSize = 4096;
+        profile.txTransferSize = 4096;
+        profile.readTimeoutMs = 1000;
+        profile.writeTimeoutMs = 1000;
+        return profile;
+    }
+
+    /*
+     * @brief Поиск профиля по имени ("default" | "low-latency" | "bulk")
+     * @return false, если имя не известно, profile при этом не меняется
+     * */
+    static bool fromName(const std::string &name, LinkProfile &profile)
+    {
+        if (name == "default")
+            profile = defaults();
+        else if (name == "low-latency")
+            profile = lowLatency();
+        else if (name == "bulk")
+            profile = bulk();
+        else
+            return false;
+        return true;
+    }
+};
+
+#endif // LINK_PROFILE_HPP_
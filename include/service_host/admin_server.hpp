@@ -0,0 +1,57 @@
+#ifndef ADMIN_SERVER_HPP_
+#define ADMIN_SERVER_HPP_
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+/*
+ * @brief AdminServer - HTTP-порт администрирования: GET /metrics отдает MetricsRegistry::render()
+ * в текстовом формате Prometheus.
+ *
+ * Работает в своем потоке со своим сокетом и не трогает цикл Server: съем метрик не задерживает
+ * команды клиентов. Соединение обслуживается по одному запросу и закрывается.
+ * */
+class AdminServer
+{
+public:
+    AdminServer(const std::string &ip, int port);
+    AdminServer(const AdminServer &) = delete;
+    AdminServer(AdminServer &&) = delete;
+    ~AdminServer();
+
+    AdminServer &operator=(const AdminServer &) = delete;
+    AdminServer &operator=(AdminServer &&) = delete;
+
+    /*
+     * @brief Открыть порт и запустить поток, бросает SocketNotCreate/BindFailure/ListenException
+     * */
+    void start();
+    void stop();
+
+    /*
+     * @brief Порт, на котором реально слушает сервер (полезно при port = 0)
+     * */
+    int port() const
+    {
+        return m_port;
+    }
+
+    /*
+     * @brief Ответ на запрос: статус, заголовки и тело HTTP/1.0
+     * @param request первая строка и заголовки запроса
+     * */
+    static std::string respond(const std::string &request);
+
+private:
+    std::string m_ip;
+    int m_port;
+    int m_fd = -1;
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+
+    void serveLoop();
+    void serveClient(int fd);
+};
+
+#endif // ADMIN_SERVER_HPP_
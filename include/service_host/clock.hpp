@@ -0,0 +1,118 @@
+#ifndef CLOCK_HPP_
+#define CLOCK_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+/*
+ * @brief IClock - источник времени и ожиданий для ядра и модулей.
+ *
+ * Все таймауты и паузы опроса MCU берут время и спят через IClock, а не через steady_clock и
+ * std::this_thread напрямую: в тестах подставляется ManualClock и таймаут в 5 секунд проходит
+ * мгновенно.
+ *
+ * Прерываемый sleepFor(duration, interrupted) нужен ожиданиям, которые должна обрывать экстренная
+ * остановка: тот, кто меняет условие, вызывает wakeAll(), и спящие потоки его проверяют.
+ * */
+class IClock
+{
+public:
+    using Duration = std::chrono::steady_clock::duration;
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    virtual ~IClock() = default;
+
+    virtual TimePoint now() const = 0;
+
+    virtual void sleepFor(Duration duration) = 0;
+
+    /*
+     * @brief Сон, который обрывается раньше срока, если после wakeAll() interrupted() вернет true
+     * @return false, если сон прерван
+     * */
+    virtual bool sleepFor(Duration duration, const std::function<bool()> &interrupted) = 0;
+
+    /*
+     * @brief Разбудить потоки в прерываемом sleepFor(), чтобы они проверили свое условие
+     * */
+    virtual void wakeAll() = 0;
+
+    void sleepUntil(TimePoint deadline)
+    {
+        const auto current = now();
+        if (deadline > current)
+            sleepFor(deadline - current);
+    }
+};
+
+/*
+ * @brief SystemClock - steady_clock и настоящий сон потока, используется по умолчанию
+ * */
+class SystemClock : public IClock
+{
+public:
+    static SystemClock &instance();
+
+    TimePoint now() const override
+    {
+        return std::chrono::steady_clock::now();
+    }
+
+    void sleepFor(Duration duration) override;
+    bool sleepFor(Duration duration, const std::function<bool()> &interrupted) override;
+    void wakeAll() override;
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+/*
+ * @brief ManualClock - виртуальное время для тестов
+ *
+ * Время стоит, пока его не сдвинут через advance(). sleepFor() блокирует поток до тех пор, пока
+ * виртуальное время не дойдет до срока. С autoAdvance = true sleepFor() сам сдвигает время на
+ * длительность сна и сразу возвращается: однопоточный код с таймаутами выполняется без ожиданий.
+ * */
+class ManualClock : public IClock
+{
+public:
+    explicit ManualClock(bool autoAdvance = false, TimePoint start = TimePoint{});
+
+    TimePoint now() const override;
+
+    void sleepFor(Duration duration) override;
+    bool sleepFor(Duration duration, const std::function<bool()> &interrupted) override;
+    void wakeAll() override;
+
+    /*
+     * @brief Сдвинуть время вперед и разбудить потоки, срок сна которых наступил
+     * */
+    void advance(Duration duration);
+
+    /*
+     * @brief Сколько потоков сейчас спит в sleepFor() (только без autoAdvance)
+     * */
+    size_t sleepers() const;
+
+    /*
+     * @brief Дождаться, пока в sleepFor() уснет не меньше count потоков. Для тестов, где время
+     * двигает тестовый поток, а ждут потоки плат
+     * @param timeout реальное время ожидания
+     * */
+    bool waitForSleepers(
+        size_t count,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(1000)) const;
+
+private:
+    const bool m_autoAdvance;
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_cv;
+    TimePoint m_now;
+    size_t m_sleepers = 0;
+};
+
+#endif // CLOCK_HPP_
@@ -36,6 +36,13 @@ public:
      * */
     virtual void Process(const int, const std::string &, const std::string &) = 0;
 
+    /*
+     * @brief клиент отключился, сокет сразу после вызова закрывается. Ядро должно забыть
+     * дескриптор: номер может достаться следующему клиенту
+     * @param 1 - сокет
+     * */
+    virtual void Disconnected(const int) {}
+
     /*
      * @brief запуск каго-то внутреннего действия
      * */
@@ -0,0 +1,167 @@
+#ifndef LATENCY_HISTOGRAM_HPP_
+#define LATENCY_HISTOGRAM_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * @brief LatencyHistogram - гистограмма задержек в стиле HDR: логарифмические интервалы, каждый
+ * разбит на SUB_BUCKETS линейных корзин, т.е. относительная ошибка не больше 1/SUB_BUCKETS
+ * (12.5%) во всем диапазоне 1 нс .. ~2.4 часа.
+ *
+ * Запись - одно атомарное сложение (relaxed) в корзину своего шарда: каждый поток при первом
+ * обращении получает свой номер шарда, так что потоки сервера и плат не делят кэш-линии счетчиков.
+ * Шарды складываются только в snapshot().
+ * */
+class LatencyHistogram
+{
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 3;
+    static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+    static constexpr size_t MAX_EXPONENT = 42; // 2^43 нс
+    static constexpr size_t BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+    static constexpr size_t SHARDS = 4;
+
+    /*
+     * @brief Сводка, собранная со всех шардов
+     * */
+    struct Snapshot
+    {
+        uint64_t count = 0;
+        uint64_t sumNs = 0;
+        uint64_t maxNs = 0;
+        std::array<uint64_t, BUCKETS> buckets{};
+
+        /*
+         * @brief Значение, ниже которого лежит доля q (0..1) записей, с точностью до корзины
+         * */
+        uint64_t percentile(double q) const;
+
+        double meanNs() const
+        {
+            return count ? static_cast<double>(sumNs) / static_cast<double>(count) : 0.0;
+        }
+
+        void merge(const Snapshot &other);
+    };
+
+    void record(std::chrono::nanoseconds duration)
+    {
+        recordNs(duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0);
+    }
+
+    void recordNs(uint64_t ns);
+
+    Snapshot snapshot() const;
+
+    void reset();
+
+    static size_t bucketIndex(uint64_t ns);
+
+    /*
+     * @brief Наибольшее значение, попадающее в корзину
+     * */
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    struct alignas(64) Shard
+    {
+        std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sumNs{0};
+        std::atomic<uint64_t> maxNs{0};
+    };
+
+    static size_t shardIndex();
+
+    std::array<Shard, SHARDS> m_shards;
+};
+
+/*
+ * @brief Этапы обработки команды, на границах которых снимаются задержки
+ * */
+enum class LatencyStage : uint8_t
+{
+    SocketRead = 0, // чтение посылки из сокета (Server)
+    FrameSplit,     // разбиение потока на сообщения (Server)
+    Parse,          // десериализация pkg::Message и mms::Manager
+    Validate,       // разбор и проверки аргументов команды
+    McuWrite,       // запись кадра в модуль
+    McuReadiness,   // ожидание байта готовности MCU
+    McuCompletion,  // ожидание ответа о выполнении MCU
+    Serialize,      // сериализация ответа
+    SocketWrite,    // запись ответа в сокет
+    Total,          // от входа в Process() до отправки ответа
+    Count
+};
+
+/*
+ * @brief LatencyRegistry - набор гистограмм по областям ("server" и по одной на команду из
+ * m_methods) и этапам. Области создаются один раз при старте, дальше запись идет без блокировок.
+ * */
+class LatencyRegistry
+{
+public:
+    static constexpr size_t STAGE_COUNT = static_cast<size_t>(LatencyStage::Count);
+
+    class Stages
+    {
+    public:
+        LatencyHistogram &operator[](LatencyStage stage)
+        {
+            return m_stages[static_cast<size_t>(stage)];
+        }
+
+        const LatencyHistogram &operator[](LatencyStage stage) const
+        {
+            return m_stages[static_cast<size_t>(stage)];
+        }
+
+    private:
+        std::array<LatencyHistogram, STAGE_COUNT> m_stages;
+    };
+
+    struct Row
+    {
+        std::string scope;
+        LatencyStage stage;
+        LatencyHistogram::Snapshot data;
+    };
+
+    static LatencyRegistry &instance();
+
+    /*
+     * @brief Гистограммы области, создаются при первом обращении. Ссылка действительна все время
+     * работы программы
+     * */
+    Stages &scope(const std::string &name);
+
+    /*
+     * @brief Сводка по всем непустым гистограммам, отсортирована по области и этапу
+     * */
+    std::vector<Row> snapshot() const;
+
+    /*
+     * @brief Текстовая таблица: область, этап, count, mean, p50, p90, p99, p99.9, max (мкс)
+     * */
+    std::string report() const;
+
+    void reset();
+
+    static const char *stageName(LatencyStage stage);
+
+private:
+    LatencyRegistry() = default;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::unique_ptr<Stages>> m_scopes;
+};
+
+#endif // LATENCY_HISTOGRAM_HPP_
@@ -0,0 +1,196 @@
+#ifndef LOGGER_HPP_
+#define LOGGER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+/*
+ * @brief Уровни логирования, по возрастанию важности
+ * */
+enum class LogLevel : uint8_t
+{
+    Trace = 0,
+    Debug,
+    Info,
+    Warning,
+    Error,
+    Off
+};
+
+/*
+ * Минимальный уровень, точки логирования ниже которого вырезаются при компиляции. По умолчанию
+ * вырезаются trace-точки из циклов опроса MCU, включаются через ENABLE_LOG_TRACE в CMake.
+ * */
+#ifndef MMS_LOG_COMPILE_LEVEL
+#define MMS_LOG_COMPILE_LEVEL 1
+#endif
+
+/*
+ * @brief Logger - асинхронный логгер общего пользования для service_host, core, module_rs232 и mock-mcu.
+ *
+ * Запись в лог не трогает терминал: сообщение форматируется сразу в ячейку кольцевого буфера
+ * фиксированного размера (без аллокаций и блокировок, очередь MPMC с номерами последовательности
+ * в ячейках), а фоновый поток забирает готовые записи, добавляет время и уровень и пишет их в sink
+ * пачками. Если буфер переполнен, запись отбрасывается и учитывается в dropped() - горячий путь
+ * никогда не ждет вывод.
+ *
+ * Формат строки: [HH:MM:SS.mmm] LEVEL tag: сообщение
+ * */
+class Logger
+{
+public:
+    static constexpr size_t CAPACITY = 4096; // количество ячеек, степень двойки
+    static constexpr size_t MAX_TEXT = 240;  // длиннее - обрезается с "..."
+
+    static Logger &instance();
+
+    Logger(const Logger &) = delete;
+    Logger(Logger &&) = delete;
+    ~Logger();
+
+    Logger &operator=(const Logger &) = delete;
+    Logger &operator=(Logger &&) = delete;
+
+    bool enabled(LogLevel level) const
+    {
+        return level >= m_level.load(std::memory_order_relaxed);
+    }
+
+    void setLevel(LogLevel level)
+    {
+        m_level.store(level, std::memory_order_relaxed);
+    }
+
+    LogLevel level() const
+    {
+        return m_level.load(std::memory_order_relaxed);
+    }
+
+    /*
+     * @brief Куда писать лог (по умолчанию stdout). Файл не закрывается логгером
+     * */
+    void setSink(FILE *sink);
+
+    /*
+     * @brief Запись сообщения, форматирование выполняется в вызывающем потоке сразу в буфер
+     * @param tag короткое имя подсистемы: "server", "core", "ft232rl", "mock-mcu"...
+     * */
+    template <class... Args>
+    void log(LogLevel level, const char *tag, std::format_string<Args...> fmt, Args &&...args)
+    {
+        size_t position = 0;
+        Record *record = claim(position);
+        if (record == nullptr)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        try
+        {
+            auto result = std::format_to_n(record->text, MAX_TEXT, fmt, std::forward<Args>(args)...);
+            record->size = static_cast<size_t>(result.size);
+        }
+        catch (const std::exception &e)
+        {
+            record->size = std::format_to_n(record->text, MAX_TEXT, "<format error: {}>", e.what()).size;
+        }
+        publish(*record, position, level, tag);
+    }
+
+    /*
+     * @brief Запись готовой строки
+     * */
+    void write(LogLevel level, const char *tag, std::string_view text);
+
+    /*
+     * @brief Дождаться вывода всех записей, поставленных до вызова
+     * */
+    void flush();
+
+    /*
+     * @brief Сколько записей отброшено из-за переполнения буфера
+     * */
+    uint64_t dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    /*
+     * @brief Разбор уровня по имени: trace, debug, info, warning, error, off
+     * @return false, если имя не распознано
+     * */
+    static bool parseLevel(std::string_view name, LogLevel &level);
+
+    static const char *levelName(LogLevel level);
+
+private:
+    struct Record
+    {
+        std::atomic<size_t> sequence;
+        LogLevel level;
+        const char *tag;
+        std::chrono::system_clock::time_point time;
+        size_t size; // длина до обрезки
+        char text[MAX_TEXT];
+    };
+
+    Logger();
+
+    Record *claim(size_t &position);
+    void publish(Record &record, size_t position, LogLevel level, const char *tag);
+    bool drain();
+    void flusherLoop();
+
+    std::unique_ptr<Record[]> m_ring;
+    alignas(64) std::atomic<size_t> m_head{0}; // следующая ячейка для записи
+    alignas(64) std::atomic<size_t> m_tail{0}; // следующая ячейка для вывода, двигает только flusher
+
+    std::atomic<LogLevel> m_level{LogLevel::Info};
+    std::atomic<uint64_t> m_dropped{0};
+
+    std::mutex m_sinkMutex;
+    FILE *m_sink;
+    std::string m_batch; // строки пачки до fwrite, используется только flusher
+
+    std::atomic<bool> m_running{true};
+    std::thread m_flusher;
+};
+
+#define MMS_LOG(level, tag, ...)                                                                   \
+    do                                                                                             \
+    {                                                                                              \
+        if (Logger::instance().enabled(level))                                                     \
+            Logger::instance().log(level, tag, __VA_ARGS__);                                       \
+    } while (0)
+
+#if MMS_LOG_COMPILE_LEVEL <= 0
+#define MMS_LOG_TRACE(tag, ...) MMS_LOG(LogLevel::Trace, tag, __VA_ARGS__)
+#else
+#define MMS_LOG_TRACE(tag, ...)                                                                    \
+    do                                                                                             \
+    {                                                                                              \
+    } while (0)
+#endif
+
+#if MMS_LOG_COMPILE_LEVEL <= 1
+#define MMS_LOG_DEBUG(tag, ...) MMS_LOG(LogLevel::Debug, tag, __VA_ARGS__)
+#else
+#define MMS_LOG_DEBUG(tag, ...)                                                                    \
+    do                                                                                             \
+    {                                                                                              \
+    } while (0)
+#endif
+
+#define MMS_LOG_INFO(tag, ...) MMS_LOG(LogLevel::Info, tag, __VA_ARGS__)
+#define MMS_LOG_WARN(tag, ...) MMS_LOG(LogLevel::Warning, tag, __VA_ARGS__)
+#define MMS_LOG_ERROR(tag, ...) MMS_LOG(LogLevel::Error, tag, __VA_ARGS__)
+
+#endif // LOGGER_HPP_
@@ -0,0 +1,152 @@
+#ifndef METRICS_HPP_
+#define METRICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Счетчики метрик разбиты на шарды по потокам: поток при первом обращении получает свой номер шарда
+ * и дальше пишет relaxed-сложением в свою кэш-линию. Шарды складываются только при выгрузке
+ * (MetricsRegistry::render()), т.е. стоимость метрик на пути команды - одно атомарное сложение.
+ * */
+namespace metrics_detail
+{
+constexpr size_t SHARDS = 4;
+
+size_t threadShard();
+
+template <class T>
+class Sharded
+{
+public:
+    void add(T value)
+    {
+        m_shards[threadShard()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    T value() const
+    {
+        T sum = 0;
+        for (const auto &shard : m_shards)
+            sum += shard.value.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<T> value{0};
+    };
+
+    std::array<Shard, SHARDS> m_shards;
+};
+} // namespace metrics_detail
+
+/*
+ * @brief Монотонный счетчик (Prometheus counter)
+ * */
+class MetricCounter
+{
+public:
+    void inc(uint64_t value = 1)
+    {
+        m_value.add(value);
+    }
+
+    uint64_t value() const
+    {
+        return m_value.value();
+    }
+
+private:
+    metrics_detail::Sharded<uint64_t> m_value;
+};
+
+/*
+ * @brief Значение, которое растет и убывает (Prometheus gauge): клиенты, запросы в работе, очереди
+ * */
+class MetricGauge
+{
+public:
+    void inc(int64_t value = 1)
+    {
+        m_value.add(value);
+    }
+
+    void dec(int64_t value = 1)
+    {
+        m_value.add(-value);
+    }
+
+    int64_t value() const
+    {
+        return m_value.value();
+    }
+
+private:
+    metrics_detail::Sharded<int64_t> m_value;
+};
+
+/*
+ * @brief MetricsRegistry - все метрики процесса. Метрики создаются при старте (регистрация под
+ * мьютексом), ссылки на них действительны все время работы программы.
+ *
+ * render() выдает текстовый формат Prometheus 0.0.4, вместе с метриками выгружаются квантили
+ * гистограмм задержек LatencyRegistry (mms_latency_seconds).
+ * */
+class MetricsRegistry
+{
+public:
+    static MetricsRegistry &instance();
+
+    /*
+     * @param name имя метрики, например "mms_commands_total"
+     * @param help описание для # HELP
+     * @param labels метки без фигурных скобок, например "command=\"moving\""
+     * */
+    MetricCounter &counter(const std::string &name, const std::string &help, const std::string &labels = "");
+    MetricGauge &gauge(const std::string &name, const std::string &help, const std::string &labels = "");
+
+    std::string render() const;
+
+private:
+    MetricsRegistry() = default;
+
+    struct Series
+    {
+        std::string name;
+        std::string help;
+        std::string labels;
+        std::unique_ptr<MetricCounter> counter; // ровно одно из двух
+        std::unique_ptr<MetricGauge> gauge;
+    };
+
+    Series *find(const std::string &name, const std::string &labels);
+    void add(std::unique_ptr<Series> series);
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Series>> m_series; // порядок регистрации для render()
+    std::unordered_map<std::string, Series *> m_index; // "name{labels}" -> серия
+};
+
+/*
+ * @brief Общие метрики сервиса, создаются при первом обращении
+ * */
+struct ServiceMetrics
+{
+    MetricGauge &clientsConnected;
+    MetricGauge &requestsInFlight;
+    MetricCounter &mcuTimeouts;
+    MetricCounter &bytesReceived;
+    MetricCounter &bytesSent;
+
+    static ServiceMetrics &instance();
+};
+
+#endif // METRICS_HPP_
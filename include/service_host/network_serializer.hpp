@@ -73,6 +73,14 @@ public:
      * */
     std::string readFromSock(const int socket_);
 
+    /*
+     * @brief Чтение из неблокирующего сокета всего, что уже пришло, в конец buffer. Посылка может
+     *        прийти частями: незаконченный хвост остается в buffer до следующего чтения
+     * @param socket_ сокет
+     * @return false, если клиент закрыл соединение или чтение завершилось ошибкой
+     * */
+    bool readAvailable(const int socket_, std::string& buffer);
+
     /*
      * @brief Запись в сокет сообщения длины msg.size(), важно, данный метод,
      *        самостоятельно добавляет \n\n в конце
@@ -81,6 +89,14 @@ public:
      * */
     void writeToSock(const int socket_, std::string msg);
 
+    /*
+     * @brief Запись в сокет готового кадра, который уже оканчивается на \n\n, без копирования.
+     *        Для сообщений, которые сериализуются один раз и уходят многим клиентам
+     * @param socket_ сокет в который отправлять
+     * @param frame сообщение вместе с \n\n
+     * */
+    void writeFramed(const int socket_, std::string_view frame);
+
     /*
      * @brief Дробление всей посылки на малые части -> отдельные сообщения, дробление по \n\n
      * @param msg - входное ссобщение, состаящие из посылок разделенных \n\n
@@ -0,0 +1,93 @@
+#ifndef OUTBOX_HPP_
+#define OUTBOX_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/*
+ * @brief Outbox - очереди отправки неблокирующих сокетов клиентов Server.
+ *
+ * Server открывает очередь для каждого принятого соединения, Socket::write пишет в такие сокеты через
+ * нее: что влезло в буфер ядра, уходит сразу, остаток ставится в очередь, и запись не ждет клиента -
+ * ни на потоке Server, ни на потоках ядра. Server дописывает очередь по POLLOUT (flush()) и закрывает
+ * соединение, если очередь не двигается дольше срока остановки отправки или переполнена.
+ *
+ * Потокобезопасен: пишут потоки ядра и Server, очереди меняются под одним мьютексом.
+ * */
+class Outbox
+{
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    // Больше в очереди одного соединения не держится: запись сверх предела - ошибка, соединение
+    // закрывается
+    static constexpr size_t MAX_QUEUED_BYTES = 16 * 1024 * 1024;
+
+    enum class State
+    {
+        Empty,
+        Pending, // в очереди есть данные, нужен POLLOUT
+        Broken   // очередь переполнена или запись завершилась ошибкой
+    };
+
+    static Outbox &instance();
+
+    /*
+     * @brief Завести очередь для неблокирующего сокета fd
+     * */
+    void open(int fd);
+
+    /*
+     * @brief Отбросить очередь fd, вызывается до close()
+     * */
+    void close(int fd);
+
+    /*
+     * @brief Записать count байт в сокет fd или поставить остаток в очередь
+     * @param written принято байт (count) или -1, если соединение сломано
+     * @return false, если у fd нет очереди: сокет пишется как обычно
+     * */
+    bool write(int fd, const void *buf, size_t count, size_t &written);
+
+    /*
+     * @brief Дописать очередь fd, вызывается по POLLOUT
+     * */
+    State flush(int fd);
+
+    State state(int fd) const;
+
+    /*
+     * @brief Время последнего продвижения очереди, {} - очередь пуста
+     * */
+    TimePoint stalledSince(int fd) const;
+
+private:
+    Outbox() = default;
+
+    struct Queue
+    {
+        std::string data;
+        size_t head = 0; // отправленная часть data
+        TimePoint progress{};
+        bool broken = false;
+
+        size_t size() const
+        {
+            return data.size() - head;
+        }
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<int, Queue> m_queues;
+
+    /*
+     * @brief Отправить сколько примет ядро, false - ошибка записи
+     * */
+    static bool sendQueued(int fd, Queue &queue);
+    static State stateOf(const Queue &queue);
+};
+
+#endif // OUTBOX_HPP_
@@ -0,0 +1,135 @@
+#ifndef RATE_LIMITER_HPP_
+#define RATE_LIMITER_HPP_
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "metrics.hpp"
+
+/*
+ * @brief Предел частоты запросов: rate запросов в секунду в среднем и до burst подряд
+ * */
+struct RateLimit
+{
+    double rate = 0.0; // 0 - без ограничения
+    double burst = 0.0;
+
+    bool enabled() const
+    {
+        return rate > 0.0;
+    }
+
+    /*
+     * @brief Разбор "RATE" или "RATE/BURST", по умолчанию burst = rate, но не меньше 1
+     * */
+    static bool parse(const std::string &text, RateLimit &limit);
+};
+
+/*
+ * @brief TokenBucket - корзина токенов: пополняется со скоростью rate до burst, запрос забирает один
+ * */
+class TokenBucket
+{
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    TokenBucket() = default;
+    TokenBucket(const RateLimit &limit, TimePoint now);
+
+    /*
+     * @brief Забрать токен
+     * @return false, если корзина пуста
+     * */
+    bool tryTake(TimePoint now);
+
+    /*
+     * @brief Корзина к моменту now пополнилась бы до burst: ее можно заменить новой
+     * */
+    bool full(TimePoint now) const;
+
+private:
+    double m_rate = 0.0;
+    double m_burst = 0.0;
+    double m_tokens = 0.0;
+    TimePoint m_updated{};
+};
+
+/*
+ * @brief RateLimiter - пределы частоты запросов для Server: по соединению и по имени клиента.
+ *
+ * Проверка идет до разбора посылки, на ее пути нет JSON и выделений памяти (кроме первого запроса
+ * нового соединения или имени). Предел по имени общий для всех соединений клиента: скрипт, открывший
+ * десять сокетов под одним именем, получает ту же долю, что и с одним. Корзина имени переживает
+ * закрытие последнего соединения, пока не пополнится: переподключение не обнуляет предел. Такие
+ * корзины удаляются лениво, при появлении нового имени.
+ *
+ * Отклоненные запросы считаются в mms_requests_throttled_total{client, scope}, scope - "connection"
+ * или "client". Серии метрик не удаляются, поэтому своя метка client есть только у первых
+ * MAX_LABELED_CLIENTS имен, остальные считаются под client="other". Не потокобезопасен: используется
+ * из цикла Server.
+ * */
+class RateLimiter
+{
+public:
+    using TimePoint = TokenBucket::TimePoint;
+
+    static constexpr size_t MAX_LABELED_CLIENTS = 64;
+
+    enum class Verdict
+    {
+        Allowed,
+        ConnectionLimited,
+        ClientLimited
+    };
+
+    void setLimits(const RateLimit &connection, const RateLimit &client);
+
+    /*
+     * @brief Учесть запрос соединения fd клиента client (пустое имя - до знакомства)
+     * */
+    Verdict admit(int fd, const std::string &client, TimePoint now);
+
+    /*
+     * @brief Соединение закрыто: его корзина удаляется, корзина имени остается до пополнения
+     * */
+    void forget(int fd);
+
+private:
+    struct Client
+    {
+        TokenBucket bucket;
+        MetricCounter *byConnection;
+        MetricCounter *byClient;
+        size_t connections = 0; // открытые соединения с этим именем
+    };
+
+    using Clients = std::unordered_map<std::string, Client>;
+
+    struct Connection
+    {
+        TokenBucket bucket;
+        Clients::value_type *client = nullptr; // nullptr - до знакомства; узлы m_clients не переезжают
+    };
+
+    RateLimit m_connectionLimit;
+    RateLimit m_clientLimit;
+    std::unordered_map<int, Connection> m_connections;
+    Clients m_clients;
+    std::unordered_set<std::string> m_labeled; // имена со своей меткой client
+
+    Clients::value_type &client(const std::string &name, TimePoint now);
+
+    /*
+     * @brief Удалить корзины имен без открытых соединений, успевшие пополниться
+     * */
+    void dropIdle(TimePoint now);
+
+    /*
+     * @brief Счетчик отказов имени name, сверх MAX_LABELED_CLIENTS имен - общий client="other"
+     * */
+    MetricCounter &throttled(const std::string &name, const char *scope);
+};
+
+#endif // RATE_LIMITER_HPP_
@@ -20,8 +20,23 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <poll.h>
+#include <fcntl.h>
 
 #include "network_serializer.hpp"
+#include "outbox.hpp"
+#include "latency_histogram.hpp"
+#include "rate_limiter.hpp"
+#include "timer_wheel.hpp"
+
+/*
+ * @brief Сроки соединений Server, нулевая длительность - без ограничения
+ * */
+struct ConnectionTimeouts
+{
+    std::chrono::milliseconds handshake{10000}; // от подключения до pkg::WhoWantsToTalkToMe
+    std::chrono::milliseconds idle{0};          // без входящих посылок
+    std::chrono::milliseconds writeStall{30000}; // очередь отправки не двигается: клиент не читает ответы
+};
 
 class Server : protected NetworkSerializer
 {
@@ -33,6 +48,29 @@ private:
 
     std::unordered_map<int, std::string> clients_name_;
 
+    // Сроки соединений по индексу в fds_: знакомство, простой, остановка отправки
+    static constexpr std::chrono::milliseconds TIMER_TICK{100};
+    static constexpr size_t TIMER_SLOTS = 512;
+
+    // Незаконченная посылка длиннее предела закрывает соединение: буфер чтения не растет без конца
+    static constexpr size_t MAX_PENDING_INPUT = 1024 * 1024;
+
+    struct Connection
+    {
+        std::chrono::steady_clock::time_point lastActivity;
+        std::string input; // пришедший хвост без \n\n, сокет неблокирующий
+        int rejected = 0;  // отказов по пределу частоты подряд
+    };
+
+    ConnectionTimeouts timeouts_;
+    std::vector<Connection> connections_ = std::vector<Connection>(MAX_CLIENTS + 1);
+    std::vector<int> freeSlots_; // индексы fds_ закрытых соединений, занимаются новыми до роста nfds_
+    TimerWheel timers_{
+        static_cast<size_t>(MAX_CLIENTS + 1), TIMER_TICK, TIMER_SLOTS, std::chrono::steady_clock::now()};
+
+    // Очереди отправки сокетов клиентов, в них пишут и ответы ядра
+    Outbox &outbox_ = Outbox::instance();
+
     std::atomic<bool> serverWorkStatus_;
 
     std::string ip_;
@@ -46,6 +84,16 @@ private:
 
     std::unique_ptr<ICore> core_;
 
+    // Задержки чтения и разбиения посылок, до того как известна команда
+    LatencyRegistry::Stages &latency_ = LatencyRegistry::instance().scope("server");
+
+    // Пределы частоты запросов по соединению и по имени клиента, отказ сериализуется один раз
+    RateLimiter limiter_;
+    std::string throttledFrame_;
+
+    // Столько отказов подряд - и соединение закрывается: клиент не сбавляет темп
+    static constexpr int MAX_REJECTIONS = 64;
+
     /*
      * @brief
      * */
@@ -66,11 +114,38 @@ private:
      * */
     bool ifMessageEmptyCloseSocket(const int);
 
+    /*
+     * @brief Сдвигает колесо таймеров и закрывает соединения с истекшими сроками
+     * */
+    void checkingTimers();
+
+    /*
+     * @brief Срок соединения наступил: проверить знакомство, простой и отправку
+     * */
+    void checkingConnectionTimeouts(const int, std::chrono::steady_clock::time_point);
+
+    /*
+     * @brief Поставить таймер соединения, которое уже представилось, на ближайшую проверку
+     * */
+    void armConnectionTimer(const int, std::chrono::steady_clock::time_point);
+
+    /*
+     * @brief Закрыть соединение по сроку или пределу, reason - метка в mms_connections_expired_total
+     * */
+    void expireConnection(const int, const char* reason);
+
     /*
      * @brief надо проверить при первом подключении, что, тот с кем хотим работать имеет имя
      * */
     bool get_WhoAmI_Info(const int, std::string&);
 
+    /*
+     * @brief Проверка пределов частоты до разбора посылки, сверх предела клиенту уходит throttledFrame_,
+     *        если его очередь отправки пуста. После MAX_REJECTIONS отказов подряд соединение закрывается
+     * @return false, если посылку нужно отбросить
+     * */
+    bool admitRequest(const int);
+
     /*
      * @brief когда проверки доходят до этого метода можно быть увереным, что у нас 'сообщение'
      *
@@ -84,9 +159,15 @@ private:
 
     /*
      * @brief checkingSocketsOnNewContent - проверяет какие сообщения пришли от сокетов пользователей
+     *        и дописывает очереди отправки
      * */
     void checkingSocketsOnNewContent();
 
+    /*
+     * @brief Ждать POLLOUT у соединений с непустой очередью отправки, сломанные очереди закрываются
+     * */
+    void watchingPendingWrites();
+
 public:
     Server(const std::string&, const int&, std::unique_ptr<ICore>);
 
@@ -96,6 +177,17 @@ public:
     Server& operator=(Server&&) = delete;
     ~Server();
 
+    /*
+     * @brief Пределы частоты запросов: на одно соединение и на все соединения одного имени.
+     *        RateLimit{} - без ограничения (по умолчанию). Задается до run()
+     * */
+    void setRateLimits(const RateLimit& connection, const RateLimit& client);
+
+    /*
+     * @brief Сроки соединений, задается до run()
+     * */
+    void setTimeouts(const ConnectionTimeouts& timeouts);
+
     /*
      * @brief запустить сервер. !!! Блокирует поток !!!
      * */
@@ -0,0 +1,82 @@
+#ifndef TIMER_WHEEL_HPP_
+#define TIMER_WHEEL_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * @brief TimerWheel - хешированное колесо таймеров для сроков соединений Server.
+ *
+ * Колесо из slots ячеек, каждая ячейка - tick времени. Таймер с ключом key (номер слота соединения,
+ * 0..capacity-1) лежит в двусвязном списке ячейки своего срока, для сроков дальше одного оборота
+ * хранится число оставшихся оборотов. schedule() и cancel() - O(1), advance() обходит только ячейки
+ * прошедших тиков, а не все соединения. Срок округляется вверх до тика: таймер срабатывает не раньше
+ * срока и не позже чем через tick после него.
+ *
+ * У ключа один таймер, повторный schedule() переносит его. Не потокобезопасен: используется из
+ * цикла Server.
+ * */
+class TimerWheel
+{
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+    using Duration = std::chrono::steady_clock::duration;
+
+    TimerWheel(size_t capacity, Duration tick, size_t slots, TimePoint now);
+
+    /*
+     * @brief Поставить (или перенести) таймер ключа на срок deadline
+     * */
+    void schedule(size_t key, TimePoint deadline);
+
+    void cancel(size_t key);
+
+    bool scheduled(size_t key) const;
+
+    /*
+     * @brief Сдвинуть колесо до now и вызвать expired(key) для наступивших сроков. expired может
+     * ставить и снимать таймеры, в том числе своего ключа
+     * */
+    template <typename Expired>
+    void advance(TimePoint now, Expired &&expired)
+    {
+        while (now - m_cursorTime >= m_tick)
+        {
+            collectNextTick();
+
+            // Обработчики вызываются после обхода ячейки: они могут переставлять таймеры
+            for (size_t key : m_fired)
+                expired(key);
+            m_fired.clear();
+        }
+    }
+
+private:
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    struct Node
+    {
+        size_t prev = NONE;
+        size_t next = NONE;
+        size_t slot = NONE; // NONE - таймер не стоит
+        uint64_t rounds = 0;
+    };
+
+    Duration m_tick;
+    std::vector<Node> m_nodes;
+    std::vector<size_t> m_heads;
+    std::vector<size_t> m_fired;
+    size_t m_cursor = 0;
+    TimePoint m_cursorTime; // время, до которого колесо уже сдвинуто
+
+    /*
+     * @brief Перейти к следующей ячейке: наступившие таймеры снимаются и переносятся в m_fired
+     * */
+    void collectNextTick();
+    void link(size_t key, size_t slot);
+    void unlink(size_t key);
+};
+
+#endif // TIMER_WHEEL_HPP_
@@ -1,10 +1,12 @@
 import json
+import urllib.request
 from datetime import datetime
 from serverconnector import ServerConnector
 from flask import Flask, render_template, request, jsonify
 
 IP = "127.0.0.1"
 PORT = 38000
+ADMIN_PORT = 38001  # метрики Prometheus сервиса (--admin-port)
 MYNAME = "UserInterface"
 
 app = Flask(__name__)
@@ -408,6 +410,22 @@ def stop_all_motors():
         log_json("ОТПРАВЛЕН JSON (ошибка)", error_response)
         return jsonify(error_response), 500
 
+def read_service_metrics():
+    """Снимает метрики сервиса с admin-порта, без подписей и квантилей задержек"""
+    try:
+        with urllib.request.urlopen(f"http://{IP}:{ADMIN_PORT}/metrics", timeout=0.5) as response:
+            text = response.read().decode("utf-8")
+    except Exception:
+        return None
+
+    metrics = {}
+    for line in text.splitlines():
+        if not line or line.startswith("#") or line.startswith("mms_latency_seconds"):
+            continue
+        name, _, value = line.rpartition(" ")
+        metrics[name] = float(value)
+    return metrics
+
 @app.route('/api/system/status', methods=['GET'])
 def get_system_status():
     """Получение статуса системы"""
@@ -416,13 +434,15 @@ def get_system_status():
     log_json("ПОЛУЧЕН ЗАПРОС (статус системы)", {})
     
     is_connected = connector is not None
+    metrics = read_service_metrics()
     
     success_response = {
         'status': 'success',
         'connected': is_connected,
-        'server': 'MotorControlService',
+        'server': 'MotorControlService' if metrics is not None else 'Unavailable',
         'mcu': 'MockMCU' if is_connected else 'Disconnected',
-        'device': 'FT232RL' if is_connected else 'Disconnected'
+        'device': 'FT232RL' if is_connected else 'Disconnected',
+        'metrics': metrics or {}
     }
     log_json("ОТПРАВЛЕН JSON (статус системы)", success_response)
     return jsonify(success_response)
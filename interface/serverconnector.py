@@ -48,12 +48,16 @@ class ServerConnector:
         self.socket.sendall(data.encode('utf-8'))
         print(f"Sent name: {name_to_send}")
 
-    def send_command(self, command: str, message: str):
-        """Отправляет команду и возвращает ответ"""
+    def send_command(self, command: str, message: str, retries: int = 2):
+        """Отправляет команду и возвращает ответ.
+
+        Если ответ не пришел за таймаут сокета, запрос повторяется с тем же id: сервер не выполняет
+        движение второй раз, а отдает ответ исходной команды.
+        """
         if not self.socket:
             raise ValidationError(f'Not socket {self.socket}')
 
-        message_id = random.randint(0, 999999)
+        message_id = random.randint(1, 999999)  # 0 отключает защиту от повторов на сервере
         
         # Правильно экранируем message для JSON
         escaped_message = json.dumps(message)  # Это автоматически экранирует кавычки
@@ -71,14 +75,18 @@ class ServerConnector:
         print(f"Message: {message}")
         print(f"Data: {data}")
 
-        # Отправляем как UTF-8
-        try:
-            self.socket.sendall(data.encode('utf-8'))
-        except (ConnectionResetError, BrokenPipeError, OSError) as e:
-            raise ValidationError(f'Connection lost during send: {e}')
-        
-        # Читаем ответ
-        response = self.receive_response()
+        for attempt in range(retries + 1):
+            # Отправляем как UTF-8
+            try:
+                self.socket.sendall(data.encode('utf-8'))
+            except (ConnectionResetError, BrokenPipeError, OSError) as e:
+                raise ValidationError(f'Connection lost during send: {e}')
+
+            # Читаем ответ
+            response = self.receive_response()
+            if response.get("error") != "No response received":
+                return response
+            print(f"No response to {command} (id {message_id}), attempt {attempt + 1}")
         return response
 
     def receive_response(self):
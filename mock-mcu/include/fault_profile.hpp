@@ -0,0 +1,65 @@
+#ifndef FAULT_PROFILE_HPP_
+#define FAULT_PROFILE_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Сбои одного MockMCU и его канала, у каждой платы свой профиль и свой генератор
+ *
+ * Вероятности задаются на команду движения, кроме dropByteRate (на каждый отправленный байт).
+ * Код ошибки 0 - случайный: 0x01-0x0A для готовности, 0x01-0x0F для выполнения.
+ *
+ * Текстовая форма - записи "имя=вероятность[:параметр]" через запятую или с новой строки,
+ * "#" - комментарий до конца строки:
+ *
+ *   execution-error=0.05:0x06   ошибка выполнения с кодом 0x06 в 5% команд
+ *   readiness-error=0.02        ошибка готовности со случайным кодом
+ *   readiness-delay=0.1:300     байт готовности на 300 мс позже
+ *   truncated-completion=0.01   от ответа о завершении доходит только первый байт
+ *   drop-byte=0.001             байт ответа теряется в канале
+ *   stall=0.01:2000             после готовности канал замирает на 2 с в обе стороны
+ *   disconnect=0.005:1000       после готовности плата отключается на 1 с
+ *   seed=42
+ */
+struct FaultProfile {
+    double executionErrorRate = 0.0; ///< доля команд движения, завершающихся ошибкой (0..1)
+    uint8_t executionErrorCode = 0;  ///< код ошибки выполнения, 0 - случайный 0x01-0x0F
+    uint32_t seed = 1;               ///< seed генератора: прогоны воспроизводимы
+
+    double readinessErrorRate = 0.0;
+    uint8_t readinessErrorCode = 0;
+    double readinessDelayRate = 0.0;
+    std::chrono::milliseconds readinessDelay{0};
+    double truncatedCompletionRate = 0.0;
+    double dropByteRate = 0.0;
+    double stallRate = 0.0;
+    std::chrono::milliseconds stallDuration{0};
+    double disconnectRate = 0.0;
+    std::chrono::milliseconds disconnectDuration{0};
+
+    /**
+     * @brief Есть ли хоть один сбой с ненулевой вероятностью
+     */
+    bool enabled() const;
+
+    /**
+     * @brief Разбор текстовой формы
+     * @param error Описание первой ошибки разбора
+     */
+    static std::optional<FaultProfile> parse(const std::string& text, std::string& error);
+
+    /**
+     * @brief Разбор файла в текстовой форме
+     */
+    static std::optional<FaultProfile> load(const std::string& path, std::string& error);
+
+    /**
+     * @brief Текстовая форма, которую принимает parse()
+     */
+    std::string describe() const;
+};
+
+#endif // FAULT_PROFILE_HPP_
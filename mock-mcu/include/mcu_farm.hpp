@@ -0,0 +1,75 @@
+#ifndef MCU_FARM_HPP_
+#define MCU_FARM_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "mock_mcu.hpp"
+
+/**
+ * @brief McuFarm - много MockMCU в одном процессе на общем пуле потоков
+ *
+ * Вместо потока на плату, который спит между опросами, плата i обслуживается потоком
+ * i % threads: поток по кругу вызывает MockMCU::poll() своих плат и, если работы нет, засыпает
+ * до ближайшего завершения движения, но не дольше idleInterval. Платы независимы: у каждой свой
+ * канал (FT232RL или VirtualLink), своя статистика и свой профиль сбоев.
+ */
+class McuFarm
+{
+public:
+    explicit McuFarm(size_t threads = 2, std::chrono::microseconds idleInterval = std::chrono::milliseconds(1));
+    ~McuFarm();
+
+    McuFarm(const McuFarm&) = delete;
+    McuFarm& operator=(const McuFarm&) = delete;
+
+    /**
+     * @brief Добавить инициализированную плату. Только до start()
+     * @return Индекс платы
+     */
+    size_t add(std::unique_ptr<MockMCU> mcu);
+
+    size_t size() const
+    {
+        return m_mcus.size();
+    }
+
+    size_t threads() const
+    {
+        return m_threadCount;
+    }
+
+    MockMCU& operator[](size_t i)
+    {
+        return *m_mcus[i];
+    }
+
+    /**
+     * @brief Сумма статистики всех плат
+     */
+    MockMCU::Statistics totalStatistics() const;
+
+    void start();
+    void stop();
+
+    bool isRunning() const
+    {
+        return m_running;
+    }
+
+private:
+    const size_t m_threadCount;
+    const std::chrono::microseconds m_idleInterval;
+    std::vector<std::unique_ptr<MockMCU>> m_mcus;
+    size_t m_activeThreads = 1;
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_running{false};
+
+    void workerLoop(size_t index);
+};
+
+#endif // MCU_FARM_HPP_
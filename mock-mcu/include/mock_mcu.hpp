@@ -3,26 +3,39 @@
 
 #include <memory>
 #include <vector>
+#include <deque>
 #include <cstdint>
 #include <string>
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <chrono>
+#include <optional>
+#include <random>
 #include <condition_variable>
 
 #include "i_module.hpp"
+#include "fault_profile.hpp"
+#include "motion_model.hpp"
+#include "protocol_handler.hpp"
 
 /**
  * @brief Mock MCU - имитатор микроконтроллера для тестирования протокола
- * 
+ *
  * Этот класс имитирует поведение реального микроконтроллера, который:
- * 1. Принимает команды от основного сервиса через FT232RL
+ * 1. Принимает команды от основного сервиса через FT232RL или VirtualLink
  * 2. Обрабатывает команды согласно протоколу
  * 3. Отправляет ответы обратно в сервис
+ *
+ * Обработка неблокирующая: poll() разбирает пришедшие байты и отправляет ответы, движение моторов
+ * не спит, а ставит срок завершения. Поэтому одна плата может работать в своем потоке (start()),
+ * а много плат - на общем пуле потоков (McuFarm).
  */
 class MockMCU
 {
 public:
+    using Clock = std::chrono::steady_clock;
+
     MockMCU();
     ~MockMCU();
 
@@ -34,7 +47,33 @@ public:
     bool initialize(int deviceId);
 
     /**
-     * @brief Запуск обработки команд
+     * @brief Инициализация mock-MCU на готовом канале, например VirtualLink::mcuEnd()
+     * @param link Канал связи с сервисом
+     * @return true если инициализация успешна
+     */
+    bool initialize(std::unique_ptr<IModule> link);
+
+    /**
+     * @brief Объединенный режим протокола (прошивка 2.0): заголовок 0x8N/0x4N и параметры моторов
+     * приходят одной записью, версия отдается как 0x20. Задается до start()
+     * @param enabled true - объединенный режим, false - двухэтапный (по умолчанию)
+     */
+    void setCoalescedMode(bool enabled);
+
+    /**
+     * @brief Модель движения, по которой считается время выполнения команды. Задается до start()
+     * @param model Профиль скорости моторов (по умолчанию трапециевидный)
+     * @param timeScale Во сколько раз быстрее реального времени идет имитация, 0 - без ожидания
+     */
+    void setMotionModel(const MotionModel& model, double timeScale = 1.0);
+
+    /**
+     * @brief Профиль сбоев этой платы и ее канала (см. FaultProfile). Задается до start()
+     */
+    void setFaultProfile(const FaultProfile& profile);
+
+    /**
+     * @brief Запуск обработки команд в собственном потоке
      */
     void start();
 
@@ -49,6 +88,19 @@ public:
      */
     bool isRunning() const;
 
+    /**
+     * @brief Один шаг обработки без ожидания: завершить движение, если срок наступил, и разобрать
+     * пришедшие байты. Вызывается из одного потока за раз (свой поток платы или поток McuFarm)
+     * @param now Текущее время
+     * @return true если что-то обработано
+     */
+    bool poll(Clock::time_point now);
+
+    /**
+     * @brief Срок, к которому poll() нужно вызвать без новых данных (завершение движения)
+     */
+    std::optional<Clock::time_point> nextDeadline() const;
+
     /**
      * @brief Получение статистики работы
      */
@@ -58,60 +110,145 @@ public:
         uint32_t errorsOccurred = 0;
         uint32_t versionRequests = 0;
         uint32_t motorCommands = 0;
+        uint32_t faultsInjected = 0;
+        uint32_t emergencyStops = 0;
     };
-    
+
     Statistics getStatistics() const;
 
 private:
     std::unique_ptr<IModule> m_module;
     std::atomic<bool> m_running;
     std::atomic<bool> m_initialized;
-    
+    bool m_coalesced;
+    MotionModel m_motion;
+    double m_timeScale;
+    FaultProfile m_faults;
+    std::mt19937 m_random;
+
     mutable std::mutex m_statsMutex;
     Statistics m_statistics;
-    
+
     std::thread m_workerThread;
-    
+
+    /**
+     * @brief Ответ, который уйдет в канал не раньше at
+     */
+    struct Outgoing {
+        Clock::time_point at;
+        std::vector<uint8_t> bytes;
+    };
+
+    /**
+     * @brief Сбои, выпавшие текущей команде движения
+     */
+    struct PendingFaults {
+        Clock::duration readinessDelay{0};
+        bool truncated = false;
+        bool stall = false;
+        bool disconnect = false;
+    };
+
+    int m_deviceId = 0;
+    std::deque<uint8_t> m_input;                  ///< прочитанные, но еще не разобранные байты
+    std::deque<Outgoing> m_outbox;                ///< ответы по времени отправки
+    uint8_t m_header = 0;                         ///< 0 - ждем команду
+    std::vector<uint8_t> m_payload;               ///< параметры моторов текущей команды
+    std::optional<Clock::time_point> m_busyUntil; ///< моторы в движении до этого момента
+    Clock::time_point m_retryAt{};                ///< после ошибки канала не опрашивать до
+    PendingFaults m_pending;
+    std::optional<std::pair<Clock::time_point, Clock::time_point>> m_stall; ///< канал замер [с, до)
+    std::optional<Clock::time_point> m_disconnectAt;                         ///< внедренное отключение
+    std::optional<Clock::time_point> m_offlineUntil;                         ///< плата отключена до
+
     /**
      * @brief Основной цикл обработки команд
      */
     void workerLoop();
-    
+
+    /**
+     * @brief Разбор одного байта команды или параметров
+     * @return false если байт - отклоненный заголовок команды движения
+     */
+    bool consume(uint8_t byte, Clock::time_point now);
+
     /**
      * @brief Обработка команды версии (0x20)
      */
-    void handleVersionCommand();
-    
+    void handleVersionCommand(Clock::time_point now);
+
     /**
-     * @brief Обработка команды движения моторов
+     * @brief Обработка заголовка команды движения моторов
      * @param commandByte Байт команды (0x8N или 0x4N)
+     * @return false если команда отклонена
+     */
+    bool handleMotorCommand(uint8_t commandByte, Clock::time_point now);
+
+    /**
+     * @brief Все параметры моторов получены: запуск движения
      */
-    void handleMotorCommand(uint8_t commandByte);
+    void startMotion(Clock::time_point now);
     
+    /**
+     * @brief Экстренная остановка (0x10) во время движения: ответ о завершении с кодом 0x0B
+     * уходит сразу вместо запланированного
+     */
+    void stopMotion(Clock::time_point now);
+
     /**
      * @brief Отправка ответа готовности
      * @param status Код статуса (0x00 = OK, другие = ошибка)
+     * @param at Момент отправки
      */
-    void sendReadinessResponse(uint8_t status);
-    
+    void sendReadinessResponse(uint8_t status, Clock::time_point at);
+
     /**
      * @brief Отправка ответа выполнения
      * @param status Код статуса (0xFF = успех, другие = ошибка)
+     * @param at Момент отправки
+     * @param truncated Отправить только первый байт
      */
-    void sendExecutionResponse(uint8_t status);
-    
+    void sendExecutionResponse(uint8_t status, Clock::time_point at, bool truncated);
+
     /**
-     * @brief Симуляция обработки моторов
-     * @param motorCount Количество моторов
-     * @param isSynchronous Синхронный ли режим
-     * @return Код результата выполнения
+     * @brief Поставить ответ в очередь, ответы уходят в порядке постановки
      */
-    uint8_t simulateMotorProcessing(size_t motorCount, bool isSynchronous);
-    
+    void send(std::vector<uint8_t> bytes, Clock::time_point at);
+
+    /**
+     * @brief Записать в канал ответы, время которых наступило
+     * @return true если что-то отправлено
+     */
+    bool flush(Clock::time_point now);
+
+    /**
+     * @brief Внедренное отключение: канал закрывается, все в полете теряется
+     */
+    void goOffline(Clock::time_point now);
+
     /**
-     * @brief Логирование событий
+     * @brief Подключиться снова, когда истекло время отключения
+     */
+    bool reconnect(Clock::time_point now);
+
+    /**
+     * @brief Выпал ли сбой с вероятностью rate, выпавшие сбои считаются в статистике
+     */
+    bool roll(double rate);
+
+    uint8_t randomCode(uint8_t max);
+
+    /**
+     * @brief Симуляция обработки моторов по модели движения m_motion
+     * @param motors Параметры моторов
+     * @param isSynchronous Синхронный ли режим
+     * @param duration Время движения в масштабе m_timeScale
+     * @return Код результата выполнения
      */
-    void logEvent(const std::string& message);
+    uint8_t simulateMotorProcessing(
+        const std::vector<ProtocolHandler::MotorData>& motors,
+        bool isSynchronous,
+        Clock::duration& duration);
 };
 
 #endif // MOCK_MCU_HPP_
@@ -0,0 +1,83 @@
+#ifndef MOTION_MODEL_HPP_
+#define MOTION_MODEL_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "protocol_handler.hpp"
+
+/**
+ * @brief Кинематическая модель шагового мотора: сколько длится перемещение по параметрам MotorData
+ *
+ * Единицы - как в протоколе: step - шаги, maxSpeed - шаги/с, acceleration - шаги/с².
+ *
+ * Trapezoidal - разгон с постоянным ускорением, движение на maxSpeed, торможение. Если на разгон и
+ * торможение не хватает пути, профиль треугольный: пиковая скорость sqrt(|step| * acceleration).
+ *
+ * SCurve - ускорение нарастает и спадает с рывком jerk (шаги/с³), т.е. каждый разгон и торможение
+ * длиннее трапециевидного на acceleration / jerk. Если путь короткий, пиковая скорость снижается,
+ * а при совсем малом пути ускорение не успевает дойти до acceleration.
+ *
+ * Synchronous (0x8N) - интерполированное движение: моторы стартуют вместе и приходят одновременно,
+ * каждый по времени самого долгого. Asynchronous (0x4N) - каждый мотор идет по своему профилю и
+ * заканчивает сам. В обоих режимах MCU отвечает о завершении, когда остановился последний мотор.
+ */
+class MotionModel
+{
+public:
+    using Duration = std::chrono::nanoseconds;
+
+    enum class Profile : uint8_t {
+        Trapezoidal = 0,
+        SCurve
+    };
+
+    /**
+     * @brief Расписание одной команды движения
+     */
+    struct Plan {
+        std::vector<Duration> finish; ///< момент остановки каждого мотора от старта, в порядке команды
+        Duration total{0};            ///< когда MCU отвечает о завершении
+    };
+
+    explicit MotionModel(Profile profile = Profile::Trapezoidal, double jerk = 100000.0);
+
+    Profile profile() const
+    {
+        return m_profile;
+    }
+
+    double jerk() const
+    {
+        return m_jerk;
+    }
+
+    /**
+     * @brief Время перемещения одного мотора, 0 - для нулевого пути или параметров
+     */
+    Duration moveTime(const ProtocolHandler::MotorData& motor) const;
+
+    /**
+     * @brief Расписание команды с учетом режима
+     */
+    Plan plan(const std::vector<ProtocolHandler::MotorData>& motors, bool isSynchronous) const;
+
+    /**
+     * @brief "trapezoidal" | "scurve"
+     */
+    static std::optional<Profile> parseProfile(const std::string& name);
+
+    static const char* profileName(Profile profile);
+
+private:
+    Profile m_profile;
+    double m_jerk;
+
+    double trapezoidalSeconds(double distance, double speed, double acceleration) const;
+    double sCurveSeconds(double distance, double speed, double acceleration) const;
+};
+
+#endif // MOTION_MODEL_HPP_
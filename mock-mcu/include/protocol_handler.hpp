@@ -14,6 +14,9 @@
 class ProtocolHandler
 {
 public:
+    static constexpr uint8_t EMERGENCY_STOP = 0x10; ///< команда экстренной остановки
+    static constexpr uint8_t STOPPED = 0x0B;        ///< код завершения движения, прерванного остановкой
+    
     /**
      * @brief Структура данных мотора для обработки
      */
@@ -47,6 +50,13 @@ public:
      */
     static CommandResult handleMotorCommand(uint8_t commandByte, const std::vector<MotorData>& motorData);
     
+    /**
+     * @brief Ответ о завершении команды движения в том виде, в каком его читает сервис:
+     * [0x00, код] (UserCore::executeMove ждет два байта и проверяет второй)
+     * @param code Код результата (0xFF = успех)
+     */
+    static std::vector<uint8_t> completionFrame(uint8_t code);
+    
     /**
      * @brief Парсинг данных моторов из байтового массива
      * @param data Байтовый массив с данными
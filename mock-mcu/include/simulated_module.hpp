@@ -0,0 +1,187 @@
+#ifndef SIMULATED_MODULE_HPP_
+#define SIMULATED_MODULE_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "i_module.hpp"
+#include "clock.hpp"
+#include "motion_model.hpp"
+
+/**
+ * @brief Внедряемые сбои SimulatedModule, применяются к команде движения
+ */
+enum class SimulatedFault : uint8_t
+{
+    None = 0,
+    ReadinessError, ///< байт готовности != 0x00 (код из injectFault)
+    ExecutionError, ///< код завершения != 0xFF (код из injectFault)
+    NoReadiness,    ///< MCU не отвечает на заголовок
+    NoCompletion,   ///< готовность есть, завершения нет
+    Disconnect      ///< плата пропадает: isConnected() == false, запись и чтение бросают исключение
+};
+
+/**
+ * @brief SimulatedModule - плата MCU в памяти процесса, без FT232RL и USB
+ *
+ * Реализует протокол из docs/device_interface.md поверх ProtocolHandler из mock-mcu:
+ * 0x20 -> байт версии, 0x8N/0x4N -> байт готовности, N x 16 байт параметров -> завершение.
+ * Заголовок и параметры принимаются как раздельно, так и одной записью (прошивка 2.0).
+ * Завершение отдается двумя байтами [0x00, код], как его читает UserCore::executeMove.
+ *
+ * Задержки ответов задаются отдельно для версии, готовности и завершения (по умолчанию нулевые):
+ * ответ ставится в очередь с моментом прихода и виден в checkRXChannel() только после него.
+ * Сбои задаются разово (injectFault) или с вероятностью (setFaultProbability, генератор с
+ * фиксированным seed - прогоны воспроизводимы).
+ *
+ * С моделью движения (setMotionModel) к задержке завершения добавляется время перемещения моторов
+ * по их ускорению, скорости и числу шагов.
+ *
+ * Экстренная остановка (0x10) во время движения заменяет еще не пришедшее завершение ответом
+ * [0x00, 0x0B] без задержки, без движения остановка игнорируется.
+ *
+ * Моменты прихода считаются по IClock (setClock): с тем же ManualClock, что у UserCore, задержки
+ * платы проходят в виртуальном времени.
+ *
+ * В отличие от FT232RL, readData не сбрасывает приемный буфер после чтения: при нулевых задержках
+ * готовность и завершение приходят одновременно.
+ */
+class SimulatedModule : public IModule
+{
+public:
+    /**
+     * @brief Задержки ответов MCU
+     */
+    struct Latency {
+        std::chrono::microseconds version{0};
+        std::chrono::microseconds readiness{0};
+        std::chrono::microseconds completion{0};
+    };
+
+    /**
+     * @brief Счетчики обработанных команд
+     */
+    struct Statistics {
+        uint32_t versionRequests = 0;
+        uint32_t motorCommands = 0;
+        uint32_t faultsInjected = 0;
+        uint32_t emergencyStops = 0;
+    };
+
+    SimulatedModule();
+    explicit SimulatedModule(Latency latency);
+
+    /**
+     * @brief Задержки ответов, действуют для следующих команд
+     */
+    void setLatency(Latency latency);
+
+    /**
+     * @brief Байт версии прошивки (x.y -> 0xXY), по умолчанию из ProtocolHandler
+     */
+    void setFirmwareVersion(uint8_t version);
+
+    /**
+     * @brief Источник времени для задержек ответов, по умолчанию SystemClock.
+     * Задается до первой команды, clock должен жить дольше модуля
+     */
+    void setClock(IClock& clock);
+
+    /**
+     * @brief Время выполнения команды движения по модели: завершение приходит через
+     * Latency::completion плюс время движения / timeScale. std::nullopt - только Latency::completion
+     */
+    void setMotionModel(std::optional<MotionModel> model, double timeScale = 1.0);
+
+    /**
+     * @brief Разовый сбой для следующей команды движения, сбои копятся в очередь
+     * @param fault Вид сбоя
+     * @param code Код ошибки для ReadinessError/ExecutionError (0x01-0x0F)
+     */
+    void injectFault(SimulatedFault fault, uint8_t code = 0x0F);
+
+    /**
+     * @brief Сбой с вероятностью probability на каждую команду движения, 0 - отключить
+     */
+    void setFaultProbability(SimulatedFault fault, double probability, uint8_t code = 0x0F, uint32_t seed = 1);
+
+    /**
+     * @brief Вернуть плату после SimulatedFault::Disconnect, очередь ответов очищается
+     */
+    void restore();
+
+    Statistics getStatistics() const;
+
+    bool connect(const int deviceId) override;
+    void disconnect() override;
+    bool isConnected() const override;
+    std::vector<std::string> listComs() const override;
+
+    void setBaudRate(const int baudRate) override;
+    int getBaudRate() override;
+    void setUSBParameters(const int, const int) override {}
+    void setCharacteristics(const uchar, const uchar, const uchar) override {}
+    void setLinkProfile(const LinkProfile& profile) override;
+    LinkProfile getLinkProfile() const override;
+    void waitWriteSuccess() override {}
+    size_t checkRXChannel() const override;
+    void writeData(const std::vector<uchar>& data) override;
+    void readData(std::vector<uchar>& data) override;
+    std::vector<uchar> read(const size_t timeout) override;
+
+    explicit operator bool() const override
+    {
+        return isConnected();
+    }
+
+private:
+    struct Pending {
+        uchar byte;
+        IClock::TimePoint arrival;
+    };
+
+    struct Fault {
+        SimulatedFault kind;
+        uint8_t code;
+    };
+
+    mutable std::mutex m_mutex;
+    IClock* m_clock = &SystemClock::instance();
+    bool m_connected = true;
+    bool m_lost = false;
+    int m_deviceId = 0;
+    int m_baudRate = 115200;
+    uint8_t m_version;
+    LinkProfile m_profile{};
+    Latency m_latency{};
+    std::optional<MotionModel> m_motion;
+    double m_timeScale = 1.0;
+    Statistics m_statistics{};
+
+    std::deque<Pending> m_rx;
+    std::vector<uint8_t> m_payload; // параметры моторов текущей команды
+    uint8_t m_header = 0;           // 0 - ждем заголовок
+    std::optional<IClock::TimePoint> m_busyUntil; // приход ответа о завершении движения
+    Fault m_current{SimulatedFault::None, 0};
+
+    std::deque<Fault> m_faults;
+    Fault m_randomFault{SimulatedFault::None, 0};
+    double m_faultProbability = 0.0;
+    std::mt19937 m_random;
+
+    void checkAlive() const;
+    void push(std::initializer_list<uchar> bytes, std::chrono::microseconds delay);
+    bool acceptHeader(uint8_t header);
+    void stopMotion();
+    void completeMotorCommand();
+    Fault nextFault();
+    size_t arrived(IClock::TimePoint now) const;
+};
+
+#endif // SIMULATED_MODULE_HPP_
@@ -0,0 +1,53 @@
+#ifndef VIRTUAL_LINK_HPP_
+#define VIRTUAL_LINK_HPP_
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "i_module.hpp"
+
+/**
+ * @brief VirtualLink - последовательный канал в памяти процесса между сервисом и MockMCU
+ *
+ * Заменяет пару FT232RL с кабелем: hostEnd() отдается сервису (DeviceManager, UserCore),
+ * mcuEnd() - MockMCU. Записанное в один конец читается из другого в том же порядке.
+ *
+ * Отключение конца MCU (disconnect) - как выдернутый кабель: байты в полете теряются, конец сервиса
+ * считается отключенным и бросает исключение на запись и чтение, пока MCU не подключится снова.
+ *
+ * В отличие от FT232RL, readData не ждет и не сбрасывает приемный буфер: читает сколько пришло
+ * (не больше размера буфера), остальное остается до следующего чтения.
+ */
+class VirtualLink
+{
+public:
+    explicit VirtualLink(std::string name = "Virtual link");
+
+    /**
+     * @brief Конец сервиса. Вызывается один раз, канал живет, пока жив любой из концов
+     */
+    std::unique_ptr<IModule> hostEnd();
+
+    /**
+     * @brief Конец MCU. Вызывается один раз
+     */
+    std::unique_ptr<IModule> mcuEnd();
+
+private:
+    struct Shared {
+        std::mutex mutex;
+        std::deque<uchar> toMcu;
+        std::deque<uchar> toHost;
+        bool mcuConnected = true;
+        std::string name;
+    };
+
+    class End;
+
+    std::shared_ptr<Shared> m_shared;
+};
+
+#endif // VIRTUAL_LINK_HPP_
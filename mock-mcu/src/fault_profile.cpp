@@ -0,0 +1,207 @@
+#include "fault_profile.hpp"
+
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+std::string trim(const std::string& text)
+{
+    const auto first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return "";
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+bool parseNumber(const std::string& text, double& value)
+{
+    try {
+        size_t used = 0;
+        value = std::stod(text, &used);
+        return used == text.size();
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool parseUnsigned(const std::string& text, unsigned long max, unsigned long& value)
+{
+    try {
+        size_t used = 0;
+        value = std::stoul(text, &used, 0); // 0x06 и 6
+        return used == text.size() && value <= max && text.front() != '-';
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Одна запись "имя=вероятность[:параметр]"
+ */
+bool applyEntry(FaultProfile& profile, const std::string& entry, std::string& error)
+{
+    const auto eq = entry.find('=');
+    if (eq == std::string::npos) {
+        error = std::format("'{}': expected name=value", entry);
+        return false;
+    }
+
+    const std::string name = trim(entry.substr(0, eq));
+    std::string value = trim(entry.substr(eq + 1));
+    std::string param;
+    if (const auto colon = value.find(':'); colon != std::string::npos) {
+        param = trim(value.substr(colon + 1));
+        value = trim(value.substr(0, colon));
+    }
+
+    if (name == "seed") {
+        unsigned long seed = 0;
+        if (!parseUnsigned(value, UINT32_MAX, seed) || !param.empty()) {
+            error = std::format("'{}': seed must be an unsigned integer", entry);
+            return false;
+        }
+        profile.seed = static_cast<uint32_t>(seed);
+        return true;
+    }
+
+    double rate = 0.0;
+    if (!parseNumber(value, rate) || rate < 0.0 || rate > 1.0) {
+        error = std::format("'{}': probability must be in [0, 1]", entry);
+        return false;
+    }
+
+    // Параметр - код ошибки или длительность в мс
+    const auto code = [&](double& rateField, uint8_t& codeField, unsigned long max) {
+        unsigned long parsed = 0;
+        if (!param.empty() && (!parseUnsigned(param, max, parsed) || parsed == 0)) {
+            error = std::format("'{}': error code must be 0x01-0x{:02X}", entry, max);
+            return false;
+        }
+        rateField = rate;
+        codeField = static_cast<uint8_t>(parsed);
+        return true;
+    };
+    const auto duration = [&](double& rateField, std::chrono::milliseconds& durationField) {
+        unsigned long ms = 0;
+        if (!parseUnsigned(param, 3600000, ms)) {
+            error = std::format("'{}': duration in ms is required, e.g. {}=0.1:500", entry, name);
+            return false;
+        }
+        rateField = rate;
+        durationField = std::chrono::milliseconds(ms);
+        return true;
+    };
+    const auto plain = [&](double& rateField) {
+        if (!param.empty()) {
+            error = std::format("'{}': no parameter expected", entry);
+            return false;
+        }
+        rateField = rate;
+        return true;
+    };
+
+    if (name == "execution-error") {
+        return code(profile.executionErrorRate, profile.executionErrorCode, 0x0F);
+    }
+    if (name == "readiness-error") {
+        return code(profile.readinessErrorRate, profile.readinessErrorCode, 0x0A);
+    }
+    if (name == "readiness-delay") {
+        return duration(profile.readinessDelayRate, profile.readinessDelay);
+    }
+    if (name == "truncated-completion") {
+        return plain(profile.truncatedCompletionRate);
+    }
+    if (name == "drop-byte") {
+        return plain(profile.dropByteRate);
+    }
+    if (name == "stall") {
+        return duration(profile.stallRate, profile.stallDuration);
+    }
+    if (name == "disconnect") {
+        return duration(profile.disconnectRate, profile.disconnectDuration);
+    }
+
+    error = std::format("'{}': unknown fault '{}'", entry, name);
+    return false;
+}
+} // namespace
+
+bool FaultProfile::enabled() const
+{
+    return executionErrorRate > 0.0 || readinessErrorRate > 0.0 || readinessDelayRate > 0.0
+        || truncatedCompletionRate > 0.0 || dropByteRate > 0.0 || stallRate > 0.0 || disconnectRate > 0.0;
+}
+
+std::optional<FaultProfile> FaultProfile::parse(const std::string& text, std::string& error)
+{
+    FaultProfile profile;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream entries(line);
+        std::string entry;
+        while (std::getline(entries, entry, ',')) {
+            entry = trim(entry);
+            if (!entry.empty() && !applyEntry(profile, entry, error)) {
+                return std::nullopt;
+            }
+        }
+    }
+    return profile;
+}
+
+std::optional<FaultProfile> FaultProfile::load(const std::string& path, std::string& error)
+{
+    std::ifstream file(path);
+    if (!file) {
+        error = std::format("cannot open '{}'", path);
+        return std::nullopt;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+    return parse(text.str(), error);
+}
+
+std::string FaultProfile::describe() const
+{
+    std::string text;
+    const auto add = [&text](const std::string& entry) {
+        text += (text.empty() ? "" : ",") + entry;
+    };
+    const auto withCode = [](double rate, uint8_t code) {
+        return code == 0 ? std::format("{}", rate) : std::format("{}:0x{:02X}", rate, code);
+    };
+
+    if (executionErrorRate > 0.0) {
+        add("execution-error=" + withCode(executionErrorRate, executionErrorCode));
+    }
+    if (readinessErrorRate > 0.0) {
+        add("readiness-error=" + withCode(readinessErrorRate, readinessErrorCode));
+    }
+    if (readinessDelayRate > 0.0) {
+        add(std::format("readiness-delay={}:{}", readinessDelayRate, readinessDelay.count()));
+    }
+    if (truncatedCompletionRate > 0.0) {
+        add(std::format("truncated-completion={}", truncatedCompletionRate));
+    }
+    if (dropByteRate > 0.0) {
+        add(std::format("drop-byte={}", dropByteRate));
+    }
+    if (stallRate > 0.0) {
+        add(std::format("stall={}:{}", stallRate, stallDuration.count()));
+    }
+    if (disconnectRate > 0.0) {
+        add(std::format("disconnect={}:{}", disconnectRate, disconnectDuration.count()));
+    }
+    add(std::format("seed={}", seed));
+    return text;
+}
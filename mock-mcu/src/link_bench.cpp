@@ -0,0 +1,154 @@
+#include "ft232rl.hpp"
+#include "link_profile.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Замер времени round-trip команды версии (0x20 -> 1 байт) для профилей канала
+ *
+ * Запускается против работающего MockMCU: сервисная сторона на устройстве -d, MockMCU на соседнем.
+ * Для каждого профиля модуль переподключается, чтобы параметры применялись так же, как в connect.
+ */
+
+struct RoundTripStats {
+    std::string profile;
+    size_t samples = 0;
+    size_t timeouts = 0;
+    double minUs = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+    double maxUs = 0;
+    double avgUs = 0;
+};
+
+void printUsage(const char* programName)
+{
+    std::cout << std::format(
+        "link-bench - замер round-trip команды 0x20 через FT232RL для профилей канала\n\n"
+        "Использование: {} [OPTIONS]\n\n"
+        "Опции:\n"
+        "  -d, --device ID      ID устройства FT232RL со стороны сервиса (по умолчанию: 0)\n"
+        "  -n, --count N        Количество запросов на профиль (по умолчанию: 1000)\n"
+        "  -p, --profile NAME   default | low-latency | bulk (по умолчанию: все)\n"
+        "  -h, --help           Показать эту справку\n\n"
+        "Перед запуском поднимите MockMCU на втором устройстве: ./mock-mcu -d 1\n\n",
+        programName
+    );
+}
+
+RoundTripStats runProfile(int deviceId, const LinkProfile& profile, size_t count)
+{
+    using clock = std::chrono::steady_clock;
+
+    RoundTripStats stats;
+    stats.profile = profile.name;
+
+    FT232RL module;
+    module.setLinkProfile(profile);
+    if (!module.connect(deviceId)) {
+        std::cerr << std::format("Не удалось подключиться к устройству {}\n", deviceId);
+        return stats;
+    }
+
+    std::vector<double> samples;
+    samples.reserve(count);
+
+    const std::vector<uchar> request = {0x20};
+    std::vector<uchar> response(1, 0);
+    const auto timeout = std::chrono::milliseconds(profile.readTimeoutMs);
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto start = clock::now();
+        module.writeData(request);
+
+        bool received = false;
+        while (clock::now() - start < timeout) {
+            if (module.checkRXChannel() >= 1) {
+                module.readData(response);
+                received = true;
+                break;
+            }
+        }
+
+        if (!received) {
+            ++stats.timeouts;
+            continue;
+        }
+
+        samples.push_back(std::chrono::duration<double, std::micro>(clock::now() - start).count());
+    }
+
+    module.disconnect();
+
+    if (samples.empty()) {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    stats.samples = samples.size();
+    stats.minUs = samples.front();
+    stats.maxUs = samples.back();
+    stats.p50Us = samples[samples.size() / 2];
+    stats.p99Us = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    stats.avgUs = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    return stats;
+}
+
+int main(int argc, char* argv[])
+{
+    int deviceId = 0;
+    size_t count = 1000;
+    std::vector<LinkProfile> profiles = {
+        LinkProfile::defaults(), LinkProfile::lowLatency(), LinkProfile::bulk()};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else if ((arg == "-d" || arg == "--device") && i + 1 < argc) {
+            deviceId = std::stoi(argv[++i]);
+        }
+        else if ((arg == "-n" || arg == "--count") && i + 1 < argc) {
+            count = std::stoul(argv[++i]);
+        }
+        else if ((arg == "-p" || arg == "--profile") && i + 1 < argc) {
+            LinkProfile profile;
+            if (!LinkProfile::fromName(argv[++i], profile)) {
+                std::cerr << "Неизвестный профиль: " << argv[i] << std::endl;
+                return 1;
+            }
+            profiles = {profile};
+        }
+        else {
+            std::cerr << "Неизвестный аргумент: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::cout << std::format("{:<12} {:>8} {:>8} {:>10} {:>10} {:>10} {:>10} {:>10}\n",
+                             "profile", "samples", "timeouts", "min,us", "p50,us", "p99,us", "max,us", "avg,us");
+
+    for (const auto& profile : profiles) {
+        try {
+            const auto stats = runProfile(deviceId, profile, count);
+            std::cout << std::format("{:<12} {:>8} {:>8} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}\n",
+                                     stats.profile, stats.samples, stats.timeouts,
+                                     stats.minUs, stats.p50Us, stats.p99Us, stats.maxUs, stats.avgUs);
+        }
+        catch (const std::exception& e) {
+            std::cerr << std::format("{}: {}\n", profile.name, e.what());
+        }
+    }
+
+    return 0;
+}
@@ -1,14 +1,17 @@
-#include "mock_mcu.hpp"
+#include "mcu_farm.hpp"
+#include "logger.hpp"
+#include <algorithm>
 #include <iostream>
 #include <csignal>
 #include <atomic>
 #include <format>
 #include <thread>
 #include <chrono>
+#include <vector>
 
 // Глобальная переменная для корректного завершения
 std::atomic<bool> g_running{true};
-std::unique_ptr<MockMCU> g_mockMCU;
+std::unique_ptr<McuFarm> g_farm;
 
 /**
  * @brief Обработчик сигналов для корректного завершения
@@ -18,8 +21,8 @@ void signalHandler(int signal)
     std::cout << std::format("\nReceived signal {}, shutting down...\n", signal);
     g_running = false;
     
-    if (g_mockMCU) {
-        g_mockMCU->stop();
+    if (g_farm) {
+        g_farm->stop();
     }
 }
 
@@ -32,44 +35,72 @@ void printUsage(const char* programName)
         "MockMCU - Имитатор микроконтроллера для тестирования MotorControlService\n\n"
         "Использование: {} [OPTIONS]\n\n"
         "Опции:\n"
-        "  -d, --device ID     ID устройства FT232RL (по умолчанию: 1)\n"
+        "  -d, --device ID     ID устройства FT232RL (по умолчанию: 1), можно повторять\n"
+        "  -T, --threads N     Потоков на все платы (по умолчанию: 1 на плату, не больше 4)\n"
         "  -h, --help          Показать эту справку\n"
-        "  -v, --verbose       Подробный вывод\n"
-        "  -s, --stats         Показывать статистику каждые 5 секунд\n\n"
+        "  -v, --verbose       Подробный вывод (каждая команда и ответ MCU)\n"
+        "  -s, --stats         Показывать статистику каждые 5 секунд\n"
+        "  -c, --coalesced     Прошивка 2.0: заголовок и параметры моторов одной записью\n"
+        "  -p, --profile NAME  Профиль скорости моторов: trapezoidal (по умолчанию) | scurve\n"
+        "  -j, --jerk J        Рывок для scurve, шаги/с^3 (по умолчанию: 100000)\n"
+        "  -t, --time-scale K  Имитация движения в K раз быстрее реального времени, 0 - без ожидания\n"
+        "  -f, --faults SPEC   Профиль сбоев, например execution-error=0.05:0x06,stall=0.01:2000\n"
+        "  -F, --fault-file P  Профиль сбоев из файла (записи через запятую или с новой строки)\n\n"
         "Примеры:\n"
         "  {}                  # Запуск с устройством ID=1\n"
         "  {} -d 0             # Запуск с устройством ID=0\n"
-        "  {} -d 1 -s          # Запуск с показом статистики\n\n"
+        "  {} -d 1 -s          # Запуск с показом статистики\n"
+        "  {} -d 1 -d 2 -d 3 -T 1  # Три платы в одном процессе на одном потоке\n"
+        "  {} -p scurve -t 10  # S-кривая, время движения в 10 раз короче\n"
+        "  {} -f drop-byte=0.01,disconnect=0.001:1000  # Деградировавший канал\n\n"
         "Протокол:\n"
         "  MockMCU имитирует микроконтроллер, который:\n"
         "  - Принимает команды от MotorControlService\n"
         "  - Обрабатывает команды version() и moving()\n"
         "  - Отправляет ответы согласно протоколу\n\n",
-        programName, programName, programName, programName
+        programName, programName, programName, programName, programName, programName, programName
     );
 }
 
 /**
  * @brief Вывод статистики
  */
-void printStatistics(const MockMCU::Statistics& stats)
+void printStatistics(const MockMCU::Statistics& stats, const std::string& title)
 {
     std::cout << std::format(
-        "\n=== Статистика MockMCU ===\n"
+        "\n=== Статистика {} ===\n"
         "Команд получено:     {}\n"
         "Команд обработано:   {}\n"
         "Ошибок произошло:    {}\n"
         "Запросов версии:     {}\n"
         "Команд моторов:      {}\n"
+        "Внедрено сбоев:      {}\n"
+        "Остановок (STOP):    {}\n"
         "========================\n",
+        title,
         stats.commandsReceived,
         stats.commandsProcessed,
         stats.errorsOccurred,
         stats.versionRequests,
-        stats.motorCommands
+        stats.motorCommands,
+        stats.faultsInjected,
+        stats.emergencyStops
     );
 }
 
+/**
+ * @brief Статистика каждой платы и, если их несколько, сумма
+ */
+void printFarmStatistics(McuFarm& farm, const std::vector<int>& deviceIds)
+{
+    for (size_t i = 0; i < farm.size(); ++i) {
+        printStatistics(farm[i].getStatistics(), std::format("MockMCU (device {})", deviceIds[i]));
+    }
+    if (farm.size() > 1) {
+        printStatistics(farm.totalStatistics(), "MockMCU (всего)");
+    }
+}
+
 int main(int argc, char* argv[])
 {
     // Настройка обработчиков сигналов
@@ -77,9 +108,15 @@ int main(int argc, char* argv[])
     std::signal(SIGTERM, signalHandler);
     
     // Параметры по умолчанию
-    int deviceId = 1;
+    std::vector<int> deviceIds;
+    size_t threads = 0;
     bool verbose = false;
     bool showStats = false;
+    bool coalesced = false;
+    MotionModel::Profile profile = MotionModel::Profile::Trapezoidal;
+    double jerk = 100000.0;
+    double timeScale = 1.0;
+    FaultProfile faults;
     
     // Парсинг аргументов командной строки
     for (int i = 1; i < argc; ++i) {
@@ -92,7 +129,7 @@ int main(int argc, char* argv[])
         else if (arg == "-d" || arg == "--device") {
             if (i + 1 < argc) {
                 try {
-                    deviceId = std::stoi(argv[++i]);
+                    deviceIds.push_back(std::stoi(argv[++i]));
                 } catch (const std::exception& e) {
                     std::cerr << "Ошибка: неверный ID устройства: " << argv[i] << std::endl;
                     return 1;
@@ -102,12 +139,60 @@ int main(int argc, char* argv[])
                 return 1;
             }
         }
+        else if (arg == "-f" || arg == "--faults" || arg == "-F" || arg == "--fault-file") {
+            if (i + 1 >= argc) {
+                std::cerr << "Ошибка: не указан профиль сбоев после " << arg << std::endl;
+                return 1;
+            }
+            std::string error;
+            const bool fromFile = arg == "-F" || arg == "--fault-file";
+            const auto parsed = fromFile ? FaultProfile::load(argv[++i], error) : FaultProfile::parse(argv[++i], error);
+            if (!parsed) {
+                std::cerr << "Ошибка в профиле сбоев: " << error << std::endl;
+                return 1;
+            }
+            faults = *parsed;
+        }
+        else if (arg == "-T" || arg == "--threads") {
+            try {
+                threads = i + 1 < argc ? std::stoul(argv[++i]) : 0;
+            } catch (const std::exception&) {
+            }
+            if (threads == 0) {
+                std::cerr << "Ошибка: неверное число потоков" << std::endl;
+                return 1;
+            }
+        }
         else if (arg == "-v" || arg == "--verbose") {
             verbose = true;
         }
         else if (arg == "-s" || arg == "--stats") {
             showStats = true;
         }
+        else if (arg == "-c" || arg == "--coalesced") {
+            coalesced = true;
+        }
+        else if (arg == "-p" || arg == "--profile") {
+            const auto parsed = i + 1 < argc ? MotionModel::parseProfile(argv[++i]) : std::nullopt;
+            if (!parsed) {
+                std::cerr << "Ошибка: профиль должен быть trapezoidal или scurve" << std::endl;
+                return 1;
+            }
+            profile = *parsed;
+        }
+        else if (arg == "-j" || arg == "--jerk" || arg == "-t" || arg == "--time-scale") {
+            double value = -1.0;
+            try {
+                value = i + 1 < argc ? std::stod(argv[++i]) : -1.0;
+            } catch (const std::exception&) {
+            }
+            const bool isJerk = arg == "-j" || arg == "--jerk";
+            if (value < 0.0 || (isJerk && value == 0.0)) {
+                std::cerr << "Ошибка: неверное значение для " << arg << std::endl;
+                return 1;
+            }
+            (isJerk ? jerk : timeScale) = value;
+        }
         else {
             std::cerr << "Неизвестный аргумент: " << arg << std::endl;
             printUsage(argv[0]);
@@ -115,40 +200,75 @@ int main(int argc, char* argv[])
         }
     }
     
+    if (deviceIds.empty()) {
+        deviceIds.push_back(1);
+    }
+    if (threads == 0) {
+        threads = std::min<size_t>(deviceIds.size(), 4);
+    }
+    
+    std::string devices;
+    for (int id : deviceIds) {
+        devices += (devices.empty() ? "" : ", ") + std::to_string(id);
+    }
+    
     std::cout << std::format(
         "MockMCU v1.0 - Имитатор микроконтроллера\n"
         "Устройство FT232RL: {}\n"
+        "Потоков: {}\n"
         "Режим: {}\n"
-        "Статистика: {}\n\n",
-        deviceId,
+        "Статистика: {}\n"
+        "Протокол: {}\n"
+        "Движение: {}, масштаб времени {}\n"
+        "Сбои: {}\n\n",
+        devices,
+        threads,
         verbose ? "подробный" : "обычный",
-        showStats ? "включена" : "отключена"
+        showStats ? "включена" : "отключена",
+        coalesced ? "объединенная запись (2.0)" : "двухэтапный (1.2)",
+        MotionModel::profileName(profile),
+        timeScale,
+        faults.enabled() ? faults.describe() : "нет"
     );
     
-    // Создание и инициализация MockMCU
-    g_mockMCU = std::make_unique<MockMCU>();
+    // События по каждой команде пишутся на уровне debug, без -v остаются только запуск/остановка и ошибки
+    Logger::instance().setLevel(verbose ? LogLevel::Debug : LogLevel::Info);
     
-    if (!g_mockMCU->initialize(deviceId)) {
-        std::cerr << "Ошибка инициализации MockMCU" << std::endl;
-        return 1;
+    // Создание и инициализация плат, все платы обслуживаются общим пулом потоков
+    g_farm = std::make_unique<McuFarm>(threads, std::chrono::milliseconds(10));
+    for (int deviceId : deviceIds) {
+        auto mcu = std::make_unique<MockMCU>();
+        mcu->setCoalescedMode(coalesced);
+        mcu->setMotionModel(MotionModel(profile, jerk), timeScale);
+        
+        // Профиль общий, но сбои у плат независимые: у каждой свой seed
+        FaultProfile boardFaults = faults;
+        boardFaults.seed += static_cast<uint32_t>(g_farm->size());
+        mcu->setFaultProfile(boardFaults);
+        
+        if (!mcu->initialize(deviceId)) {
+            std::cerr << "Ошибка инициализации MockMCU на устройстве " << deviceId << std::endl;
+            return 1;
+        }
+        g_farm->add(std::move(mcu));
     }
     
     // Запуск MockMCU
-    g_mockMCU->start();
+    g_farm->start();
     
     std::cout << "MockMCU запущен. Нажмите Ctrl+C для остановки.\n" << std::endl;
     
     // Основной цикл
     auto lastStatsTime = std::chrono::steady_clock::now();
     
-    while (g_running && g_mockMCU->isRunning()) {
+    while (g_running && g_farm->isRunning()) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
         
         // Показ статистики каждые 5 секунд
         if (showStats) {
             auto now = std::chrono::steady_clock::now();
             if (std::chrono::duration_cast<std::chrono::seconds>(now - lastStatsTime).count() >= 5) {
-                printStatistics(g_mockMCU->getStatistics());
+                printFarmStatistics(*g_farm, deviceIds);
                 lastStatsTime = now;
             }
         }
@@ -157,11 +277,10 @@ int main(int argc, char* argv[])
     // Корректное завершение
     std::cout << "\nЗавершение работы MockMCU..." << std::endl;
     
-    if (g_mockMCU) {
-        auto finalStats = g_mockMCU->getStatistics();
-        printStatistics(finalStats);
+    if (g_farm) {
+        printFarmStatistics(*g_farm, deviceIds);
         
-        g_mockMCU->stop();
+        g_farm->stop();
     }
     
     std::cout << "MockMCU остановлен." << std::endl;
@@ -0,0 +1,88 @@
+#include "mcu_farm.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+
+McuFarm::McuFarm(size_t threads, std::chrono::microseconds idleInterval)
+    : m_threadCount(std::max<size_t>(threads, 1))
+    , m_idleInterval(idleInterval)
+{
+}
+
+McuFarm::~McuFarm()
+{
+    stop();
+}
+
+size_t McuFarm::add(std::unique_ptr<MockMCU> mcu)
+{
+    m_mcus.push_back(std::move(mcu));
+    return m_mcus.size() - 1;
+}
+
+MockMCU::Statistics McuFarm::totalStatistics() const
+{
+    MockMCU::Statistics total;
+    for (const auto& mcu : m_mcus) {
+        const auto stats = mcu->getStatistics();
+        total.commandsReceived += stats.commandsReceived;
+        total.commandsProcessed += stats.commandsProcessed;
+        total.errorsOccurred += stats.errorsOccurred;
+        total.versionRequests += stats.versionRequests;
+        total.motorCommands += stats.motorCommands;
+        total.faultsInjected += stats.faultsInjected;
+        total.emergencyStops += stats.emergencyStops;
+    }
+    return total;
+}
+
+void McuFarm::start()
+{
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    // Потоков не больше, чем плат: лишним нечего опрашивать
+    m_activeThreads = std::min(m_threadCount, std::max<size_t>(m_mcus.size(), 1));
+    for (size_t i = 0; i < m_activeThreads; ++i) {
+        m_threads.emplace_back(&McuFarm::workerLoop, this, i);
+    }
+
+    MMS_LOG_INFO("mock-mcu", "McuFarm started: {} MCU(s) on {} thread(s)", m_mcus.size(), m_activeThreads);
+}
+
+void McuFarm::stop()
+{
+    if (!m_running) {
+        return;
+    }
+
+    m_running = false;
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+
+    MMS_LOG_INFO("mock-mcu", "McuFarm stopped");
+}
+
+void McuFarm::workerLoop(size_t index)
+{
+    while (m_running) {
+        const auto now = MockMCU::Clock::now();
+        auto wakeUp = now + m_idleInterval;
+        bool progress = false;
+
+        for (size_t i = index; i < m_mcus.size(); i += m_activeThreads) {
+            progress |= m_mcus[i]->poll(now);
+            if (const auto deadline = m_mcus[i]->nextDeadline()) {
+                wakeUp = std::min(wakeUp, *deadline);
+            }
+        }
+
+        if (!progress) {
+            std::this_thread::sleep_until(wakeUp);
+        }
+    }
+}
@@ -2,16 +2,21 @@
 #include "protocol_handler.hpp"
 #include "ft232rl.hpp"
 #include "exceptions.hpp"
+#include "logger.hpp"
 
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <format>
 #include <iomanip>
+#include <algorithm>
 
 MockMCU::MockMCU() 
     : m_running(false)
     , m_initialized(false)
+    , m_coalesced(false)
+    , m_timeScale(1.0)
+    , m_random(1)
 {
     m_statistics = {};
 }
@@ -25,9 +30,10 @@ bool MockMCU::initialize(int deviceId)
 {
     try {
         m_module = std::make_unique<FT232RL>();
+        m_module->setLinkProfile(LinkProfile::lowLatency());
         
         if (!m_module->connect(deviceId)) {
-            std::cerr << "Failed to connect to FT232RL device " << deviceId << std::endl;
+            MMS_LOG_ERROR("mock-mcu", "Failed to connect to FT232RL device {}", deviceId);
             return false;
         }
         
@@ -36,32 +42,63 @@ bool MockMCU::initialize(int deviceId)
         m_module->setUSBParameters(256, 256);
         m_module->setCharacteristics(FT_BITS_8, FT_STOP_BITS_1, FT_PARITY_NONE);
         
+        m_deviceId = deviceId;
         m_initialized = true;
-        logEvent(std::format("MockMCU initialized on device {}", deviceId));
+        MMS_LOG_INFO("mock-mcu", "MockMCU initialized on device {}", deviceId);
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "Error initializing MockMCU: " << e.what() << std::endl;
+        MMS_LOG_ERROR("mock-mcu", "Error initializing MockMCU: {}", e.what());
         return false;
     }
 }
 
+bool MockMCU::initialize(std::unique_ptr<IModule> link)
+{
+    if (!link || !link->isConnected()) {
+        MMS_LOG_ERROR("mock-mcu", "MockMCU link is not connected");
+        return false;
+    }
+    
+    m_module = std::move(link);
+    m_initialized = true;
+    MMS_LOG_INFO("mock-mcu", "MockMCU initialized on {}", m_module->listComs().front());
+    return true;
+}
+
+void MockMCU::setCoalescedMode(bool enabled)
+{
+    m_coalesced = enabled;
+}
+
+void MockMCU::setMotionModel(const MotionModel& model, double timeScale)
+{
+    m_motion = model;
+    m_timeScale = std::max(timeScale, 0.0);
+}
+
+void MockMCU::setFaultProfile(const FaultProfile& profile)
+{
+    m_faults = profile;
+    m_random.seed(profile.seed);
+}
+
 void MockMCU::start()
 {
     if (!m_initialized) {
-        std::cerr << "MockMCU not initialized" << std::endl;
+        MMS_LOG_ERROR("mock-mcu", "MockMCU not initialized");
         return;
     }
     
     if (m_running) {
-        std::cerr << "MockMCU already running" << std::endl;
+        MMS_LOG_WARN("mock-mcu", "MockMCU already running");
         return;
     }
     
     m_running = true;
     m_workerThread = std::thread(&MockMCU::workerLoop, this);
     
-    logEvent("MockMCU started");
+    MMS_LOG_INFO("mock-mcu", "MockMCU started");
 }
 
 void MockMCU::stop()
@@ -80,7 +117,7 @@ void MockMCU::stop()
         m_module->disconnect();
     }
     
-    logEvent("MockMCU stopped");
+    MMS_LOG_INFO("mock-mcu", "MockMCU stopped");
 }
 
 bool MockMCU::isRunning() const
@@ -96,77 +133,172 @@ MockMCU::Statistics MockMCU::getStatistics() const
 
 void MockMCU::workerLoop()
 {
-    logEvent("Worker thread started");
+    MMS_LOG_INFO("mock-mcu", "Worker thread started");
     
     while (m_running) {
-        try {
-            // Проверяем наличие данных для чтения
-            size_t availableBytes = m_module->checkRXChannel();
-            
-            if (availableBytes > 0) {
-                // Читаем команду (1 байт)
-                std::vector<uint8_t> commandData(1);
-                m_module->readData(commandData);
-                
-                uint8_t command = commandData[0];
-                
-                {
-                    std::lock_guard<std::mutex> lock(m_statsMutex);
-                    m_statistics.commandsReceived++;
-                }
-                
-                logEvent(std::format("Received command: 0x{:02X}", command));
-                
-                // Обработка команды
-                if (command == 0x20) {
-                    // Команда версии
-                    handleVersionCommand();
-                }
-                else if ((command & 0xF0) == 0x80 || (command & 0xF0) == 0x40) {
-                    // Команда движения моторов
-                    handleMotorCommand(command);
-                }
-                else {
-                    // Неизвестная команда
-                    logEvent(std::format("Unknown command: 0x{:02X}", command));
-                    sendReadinessResponse(0x0A); // Общая ошибка системы
-                }
-            }
-            else {
-                // Небольшая задержка, чтобы не нагружать CPU
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const auto now = Clock::now();
+        if (!poll(now)) {
+            // Небольшая задержка, чтобы не нагружать CPU, но не дольше срока завершения движения
+            auto wakeUp = now + std::chrono::milliseconds(10);
+            if (const auto deadline = nextDeadline()) {
+                wakeUp = std::min(wakeUp, *deadline);
             }
+            std::this_thread::sleep_until(wakeUp);
         }
-        catch (const std::exception& e) {
-            std::cerr << "Error in worker loop: " << e.what() << std::endl;
+    }
+    
+    MMS_LOG_INFO("mock-mcu", "Worker thread finished");
+}
+
+bool MockMCU::poll(Clock::time_point now)
+{
+    if (!m_initialized || now < m_retryAt) {
+        return false;
+    }
+    
+    try {
+        if (m_offlineUntil) {
+            return reconnect(now);
+        }
+        
+        // Канал замер: уходят только ответы, отправленные до начала зависания
+        if (m_stall && now < m_stall->second) {
+            flush(std::min(now, m_stall->first));
+            return false;
+        }
+        m_stall.reset();
+        
+        bool progress = false;
+        if (m_busyUntil && now >= *m_busyUntil) {
+            m_busyUntil.reset();
             {
                 std::lock_guard<std::mutex> lock(m_statsMutex);
-                m_statistics.errorsOccurred++;
+                m_statistics.commandsProcessed++;
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            progress = true;
         }
+        
+        // Читаем все, что пришло: readData FT232RL сбрасывает приемный буфер после чтения
+        if (const size_t availableBytes = m_module->checkRXChannel(); availableBytes > 0) {
+            std::vector<uint8_t> data(availableBytes);
+            m_module->readData(data);
+            m_input.insert(m_input.end(), data.begin(), data.end());
+            progress = true;
+        }
+        
+        // Пока моторы движутся, новые команды ждут своей очереди, кроме экстренной остановки
+        while (!m_input.empty()) {
+            const uint8_t byte = m_input.front();
+            if (m_busyUntil) {
+                if (byte != ProtocolHandler::EMERGENCY_STOP) {
+                    break;
+                }
+                m_input.pop_front();
+                stopMotion(now);
+                continue;
+            }
+            m_input.pop_front();
+            if (!consume(byte, now) && m_coalesced) {
+                m_input.clear(); // Кадр отклонен, параметры из этой же записи не разбираем
+            }
+        }
+        
+        progress |= flush(now);
+        
+        if (m_disconnectAt && now >= *m_disconnectAt) {
+            goOffline(now);
+            return true;
+        }
+        return progress;
+    }
+    catch (const std::exception& e) {
+        MMS_LOG_ERROR("mock-mcu", "Error in worker loop: {}", e.what());
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_statistics.errorsOccurred++;
+        }
+        m_retryAt = now + std::chrono::milliseconds(100);
+        return false;
     }
+}
+
+std::optional<MockMCU::Clock::time_point> MockMCU::nextDeadline() const
+{
+    std::optional<Clock::time_point> deadline = m_busyUntil;
+    const auto earliest = [&deadline](Clock::time_point at) {
+        deadline = deadline ? std::min(*deadline, at) : at;
+    };
+    
+    if (!m_outbox.empty()) {
+        earliest(m_outbox.front().at);
+    }
+    if (m_stall) {
+        earliest(m_stall->second);
+    }
+    if (m_disconnectAt) {
+        earliest(*m_disconnectAt);
+    }
+    if (m_offlineUntil) {
+        earliest(*m_offlineUntil);
+    }
+    return deadline;
+}
+
+bool MockMCU::consume(uint8_t byte, Clock::time_point now)
+{
+    if (m_header != 0) {
+        m_payload.push_back(byte);
+        if (m_payload.size() == (m_header & 0x0F) * 16u) {
+            startMotion(now);
+        }
+        return true;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_statistics.commandsReceived++;
+    }
+    
+    MMS_LOG_DEBUG("mock-mcu", "Received command: 0x{:02X}", byte);
     
-    logEvent("Worker thread finished");
+    // Обработка команды
+    if (byte == ProtocolHandler::EMERGENCY_STOP) {
+        // Моторы стоят: останавливать нечего, ответа нет
+        MMS_LOG_DEBUG("mock-mcu", "Emergency stop while idle");
+    }
+    else if (byte == 0x20) {
+        // Команда версии
+        handleVersionCommand(now);
+    }
+    else if ((byte & 0xF0) == 0x80 || (byte & 0xF0) == 0x40) {
+        // Команда движения моторов
+        return handleMotorCommand(byte, now);
+    }
+    else {
+        // Неизвестная команда
+        MMS_LOG_DEBUG("mock-mcu", "Unknown command: 0x{:02X}", byte);
+        sendReadinessResponse(0x0A, now); // Общая ошибка системы
+    }
+    return true;
 }
 
-void MockMCU::handleVersionCommand()
+void MockMCU::handleVersionCommand(Clock::time_point now)
 {
     {
         std::lock_guard<std::mutex> lock(m_statsMutex);
         m_statistics.versionRequests++;
     }
     
-    logEvent("Handling version command");
+    MMS_LOG_DEBUG("mock-mcu", "Handling version command");
     
-    // Отправляем версию прошивки (1.2 = 0x12)
-    std::vector<uint8_t> versionResponse = {0x12};
-    m_module->writeData(versionResponse);
+    // Отправляем версию прошивки (1.2 = 0x12, в объединенном режиме 2.0 = 0x20)
+    const uint8_t version = m_coalesced ? 0x20 : 0x12;
+    send({version}, now);
     
-    logEvent("Version response sent: 1.2");
+    MMS_LOG_DEBUG("mock-mcu", "Version response sent: {}.{}", version >> 4, version & 0x0F);
 }
 
-void MockMCU::handleMotorCommand(uint8_t commandByte)
+bool MockMCU::handleMotorCommand(uint8_t commandByte, Clock::time_point now)
 {
     {
         std::lock_guard<std::mutex> lock(m_statsMutex);
@@ -176,91 +308,237 @@ void MockMCU::handleMotorCommand(uint8_t commandByte)
     bool isSynchronous = (commandByte & 0xF0) == 0x80;
     size_t motorCount = commandByte & 0x0F;
     
-    logEvent(std::format("Handling motor command: {} mode, {} motors", 
-                        isSynchronous ? "synchronous" : "asynchronous", motorCount));
+    MMS_LOG_DEBUG("mock-mcu", "Handling motor command: {} mode, {} motors", 
+                        isSynchronous ? "synchronous" : "asynchronous", motorCount);
     
     // Валидация команды
     if (!ProtocolHandler::validateMotorCommand(commandByte, motorCount)) {
-        logEvent("Invalid motor command");
-        sendReadinessResponse(0x01); // Некорректное количество моторов
-        return;
+        MMS_LOG_DEBUG("mock-mcu", "Invalid motor command");
+        sendReadinessResponse(0x01, now); // Некорректное количество моторов
+        return false;
     }
     
-    // Отправляем подтверждение готовности
-    sendReadinessResponse(0x00); // OK
+    // Сбои на команду разыгрываются сразу, в фиксированном порядке: прогон воспроизводим по seed
+    m_pending = {};
+    if (roll(m_faults.readinessErrorRate)) {
+        const uint8_t code = m_faults.readinessErrorCode != 0 ? m_faults.readinessErrorCode : randomCode(0x0A);
+        MMS_LOG_DEBUG("mock-mcu", "Fault: readiness error 0x{:02X}", code);
+        sendReadinessResponse(code, now);
+        return false;
+    }
+    m_pending.readinessDelay = roll(m_faults.readinessDelayRate) ? m_faults.readinessDelay : Clock::duration{0};
+    m_pending.truncated = roll(m_faults.truncatedCompletionRate);
+    m_pending.stall = roll(m_faults.stallRate);
+    m_pending.disconnect = roll(m_faults.disconnectRate);
     
-    // Ждем данные моторов
-    std::vector<uint8_t> motorData(motorCount * 16); // 16 байт на мотор
-    m_module->readData(motorData);
+    m_header = commandByte;
+    m_payload.clear();
+    m_payload.reserve(motorCount * 16); // 16 байт на мотор
     
-    // Парсим данные моторов
-    auto motors = ProtocolHandler::parseMotorData(motorData, motorCount);
+    // В двухэтапном режиме готовность подтверждается до параметров, в объединенном - после кадра
+    if (!m_coalesced) {
+        sendReadinessResponse(0x00, now + m_pending.readinessDelay); // OK
+    }
+    return true;
+}
+
+void MockMCU::startMotion(Clock::time_point now)
+{
+    const uint8_t commandByte = m_header;
+    m_header = 0;
+    
+    Clock::time_point readyAt = now;
+    if (m_coalesced) {
+        readyAt += m_pending.readinessDelay;
+        sendReadinessResponse(0x00, readyAt); // OK, кадр принят целиком
+    }
+    
+    // Сбои канала посреди команды: после байта готовности
+    if (m_pending.stall) {
+        MMS_LOG_DEBUG("mock-mcu", "Fault: link stall for {} ms", m_faults.stallDuration.count());
+        m_stall = {readyAt, readyAt + m_faults.stallDuration};
+    }
+    if (m_pending.disconnect) {
+        MMS_LOG_DEBUG("mock-mcu", "Fault: disconnect for {} ms", m_faults.disconnectDuration.count());
+        m_disconnectAt = readyAt;
+    }
     
-    logEvent(std::format("Received data for {} motors", motors.size()));
+    // Парсим данные моторов
+    auto motors = ProtocolHandler::parseMotorData(m_payload, commandByte & 0x0F);
     
-    // Симулируем обработку моторов
-    uint8_t result = simulateMotorProcessing(motorCount, isSynchronous);
+    MMS_LOG_DEBUG("mock-mcu", "Received data for {} motors", motors.size());
     
-    // Отправляем результат выполнения
-    sendExecutionResponse(result);
+    // Симулируем обработку моторов: ответ уйдет из poll(), когда истечет время движения
+    Clock::duration duration{0};
+    const uint8_t result = simulateMotorProcessing(motors, (commandByte & 0xF0) == 0x80, duration);
+    m_busyUntil = std::max(now + duration, readyAt);
     
+    // Замерший канал отдаст ответ о завершении не раньше, чем оживет
+    const Clock::time_point doneAt = m_stall ? std::max(*m_busyUntil, m_stall->second) : *m_busyUntil;
+    sendExecutionResponse(result, doneAt, m_pending.truncated);
+}
+
+void MockMCU::stopMotion(Clock::time_point now)
+{
+    m_busyUntil.reset();
     {
         std::lock_guard<std::mutex> lock(m_statsMutex);
         m_statistics.commandsProcessed++;
+        m_statistics.emergencyStops++;
     }
+    
+    // Пока моторы движутся, последний в очереди - ответ о завершении, он еще не отправлен
+    if (!m_outbox.empty()) {
+        m_outbox.pop_back();
+    }
+    MMS_LOG_DEBUG("mock-mcu", "Emergency stop: motion aborted");
+    sendExecutionResponse(ProtocolHandler::STOPPED, now, false);
 }
 
-void MockMCU::sendReadinessResponse(uint8_t status)
+void MockMCU::sendReadinessResponse(uint8_t status, Clock::time_point at)
 {
-    std::vector<uint8_t> response = {status};
-    m_module->writeData(response);
+    send({status}, at);
     
     if (status == 0x00) {
-        logEvent("Readiness response sent: OK");
+        MMS_LOG_DEBUG("mock-mcu", "Readiness response queued: OK");
     } else {
-        logEvent(std::format("Readiness response sent: ERROR 0x{:02X}", status));
+        MMS_LOG_DEBUG("mock-mcu", "Readiness response queued: ERROR 0x{:02X}", status);
     }
 }
 
-void MockMCU::sendExecutionResponse(uint8_t status)
+void MockMCU::sendExecutionResponse(uint8_t status, Clock::time_point at, bool truncated)
 {
-    std::vector<uint8_t> response = {status};
-    m_module->writeData(response);
+    auto frame = ProtocolHandler::completionFrame(status);
+    if (truncated) {
+        MMS_LOG_DEBUG("mock-mcu", "Fault: completion truncated to {} byte", 1);
+        frame.resize(1);
+    }
+    send(std::move(frame), at);
     
     if (status == 0xFF) {
-        logEvent("Execution response sent: SUCCESS");
+        MMS_LOG_DEBUG("mock-mcu", "Execution response queued: SUCCESS");
     } else {
-        logEvent(std::format("Execution response sent: ERROR 0x{:02X}", status));
+        MMS_LOG_DEBUG("mock-mcu", "Execution response queued: ERROR 0x{:02X}", status);
     }
 }
 
-uint8_t MockMCU::simulateMotorProcessing(size_t motorCount, bool isSynchronous)
+void MockMCU::send(std::vector<uint8_t> bytes, Clock::time_point at)
 {
-    logEvent(std::format("Simulating motor processing: {} motors, {} mode", 
-                        motorCount, isSynchronous ? "synchronous" : "asynchronous"));
+    // Ответы не обгоняют друг друга, как в одном UART
+    if (!m_outbox.empty()) {
+        at = std::max(at, m_outbox.back().at);
+    }
+    m_outbox.push_back({at, std::move(bytes)});
+}
+
+bool MockMCU::flush(Clock::time_point now)
+{
+    bool sent = false;
+    while (!m_outbox.empty() && m_outbox.front().at <= now) {
+        auto bytes = std::move(m_outbox.front().bytes);
+        m_outbox.pop_front();
+        
+        if (m_faults.dropByteRate > 0.0) {
+            const auto dropped = std::remove_if(bytes.begin(), bytes.end(), [this](uint8_t) {
+                return roll(m_faults.dropByteRate);
+            });
+            if (dropped != bytes.end()) {
+                MMS_LOG_DEBUG("mock-mcu", "Fault: {} byte(s) dropped", std::distance(dropped, bytes.end()));
+                bytes.erase(dropped, bytes.end());
+            }
+        }
+        if (!bytes.empty()) {
+            m_module->writeData(bytes);
+        }
+        sent = true;
+    }
+    return sent;
+}
+
+void MockMCU::goOffline(Clock::time_point now)
+{
+    m_disconnectAt.reset();
+    m_module->disconnect();
+    m_offlineUntil = now + m_faults.disconnectDuration;
     
-    // Симуляция времени обработки
-    std::this_thread::sleep_for(std::chrono::milliseconds(100 + motorCount * 50));
+    // Все, что было в полете, теряется вместе с платой
+    m_input.clear();
+    m_outbox.clear();
+    m_header = 0;
+    m_busyUntil.reset();
+    m_stall.reset();
+}
+
+bool MockMCU::reconnect(Clock::time_point now)
+{
+    if (now < *m_offlineUntil) {
+        return false;
+    }
     
-    // В реальном MCU здесь была бы обработка моторов
-    // Для mock-MCU просто возвращаем успех
-    logEvent("Motor processing simulation completed successfully");
-    return 0xFF; // Успешное выполнение
+    if (!m_module->connect(m_deviceId)) {
+        m_offlineUntil = now + std::chrono::milliseconds(100);
+        return false;
+    }
+    m_offlineUntil.reset();
+    MMS_LOG_INFO("mock-mcu", "MockMCU reconnected after injected disconnect");
+    return true;
 }
 
-void MockMCU::logEvent(const std::string& message)
+bool MockMCU::roll(double rate)
 {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::tm* tm = std::localtime(&time_t);
-    
-    std::cout << std::format("[{:02d}:{:02d}:{:02d}.{:03d}] MockMCU: {}\n",
-                            tm->tm_hour,
-                            tm->tm_min,
-                            tm->tm_sec,
-                            ms.count(),
-                            message);
+    if (rate <= 0.0) {
+        return false; // Выключенный сбой не расходует генератор
+    }
+    
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    if (chance(m_random) >= rate) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_statistics.faultsInjected++;
+    return true;
+}
+
+uint8_t MockMCU::randomCode(uint8_t max)
+{
+    return static_cast<uint8_t>(std::uniform_int_distribution<int>(0x01, max)(m_random));
+}
+
+uint8_t MockMCU::simulateMotorProcessing(
+    const std::vector<ProtocolHandler::MotorData>& motors,
+    bool isSynchronous,
+    Clock::duration& duration)
+{
+    MMS_LOG_DEBUG("mock-mcu", "Simulating motor processing: {} motors, {} mode, {} profile", 
+                        motors.size(), isSynchronous ? "synchronous" : "asynchronous",
+                        MotionModel::profileName(m_motion.profile()));
+    
+    // Ошибки параметров MCU обнаруживает до старта моторов
+    const auto check = ProtocolHandler::handleMotorCommand(
+        static_cast<uint8_t>((isSynchronous ? 0x80 : 0x40) | motors.size()), motors);
+    if (!check.success) {
+        MMS_LOG_DEBUG("mock-mcu", "Motor command rejected: {}", check.description);
+        return check.errorCode;
+    }
+    
+    const auto plan = m_motion.plan(motors, isSynchronous);
+    for (size_t i = 0; i < motors.size(); ++i) {
+        MMS_LOG_DEBUG("mock-mcu", "Motor {} finishes at {} ms", motors[i].number,
+                            std::chrono::duration_cast<std::chrono::milliseconds>(plan.finish[i]).count());
+    }
+    
+    // Ответ о завершении - когда остановился последний мотор, в масштабе m_timeScale
+    if (m_timeScale > 0.0) {
+        duration = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::nano>(plan.total.count() / m_timeScale));
+    }
+    
+    // Сбой из профиля платы: моторы отработали, но MCU сообщает об ошибке
+    if (roll(m_faults.executionErrorRate)) {
+        return m_faults.executionErrorCode != 0 ? m_faults.executionErrorCode : randomCode(0x0F);
+    }
+    
+    MMS_LOG_DEBUG("mock-mcu", "Motor processing simulation completed successfully");
+    return 0xFF; // Успешное выполнение
 }
@@ -0,0 +1,94 @@
+#include "motion_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+MotionModel::MotionModel(Profile profile, double jerk)
+    : m_profile(profile)
+    , m_jerk(jerk)
+{
+}
+
+MotionModel::Duration MotionModel::moveTime(const ProtocolHandler::MotorData& motor) const
+{
+    const double distance = std::abs(static_cast<double>(motor.step));
+    const double speed = motor.maxSpeed;
+    const double acceleration = motor.acceleration;
+    if (distance == 0.0 || speed == 0.0 || acceleration == 0.0) {
+        return Duration{0};
+    }
+
+    const double seconds = m_profile == Profile::SCurve && m_jerk > 0.0
+        ? sCurveSeconds(distance, speed, acceleration)
+        : trapezoidalSeconds(distance, speed, acceleration);
+    return std::chrono::duration_cast<Duration>(std::chrono::duration<double>(seconds));
+}
+
+MotionModel::Plan MotionModel::plan(
+    const std::vector<ProtocolHandler::MotorData>& motors,
+    bool isSynchronous) const
+{
+    Plan result;
+    result.finish.reserve(motors.size());
+    for (const auto& motor : motors) {
+        result.finish.push_back(moveTime(motor));
+        result.total = std::max(result.total, result.finish.back());
+    }
+
+    if (isSynchronous) {
+        // Скорости согласуются так, чтобы все моторы пришли вместе с самым долгим
+        std::fill(result.finish.begin(), result.finish.end(), result.total);
+    }
+    return result;
+}
+
+std::optional<MotionModel::Profile> MotionModel::parseProfile(const std::string& name)
+{
+    if (name == "trapezoidal") {
+        return Profile::Trapezoidal;
+    }
+    if (name == "scurve") {
+        return Profile::SCurve;
+    }
+    return std::nullopt;
+}
+
+const char* MotionModel::profileName(Profile profile)
+{
+    return profile == Profile::SCurve ? "scurve" : "trapezoidal";
+}
+
+double MotionModel::trapezoidalSeconds(double distance, double speed, double acceleration) const
+{
+    // Разгон до speed и торможение вместе занимают speed² / acceleration шагов
+    if (distance >= speed * speed / acceleration) {
+        return distance / speed + speed / acceleration;
+    }
+    return 2.0 * std::sqrt(distance / acceleration);
+}
+
+double MotionModel::sCurveSeconds(double distance, double speed, double acceleration) const
+{
+    // Время разгона до скорости v: ускорение дорастает до acceleration за acceleration / jerk,
+    // если v для этого достаточно велика, иначе разгон целиком из двух участков с рывком
+    const auto accelTime = [this, acceleration](double v) {
+        return v >= acceleration * acceleration / m_jerk ? v / acceleration + acceleration / m_jerk
+                                                         : 2.0 * std::sqrt(v / m_jerk);
+    };
+
+    // Профиль симметричный: путь разгона и торможения вместе равен v * accelTime(v)
+    const double cruiseAccel = accelTime(speed);
+    if (distance >= speed * cruiseAccel) {
+        return distance / speed + cruiseAccel;
+    }
+
+    // Пути не хватает, пиковая скорость ниже speed: v² / a + v * a / j = distance
+    const double ratio = acceleration / m_jerk;
+    double peak = acceleration / 2.0 * (std::sqrt(ratio * ratio + 4.0 * distance / acceleration) - ratio);
+    if (peak < acceleration * ratio) {
+        // Ускорение не доходит до acceleration: distance = 2 * v^(3/2) / sqrt(jerk)
+        peak = std::pow(distance * std::sqrt(m_jerk) / 2.0, 2.0 / 3.0);
+    }
+    return 2.0 * accelTime(peak);
+}
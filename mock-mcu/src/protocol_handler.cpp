@@ -1,8 +1,6 @@
 #include "protocol_handler.hpp"
 #include <iostream>
 #include <format>
-#include <thread>
-#include <chrono>
 
 ProtocolHandler::CommandResult ProtocolHandler::handleVersionCommand()
 {
@@ -39,6 +37,11 @@ ProtocolHandler::CommandResult ProtocolHandler::handleMotorCommand(
     return {true, 0xFF, "Success"};
 }
 
+std::vector<uint8_t> ProtocolHandler::completionFrame(uint8_t code)
+{
+    return {0x00, code};
+}
+
 std::vector<ProtocolHandler::MotorData> ProtocolHandler::parseMotorData(
     const std::vector<uint8_t>& data, 
     size_t motorCount)
@@ -46,14 +49,20 @@ std::vector<ProtocolHandler::MotorData> ProtocolHandler::parseMotorData(
     std::vector<MotorData> motors;
     motors.reserve(motorCount);
     
-    const uint32_t* ptr = reinterpret_cast<const uint32_t*>(data.data());
+    // Параметры в little-endian (см. McuTransaction), читаем побайтно - буфер может быть не выровнен
+    auto loadLE32 = [&data](size_t offset) -> uint32_t {
+        return static_cast<uint32_t>(data[offset])
+            | (static_cast<uint32_t>(data[offset + 1]) << 8)
+            | (static_cast<uint32_t>(data[offset + 2]) << 16)
+            | (static_cast<uint32_t>(data[offset + 3]) << 24);
+    };
     
-    for (size_t i = 0; i < motorCount; ++i) {
+    for (size_t i = 0; i < motorCount && (i + 1) * 16 <= data.size(); ++i) {
         MotorData motor;
-        motor.number = ptr[i * 4 + 0];
-        motor.acceleration = ptr[i * 4 + 1];
-        motor.maxSpeed = ptr[i * 4 + 2];
-        motor.step = static_cast<int32_t>(ptr[i * 4 + 3]);
+        motor.number = loadLE32(i * 16 + 0);
+        motor.acceleration = loadLE32(i * 16 + 4);
+        motor.maxSpeed = loadLE32(i * 16 + 8);
+        motor.step = static_cast<int32_t>(loadLE32(i * 16 + 12));
         
         motors.push_back(motor);
     }
@@ -120,21 +129,8 @@ uint8_t ProtocolHandler::simulateSingleMotorProcessing(const MotorData& motor)
         return 0x02; // Превышение максимальной скорости
     }
     
-    // Симуляция случайных ошибок (5% вероятность)
-    static bool errorSimulation = false; // Можно включить для тестирования
-    if (errorSimulation) {
-        static int errorCounter = 0;
-        errorCounter++;
-        
-        // Каждый 20-й мотор будет с ошибкой для демонстрации
-        if (errorCounter % 20 == 0) {
-            return 0x05; // Механическая ошибка
-        }
-    }
-    
-    // Симуляция времени обработки
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    
+    // Случайные сбои задает профиль платы (FaultProfile в MockMCU, SimulatedFault в SimulatedModule)
+    // Время обработки задает вызывающий (MockMCU, SimulatedModule), здесь только логика протокола
     return 0xFF; // Успешное выполнение
 }
 
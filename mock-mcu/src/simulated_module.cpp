@@ -0,0 +1,334 @@
+#include "simulated_module.hpp"
+#include "protocol_handler.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+
+namespace
+{
+constexpr uint8_t VERSION_REQUEST = 0x20;
+constexpr uint8_t READY = 0x00;
+constexpr size_t MOTOR_FRAME_SIZE = 16;
+constexpr unsigned int FT_DEVICE_NOT_OPENED_CODE = 3; // как FT232RL для закрытого устройства
+
+bool isMotorHeader(uint8_t byte)
+{
+    return (byte & 0xF0) == 0x80 || (byte & 0xF0) == 0x40;
+}
+} // namespace
+
+SimulatedModule::SimulatedModule()
+    : SimulatedModule(Latency{})
+{
+}
+
+SimulatedModule::SimulatedModule(Latency latency)
+    : m_version(ProtocolHandler::handleVersionCommand().errorCode)
+    , m_latency(latency)
+    , m_random(1)
+{
+}
+
+void SimulatedModule::setLatency(Latency latency)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_latency = latency;
+}
+
+void SimulatedModule::setFirmwareVersion(uint8_t version)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_version = version;
+}
+
+void SimulatedModule::setClock(IClock& clock)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_clock = &clock;
+}
+
+void SimulatedModule::setMotionModel(std::optional<MotionModel> model, double timeScale)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_motion = model;
+    m_timeScale = timeScale;
+}
+
+void SimulatedModule::injectFault(SimulatedFault fault, uint8_t code)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_faults.push_back({fault, code});
+}
+
+void SimulatedModule::setFaultProbability(SimulatedFault fault, double probability, uint8_t code, uint32_t seed)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_randomFault = {fault, code};
+    m_faultProbability = std::clamp(probability, 0.0, 1.0);
+    m_random.seed(seed);
+}
+
+void SimulatedModule::restore()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lost = false;
+    m_rx.clear();
+    m_payload.clear();
+    m_header = 0;
+    m_busyUntil.reset();
+}
+
+SimulatedModule::Statistics SimulatedModule::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics;
+}
+
+bool SimulatedModule::connect(const int deviceId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_lost) {
+        return false;
+    }
+    m_connected = true;
+    m_deviceId = deviceId;
+    return true;
+}
+
+void SimulatedModule::disconnect()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_connected = false;
+    m_rx.clear();
+    m_payload.clear();
+    m_header = 0;
+    m_busyUntil.reset();
+}
+
+bool SimulatedModule::isConnected() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_connected && !m_lost;
+}
+
+std::vector<std::string> SimulatedModule::listComs() const
+{
+    return {"Simulated MCU"};
+}
+
+void SimulatedModule::setBaudRate(const int baudRate)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_baudRate = baudRate;
+}
+
+int SimulatedModule::getBaudRate()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_baudRate;
+}
+
+void SimulatedModule::setLinkProfile(const LinkProfile& profile)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_profile = profile;
+}
+
+LinkProfile SimulatedModule::getLinkProfile() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_profile;
+}
+
+size_t SimulatedModule::checkRXChannel() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    checkAlive();
+    return arrived(m_clock->now());
+}
+
+void SimulatedModule::writeData(const std::vector<uchar>& data)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    checkAlive();
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (m_header != 0) {
+            // Ждем параметры моторов: берем сколько пришло, остальное - в следующих записях
+            const size_t need = (m_header & 0x0F) * MOTOR_FRAME_SIZE - m_payload.size();
+            const size_t take = std::min(need, data.size() - i);
+            m_payload.insert(m_payload.end(), data.begin() + i, data.begin() + i + take);
+            i += take - 1;
+
+            if (m_payload.size() == (m_header & 0x0F) * MOTOR_FRAME_SIZE) {
+                completeMotorCommand();
+            }
+        }
+        else if (data[i] == ProtocolHandler::EMERGENCY_STOP) {
+            stopMotion();
+        }
+        else if (data[i] == VERSION_REQUEST) {
+            ++m_statistics.versionRequests;
+            push({m_version}, m_latency.version);
+        }
+        else if (isMotorHeader(data[i])) {
+            if (!acceptHeader(data[i])) {
+                return; // Кадр отклонен, параметры из этой же записи не разбираем
+            }
+        }
+        else {
+            push({0x0A}, m_latency.readiness); // Общая ошибка системы
+        }
+    }
+}
+
+void SimulatedModule::readData(std::vector<uchar>& data)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    checkAlive();
+
+    const size_t count = std::min(data.size(), arrived(m_clock->now()));
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = m_rx.front().byte;
+        m_rx.pop_front();
+    }
+}
+
+std::vector<uchar> SimulatedModule::read(const size_t timeout)
+{
+    // Как FT232RL::read: ждем первый байт, но не дольше timeout мс, если ответа не будет вовсе
+    std::unique_lock<std::mutex> lock(m_mutex);
+    IClock* clock = m_clock;
+    const auto deadline = clock->now() + std::chrono::milliseconds(timeout);
+    checkAlive();
+    while (arrived(clock->now()) == 0 && !m_rx.empty() && clock->now() < deadline) {
+        const auto wait = m_rx.front().arrival;
+        lock.unlock();
+        clock->sleepUntil(std::min(wait, deadline));
+        lock.lock();
+        checkAlive();
+    }
+
+    std::vector<uchar> data(arrived(clock->now()));
+    for (auto& byte : data) {
+        byte = m_rx.front().byte;
+        m_rx.pop_front();
+    }
+    return data;
+}
+
+void SimulatedModule::checkAlive() const
+{
+    if (!m_connected || m_lost) {
+        throw ModuleFT2xxException(FT_DEVICE_NOT_OPENED_CODE);
+    }
+}
+
+void SimulatedModule::push(std::initializer_list<uchar> bytes, std::chrono::microseconds delay)
+{
+    // Ответы не обгоняют друг друга, как в одном UART
+    auto arrival = m_clock->now() + delay;
+    if (!m_rx.empty()) {
+        arrival = std::max(arrival, m_rx.back().arrival);
+    }
+
+    for (uchar byte : bytes) {
+        m_rx.push_back({byte, arrival});
+    }
+}
+
+bool SimulatedModule::acceptHeader(uint8_t header)
+{
+    ++m_statistics.motorCommands;
+    m_current = nextFault();
+    if (m_current.kind != SimulatedFault::None) {
+        ++m_statistics.faultsInjected;
+    }
+
+    switch (m_current.kind) {
+        case SimulatedFault::Disconnect:
+            m_lost = true;
+            m_rx.clear();
+            m_busyUntil.reset();
+            return false;
+        case SimulatedFault::NoReadiness:
+            return false;
+        case SimulatedFault::ReadinessError:
+            push({m_current.code}, m_latency.readiness);
+            return false;
+        default:
+            break;
+    }
+
+    if (!ProtocolHandler::validateMotorCommand(header, header & 0x0F)) {
+        push({0x01}, m_latency.readiness); // Некорректное количество моторов
+        return false;
+    }
+
+    push({READY}, m_latency.readiness);
+    m_header = header;
+    m_payload.clear();
+    return true;
+}
+
+void SimulatedModule::completeMotorCommand()
+{
+    const uint8_t header = m_header;
+    m_header = 0;
+
+    const auto motors = ProtocolHandler::parseMotorData(m_payload, header & 0x0F);
+    uint8_t code = ProtocolHandler::handleMotorCommand(header, motors).errorCode;
+    if (m_current.kind == SimulatedFault::NoCompletion) {
+        return;
+    }
+    if (m_current.kind == SimulatedFault::ExecutionError) {
+        code = m_current.code;
+    }
+
+    auto delay = m_latency.completion;
+    if (m_motion && m_timeScale > 0.0 && code == 0xFF) {
+        const auto motion = m_motion->plan(motors, (header & 0xF0) == 0x80).total;
+        delay += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::duration<double, std::nano>(motion.count() / m_timeScale));
+    }
+    const auto frame = ProtocolHandler::completionFrame(code);
+    push({frame[0], frame[1]}, delay);
+    m_busyUntil = m_rx.back().arrival;
+}
+
+void SimulatedModule::stopMotion()
+{
+    const auto now = m_clock->now();
+    if (!m_busyUntil || *m_busyUntil <= now) {
+        return; // Моторы стоят, останавливать нечего
+    }
+
+    // Завершение еще не пришло и лежит в конце очереди: MCU отвечает кодом остановки сразу
+    m_busyUntil.reset();
+    ++m_statistics.emergencyStops;
+    m_rx.resize(m_rx.size() - 2);
+    const auto frame = ProtocolHandler::completionFrame(ProtocolHandler::STOPPED);
+    push({frame[0], frame[1]}, std::chrono::microseconds{0});
+}
+
+SimulatedModule::Fault SimulatedModule::nextFault()
+{
+    if (!m_faults.empty()) {
+        const Fault fault = m_faults.front();
+        m_faults.pop_front();
+        return fault;
+    }
+
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    if (m_faultProbability > 0.0 && chance(m_random) < m_faultProbability) {
+        return m_randomFault;
+    }
+    return {SimulatedFault::None, 0};
+}
+
+size_t SimulatedModule::arrived(IClock::TimePoint now) const
+{
+    const auto firstLate =
+        std::find_if(m_rx.begin(), m_rx.end(), [now](const Pending& pending) { return pending.arrival > now; });
+    return static_cast<size_t>(std::distance(m_rx.begin(), firstLate));
+}
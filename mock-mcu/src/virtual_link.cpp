@@ -0,0 +1,155 @@
+#include "virtual_link.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+
+namespace
+{
+constexpr unsigned int FT_DEVICE_NOT_OPENED_CODE = 3; // как FT232RL для закрытого устройства
+} // namespace
+
+/**
+ * @brief Один конец канала: пишет в очередь другой стороны, читает из своей
+ */
+class VirtualLink::End : public IModule
+{
+public:
+    End(std::shared_ptr<Shared> shared, bool isHost)
+        : m_shared(std::move(shared))
+        , m_isHost(isHost)
+        , m_rx(isHost ? &m_shared->toHost : &m_shared->toMcu)
+        , m_tx(isHost ? &m_shared->toMcu : &m_shared->toHost)
+    {
+    }
+
+    bool connect(const int) override
+    {
+        std::lock_guard<std::mutex> lock(m_shared->mutex);
+        m_connected = true;
+        if (!m_isHost) {
+            m_shared->mcuConnected = true;
+        }
+        return true;
+    }
+
+    void disconnect() override
+    {
+        std::lock_guard<std::mutex> lock(m_shared->mutex);
+        m_connected = false;
+        m_rx->clear();
+        if (!m_isHost) {
+            m_shared->mcuConnected = false;
+            m_tx->clear();
+        }
+    }
+
+    bool isConnected() const override
+    {
+        std::lock_guard<std::mutex> lock(m_shared->mutex);
+        return alive();
+    }
+
+    std::vector<std::string> listComs() const override
+    {
+        return {m_shared->name};
+    }
+
+    void setBaudRate(const int baudRate) override
+    {
+        m_baudRate = baudRate;
+    }
+
+    int getBaudRate() override
+    {
+        return m_baudRate;
+    }
+
+    void setUSBParameters(const int, const int) override {}
+    void setCharacteristics(const uchar, const uchar, const uchar) override {}
+
+    void setLinkProfile(const LinkProfile& profile) override
+    {
+        m_profile = profile;
+    }
+
+    LinkProfile getLinkProfile() const override
+    {
+        return m_profile;
+    }
+
+    void waitWriteSuccess() override {}
+
+    size_t checkRXChannel() const override
+    {
+        std::lock_guard<std::mutex> lock(m_shared->mutex);
+        checkAlive();
+        return m_rx->size();
+    }
+
+    void writeData(const std::vector<uchar>& data) override
+    {
+        std::lock_guard<std::mutex> lock(m_shared->mutex);
+        checkAlive();
+        m_tx->insert(m_tx->end(), data.begin(), data.end());
+    }
+
+    void readData(std::vector<uchar>& data) override
+    {
+        std::lock_guard<std::mutex> lock(m_shared->mutex);
+        checkAlive();
+        const size_t count = std::min(data.size(), m_rx->size());
+        std::copy_n(m_rx->begin(), count, data.begin());
+        m_rx->erase(m_rx->begin(), m_rx->begin() + static_cast<std::ptrdiff_t>(count));
+    }
+
+    std::vector<uchar> read(const size_t) override
+    {
+        std::lock_guard<std::mutex> lock(m_shared->mutex);
+        checkAlive();
+        std::vector<uchar> data(m_rx->begin(), m_rx->end());
+        m_rx->clear();
+        return data;
+    }
+
+    explicit operator bool() const override
+    {
+        return isConnected();
+    }
+
+private:
+    std::shared_ptr<Shared> m_shared;
+    const bool m_isHost;
+    std::deque<uchar>* m_rx;
+    std::deque<uchar>* m_tx;
+    bool m_connected = true;
+    int m_baudRate = 115200;
+    LinkProfile m_profile{};
+
+    bool alive() const
+    {
+        return m_connected && (!m_isHost || m_shared->mcuConnected);
+    }
+
+    void checkAlive() const
+    {
+        if (!alive()) {
+            throw ModuleFT2xxException(FT_DEVICE_NOT_OPENED_CODE);
+        }
+    }
+};
+
+VirtualLink::VirtualLink(std::string name)
+    : m_shared(std::make_shared<Shared>())
+{
+    m_shared->name = std::move(name);
+}
+
+std::unique_ptr<IModule> VirtualLink::hostEnd()
+{
+    return std::make_unique<End>(m_shared, true);
+}
+
+std::unique_ptr<IModule> VirtualLink::mcuEnd()
+{
+    return std::make_unique<End>(m_shared, false);
+}
@@ -0,0 +1,171 @@
+#include "device_channel.hpp"
+
+#include "logger.hpp"
+
+DeviceChannel::DeviceChannel(std::unique_ptr<IModule> module, int deviceId, int firstMotor, int lastMotor)
+    : m_module(std::move(module))
+    , m_deviceId(deviceId)
+    , m_firstMotor(firstMotor)
+    , m_lastMotor(lastMotor)
+    , m_queueDepth(MetricsRegistry::instance().gauge(
+          "mms_board_queue_depth",
+          "Jobs waiting for the board I/O thread",
+          std::format("board=\"{}-{}\"", firstMotor, lastMotor)))
+{
+    m_txFrame.reserve(McuTransaction::MAX_FRAME_SIZE);
+}
+
+DeviceChannel::~DeviceChannel()
+{
+    stop();
+}
+
+void DeviceChannel::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running)
+        return;
+
+    m_running = true;
+    m_thread = std::thread(&DeviceChannel::workerLoop, this);
+}
+
+void DeviceChannel::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+            return;
+        m_running = false;
+    }
+    m_cv.notify_all();
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void DeviceChannel::post(Job job, const std::string &client)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running)
+        {
+            m_jobs.push(client, std::move(job));
+            m_queueDepth.inc();
+            m_cv.notify_one();
+            return;
+        }
+    }
+
+    // Поток не запущен - выполняем в вызывающем потоке
+    execute(job);
+}
+
+size_t DeviceChannel::pending() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobs.size();
+}
+
+size_t DeviceChannel::pending(const std::string &client) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobs.size(client);
+}
+
+void DeviceChannel::setClientWeight(const std::string &client, uint32_t weight)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.setWeight(client, weight);
+}
+
+bool DeviceChannel::idle() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobs.empty() && !m_busy;
+}
+
+DeviceChannel::Firmware DeviceChannel::firmware() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_firmware;
+}
+
+void DeviceChannel::setFirmware(const Firmware &firmware)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_firmware = firmware;
+}
+
+void DeviceChannel::writeFrame(std::span<const uint8_t> frame, bool keepOpen)
+{
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    m_txFrame.assign(frame.begin(), frame.end());
+    m_frameOpen = keepOpen;
+    if (!keepOpen && m_stopDeferred)
+    {
+        // STOP уходит той же записью сразу за кадром
+        m_stopDeferred = false;
+        m_txFrame.push_back(McuTransaction::EMERGENCY_STOP);
+    }
+    m_module->writeData(m_txFrame);
+}
+
+void DeviceChannel::closeFrame()
+{
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    m_frameOpen = false;
+    if (!m_stopDeferred)
+        return;
+
+    m_stopDeferred = false;
+    m_module->writeData({McuTransaction::EMERGENCY_STOP});
+}
+
+void DeviceChannel::emergencyStop()
+{
+    m_stopEpoch.fetch_add(1, std::memory_order_acq_rel);
+
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    if (m_frameOpen)
+    {
+        // Байт STOP посреди кадра MCU принял бы за параметр мотора
+        m_stopDeferred = true;
+        return;
+    }
+    m_module->writeData({McuTransaction::EMERGENCY_STOP});
+}
+
+void DeviceChannel::workerLoop()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return !m_jobs.empty() || !m_running; });
+
+            if (!m_jobs.pop(job))
+                break;
+            m_queueDepth.dec();
+            m_busy = true;
+        }
+
+        execute(job);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_busy = false;
+    }
+}
+
+void DeviceChannel::execute(Job &job)
+{
+    try
+    {
+        job(*this);
+    }
+    catch (const std::exception &e)
+    {
+        MMS_LOG_ERROR("core", "[device {}]: {}", m_deviceId, e.what());
+    }
+}
@@ -0,0 +1,132 @@
+#include "device_manager.hpp"
+
+#include <algorithm>
+#include <regex>
+
+#include "logger.hpp"
+
+DeviceManager::DeviceManager(std::unique_ptr<IModule> module)
+{
+    add(std::move(module), -1, 1, static_cast<int>(McuTransaction::MAX_MOTORS));
+}
+
+DeviceManager::~DeviceManager()
+{
+    stop();
+}
+
+bool DeviceManager::add(std::unique_ptr<IModule> module, int deviceId, int firstMotor, int lastMotor)
+{
+    if (!module || firstMotor < 1 || lastMotor < firstMotor)
+        return false;
+
+    if (static_cast<size_t>(lastMotor - firstMotor + 1) > McuTransaction::MAX_MOTORS)
+        return false;
+
+    for (const auto &channel : m_channels)
+    {
+        if (firstMotor <= channel->lastMotor() && lastMotor >= channel->firstMotor())
+            return false;
+        if (deviceId >= 0 && channel->deviceId() == deviceId)
+            return false;
+    }
+
+    m_channels.push_back(std::make_unique<DeviceChannel>(std::move(module), deviceId, firstMotor, lastMotor));
+    return true;
+}
+
+DeviceChannel *DeviceManager::findByDevice(int deviceId)
+{
+    for (auto &channel : m_channels)
+    {
+        if (channel->deviceId() == deviceId)
+            return channel.get();
+    }
+    return nullptr;
+}
+
+DeviceChannel *DeviceManager::findByMotor(int motor)
+{
+    for (auto &channel : m_channels)
+    {
+        if (channel->owns(motor))
+            return channel.get();
+    }
+    return nullptr;
+}
+
+int DeviceManager::firstMotor() const
+{
+    int first = 0;
+    for (const auto &channel : m_channels)
+        first = (first == 0) ? channel->firstMotor() : std::min(first, channel->firstMotor());
+    return first;
+}
+
+int DeviceManager::lastMotor() const
+{
+    int last = 0;
+    for (const auto &channel : m_channels)
+        last = std::max(last, channel->lastMotor());
+    return last;
+}
+
+size_t DeviceManager::motorCount() const
+{
+    size_t count = 0;
+    for (const auto &channel : m_channels)
+        count += static_cast<size_t>(channel->lastMotor() - channel->firstMotor() + 1);
+    return count;
+}
+
+void DeviceManager::connectAll()
+{
+    for (auto &channel : m_channels)
+    {
+        if (channel->deviceId() < 0 || channel->module().isConnected())
+            continue;
+
+        try
+        {
+            if (!channel->module().connect(channel->deviceId()))
+                MMS_LOG_ERROR("core", "Failed to connect board on device {}", channel->deviceId());
+        }
+        catch (const std::exception &e)
+        {
+            MMS_LOG_ERROR("core", "Failed to connect board on device {}: {}", channel->deviceId(), e.what());
+        }
+    }
+}
+
+void DeviceManager::start()
+{
+    for (auto &channel : m_channels)
+        channel->start();
+}
+
+void DeviceManager::stop()
+{
+    for (auto &channel : m_channels)
+        channel->stop();
+}
+
+bool DeviceManager::parseBoard(const std::string &text, int &deviceId, int &firstMotor, int &lastMotor)
+{
+    static const std::regex board("([0-9]+):([0-9]+)-([0-9]+)");
+
+    std::smatch match;
+    if (!std::regex_match(text, match, board))
+        return false;
+
+    try
+    {
+        deviceId = std::stoi(match[1]);
+        firstMotor = std::stoi(match[2]);
+        lastMotor = std::stoi(match[3]);
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,169 @@
+#include "event_hub.hpp"
+
+#include "logger.hpp"
+
+EventHub::EventHub(Sink sink)
+    : m_sink(std::move(sink))
+    , m_subscribersGauge(MetricsRegistry::instance().gauge(
+          "mms_event_subscribers", "Connections subscribed to pushed events"))
+    , m_published(MetricsRegistry::instance().counter("mms_events_published_total", "Events published"))
+    , m_dropped(MetricsRegistry::instance().counter(
+          "mms_events_dropped_total", "Events dropped because a subscriber queue was full"))
+{}
+
+EventHub::~EventHub()
+{
+    stop();
+    m_subscribersGauge.dec(static_cast<int64_t>(m_subscribers.size()));
+}
+
+void EventHub::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running)
+        return;
+
+    m_running = true;
+    m_thread = std::thread(&EventHub::workerLoop, this);
+}
+
+void EventHub::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+            return;
+        m_running = false;
+    }
+    m_cv.notify_all();
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+bool EventHub::subscribe(int fd, const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_subscribers.try_emplace(fd, Subscriber{name, {}}).second)
+        return false;
+
+    m_count.store(m_subscribers.size(), std::memory_order_relaxed);
+    m_subscribersGauge.inc();
+    MMS_LOG_INFO("core", "[SUBSCRIBE]({})", name);
+    return true;
+}
+
+bool EventHub::unsubscribe(int fd)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_subscribers.find(fd);
+        if (it == m_subscribers.end())
+            return false;
+
+        MMS_LOG_INFO("core", "[UNSUBSCRIBE]({})", it->second.name);
+        m_queued -= it->second.queue.size();
+        m_subscribers.erase(it);
+        m_count.store(m_subscribers.size(), std::memory_order_relaxed);
+        m_subscribersGauge.dec();
+    }
+
+    // Дожидаемся записи, которая могла начаться до отписки
+    std::lock_guard<std::mutex> delivery(m_deliveryMutex);
+    return true;
+}
+
+void EventHub::publish(std::string frame, int except)
+{
+    const auto shared = std::make_shared<const std::string>(std::move(frame));
+    m_published.inc();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (auto &[fd, subscriber] : m_subscribers)
+    {
+        if (fd == except)
+            continue;
+
+        if (subscriber.queue.size() >= MAX_QUEUED)
+        {
+            subscriber.queue.pop_front();
+            --m_queued;
+            m_dropped.inc();
+        }
+        subscriber.queue.push_back(shared);
+        ++m_queued;
+    }
+
+    if (m_running)
+    {
+        m_cv.notify_one();
+        return;
+    }
+
+    // Поток не запущен - пишем в вызывающем потоке
+    lock.unlock();
+    std::lock_guard<std::mutex> delivery(m_deliveryMutex);
+    std::unordered_map<int, std::deque<Frame>> batch;
+    {
+        std::lock_guard<std::mutex> relock(m_mutex);
+        for (auto &[fd, subscriber] : m_subscribers)
+        {
+            if (!subscriber.queue.empty())
+                batch[fd].swap(subscriber.queue);
+        }
+        m_queued = 0;
+    }
+    deliver(batch);
+}
+
+void EventHub::workerLoop()
+{
+    std::unordered_map<int, std::deque<Frame>> batch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_queued != 0 || !m_running; });
+            if (m_queued == 0)
+                break;
+        }
+
+        // Очереди забираются под m_deliveryMutex: unsubscribe() дождется их записи
+        std::lock_guard<std::mutex> delivery(m_deliveryMutex);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto &[fd, subscriber] : m_subscribers)
+            {
+                if (!subscriber.queue.empty())
+                    batch[fd].swap(subscriber.queue);
+            }
+            m_queued = 0;
+        }
+        deliver(batch);
+        batch.clear();
+    }
+}
+
+void EventHub::deliver(std::unordered_map<int, std::deque<Frame>> &batch)
+{
+    for (auto &[fd, frames] : batch)
+    {
+        for (const auto &frame : frames)
+        {
+            if (m_sink(fd, *frame))
+                continue;
+
+            // Соединение не принимает данные: остальные события ему не нужны
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (auto it = m_subscribers.find(fd); it != m_subscribers.end())
+            {
+                MMS_LOG_WARN("core", "[UNSUBSCRIBE]({}): write failed", it->second.name);
+                m_queued -= it->second.queue.size();
+                m_subscribers.erase(it);
+                m_count.store(m_subscribers.size(), std::memory_order_relaxed);
+                m_subscribersGauge.dec();
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,230 @@
+#include "link_supervisor.hpp"
+
+#include "logger.hpp"
+
+#include <algorithm>
+#include <vector>
+
+LinkSupervisor::LinkSupervisor(DeviceManager &devices, Callback onLost, Callback onRestored)
+    : m_devices(devices)
+    , m_onLost(std::move(onLost))
+    , m_onRestored(std::move(onRestored))
+    , m_losses(MetricsRegistry::instance().counter(
+          "mms_link_losses_total", "Board links found lost by the link supervisor"))
+    , m_reconnects(MetricsRegistry::instance().counter(
+          "mms_link_reconnects_total", "Board links restored by the link supervisor"))
+{}
+
+LinkSupervisor::~LinkSupervisor()
+{
+    stop();
+}
+
+void LinkSupervisor::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running)
+        return;
+
+    m_running = true;
+    m_stopping = false;
+    m_thread = std::thread(&LinkSupervisor::workerLoop, this);
+}
+
+void LinkSupervisor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+            return;
+        m_running = false;
+    }
+    m_stopping = true;
+    m_cv.notify_all();
+    m_clock->wakeAll(); // пауза между попытками в потоке платы
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void LinkSupervisor::tick()
+{
+    const auto now = m_clock->now();
+    std::vector<std::pair<DeviceChannel *, LinkState>> due;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < m_devices.size(); ++i)
+        {
+            DeviceChannel &channel = m_devices[i];
+            auto it = m_links.find(&channel);
+            if (it == m_links.end())
+                continue;
+
+            Link &link = it->second;
+            if (link.state == LinkState::Released || link.queued || now < link.due)
+                continue;
+
+            // Занятую плату проверяют ее команды, проверка откладывается до простоя
+            if (link.state == LinkState::Healthy && !channel.idle())
+                continue;
+
+            link.queued = true;
+            due.emplace_back(&channel, link.state);
+        }
+    }
+
+    // Вне m_mutex: без запущенного потока платы задание выполняется здесь же
+    for (const auto &[channel, state] : due)
+    {
+        if (state == LinkState::Healthy)
+            channel->post([this](DeviceChannel &board) { check(board); });
+        else
+            channel->post([this](DeviceChannel &board) { reconnect(board, m_clock->now()); });
+    }
+}
+
+void LinkSupervisor::watch(DeviceChannel &channel)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Link &link = m_links[&channel];
+    link.state = LinkState::Healthy;
+    link.due = m_clock->now() + HEARTBEAT_INTERVAL;
+    link.backoff = MIN_BACKOFF;
+}
+
+void LinkSupervisor::release(DeviceChannel &channel)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_links[&channel].state = LinkState::Released;
+}
+
+bool LinkSupervisor::reconnecting(const DeviceChannel &channel) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_links.find(&channel);
+    return it != m_links.end() && it->second.state == LinkState::Lost
+        && m_clock->now() < it->second.lostAt + RECONNECT_GRACE;
+}
+
+void LinkSupervisor::workerLoop()
+{
+    while (true)
+    {
+        tick();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait_for(lock, MIN_BACKOFF, [this]() { return !m_running; });
+        if (!m_running)
+            break;
+    }
+}
+
+void LinkSupervisor::check(DeviceChannel &channel)
+{
+    const bool alive = linkAlive(channel);
+    const auto now = m_clock->now();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Link &link = m_links[&channel];
+        if (link.state != LinkState::Healthy || alive)
+        {
+            link.queued = false;
+            link.due = now + HEARTBEAT_INTERVAL;
+            return;
+        }
+
+        // Задание остается в очереди платы как переподключение: queued не сбрасывается
+        link.state = LinkState::Lost;
+        link.lostAt = now;
+        link.backoff = MIN_BACKOFF;
+    }
+
+    m_losses.inc();
+    MMS_LOG_WARN("core", "[device {}]: link lost, reconnecting", channel.deviceId());
+    m_onLost(channel);
+    reconnect(channel, now + RECONNECT_GRACE);
+}
+
+void LinkSupervisor::reconnect(DeviceChannel &channel, IClock::TimePoint until)
+{
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Link &link = m_links[&channel];
+            // Плату отключили или подключили командой, пока задание ждало в очереди
+            if (link.state != LinkState::Lost || m_stopping)
+            {
+                link.queued = false;
+                return;
+            }
+        }
+
+        if (tryConnect(channel))
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Link &link = m_links[&channel];
+                link.state = LinkState::Healthy;
+                link.queued = false;
+                link.due = m_clock->now() + HEARTBEAT_INTERVAL;
+                link.backoff = MIN_BACKOFF;
+            }
+            m_reconnects.inc();
+            MMS_LOG_INFO("core", "[device {}]: link restored", channel.deviceId());
+            m_onRestored(channel);
+            return;
+        }
+
+        IClock::Duration backoff{};
+        const auto now = m_clock->now();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Link &link = m_links[&channel];
+            backoff = link.backoff;
+            link.backoff = std::min<IClock::Duration>(link.backoff * 2, MAX_BACKOFF);
+
+            // Срок вышел: следующую попытку поставит tick(), команды больше не ждут за этим заданием
+            if (now + backoff > until)
+            {
+                link.queued = false;
+                link.due = now + backoff;
+                return;
+            }
+        }
+
+        m_clock->sleepFor(backoff, [this]() { return m_stopping.load(); });
+    }
+}
+
+bool LinkSupervisor::linkAlive(DeviceChannel &channel)
+{
+    try
+    {
+        if (!channel.module().isConnected())
+            return false;
+
+        // Только размер приемной очереди FT232RL: ответ MCU не нужен
+        channel.module().checkRXChannel();
+        return true;
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+}
+
+bool LinkSupervisor::tryConnect(DeviceChannel &channel)
+{
+    try
+    {
+        // Дескриптор выдернутого устройства закрывается, иначе connect() считает плату подключенной
+        channel.module().disconnect();
+        return channel.module().connect(channel.deviceId()) && channel.module().isConnected();
+    }
+    catch (const std::exception &e)
+    {
+        MMS_LOG_DEBUG("core", "[device {}]: reconnect attempt failed: {}", channel.deviceId(), e.what());
+        return false;
+    }
+}
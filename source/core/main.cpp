@@ -1,12 +1,136 @@
 #include "user_core.hpp"
 #include "ft232rl.hpp"
 #include "server.hpp"
+#include "logger.hpp"
+#include "admin_server.hpp"
 
-int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[])
+#include <regex>
+
+namespace
+{
+std::unique_ptr<IModule> makeModule()
 {
-    // IpFromMainInput address_this_server_( 3, argv );
     auto module_ = std::make_unique<FT232RL>();
-    auto core_ = std::make_unique<UserCore>(std::move(module_));
+    // Команды и ответы MCU по 1-161 байту, таймер задержки D2XX по умолчанию (16 мс) тут основная задержка
+    module_->setLinkProfile(LinkProfile::lowLatency());
+    return module_;
+}
+} // namespace
+
+/*
+ * Платы задаются аргументами --board ID:FIRST-LAST, например:
+ *   universal_server --board 0:1-10 --board 1:11-20
+ * Без аргументов работает одна плата с моторами 1..10, устройство выбирается командой reconnect.
+ * Уровень лога: --log-level trace|debug|info|warning|error|off (по умолчанию info).
+ * Метрики Prometheus: --admin-port PORT (по умолчанию 38001, 0 - отключить), GET /metrics.
+ * Очереди плат: --client-weight NAME=W - вес клиента NAME (по умолчанию 1), --client-queue N - предел
+ * команд одного клиента в очереди платы (по умолчанию 16).
+ * Пределы частоты запросов (в секунду, по умолчанию без ограничения): --rate-limit-conn RATE[/BURST] на
+ * соединение, --rate-limit-client RATE[/BURST] на все соединения одного имени.
+ * Сроки соединений в секундах (0 - без ограничения): --handshake-timeout SEC (10), --idle-timeout SEC (0),
+ * --write-stall-timeout SEC (30).
+ * */
+int main(int argc, char *argv[])
+{
+    // IpFromMainInput address_this_server_( 3, argv );
+    DeviceManager devices_;
+    int adminPort = 38001;
+    std::vector<std::pair<std::string, uint32_t>> weights;
+    size_t clientQueue = UserCore::DEFAULT_CLIENT_QUEUE;
+    RateLimit connectionRate, clientRate;
+    ConnectionTimeouts timeouts;
+    for (int i = 1; i < argc; ++i)
+    {
+        static const std::regex port("[0-9]{1,5}");
+        if (std::string(argv[i]) == "--admin-port" && i + 1 < argc && std::regex_match(argv[i + 1], port))
+        {
+            adminPort = std::stoi(argv[++i]);
+            continue;
+        }
+
+        static const std::regex weight("([^=]+)=([1-9][0-9]{0,3})");
+        std::cmatch match;
+        if (std::string(argv[i]) == "--client-weight" && i + 1 < argc
+            && std::regex_match(argv[i + 1], match, weight))
+        {
+            weights.emplace_back(match[1].str(), static_cast<uint32_t>(std::stoul(match[2].str())));
+            ++i;
+            continue;
+        }
+
+        static const std::regex count("[1-9][0-9]{0,5}");
+        if (std::string(argv[i]) == "--client-queue" && i + 1 < argc && std::regex_match(argv[i + 1], count))
+        {
+            clientQueue = std::stoul(argv[++i]);
+            continue;
+        }
+
+        if (std::string(argv[i]) == "--rate-limit-conn" && i + 1 < argc
+            && RateLimit::parse(argv[i + 1], connectionRate))
+        {
+            ++i;
+            continue;
+        }
+
+        if (std::string(argv[i]) == "--rate-limit-client" && i + 1 < argc
+            && RateLimit::parse(argv[i + 1], clientRate))
+        {
+            ++i;
+            continue;
+        }
+
+        static const std::regex seconds("[0-9]{1,5}");
+        const std::string flag = argv[i];
+        if ((flag == "--handshake-timeout" || flag == "--idle-timeout" || flag == "--write-stall-timeout")
+            && i + 1 < argc && std::regex_match(argv[i + 1], seconds))
+        {
+            const std::chrono::milliseconds timeout = std::chrono::seconds(std::stoi(argv[++i]));
+            if (flag == "--handshake-timeout")
+                timeouts.handshake = timeout;
+            else if (flag == "--idle-timeout")
+                timeouts.idle = timeout;
+            else
+                timeouts.writeStall = timeout;
+            continue;
+        }
+
+        LogLevel level;
+        if (std::string(argv[i]) == "--log-level" && i + 1 < argc && Logger::parseLevel(argv[i + 1], level))
+        {
+            Logger::instance().setLevel(level);
+            ++i;
+            continue;
+        }
+
+        int deviceId = 0, firstMotor = 0, lastMotor = 0;
+        if (std::string(argv[i]) != "--board" || i + 1 >= argc
+            || !DeviceManager::parseBoard(argv[++i], deviceId, firstMotor, lastMotor)
+            || !devices_.add(makeModule(), deviceId, firstMotor, lastMotor))
+        {
+            std::cerr << std::format(
+                "Invalid argument \"{}\", expected --board ID:FIRST-LAST, --log-level LEVEL, "
+                "--admin-port PORT, --client-weight NAME=W, --client-queue N, "
+                "--rate-limit-conn RATE[/BURST], --rate-limit-client RATE[/BURST] or "
+                "--handshake-timeout|--idle-timeout|--write-stall-timeout SEC",
+                argv[i]) << std::endl;
+            return 1;
+        }
+    }
+
+    if (devices_.empty())
+        devices_ = DeviceManager(makeModule());
+
+    // Съем метрик идет в своем потоке и не задерживает цикл Server
+    AdminServer admin_("127.0.0.1", adminPort);
+    if (adminPort != 0)
+        admin_.start();
+
+    auto core_ = std::make_unique<UserCore>(std::move(devices_));
+    for (const auto &[client, weight] : weights)
+        core_->setClientWeight(client, weight);
+    core_->setClientQueueLimit(clientQueue);
     Server server_("127.0.0.1", 38000, std::move(core_));
+    server_.setRateLimits(connectionRate, clientRate);
+    server_.setTimeouts(timeouts);
     return server_.run();
 }
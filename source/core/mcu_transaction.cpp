@@ -0,0 +1,23 @@
+#include "mcu_transaction.hpp"
+
+#include <algorithm>
+
+void McuTransaction::encode(const mms::MotorsSettings &settings)
+{
+    const size_t motorCount = std::min(settings.motors.size(), MAX_MOTORS);
+    const uint8_t mode = (settings.mode == "synchronous") ? SYNCHRONOUS : ASYNCHRONOUS;
+
+    m_frame[0] = mode | static_cast<uint8_t>(motorCount);
+
+    uint8_t *dst = m_frame.data() + 1;
+    for (size_t i = 0; i < motorCount; ++i, dst += MOTOR_FRAME_SIZE)
+    {
+        const auto &motor = settings.motors[i];
+        storeLE32(dst + 0, static_cast<uint32_t>(motor.number));
+        storeLE32(dst + 4, motor.acceleration);
+        storeLE32(dst + 8, motor.maxSpeed);
+        storeLE32(dst + 12, static_cast<uint32_t>(motor.step));
+    }
+
+    m_size = 1 + motorCount * MOTOR_FRAME_SIZE;
+}
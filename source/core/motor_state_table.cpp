@@ -0,0 +1,78 @@
+#include "motor_state_table.hpp"
+
+#include <algorithm>
+
+MotorStateTable::MotorStateTable(int firstMotor, int lastMotor)
+    : m_firstMotor(firstMotor)
+    , m_size(firstMotor > 0 ? std::max(0, lastMotor - firstMotor + 1) : 0)
+    , m_entries(std::make_unique<Entry[]>(static_cast<size_t>(m_size)))
+{}
+
+template <typename Update>
+void MotorStateTable::write(int motor, Update update)
+{
+    if (!contains(motor))
+        return;
+
+    Entry &entry = m_entries[static_cast<size_t>(motor - m_firstMotor)];
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+
+    const uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+    entry.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    update(entry);
+
+    entry.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void MotorStateTable::accept(const mms::Motor &motor)
+{
+    write(motor.number, [&motor](Entry &entry) {
+        entry.step.store(motor.step, std::memory_order_relaxed);
+        entry.acceleration.store(motor.acceleration, std::memory_order_relaxed);
+        entry.maxSpeed.store(motor.maxSpeed, std::memory_order_relaxed);
+        entry.inFlight.fetch_add(1, std::memory_order_relaxed);
+    });
+}
+
+void MotorStateTable::complete(const mms::Motor &motor, uint32_t status)
+{
+    write(motor.number, [&motor, status](Entry &entry) {
+        if (status == 0)
+            entry.position.fetch_add(motor.step, std::memory_order_relaxed);
+        entry.error.store(status, std::memory_order_relaxed);
+        if (entry.inFlight.load(std::memory_order_relaxed) > 0)
+            entry.inFlight.fetch_sub(1, std::memory_order_relaxed);
+    });
+}
+
+mms::MotorState MotorStateTable::get(int motor) const
+{
+    mms::MotorState state{};
+    state.number = motor;
+    if (!contains(motor))
+        return state;
+
+    const Entry &entry = m_entries[static_cast<size_t>(motor - m_firstMotor)];
+    uint32_t before = 0;
+    uint32_t after = 0;
+    do
+    {
+        before = entry.sequence.load(std::memory_order_acquire);
+        if (before % 2 != 0)
+            continue; // Запись еще идет
+
+        state.position = entry.position.load(std::memory_order_relaxed);
+        state.step = entry.step.load(std::memory_order_relaxed);
+        state.acceleration = entry.acceleration.load(std::memory_order_relaxed);
+        state.maxSpeed = entry.maxSpeed.load(std::memory_order_relaxed);
+        state.busy = entry.inFlight.load(std::memory_order_relaxed) > 0;
+        state.error = entry.error.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = entry.sequence.load(std::memory_order_relaxed);
+    } while (before % 2 != 0 || before != after);
+
+    return state;
+}
@@ -0,0 +1,73 @@
+#include "move_cache.hpp"
+
+MoveCache::MoveCache(size_t capacity)
+    : m_capacity(capacity)
+    , m_hits(MetricsRegistry::instance().counter(
+          "mms_move_cache_hits_total", "moving() requests served from the compiled move cache"))
+    , m_misses(MetricsRegistry::instance().counter(
+          "mms_move_cache_misses_total", "moving() requests parsed, validated and encoded"))
+{}
+
+std::shared_ptr<const CompiledMove> MoveCache::find(std::string_view settings)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(settings);
+    if (it == m_index.end())
+    {
+        m_misses.inc();
+        return nullptr;
+    }
+
+    m_hits.inc();
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return it->second->second;
+}
+
+void MoveCache::insert(std::string_view settings, std::shared_ptr<const CompiledMove> move)
+{
+    if (m_capacity == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(settings);
+    if (it != m_index.end())
+    {
+        // Тот же запрос скомпилирован параллельно в другом потоке
+        it->second->second = std::move(move);
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return;
+    }
+
+    if (m_lru.size() == m_capacity)
+    {
+        m_index.erase(m_lru.back().first);
+        m_lru.pop_back();
+    }
+
+    m_lru.emplace_front(std::string(settings), std::move(move));
+    m_index.emplace(m_lru.front().first, m_lru.begin());
+}
+
+bool MoveCache::storeRecipe(const std::string &name, std::shared_ptr<const CompiledMove> move)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_recipes.find(name);
+    if (it != m_recipes.end())
+    {
+        it->second = std::move(move);
+        return true;
+    }
+
+    if (m_recipes.size() >= MAX_RECIPES)
+        return false;
+
+    m_recipes.emplace(name, std::move(move));
+    return true;
+}
+
+std::shared_ptr<const CompiledMove> MoveCache::recipe(const std::string &name) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_recipes.find(name);
+    return (it != m_recipes.end()) ? it->second : nullptr;
+}
@@ -0,0 +1,90 @@
+#include "request_journal.hpp"
+
+#include <algorithm>
+
+RequestJournal::RequestJournal(size_t capacity, IClock::Duration retention)
+    : m_capacity(capacity)
+    , m_retention(retention)
+    , m_replays(MetricsRegistry::instance().counter(
+          "mms_request_replays_total", "Retried motion requests answered without running them again"))
+{}
+
+RequestJournal::Claim RequestJournal::claim(
+    const std::string &client, int id, const std::string &text, Connection from)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Key key{client, id};
+    auto it = m_entries.find(key);
+    const bool expired = it != m_entries.end() && it->second.done
+                         && m_clock->now() - it->second.completedAt >= m_retention;
+    if (it != m_entries.end() && it->second.text == text && !expired)
+    {
+        m_replays.inc();
+        if (it->second.done)
+            return Claim{State::Done, 0, it->second.result};
+
+        // Повтор с того же соединения получит исходный ответ и так
+        auto &waiters = it->second.waiters;
+        if (from != it->second.from && std::find(waiters.begin(), waiters.end(), from) == waiters.end())
+            waiters.push_back(from);
+        return Claim{State::InFlight};
+    }
+
+    // Клиент использовал id заново для другой команды или срок ответа истек: прежний ответ больше не нужен
+    if (it != m_entries.end())
+    {
+        m_tokens.erase(it->second.token);
+        m_entries.erase(it);
+    }
+
+    const uint64_t token = m_nextToken++;
+    m_entries.try_emplace(key, token, text, from);
+    m_tokens.emplace(token, std::move(key));
+    return Claim{State::New, token};
+}
+
+std::vector<RequestJournal::Connection> RequestJournal::complete(uint64_t token, const pkg::Status &result)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto tokenIt = m_tokens.find(token);
+    if (tokenIt == m_tokens.end())
+        return {};
+
+    const auto now = m_clock->now();
+    const Key key = tokenIt->second;
+    m_tokens.erase(tokenIt);
+    Entry &entry = m_entries.at(key);
+    entry.done = true;
+    entry.result = result;
+    entry.completedAt = now;
+    std::vector<Connection> waiters = std::move(entry.waiters);
+    entry.waiters.clear();
+
+    // m_completed идет по времени ответа: сверх емкости и с истекшим сроком вытесняется начало
+    m_completed.emplace_back(token, key);
+    while (!m_completed.empty())
+    {
+        const auto &[oldToken, oldKey] = m_completed.front();
+        auto old = m_entries.find(oldKey);
+        // Запись могли заменить командой с тем же id
+        const bool current = old != m_entries.end() && old->second.token == oldToken;
+        if (current && m_completed.size() <= m_capacity && now - old->second.completedAt < m_retention)
+            break;
+        if (current)
+            m_entries.erase(old);
+        m_completed.pop_front();
+    }
+    return waiters;
+}
+
+void RequestJournal::forget(int fd)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto &[token, key] : m_tokens)
+    {
+        Entry &entry = m_entries.at(key);
+        if (entry.from.fd == fd)
+            entry.from = Connection{};
+        std::erase_if(entry.waiters, [fd](const Connection &waiter) { return waiter.fd == fd; });
+    }
+}
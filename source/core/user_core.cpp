@@ -1,21 +1,277 @@
 #include "user_core.hpp"
+#include "logger.hpp"
 #include <thread>
 #include <chrono>
 #include <algorithm>
+#include <latch>
+#include <sstream>
 
 using namespace std::chrono_literals;
 
-UserCore::~UserCore() {}
+namespace
+{
+// Команда, которую обрабатывает текущий поток: задается в Process() и переносится в задания плат
+struct RequestContext
+{
+    LatencyRegistry::Stages *stages = nullptr;
+    IClock::TimePoint start{};
+    IClock *clock = nullptr;
+    const std::string *command = nullptr; // ключ m_methods
+    uint64_t journal = 0;                 // запись RequestJournal, ответ запоминается для повторов
+};
+
+thread_local RequestContext t_request;
+
+class RequestScope
+{
+public:
+    explicit RequestScope(const RequestContext &context)
+        : m_saved(t_request)
+    {
+        t_request = context;
+    }
+
+    RequestScope(const RequestScope &) = delete;
+    RequestScope &operator=(const RequestScope &) = delete;
+
+    ~RequestScope()
+    {
+        t_request = m_saved;
+    }
+
+private:
+    RequestContext m_saved;
+};
+
+void recordStage(LatencyStage stage, IClock::Duration duration)
+{
+    if (t_request.stages != nullptr)
+        (*t_request.stages)[stage].record(duration);
+}
+
+void recordStageSince(LatencyStage stage, IClock::TimePoint from)
+{
+    if (t_request.stages != nullptr)
+        recordStage(stage, t_request.clock->now() - from);
+}
+
+// Имя устройства для mms::ListConnect: без символов вне ASCII (невалидный UTF-8) и обратных кавычек
+std::string cleanDeviceName(std::string name)
+{
+    name.erase(
+        std::remove_if(
+            name.begin(),
+            name.end(),
+            [](char c) { return static_cast<unsigned char>(c) > 127 || c == 0x60; }),
+        name.end());
+    return name;
+}
+
+// Команды подписки и чтения состояния не рассылаются как события: их ответы интересны только автору
+bool isTelemetryCommand(const std::string &command)
+{
+    return command == "status" || command == "subscribe" || command == "unsubscribe";
+}
+
+// Команды, которые двигают моторы: их повтор с тем же id не должен выполняться второй раз
+bool isMotionCommand(const std::string &command)
+{
+    return command == "moving" || command == "program" || command == "run_recipe";
+}
+} // namespace
+
+UserCore::~UserCore()
+{
+    m_supervisor.stop();
+    m_devices.stop();
+}
 
 void UserCore::Init()
 {
-#if 0
-    std::vector<uint8_t> data = {0b00100000};
-    m_module->writeData(data);
-    m_module->readData(data);
-    m_version = data[0] / 100.0f;
-    std::cout << std::format("\nSquid version: {}\n", m_version);
-#endif
+    m_devices.connectAll();
+    m_devices.start();
+    m_events.start();
+    m_inventory.start();
+
+    // Версии прошивок читаются платами параллельно до первой команды: moving() уже знает, можно ли
+    // слать кадр одной записью
+    std::latch firmwareRead(static_cast<std::ptrdiff_t>(m_devices.size()));
+    for (size_t i = 0; i < m_devices.size(); ++i)
+    {
+        m_devices[i].post([this, &firmwareRead](DeviceChannel &channel) {
+            if (channel.module().isConnected())
+                detectFirmware(channel);
+            firmwareRead.count_down();
+        });
+    }
+    firmwareRead.wait();
+
+    for (size_t i = 0; i < m_devices.size(); ++i)
+    {
+        if (m_devices[i].deviceId() >= 0)
+            m_supervisor.watch(m_devices[i]);
+    }
+    m_supervisor.start();
+}
+
+void UserCore::registerStats()
+{
+    auto &registry = MetricsRegistry::instance();
+    for (const auto &[command, method] : m_methods)
+    {
+        m_commandStats[command] = CommandStats{
+            &LatencyRegistry::instance().scope(command),
+            &registry.counter(
+                "mms_commands_total", "Commands received by type", std::format("command=\"{}\"", command))};
+    }
+    m_unknownCommands = &registry.counter("mms_commands_total", "Commands received by type", "command=\"unknown\"");
+
+    static constexpr uint32_t errorCodes[] = {40401, 40402, 40403, 40404, 40405, 40501, 40502, 40503,
+                                              40504, 40505, 40506, 40507, 40509, 40510, 40511, 40512,
+                                              40513, 40516, 40517, 40518, 40519, 40520};
+    for (uint32_t code : errorCodes)
+    {
+        m_errorCounters[code] =
+            &registry.counter("mms_errors_total", "Error replies by status code", std::format("code=\"{}\"", code));
+    }
+}
+
+void UserCore::reply(const uinfo &u, const pkg::Status &status)
+{
+    if (status.status != 0)
+    {
+        auto it = m_errorCounters.find(status.status);
+        MetricCounter &errors = (it != m_errorCounters.end())
+            ? *it->second
+            : MetricsRegistry::instance().counter(
+                  "mms_errors_total", "Error replies by status code", std::format("code=\"{}\"", status.status));
+        errors.inc();
+    }
+
+    const auto started = m_clock->now();
+    std::string text = serialize(status);
+    const auto serialized = m_clock->now();
+    recordStage(LatencyStage::Serialize, serialized - started);
+
+    // Повторы, пришедшие, пока команда выполнялась, получают тот же ответ
+    std::vector<RequestJournal::Connection> retries;
+    if (t_request.journal != 0)
+        retries = m_journal.complete(t_request.journal, status);
+    const std::string frame = retries.empty() ? std::string() : text + "\n\n";
+
+    bool delivered = false;
+    {
+        std::lock_guard<std::mutex> lock(m_replyMutex);
+        delivered = connected(u);
+        if (delivered)
+            writeToSock(u.fd, std::move(text));
+    }
+    if (!delivered)
+        MMS_LOG_INFO("core", "[{}]: connection closed, reply dropped", u.name);
+    for (const auto &retry : retries)
+        pushFrame(uinfo{retry.fd, u.name, retry.id}, frame);
+    recordStageSince(LatencyStage::SocketWrite, serialized);
+
+    if (t_request.stages != nullptr)
+    {
+        recordStageSince(LatencyStage::Total, t_request.start);
+        ServiceMetrics::instance().requestsInFlight.dec();
+    }
+
+    const std::string command = (t_request.command != nullptr) ? *t_request.command : "";
+    if (!m_events.empty() && !isTelemetryCommand(command))
+    {
+        const std::string type = (status.status == 0) ? "completed" : "error";
+        const int except = delivered ? u.fd : -1;
+        publishEvent(mms::Event{type, u.name, command, status.status, status.what, {}}, except);
+    }
+}
+
+void UserCore::publishEvent(const mms::Event &event, int except)
+{
+    if (m_events.empty())
+        return;
+
+    m_events.publish(eventFrame(event), except);
+}
+
+std::string UserCore::eventFrame(const mms::Event &event)
+{
+    pkg::Status message;
+    message.status = 0;
+    message.what = "mms::Event";
+    message.subMessage = serialize(event);
+
+    std::string frame = serialize(message);
+    frame += "\n\n";
+    return frame;
+}
+
+void UserCore::publishMotors(const std::vector<mms::Motor> &motors, const std::string &source)
+{
+    if (m_events.empty())
+        return;
+
+    mms::Event event{"motors", source, "moving", 0, "", {}};
+    for (const auto &motor : motors)
+        event.motors.push_back(m_motors.get(motor.number));
+    publishEvent(event);
+}
+
+void UserCore::linkLost(DeviceChannel &channel)
+{
+    channel.setFirmware({});
+    m_inventory.invalidate();
+    const std::string device = std::format("device {}", channel.deviceId());
+    publishEvent(mms::Event{"disconnected", device, "supervisor", 0, "Link lost", {}});
+}
+
+void UserCore::linkRestored(DeviceChannel &channel)
+{
+    m_inventory.invalidate();
+    const std::string device = std::format("device {}", channel.deviceId());
+    publishEvent(mms::Event{"connected", device, "supervisor", 0, "", {}});
+    detectFirmware(channel);
+}
+
+bool UserCore::pushFrame(int fd, std::string_view frame)
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_replyMutex);
+        writeFramed(fd, frame);
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        MMS_LOG_WARN("core", "event push to fd {} failed: {}", fd, e.what());
+        return false;
+    }
+}
+
+bool UserCore::pushFrame(const uinfo &u, std::string_view frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_replyMutex);
+        if (!connected(u))
+            return false;
+    }
+    return pushFrame(u.fd, frame);
+}
+
+uint64_t UserCore::connectionOf(int fd)
+{
+    std::lock_guard<std::mutex> lock(m_replyMutex);
+    auto [it, inserted] = m_connections.try_emplace(fd, 0);
+    if (inserted)
+        it->second = ++m_lastConnection;
+    return it->second;
+}
+
+bool UserCore::connected(const uinfo &u) const
+{
+    auto it = m_connections.find(u.fd);
+    return it != m_connections.end() && it->second == u.connection;
 }
 
 std::optional<pkg::Message> UserCore::deserializeMessage(const uinfo &u, const std::string &message)
@@ -29,9 +285,9 @@ std::optional<pkg::Message> UserCore::deserializeMessage(const uinfo &u, const s
     {
         pkg::Status merr_;
         merr_.status = 40401; // TODO(khosta77): #001
-        merr_.what = std::format("[{}]: The message is correct({})", u.second, message);
+        merr_.what = std::format("[{}]: The message is correct({})", u.name, message);
         merr_.subMessage = "pkg::Message";
-        writeToSock(u.first, serialize(merr_));
+        reply(u, merr_);
         return {};
     }
     return message_in;
@@ -48,9 +304,9 @@ std::optional<mms::Manager> UserCore::deserializeManager(const uinfo &u, const s
     {
         pkg::Status merr_;
         merr_.status = 40401; // TODO(khosta77): #001
-        merr_.what = std::format("[{}]: The message is correct({})", u.second, text);
+        merr_.what = std::format("[{}]: The message is correct({})", u.name, text);
         merr_.subMessage = "mms::Manager";
-        writeToSock(u.first, serialize(merr_));
+        reply(u, merr_);
         return {};
     }
     return manager;
@@ -69,9 +325,9 @@ std::optional<mms::MotorsSettings> UserCore::deserializeMotorsSettings(
     {
         pkg::Status merr_;
         merr_.status = 40402; // TODO(khosta77): #001
-        merr_.what = std::format("[{}]: The \"MotorsSettings\" is correct({})", u.second, message);
+        merr_.what = std::format("[{}]: The \"MotorsSettings\" is correct({})", u.name, message);
         merr_.subMessage = "";
-        writeToSock(u.first, serialize(merr_));
+        reply(u, merr_);
         return {};
     }
     return motorsSetings_;
@@ -88,14 +344,52 @@ std::optional<mms::Device> UserCore::deserializeDevice(const uinfo &u, const std
     {
         pkg::Status merr_;
         merr_.status = 40403; // TODO(khosta77): #001
-        merr_.what = std::format("[{}]: The \"Device\" is correct({})", u.second, message);
+        merr_.what = std::format("[{}]: The \"Device\" is correct({})", u.name, message);
         merr_.subMessage = "";
-        writeToSock(u.first, serialize(merr_));
+        reply(u, merr_);
         return {};
     }
     return device_;
 }
 
+std::optional<mms::Program> UserCore::deserializeProgram(const uinfo &u, const std::string &message)
+{
+    mms::Program program_;
+    try
+    {
+        program_ = deserialize<mms::Program>(message);
+    }
+    catch (...)
+    {
+        pkg::Status merr_;
+        merr_.status = 40404; // TODO: #001
+        merr_.what = std::format("[{}]: The \"Program\" is not correct({})", u.name, message);
+        merr_.subMessage = "";
+        reply(u, merr_);
+        return {};
+    }
+    return program_;
+}
+
+std::optional<mms::Recipe> UserCore::deserializeRecipe(const uinfo &u, const std::string &message)
+{
+    mms::Recipe recipe_;
+    try
+    {
+        recipe_ = deserialize<mms::Recipe>(message);
+    }
+    catch (...)
+    {
+        pkg::Status merr_;
+        merr_.status = 40405; // TODO: #001
+        merr_.what = std::format("[{}]: The \"Recipe\" is not correct({})", u.name, message);
+        merr_.subMessage = "";
+        reply(u, merr_);
+        return {};
+    }
+    return recipe_;
+}
+
 bool UserCore::checkMode(const uinfo &u, const mms::MotorsSettings &motorsSetings_)
 {
     if (motorsSetings_.mode == "synchronous" || motorsSetings_.mode == "asynchronous")
@@ -103,24 +397,25 @@ bool UserCore::checkMode(const uinfo &u, const mms::MotorsSettings &motorsSeting
 
     pkg::Status merr_;
     merr_.status = 40501; // TODO(khosta77): #001
-    merr_.what = std::format("[{}]: The \"mode\" is correct({})", u.second, motorsSetings_.mode);
+    merr_.what = std::format("[{}]: The \"mode\" is correct({})", u.name, motorsSetings_.mode);
     merr_.subMessage = "";
-    writeToSock(u.first, serialize(merr_));
+    reply(u, merr_);
     return true;
 }
 
 bool UserCore::checkMotors(const uinfo &u, const mms::MotorsSettings &motorsSettings_)
 {
-    if (motorsSettings_.motors.size() > 10)
+    if (motorsSettings_.motors.size() > m_devices.motorCount())
     {
         pkg::Status merr_;
         merr_.status = 40502; // TODO: #001
         merr_.what = std::format(
-            "[{}]: Motors array size exceeds limit ({} > 10)",
-            u.second,
-            motorsSettings_.motors.size());
+            "[{}]: Motors array size exceeds limit ({} > {})",
+            u.name,
+            motorsSettings_.motors.size(),
+            m_devices.motorCount());
         merr_.subMessage = "";
-        writeToSock(u.first, serialize(merr_));
+        reply(u, merr_);
         return true;
     }
 
@@ -128,17 +423,19 @@ bool UserCore::checkMotors(const uinfo &u, const mms::MotorsSettings &motorsSett
     {
         const auto &motor = motorsSettings_.motors[i];
 
-        if (motor.number < 1 || motor.number > 10)
+        if (m_devices.findByMotor(motor.number) == nullptr)
         {
             pkg::Status merr_;
             merr_.status = 40503; // TODO: #001
             merr_.what = std::format(
-                "[{}]: Motor #{} has invalid number ({}), must be 1-10",
-                u.second,
+                "[{}]: Motor #{} has invalid number ({}), must be {}-{}",
+                u.name,
                 i + 1,
-                motor.number);
+                motor.number,
+                m_devices.firstMotor(),
+                m_devices.lastMotor());
             merr_.subMessage = "";
-            writeToSock(u.first, serialize(merr_));
+            reply(u, merr_);
             return true;
         }
 
@@ -146,9 +443,9 @@ bool UserCore::checkMotors(const uinfo &u, const mms::MotorsSettings &motorsSett
         {
             pkg::Status merr_;
             merr_.status = 40504; // TODO: #001
-            merr_.what = std::format("[{}]: Motor #{} has zero acceleration", u.second, motor.number);
+            merr_.what = std::format("[{}]: Motor #{} has zero acceleration", u.name, motor.number);
             merr_.subMessage = "";
-            writeToSock(u.first, serialize(merr_));
+            reply(u, merr_);
             return true;
         }
 
@@ -156,9 +453,9 @@ bool UserCore::checkMotors(const uinfo &u, const mms::MotorsSettings &motorsSett
         {
             pkg::Status merr_;
             merr_.status = 40505; // TODO: #001
-            merr_.what = std::format("[{}]: Motor #{} has zero max speed", u.second, motor.number);
+            merr_.what = std::format("[{}]: Motor #{} has zero max speed", u.name, motor.number);
             merr_.subMessage = "";
-            writeToSock(u.first, serialize(merr_));
+            reply(u, merr_);
             return true;
         }
     }
@@ -173,9 +470,9 @@ bool UserCore::checkEmptyMessage(const uinfo &u, const std::string &message)
         pkg::Status merr_;
         merr_.status = 40506; // TODO: #001
         merr_.what =
-            std::format("[{}]: The message should be empty for version command, got: {}", u.second, message);
+            std::format("[{}]: The message should be empty for version command, got: {}", u.name, message);
         merr_.subMessage = "";
-        writeToSock(u.first, serialize(merr_));
+        reply(u, merr_);
         return true;
     }
     return false;
@@ -183,13 +480,15 @@ bool UserCore::checkEmptyMessage(const uinfo &u, const std::string &message)
 
 bool UserCore::checkConnection(const uinfo &u)
 {
-    if (!m_module->isConnected())
+    // Пока супервизор переподключает плату, команды ждут в ее очереди
+    DeviceChannel &primary = m_devices.primary();
+    if (!primary.module().isConnected() && !m_supervisor.reconnecting(primary))
     {
         pkg::Status merr_;
         merr_.status = 40507; // TODO: #001
-        merr_.what = std::format("[{}]: Module is not connected", u.second);
+        merr_.what = std::format("[{}]: Module is not connected", u.name);
         merr_.subMessage = "";
-        writeToSock(u.first, serialize(merr_));
+        reply(u, merr_);
         return true;
     }
     return false;
@@ -201,9 +500,9 @@ bool UserCore::checkDeviceId(const uinfo &u, int deviceId)
     {
         pkg::Status merr_;
         merr_.status = 40509; // TODO: #001
-        merr_.what = std::format("[{}]: Device id must be >= 0, got {}", u.second, deviceId);
+        merr_.what = std::format("[{}]: Device id must be >= 0, got {}", u.name, deviceId);
         merr_.subMessage = "";
-        writeToSock(u.first, serialize(merr_));
+        reply(u, merr_);
         return true;
     }
     return false;
@@ -215,17 +514,102 @@ bool UserCore::checkConnectResult(const uinfo &u, int deviceId, bool ok)
     {
         pkg::Status merr_;
         merr_.status = 40510; // TODO: #001
-        merr_.what = std::format("[{}]: Failed to connect device {}", u.second, deviceId);
+        merr_.what = std::format("[{}]: Failed to connect device {}", u.name, deviceId);
         merr_.subMessage = "";
-        writeToSock(u.first, serialize(merr_));
+        reply(u, merr_);
         return true;
     }
     return false;
 }
 
+bool UserCore::checkAlreadyConnected(const uinfo &u, DeviceChannel &channel)
+{
+    if (channel.module().isConnected())
+    {
+        pkg::Status merr_;
+        merr_.status = 40512; // TODO: #001
+        merr_.what = std::format("[{}]: Module is connecting", u.name);
+        merr_.subMessage = "";
+        reply(u, merr_);
+        return true;
+    }
+    return false;
+}
+
+bool UserCore::checkShards(const uinfo &u, const std::vector<Shard> &shards)
+{
+    for (const auto &[channel, settings] : shards)
+    {
+        if (settings.motors.size() > McuTransaction::MAX_MOTORS)
+        {
+            pkg::Status merr_;
+            merr_.status = 40502; // TODO: #001
+            merr_.what = std::format(
+                "[{}]: Motors array size exceeds limit for device {} ({} > {})",
+                u.name,
+                channel->deviceId(),
+                settings.motors.size(),
+                McuTransaction::MAX_MOTORS);
+            merr_.subMessage = "";
+            reply(u, merr_);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool UserCore::checkBoards(const uinfo &u, const CompiledMove &move)
+{
+    for (const auto &part : move.parts)
+    {
+        // Основная плата уже проверена в checkConnection()
+        DeviceChannel *channel = part.channel;
+        if (channel != &m_devices.primary() && !channel->module().isConnected()
+            && !m_supervisor.reconnecting(*channel))
+        {
+            pkg::Status merr_;
+            merr_.status = 40507; // TODO: #001
+            merr_.what = std::format("[{}]: Module is not connected (device {})", u.name, channel->deviceId());
+            merr_.subMessage = "";
+            reply(u, merr_);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool UserCore::checkBacklog(const uinfo &u, const CompiledMove &move)
+{
+    for (const auto &part : move.parts)
+    {
+        // Очередь платы обходится по клиентам (FairQueue), предел не дает одному клиенту копить
+        // команды быстрее, чем плата их выполняет
+        DeviceChannel *channel = part.channel;
+        const size_t queued = channel->pending(u.name);
+        if (queued >= m_clientQueueLimit)
+        {
+            pkg::Status merr_;
+            merr_.status = 40520; // TODO: #001
+            merr_.what = std::format(
+                "[{}]: Too many queued commands ({}) on device {}", u.name, queued, channel->deviceId());
+            merr_.subMessage = "";
+            reply(u, merr_);
+            return true;
+        }
+    }
+    return false;
+}
+
+void UserCore::setClientWeight(const std::string &client, uint32_t weight)
+{
+    for (size_t i = 0; i < m_devices.size(); ++i)
+        m_devices[i].setClientWeight(client, weight);
+}
+
 void UserCore::Process(const int fd, const std::string &name, const std::string &message)
 {
-    uinfo u = {fd, name};
+    uinfo u = {fd, name, connectionOf(fd)};
+    const auto started = m_clock->now();
     auto messageIn_ = deserializeMessage(u, message); // pkg::Message
     if (!messageIn_.has_value())
         return;
@@ -238,36 +622,109 @@ void UserCore::Process(const int fd, const std::string &name, const std::string
     if (it == m_methods.end())
     {
         // TODO(khosta77): #002
+        m_unknownCommands->inc();
         return;
     }
 
+    const auto &stats = m_commandStats.at(it->first);
+    stats.calls->inc();
+
+    // Повтор команды движения (тот же клиент, id и текст) не выполняется второй раз
+    uint64_t journal = 0;
+    if (messageIn_.value().id > 0 && isMotionCommand(it->first))
+    {
+        const int id = messageIn_.value().id;
+        auto claim = m_journal.claim(u.name, id, messageIn_.value().text, {fd, u.connection});
+        if (claim.state == RequestJournal::State::Done)
+        {
+            MMS_LOG_INFO("core", "[{}]: request {} repeated, replaying result", u.name, id);
+            std::lock_guard<std::mutex> lock(m_replyMutex);
+            writeToSock(fd, serialize(claim.result));
+            return;
+        }
+        if (claim.state == RequestJournal::State::InFlight)
+        {
+            MMS_LOG_INFO("core", "[{}]: request {} repeated while running", u.name, id);
+            return;
+        }
+        journal = claim.token;
+    }
+    ServiceMetrics::instance().requestsInFlight.inc();
+
+    RequestScope scope({stats.latency, started, m_clock, &it->first, journal});
+    recordStageSince(LatencyStage::Parse, started);
+
     (this->*(it->second))(u, manager_.value().message); // Вызов метода через указатель
 }
 
+void UserCore::Disconnected(const int fd)
+{
+    m_events.unsubscribe(fd);
+    m_journal.forget(fd);
+
+    // Команды соединения могут еще выполняться на платах: их ответы сбрасываются в reply()
+    std::lock_guard<std::mutex> lock(m_replyMutex);
+    m_connections.erase(fd);
+}
+
 void UserCore::Launch() {}
 
-void UserCore::Stop() {}
+void UserCore::Stop()
+{
+    m_supervisor.stop();
+    m_devices.stop();
+    m_events.stop();
+    m_inventory.stop();
+
+    std::istringstream report(LatencyRegistry::instance().report());
+    for (std::string line; std::getline(report, line);)
+        MMS_LOG_INFO("latency", "{}", line);
+}
 
 void UserCore::version(const uinfo &u, const std::string &message)
 {
-    if (checkEmptyMessage(u, message))
+    const bool refresh = (message == "refresh");
+    if (!refresh && checkEmptyMessage(u, message))
         return;
 
     if (checkConnection(u))
         return;
 
-    std::vector<uint8_t> data = {0b00100000}; // Команда запроса версии прошивки
-    m_module->writeData(data);
-    data[0] = 0x00;
-    std::this_thread::sleep_for(100ms);
-    m_module->readData(data);
+    // Версия прочитана при подключении: опрос version не занимает линию до MCU
+    const DeviceChannel::Firmware firmware = m_devices.primary().firmware();
+    if (firmware.known && !refresh)
+    {
+        replyVersion(u, firmware);
+        return;
+    }
 
-    uint8_t versionByte = data[0];
-    uint8_t integerPart = (versionByte >> 4) & 0x0F; // Первые 4 бита
-    uint8_t decimalPart = versionByte & 0x0F;        // Вторые 4 бита
+    m_devices.primary().post([this, u, refresh, context = t_request](DeviceChannel &channel) {
+        RequestScope scope(context);
 
+        // Пока команда ждала в очереди, версию мог прочитать LinkSupervisor после переподключения
+        DeviceChannel::Firmware firmware = channel.firmware();
+        try
+        {
+            if (!firmware.known || refresh)
+                firmware = readFirmware(channel);
+        }
+        catch (const std::exception &e)
+        {
+            pkg::Status merr_;
+            merr_.status = 40507; // TODO: #001
+            merr_.what = std::format("[{}]: Module is not connected: {}", u.name, e.what());
+            merr_.subMessage = "";
+            reply(u, merr_);
+            return;
+        }
+        replyVersion(u, firmware);
+    }, u.name);
+}
+
+void UserCore::replyVersion(const uinfo &u, const DeviceChannel::Firmware &firmware)
+{
     mms::Version versionInfo;
-    versionInfo.version = static_cast<float>(integerPart) + static_cast<float>(decimalPart) / 10.0f;
+    versionInfo.version = firmware.version;
     versionInfo.name = "Squid";
 
     pkg::Status response;
@@ -275,7 +732,60 @@ void UserCore::version(const uinfo &u, const std::string &message)
     response.subMessage = serialize(versionInfo);
     response.what = "mms::Version";
 
-    writeToSock(u.first, serialize(response));
+    reply(u, response);
+}
+
+DeviceChannel::Firmware UserCore::readFirmware(DeviceChannel &channel)
+{
+    const std::vector<uint8_t> request = {McuTransaction::VERSION_REQUEST}; // Команда запроса версии прошивки
+    auto started = m_clock->now();
+    channel.writeFrame(request);
+    recordStageSince(LatencyStage::McuWrite, started);
+
+    // Ответ обычно приходит сразу, ждем его не дольше VERSION_REPLY_DELAY
+    started = m_clock->now();
+    IClock::Duration waited{};
+    while (waited < VERSION_REPLY_DELAY && channel.module().checkRXChannel() == 0)
+    {
+        m_clock->sleepFor(MCU_POLL_INTERVAL);
+        waited += MCU_POLL_INTERVAL;
+    }
+
+    std::vector<uint8_t> data(1, 0);
+    channel.module().readData(data);
+    recordStageSince(LatencyStage::McuCompletion, started);
+
+    uint8_t versionByte = data[0];
+    uint8_t integerPart = (versionByte >> 4) & 0x0F; // Первые 4 бита
+    uint8_t decimalPart = versionByte & 0x0F;        // Вторые 4 бита
+
+    DeviceChannel::Firmware firmware;
+    firmware.version = static_cast<float>(integerPart) + static_cast<float>(decimalPart) / 10.0f;
+    firmware.coalesced = McuTransaction::supportsCoalesced(versionByte);
+    firmware.known = true;
+    channel.setFirmware(firmware);
+
+    MMS_LOG_INFO(
+        "core",
+        "[device {}]: firmware {}.{}{}",
+        channel.deviceId(),
+        integerPart,
+        decimalPart,
+        firmware.coalesced ? ", coalesced frames" : "");
+    return firmware;
+}
+
+void UserCore::detectFirmware(DeviceChannel &channel)
+{
+    try
+    {
+        readFirmware(channel);
+    }
+    catch (const std::exception &e)
+    {
+        channel.setFirmware({});
+        MMS_LOG_ERROR("core", "[device {}]: firmware version not read: {}", channel.deviceId(), e.what());
+    }
 }
 
 void UserCore::moving(const uinfo &u, const std::string &message)
@@ -283,175 +793,493 @@ void UserCore::moving(const uinfo &u, const std::string &message)
     if (checkConnection(u))
         return;
 
-    auto motorsSettings_ = deserializeMotorsSettings(u, message);
-    if (!motorsSettings_.has_value())
+    // Повторный запрос: разбор, проверка и кодирование уже сделаны
+    const auto validationStarted = m_clock->now();
+    auto move = m_moves.find(message);
+    if (move == nullptr)
+    {
+        auto motorsSettings_ = deserializeMotorsSettings(u, message);
+        if (!motorsSettings_.has_value())
+            return;
+
+        move = compile(u, motorsSettings_.value());
+        if (move == nullptr)
+            return;
+        m_moves.insert(message, move);
+    }
+
+    if (checkBoards(u, *move) || checkBacklog(u, *move))
         return;
+    recordStageSince(LatencyStage::Validate, validationStarted);
+
+    startMove(u, move);
+}
+
+std::shared_ptr<const CompiledMove> UserCore::compile(const uinfo &u, const mms::MotorsSettings &settings)
+{
+    if (checkMode(u, settings) || checkMotors(u, settings))
+        return nullptr;
+
+    std::vector<Shard> shards = splitByBoard(settings);
+    if (checkShards(u, shards))
+        return nullptr;
+
+    auto move = std::make_shared<CompiledMove>();
+    move->motors = settings.motors;
+    move->parts.reserve(shards.size());
+    for (const auto &[channel, local] : shards)
+    {
+        CompiledMove::Part &part = move->parts.emplace_back();
+        part.channel = channel;
+        part.transaction.encode(local);
+        part.motors = local.motors;
+        for (auto &motor : part.motors)
+            motor.number = channel->globalNumber(motor.number);
+    }
+    return move;
+}
+
+void UserCore::startMove(const uinfo &u, const std::shared_ptr<const CompiledMove> &move)
+{
+    for (const auto &motor : move->motors)
+        m_motors.accept(motor);
+    publishMotors(move->motors, u.name);
+
+    auto pending = std::make_shared<PendingReply>(u, move->parts.size());
+    for (const auto &part : move->parts)
+    {
+        const uint64_t stopEpoch = part.channel->stopEpoch();
+        // Команда из кэша живет, пока ее держит задание: запись могут вытеснить до выполнения
+        auto job = [this, pending, move, &part, stopEpoch, context = t_request](DeviceChannel &channel) {
+            RequestScope scope(context);
+            pkg::Status status;
+            try
+            {
+                status = executeMove(channel, part.transaction, pending->user, stopEpoch);
+            }
+            catch (const std::exception &e)
+            {
+                status.status = 40513; // MCU execution error
+                status.what = std::format("[{}][40513]: MCU execution error: {}", pending->user.name, e.what());
+                status.subMessage = "";
+            }
+
+            for (const auto &motor : part.motors)
+                m_motors.complete(motor, status.status);
+            publishMotors(part.motors, pending->user.name);
+            finishPart(pending, status);
+        };
+        part.channel->post(std::move(job), u.name);
+    }
+}
+
+std::vector<UserCore::Shard> UserCore::splitByBoard(const mms::MotorsSettings &settings)
+{
+    std::vector<Shard> shards;
+    for (const auto &motor : settings.motors)
+    {
+        DeviceChannel *channel = m_devices.findByMotor(motor.number);
+        auto it = std::find_if(shards.begin(), shards.end(), [channel](const Shard &shard) {
+            return shard.first == channel;
+        });
+        if (it == shards.end())
+        {
+            shards.emplace_back(channel, mms::MotorsSettings{});
+            it = std::prev(shards.end());
+            it->second.mode = settings.mode;
+        }
+
+        mms::Motor local = motor;
+        local.number = channel->localNumber(motor.number);
+        it->second.motors.push_back(local);
+    }
 
-    if (checkMode(u, motorsSettings_.value()) || checkMotors(u, motorsSettings_.value()))
+    if (shards.empty())
+        shards.emplace_back(&m_devices.primary(), settings);
+    return shards;
+}
+
+void UserCore::program(const uinfo &u, const std::string &message)
+{
+    if (checkConnection(u))
         return;
 
-    const auto &settings = motorsSettings_.value();
-    const size_t motorCount = settings.motors.size();
+    const auto validationStarted = m_clock->now();
+    auto program_ = deserializeProgram(u, message);
+    if (!program_.has_value())
+        return;
 
-    uint8_t commandByte;
-    if (settings.mode == "synchronous")
+    auto &steps = program_.value().steps;
+    if (steps.empty() || steps.size() > MAX_PROGRAM_STEPS)
     {
-        commandByte = 0x80 | static_cast<uint8_t>(motorCount); // 0x8N
+        pkg::Status merr_;
+        merr_.status = 40517; // TODO: #001
+        merr_.what = std::format(
+            "[{}]: Program must contain from 1 to {} steps ({})", u.name, MAX_PROGRAM_STEPS, steps.size());
+        merr_.subMessage = "";
+        reply(u, merr_);
+        return;
     }
-    else
-    {                                                          // asynchronous
-        commandByte = 0x40 | static_cast<uint8_t>(motorCount); // 0x4N
+
+    // Вся программа проверяется до первого обращения к MCU: ошибка в середине не оставит моторы
+    // посреди траектории
+    auto run = std::make_shared<ProgramRun>(u);
+    run->steps.reserve(steps.size());
+    for (size_t i = 0; i < steps.size(); ++i)
+    {
+        const uinfo step = {u.fd, std::format("{}][step {}", u.name, i + 1), u.connection};
+        auto move = compile(step, steps[i]);
+        if (move == nullptr || checkBoards(step, *move) || checkBacklog(u, *move))
+            return;
+        run->steps.push_back(std::move(move));
+    }
+    recordStageSince(LatencyStage::Validate, validationStarted);
+
+    // stop() отменяет всю программу, в том числе шаги, еще не поставленные в очередь
+    for (const auto &move : run->steps)
+    {
+        for (const auto &part : move->parts)
+            run->stopEpochs.try_emplace(part.channel, part.channel->stopEpoch());
+    }
+    startStep(run);
+}
+
+void UserCore::startStep(const std::shared_ptr<ProgramRun> &run)
+{
+    const CompiledMove &move = *run->steps[run->step];
+    run->remaining = move.parts.size();
+    for (const auto &motor : move.motors)
+        m_motors.accept(motor);
+
+    for (const auto &part : move.parts)
+    {
+        const uint64_t stopEpoch = run->stopEpochs.at(part.channel);
+        // Шаги хранятся в run до конца программы, задание берет их по ссылке
+        part.channel->post([this, run, stopEpoch, &part, context = t_request](DeviceChannel &board) {
+            RequestScope scope(context);
+            pkg::Status status;
+            try
+            {
+                status = executeMove(board, part.transaction, run->user, stopEpoch, true);
+            }
+            catch (const std::exception &e)
+            {
+                status.status = 40513; // MCU execution error
+                status.what = std::format("[{}][40513]: MCU execution error: {}", run->user.name, e.what());
+                status.subMessage = "";
+            }
+
+            for (const auto &motor : part.motors)
+                m_motors.complete(motor, status.status);
+            finishStep(run, status);
+        }, run->user.name);
+    }
+}
+
+void UserCore::finishStep(const std::shared_ptr<ProgramRun> &run, const pkg::Status &status)
+{
+    const size_t total = run->steps.size();
+    size_t step = 0;
+    {
+        std::lock_guard<std::mutex> lock(run->mutex);
+        if (status.status != 0 && run->result.status == 0)
+        {
+            run->result = status;
+            run->result.what += std::format(" at step {}/{}", run->step + 1, total);
+        }
+
+        if (--run->remaining != 0)
+            return;
+        step = run->step;
     }
 
-    std::vector<uint8_t> commandData = {commandByte};
-    m_module->writeData(commandData);
+    // Прогресс шага: автору команды напрямую, подписчикам - как остальные события
+    const std::string what = std::format("step {}/{}", step + 1, total);
+    mms::Event event{"progress", run->user.name, "program", run->result.status, what, {}};
+    for (const auto &motor : run->steps[step]->motors)
+        event.motors.push_back(m_motors.get(motor.number));
+    pushFrame(run->user, eventFrame(event));
+    publishEvent(event, run->user.fd);
+
+    if (run->result.status != 0 || step + 1 == total)
+    {
+        reply(run->user, run->result);
+        return;
+    }
+
+    run->step = step + 1;
+    startStep(run);
+}
+
+void UserCore::save_recipe(const uinfo &u, const std::string &message)
+{
+    auto recipe_ = deserializeRecipe(u, message);
+    if (!recipe_.has_value())
+        return;
+
+    const std::string &name = recipe_.value().name;
+    if (name.empty() || name.size() > MoveCache::MAX_RECIPE_NAME)
+    {
+        pkg::Status merr_;
+        merr_.status = 40519; // TODO: #001
+        merr_.what = std::format(
+            "[{}]: Recipe name must be 1 to {} characters long", u.name, MoveCache::MAX_RECIPE_NAME);
+        merr_.subMessage = "";
+        reply(u, merr_);
+        return;
+    }
+
+    auto move = compile(u, recipe_.value().settings);
+    if (move == nullptr)
+        return;
+
+    if (!m_moves.storeRecipe(name, std::move(move)))
+    {
+        pkg::Status merr_;
+        merr_.status = 40519; // TODO: #001
+        merr_.what = std::format("[{}]: Recipe limit reached ({})", u.name, MoveCache::MAX_RECIPES);
+        merr_.subMessage = "";
+        reply(u, merr_);
+        return;
+    }
+
+    MMS_LOG_INFO("core", "[{}]: recipe \"{}\" saved", u.name, name);
+    reply(u, pkg::Status{"", "", 0});
+}
+
+void UserCore::run_recipe(const uinfo &u, const std::string &message)
+{
+    if (checkConnection(u))
+        return;
+
+    const auto validationStarted = m_clock->now();
+    auto move = m_moves.recipe(message);
+    if (move == nullptr)
+    {
+        pkg::Status merr_;
+        merr_.status = 40518; // TODO: #001
+        merr_.what = std::format("[{}]: Unknown recipe \"{}\"", u.name, message);
+        merr_.subMessage = "";
+        reply(u, merr_);
+        return;
+    }
+
+    if (checkBoards(u, *move) || checkBacklog(u, *move))
+        return;
+    recordStageSince(LatencyStage::Validate, validationStarted);
+
+    startMove(u, move);
+}
+
+pkg::Status UserCore::executeMove(
+    DeviceChannel &channel,
+    const McuTransaction &transaction,
+    const uinfo &u,
+    uint64_t stopEpoch,
+    bool streamed)
+{
+    if (channel.stopEpoch() != stopEpoch)
+    {
+        // stop() пришел, пока команда ждала в очереди платы
+        pkg::Status errorResponse;
+        errorResponse.status = 40516; // Stopped
+        errorResponse.what = std::format("[{}][40516]: Stopped before start", u.name);
+        errorResponse.subMessage = "";
+        return errorResponse;
+    }
+
+    const bool coalesced = channel.firmware().coalesced;
+
+    // Прошивка >= 2.0 принимает заголовок и параметры одной записью, иначе сначала только заголовок.
+    // Пока MCU ждет параметры, stop() откладывает байт остановки до их записи
+    auto started = m_clock->now();
+    if (coalesced)
+        channel.writeFrame(transaction.frame());
+    else
+        channel.writeFrame(transaction.frame().first(1), true);
+    auto writeTime = m_clock->now() - started;
     std::vector<uint8_t> readinessResponse(1, 0);
 
-    size_t timeoutMs = 5000; // 5 секунд
-    size_t elapsedMs = 0;
-    const size_t checkIntervalMs = 100;
-    while (elapsedMs < timeoutMs)
+    // stop() будит ожидание готовности: готовность проверяется сразу, и отложенный STOP уходит вместе
+    // с параметрами без паузы опроса. Дальше опрос идет как обычно - кадр без параметров не закрыть,
+    // а stopEpoch остается прежним, чтобы остановку увидели и ожидания завершения ниже
+    uint64_t readinessEpoch = stopEpoch;
+    const auto stoppedWhileWaiting = [&channel, &readinessEpoch]() {
+        return channel.stopEpoch() != readinessEpoch;
+    };
+    started = m_clock->now();
+    IClock::Duration elapsed{};
+    while (elapsed < MCU_TIMEOUT)
     {
-        size_t availableBytes = m_module->checkRXChannel();
-        std::cout << std::format("\tсообщение: {}\n", availableBytes);
+        size_t availableBytes = channel.module().checkRXChannel();
+        MMS_LOG_TRACE("core", "readiness poll: {} byte(s)", availableBytes);
         if (availableBytes >= 1)
         {
-            m_module->readData(readinessResponse);
+            channel.module().readData(readinessResponse);
             break;
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(checkIntervalMs));
-        elapsedMs += checkIntervalMs;
+        if (!m_clock->sleepFor(MCU_POLL_INTERVAL, stoppedWhileWaiting))
+            readinessEpoch = channel.stopEpoch();
+        elapsed += MCU_POLL_INTERVAL;
     }
 
+    recordStageSince(LatencyStage::McuReadiness, started);
+
     uint8_t readinessCode = readinessResponse[0];
     if (readinessCode != 0x00)
     {
+        if (!coalesced)
+            channel.closeFrame();
+        recordStage(LatencyStage::McuWrite, writeTime);
         pkg::Status errorResponse;
         errorResponse.status = 40512; // MCU readiness error
-        errorResponse.what = std::format("[{}][40512]: MCU readiness error: {}", u.second, readinessCode);
+        errorResponse.what = std::format("[{}][40512]: MCU readiness error: {}", u.name, readinessCode);
         errorResponse.subMessage = "";
-        writeToSock(u.first, serialize(errorResponse));
-        return;
+        return errorResponse;
     }
 
-    std::vector<uint8_t> motorData;
-    motorData.reserve(motorCount * 16); // 4 параметра × 4 байта на мотор
-
-    for (const auto &motor : settings.motors)
+    if (!coalesced)
     {
-        uint32_t number = static_cast<uint32_t>(motor.number);
-        motorData.insert(
-            motorData.end(),
-            reinterpret_cast<uint8_t *>(&number),
-            reinterpret_cast<uint8_t *>(&number) + 4);
-
-        uint32_t acceleration = motor.acceleration;
-        motorData.insert(
-            motorData.end(),
-            reinterpret_cast<uint8_t *>(&acceleration),
-            reinterpret_cast<uint8_t *>(&acceleration) + 4);
-
-        uint32_t maxSpeed = motor.maxSpeed;
-        motorData.insert(
-            motorData.end(),
-            reinterpret_cast<uint8_t *>(&maxSpeed),
-            reinterpret_cast<uint8_t *>(&maxSpeed) + 4);
-
-        uint32_t step = static_cast<uint32_t>(motor.step);
-        motorData.insert(
-            motorData.end(),
-            reinterpret_cast<uint8_t *>(&step),
-            reinterpret_cast<uint8_t *>(&step) + 4);
+        started = m_clock->now();
+        channel.writeFrame(transaction.payload());
+        writeTime += m_clock->now() - started;
     }
+    recordStage(LatencyStage::McuWrite, writeTime);
 
-    m_module->writeData(motorData);
-    std::this_thread::sleep_for(200ms);
+    // Паузы ожидания завершения прерывает stop(): MCU отвечает на остановку сразу, опрашиваем без паузы.
+    // Шаг программы не ждет MOVE_SETTLE_DELAY и опрашивается чаще: следующий шаг уходит сразу за ним
+    const auto stopped = [&channel, &stopEpoch]() { return channel.stopEpoch() != stopEpoch; };
+    const IClock::Duration pollInterval = streamed ? PROGRAM_POLL_INTERVAL : MCU_POLL_INTERVAL;
+    started = m_clock->now();
+    if (!streamed && !m_clock->sleepFor(MOVE_SETTLE_DELAY, stopped))
+        stopEpoch = channel.stopEpoch();
 
     std::vector<uint8_t> completionResponse(2);
 
     // Простая реализация таймаута через проверку доступных данных
     // В реальной реализации здесь должен быть более сложный механизм таймаута
-    elapsedMs = 0;
-    while (elapsedMs < timeoutMs)
+    elapsed = IClock::Duration{};
+    while (elapsed < MCU_TIMEOUT)
     {
-        size_t availableBytes = m_module->checkRXChannel();
-        std::cout << std::format("\t\tсообщение: {}\n", availableBytes);
+        size_t availableBytes = channel.module().checkRXChannel();
+        MMS_LOG_TRACE("core", "completion poll: {} byte(s)", availableBytes);
         if (availableBytes >= 2)
         {
-            m_module->readData(completionResponse);
+            channel.module().readData(completionResponse);
             break;
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(checkIntervalMs));
-        elapsedMs += checkIntervalMs;
+        if (!m_clock->sleepFor(pollInterval, stopped))
+            stopEpoch = channel.stopEpoch();
+        elapsed += pollInterval;
     }
 
-    for (int i = 0; i < completionResponse.size(); ++i)
-    {
-        printf("%02x ", completionResponse[i]);
-    }
-    printf("\n");
+    recordStageSince(LatencyStage::McuCompletion, started);
+
+    MMS_LOG_DEBUG(
+        "core",
+        "[device {}] completion: {:02x} {:02x}",
+        channel.deviceId(),
+        completionResponse[0],
+        completionResponse[1]);
 
-    if (elapsedMs >= timeoutMs)
+    if (elapsed >= MCU_TIMEOUT)
     {
         // Таймаут ожидания ответа от MCU
+        ServiceMetrics::instance().mcuTimeouts.inc();
         pkg::Status errorResponse;
         errorResponse.status = 40511; // Timeout waiting for MCU response
-        errorResponse.what = std::format("[{}]: Timeout waiting for MCU response", u.second);
+        errorResponse.what = std::format("[{}]: Timeout waiting for MCU response", u.name);
         errorResponse.subMessage = "";
-        writeToSock(u.first, serialize(errorResponse));
-        return;
+        return errorResponse;
     }
 
     uint8_t completionCode = completionResponse[1];
+    if (completionCode == McuTransaction::STOPPED)
+    {
+        // Движение прервано stop()
+        pkg::Status errorResponse;
+        errorResponse.status = 40516; // Stopped
+        errorResponse.what = std::format("[{}][40516]: Stopped by emergency stop", u.name);
+        errorResponse.subMessage = "";
+        return errorResponse;
+    }
+
     if (completionCode != 0xFF)
     {
         // Ошибка выполнения на MCU
         pkg::Status errorResponse;
         errorResponse.status = 40513; // MCU execution error
         errorResponse.what =
-            std::format("[{}][40513]: MCU execution error: 0x{:02X}", u.second, completionCode);
+            std::format("[{}][40513]: MCU execution error: 0x{:02X}", u.name, completionCode);
         errorResponse.subMessage = "";
-        writeToSock(u.first, serialize(errorResponse));
-        return;
+        return errorResponse;
     }
 
     pkg::Status successResponse;
     successResponse.status = 0;
     successResponse.what = "";
     successResponse.subMessage = "";
-    writeToSock(u.first, serialize(successResponse));
+    return successResponse;
 }
 
-void UserCore::reconnect(const uinfo &u, const std::string &message)
+void UserCore::finishPart(const std::shared_ptr<PendingReply> &pending, const pkg::Status &status)
 {
-    if (m_module->isConnected())
     {
-        pkg::Status merr_;
-        merr_.status = 40512; // TODO: #001
-        merr_.what = std::format("[{}]: Module is connecting", u.second);
-        merr_.subMessage = "";
-        writeToSock(u.first, serialize(merr_));
-        return;
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        if (status.status != 0 && pending->result.status == 0)
+            pending->result = status;
+
+        if (--pending->remaining != 0)
+            return;
     }
 
+    reply(pending->user, pending->result);
+}
+
+void UserCore::reconnect(const uinfo &u, const std::string &message)
+{
+    // С одной платой переподключается она, поэтому проверяем ее до разбора сообщения
+    if (m_devices.size() == 1 && checkAlreadyConnected(u, m_devices.primary()))
+        return;
+
     auto device_ = deserializeDevice(u, message);
     if (!device_.has_value())
         return;
 
-    if (checkDeviceId(u, device_.value().deviceId))
+    const int deviceId = device_.value().deviceId;
+    if (checkDeviceId(u, deviceId))
         return;
 
-    bool ok = m_module->connect(device_.value().deviceId);
-    if (checkConnectResult(u, device_.value().deviceId, ok))
+    DeviceChannel *target = (m_devices.size() == 1) ? &m_devices.primary() : m_devices.findByDevice(deviceId);
+    if (target == nullptr)
+    {
+        checkConnectResult(u, deviceId, false);
         return;
+    }
 
-    pkg::Status ok_;
-    ok_.status = 0;
-    ok_.what = "";
-    ok_.subMessage = "";
-    writeToSock(u.first, serialize(ok_));
+    if (m_devices.size() > 1 && checkAlreadyConnected(u, *target))
+        return;
+
+    target->post([this, u, deviceId, context = t_request](DeviceChannel &channel) {
+        RequestScope scope(context);
+        bool ok = channel.module().connect(deviceId);
+        m_inventory.invalidate();
+        if (checkConnectResult(u, deviceId, ok))
+            return;
+
+        channel.setDeviceId(deviceId);
+        m_supervisor.watch(channel);
+        detectFirmware(channel);
+        publishEvent(mms::Event{"connected", std::format("device {}", deviceId), "reconnect", 0, "", {}});
+
+        pkg::Status ok_;
+        ok_.status = 0;
+        ok_.what = "";
+        ok_.subMessage = "";
+        reply(u, ok_);
+    }, u.name);
 }
 
 void UserCore::disconnect(const uinfo &u, const std::string &message)
@@ -462,63 +1290,125 @@ void UserCore::disconnect(const uinfo &u, const std::string &message)
     if (checkConnection(u))
         return;
 
-    m_module->disconnect();
+    auto pending = std::make_shared<PendingReply>(u, m_devices.size());
+    for (size_t i = 0; i < m_devices.size(); ++i)
+    {
+        m_supervisor.release(m_devices[i]);
+        m_devices[i].post([this, pending, context = t_request](DeviceChannel &channel) {
+            RequestScope scope(context);
+            channel.module().disconnect();
+            channel.setFirmware({});
+            m_inventory.invalidate();
+            const std::string device = std::format("device {}", channel.deviceId());
+            publishEvent(mms::Event{"disconnected", device, "disconnect", 0, "", {}});
+            finishPart(pending, pkg::Status{"", "", 0});
+        }, u.name);
+    }
+}
+
+void UserCore::listconnect(const uinfo &u, const std::string &message)
+{
+    if (checkEmptyMessage(u, message))
+        return;
+
+    const auto inventory = m_inventory.snapshot();
+    if (inventory->generation != m_listGeneration)
+    {
+        mms::ListConnect list;
+        for (const auto &device : inventory->devices)
+        {
+            // Если строка не пустая после очистки, добавляем её
+            if (auto cleanDevice = cleanDeviceName(device); !cleanDevice.empty())
+                list.listConnect.push_back(std::move(cleanDevice));
+        }
+
+        // Если нет устройств, добавляем заглушку
+        if (list.listConnect.empty())
+            list.listConnect.push_back("No devices found");
+
+        m_listMessage = serialize(list);
+        m_listGeneration = inventory->generation;
+    }
 
     pkg::Status ok_;
     ok_.status = 0;
-    ok_.what = "";
-    ok_.subMessage = "";
-    writeToSock(u.first, serialize(ok_));
+    ok_.what = "mms::ListConnect";
+    ok_.subMessage = m_listMessage;
+    reply(u, ok_);
 }
 
-void UserCore::listconnect(const uinfo &u, const std::string &message)
+void UserCore::status(const uinfo &u, const std::string &message)
 {
     if (checkEmptyMessage(u, message))
         return;
 
-    mms::ListConnect list;
-    auto rawDevices = m_module->listComs();
-
-    // Очистка и валидация строк для корректного UTF-8
-    for (const auto &device : rawDevices)
+    mms::MotorsState state;
+    for (int motor = m_devices.firstMotor(); motor <= m_devices.lastMotor(); ++motor)
     {
-        std::string cleanDevice = device;
+        if (m_devices.findByMotor(motor) != nullptr)
+            state.motors.push_back(m_motors.get(motor));
+    }
 
-        // Удаляем невалидные UTF-8 символы (символы с кодом > 127)
-        cleanDevice.erase(
-            std::remove_if(
-                cleanDevice.begin(),
-                cleanDevice.end(),
-                [](char c) { return static_cast<unsigned char>(c) > 127; }),
-            cleanDevice.end());
+    pkg::Status ok_;
+    ok_.status = 0;
+    ok_.what = "mms::MotorsState";
+    ok_.subMessage = serialize(state);
+    reply(u, ok_);
+}
 
-        // Дополнительная проверка на наличие обратных кавычек (0x60)
-        cleanDevice.erase(
-            std::remove_if(
-                cleanDevice.begin(),
-                cleanDevice.end(),
-                [](char c) {
-                    return c == 0x60; // Удаляем обратные кавычки
-                }),
-            cleanDevice.end());
+void UserCore::subscribe(const uinfo &u, const std::string &message)
+{
+    if (checkEmptyMessage(u, message))
+        return;
+
+    m_events.subscribe(u.fd, u.name);
+    reply(u, pkg::Status{"", "", 0});
+}
+
+void UserCore::unsubscribe(const uinfo &u, const std::string &message)
+{
+    if (checkEmptyMessage(u, message))
+        return;
+
+    m_events.unsubscribe(u.fd);
+    reply(u, pkg::Status{"", "", 0});
+}
+
+void UserCore::stop(const uinfo &u, const std::string &message)
+{
+    if (checkEmptyMessage(u, message))
+        return;
 
-        // Если строка не пустая после очистки, добавляем её
-        if (!cleanDevice.empty())
+    // Не через post(): очередь платы может быть занята движением, которое и нужно остановить
+    size_t stopped = 0;
+    for (size_t i = 0; i < m_devices.size(); ++i)
+    {
+        DeviceChannel &channel = m_devices[i];
+        if (!channel.module().isConnected())
+            continue;
+
+        try
+        {
+            channel.emergencyStop();
+            ++stopped;
+        }
+        catch (const std::exception &e)
         {
-            list.listConnect.push_back(cleanDevice);
+            MMS_LOG_ERROR("core", "[device {}] emergency stop: {}", channel.deviceId(), e.what());
         }
     }
+    m_clock->wakeAll();
 
-    // Если нет устройств, добавляем заглушку
-    if (list.listConnect.empty())
+    if (stopped == 0)
     {
-        list.listConnect.push_back("No devices found");
+        pkg::Status merr_;
+        merr_.status = 40507; // TODO: #001
+        merr_.what = std::format("[{}]: Module is not connected", u.name);
+        merr_.subMessage = "";
+        reply(u, merr_);
+        return;
     }
 
-    pkg::Status ok_;
-    ok_.status = 0;
-    ok_.what = "mms::ListConnect";
-    ok_.subMessage = serialize(list);
-    writeToSock(u.first, serialize(ok_));
+    MMS_LOG_WARN("core", "[STOP]({}): {} board(s)", u.name, stopped);
+    reply(u, pkg::Status{"", "", 0});
 }
-
@@ -0,0 +1,414 @@
+#include "load_generator.hpp"
+
+#include "dataframe.hpp"
+#include "network_serializer.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+#include <format>
+#include <sstream>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t READ_CHUNK = 4096;
+
+struct InFlight
+{
+    LoadCommand command;
+    Clock::time_point intended;
+    Clock::time_point sent;
+};
+
+struct Connection
+{
+    int fd = -1;
+    std::string rx;
+    std::deque<InFlight> inFlight;
+    Clock::time_point due; // время следующей отправки по расписанию
+    bool alive = false;
+};
+
+int openConnection(const LoadConfig &config)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config.port);
+    addr.sin_addr.s_addr = inet_addr(config.host.c_str());
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool sendAll(int fd, const std::string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string microseconds(uint64_t ns)
+{
+    return std::format("{:.1f}", static_cast<double>(ns) / 1000.0);
+}
+} // namespace
+
+LoadCommand CommandMix::pick(uint64_t n) const
+{
+    const unsigned weights[] = {version, listconnect, moving};
+    const unsigned sum = total();
+    if (sum == 0)
+        return LoadCommand::Version;
+
+    int current[std::size(weights)]{};
+    size_t chosen = 0;
+    for (uint64_t step = 0; step <= n % sum; ++step)
+    {
+        chosen = 0;
+        for (size_t i = 0; i < std::size(weights); ++i)
+        {
+            current[i] += static_cast<int>(weights[i]);
+            if (current[i] > current[chosen])
+                chosen = i;
+        }
+        current[chosen] -= static_cast<int>(sum);
+    }
+    return static_cast<LoadCommand>(chosen);
+}
+
+std::optional<CommandMix> CommandMix::parse(const std::string &text)
+{
+    CommandMix mix{0, 0, 0};
+    std::istringstream items(text);
+    for (std::string item; std::getline(items, item, ',');)
+    {
+        const auto eq = item.find('=');
+        if (eq == std::string::npos || eq + 1 == item.size())
+            return std::nullopt;
+
+        const std::string key = item.substr(0, eq);
+        const std::string value = item.substr(eq + 1);
+        const bool digits = std::all_of(value.begin(), value.end(), [](char c) { return c >= '0' && c <= '9'; });
+        if (!digits || value.size() > 6)
+            return std::nullopt;
+
+        const auto weight = static_cast<unsigned>(std::stoul(value));
+        if (key == "version")
+            mix.version = weight;
+        else if (key == "listconnect")
+            mix.listconnect = weight;
+        else if (key == "moving")
+            mix.moving = weight;
+        else
+            return std::nullopt;
+    }
+
+    if (mix.total() == 0)
+        return std::nullopt;
+    return mix;
+}
+
+std::string LoadReport::format() const
+{
+    std::string text;
+    text += std::format(
+        "requests: sent {}, completed {}, errors {}, unanswered {}, late {}\n",
+        sent,
+        completed,
+        errors,
+        unanswered,
+        late);
+    text += std::format(
+        "commands: version {}, listconnect {}, moving {}\n",
+        perCommand[static_cast<size_t>(LoadCommand::Version)],
+        perCommand[static_cast<size_t>(LoadCommand::ListConnect)],
+        perCommand[static_cast<size_t>(LoadCommand::Moving)]);
+    if (connectionsFailed != 0)
+        text += std::format("connections failed: {}\n", connectionsFailed);
+    text += std::format("elapsed {:.3f} s, throughput {:.1f} req/s\n", elapsedSec, throughput());
+
+    constexpr auto ROW = "{:<10}{:>12}{:>12}{:>12}{:>12}{:>12}{:>12}{:>12}\n";
+    text += std::format(ROW, "latency", "mean", "p50", "p90", "p99", "p99.9", "p99.99", "max");
+    for (const auto &[label, data] : {std::pair{"service", &service}, std::pair{"corrected", &corrected}})
+    {
+        text += std::format(
+            ROW,
+            label,
+            std::format("{:.1f}", data->meanNs() / 1000.0),
+            microseconds(data->percentile(0.5)),
+            microseconds(data->percentile(0.9)),
+            microseconds(data->percentile(0.99)),
+            microseconds(data->percentile(0.999)),
+            microseconds(data->percentile(0.9999)),
+            microseconds(data->maxNs));
+    }
+    text += "(us)\n";
+    return text;
+}
+
+LoadGenerator::LoadGenerator(LoadConfig config)
+    : m_config(std::move(config))
+{
+    m_config.connections = std::max<size_t>(m_config.connections, 1);
+    m_config.maxInFlight = std::max<size_t>(m_config.maxInFlight, 1);
+}
+
+const char *LoadGenerator::commandName(LoadCommand command)
+{
+    switch (command)
+    {
+    case LoadCommand::Version:
+        return "version";
+    case LoadCommand::ListConnect:
+        return "listconnect";
+    case LoadCommand::Moving:
+        return "moving";
+    default:
+        return "unknown";
+    }
+}
+
+std::string LoadGenerator::request(LoadCommand command, int id, size_t motors)
+{
+    NetworkSerializer serializer;
+    std::string message;
+    if (command == LoadCommand::Moving)
+    {
+        mms::MotorsSettings settings;
+        settings.mode = "synchronous";
+        for (size_t i = 0; i < motors; ++i)
+            settings.motors.push_back(mms::Motor{static_cast<int>(i + 1), 2000, 5000, 100});
+        message = serializer.serialize(settings);
+    }
+
+    mms::Manager manager;
+    manager.command = commandName(command);
+    manager.message = std::move(message);
+
+    pkg::Message packet;
+    packet.id = id;
+    packet.text = serializer.serialize(manager);
+    return serializer.serialize(packet);
+}
+
+std::optional<LoadCommand> LoadGenerator::classify(
+    const std::string &what,
+    const std::string &subMessage,
+    uint32_t status)
+{
+    if (status != 0)
+        return std::nullopt;
+    if (what == "mms::Version")
+        return LoadCommand::Version;
+    if (what == "mms::ListConnect")
+        return LoadCommand::ListConnect;
+    if (what.empty() && subMessage.empty())
+        return LoadCommand::Moving;
+    return std::nullopt;
+}
+
+LoadReport LoadGenerator::run()
+{
+    LoadReport report;
+    LatencyHistogram service;
+    LatencyHistogram corrected;
+    NetworkSerializer serializer;
+
+    const bool open = m_config.mode == LoadMode::Open && m_config.rate > 0.0;
+    const bool paced = m_config.rate > 0.0;
+    // В Closed с rate каждое соединение держит свою долю частоты, в Open расписание общее
+    const auto interval = paced ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(
+                                      static_cast<double>(m_config.connections) / m_config.rate))
+                                : Clock::duration::zero();
+
+    std::vector<Connection> connections(m_config.connections);
+    for (size_t i = 0; i < connections.size(); ++i)
+    {
+        auto &connection = connections[i];
+        connection.fd = openConnection(m_config);
+        if (connection.fd < 0)
+        {
+            ++report.connectionsFailed;
+            continue;
+        }
+
+        pkg::WhoWantsToTalkToMe hello;
+        hello.name = std::format("{}-{}", m_config.name, i);
+        connection.alive = sendAll(connection.fd, serializer.serialize(hello) + "\n\n");
+        if (!connection.alive)
+            ++report.connectionsFailed;
+    }
+
+    const auto started = Clock::now();
+    const auto sendUntil = started + m_config.duration;
+    const auto drainUntil = sendUntil + m_config.drainTimeout;
+    for (size_t i = 0; i < connections.size(); ++i)
+    {
+        const auto offset = paced ? std::chrono::duration_cast<Clock::duration>(
+                                        std::chrono::duration<double>(static_cast<double>(i) / m_config.rate))
+                                  : Clock::duration::zero();
+        connections[i].due = started + offset;
+    }
+
+    // Closed - один запрос в полете на соединение, Open - до maxInFlight
+    auto canSend = [&](const Connection &connection) {
+        return open ? connection.inFlight.size() < m_config.maxInFlight : connection.inFlight.empty();
+    };
+
+    uint64_t sequence = 0;
+    auto lastReply = started;
+    std::vector<pollfd> fds(connections.size());
+    auto completeOne = [&](Connection &connection, const std::string &frame, Clock::time_point now) {
+        std::optional<LoadCommand> command;
+        uint32_t status = 0;
+        try
+        {
+            const auto reply = serializer.deserialize<pkg::Status>(frame);
+            status = reply.status;
+            command = classify(reply.what, reply.subMessage, reply.status);
+        }
+        catch (const std::exception &)
+        {
+            status = 1;
+        }
+
+        if (connection.inFlight.empty())
+            return;
+
+        auto match = connection.inFlight.begin();
+        if (command.has_value())
+        {
+            auto &queue = connection.inFlight;
+            auto found = std::find_if(
+                queue.begin(), queue.end(), [&](const InFlight &request) { return request.command == *command; });
+            if (found != connection.inFlight.end())
+                match = found;
+        }
+
+        service.record(now - match->sent);
+        corrected.record(now - match->intended);
+        ++report.completed;
+        lastReply = now;
+        ++report.perCommand[static_cast<size_t>(match->command)];
+        if (status != 0)
+            ++report.errors;
+        connection.inFlight.erase(match);
+    };
+
+    while (true)
+    {
+        auto now = Clock::now();
+        const bool sending = now < sendUntil;
+        bool pending = false;
+        auto nextDue = sendUntil;
+
+        for (auto &connection : connections)
+        {
+            if (!connection.alive)
+                continue;
+
+            while (sending && connection.due <= now)
+            {
+                if (!canSend(connection))
+                    break;
+
+                const auto command = m_config.mix.pick(sequence);
+                if (open && now - connection.due > interval)
+                    ++report.late;
+
+                const std::string packet = request(command, static_cast<int>(sequence), m_config.motors) + "\n\n";
+                if (!sendAll(connection.fd, packet))
+                {
+                    connection.alive = false;
+                    break;
+                }
+
+                ++sequence;
+                ++report.sent;
+                now = Clock::now();
+                connection.inFlight.push_back(InFlight{command, paced ? connection.due : now, now});
+                connection.due = paced ? connection.due + interval : now;
+            }
+
+            pending = pending || !connection.inFlight.empty();
+            if (connection.alive && canSend(connection) && connection.due < nextDue)
+                nextDue = connection.due;
+        }
+
+        if (!sending && (!pending || now >= drainUntil))
+            break;
+
+        // Ждем ответов до следующей отправки по расписанию; меньше миллисекунды - опрос без ожидания
+        int timeoutMs = 1;
+        if (sending)
+        {
+            const auto untilDue = std::chrono::duration_cast<std::chrono::milliseconds>(nextDue - now).count();
+            timeoutMs = static_cast<int>(std::clamp<int64_t>(untilDue, 0, 100));
+        }
+
+        for (size_t i = 0; i < connections.size(); ++i)
+            fds[i] = pollfd{connections[i].alive ? connections[i].fd : -1, POLLIN, 0};
+
+        if (poll(fds.data(), fds.size(), timeoutMs) <= 0)
+            continue;
+
+        now = Clock::now();
+        for (size_t i = 0; i < connections.size(); ++i)
+        {
+            auto &connection = connections[i];
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+
+            char buffer[READ_CHUNK];
+            ssize_t n = read(connection.fd, buffer, sizeof(buffer));
+            if (n <= 0)
+            {
+                connection.alive = false;
+                continue;
+            }
+            connection.rx.append(buffer, static_cast<size_t>(n));
+
+            for (size_t end; (end = connection.rx.find("\n\n")) != std::string::npos;)
+            {
+                const std::string frame = connection.rx.substr(0, end);
+                connection.rx.erase(0, end + 2);
+                if (!frame.empty())
+                    completeOne(connection, frame, now);
+            }
+        }
+    }
+
+    // Хвост ожидания ответов, которые так и не пришли, в пропускную способность не входит
+    const auto finished = std::max(std::min(Clock::now(), sendUntil), lastReply);
+    report.elapsedSec = std::chrono::duration<double>(finished - started).count();
+    for (auto &connection : connections)
+    {
+        report.unanswered += connection.inFlight.size();
+        if (connection.fd >= 0)
+            close(connection.fd);
+    }
+
+    report.service = service.snapshot();
+    report.corrected = corrected.snapshot();
+    return report;
+}
@@ -0,0 +1,76 @@
+#include "load_generator.hpp"
+
+#include <format>
+#include <iostream>
+#include <regex>
+
+/*
+ * Нагрузочный клиент сервиса, например:
+ *   mms_loadgen --connections 8 --mode open --rate 2000 --duration 30 --mix version=1,listconnect=8,moving=1
+ *   mms_loadgen --connections 32 --mode closed --mix listconnect=1
+ *
+ * --host IP (127.0.0.1), --port PORT (38000), --connections N (1), --mode open|closed (closed),
+ * --rate REQ_PER_SEC (0 - без расписания, для open обязателен), --duration SEC (10),
+ * --mix version=W,listconnect=W,moving=W (version=1,listconnect=1), --motors N (1),
+ * --in-flight N (64, очередь соединения в open), --name PREFIX (loadgen).
+ * */
+int main(int argc, char *argv[])
+{
+    static const std::regex number("[0-9]{1,9}");
+    static const std::regex real("[0-9]{1,9}(\\.[0-9]+)?");
+
+    LoadConfig config;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string key = argv[i];
+        const std::string value = (i + 1 < argc) ? argv[i + 1] : "";
+        bool ok = !value.empty();
+
+        if (ok && key == "--host")
+            config.host = value;
+        else if (ok && key == "--port" && std::regex_match(value, number))
+            config.port = std::stoi(value);
+        else if (ok && key == "--connections" && std::regex_match(value, number))
+            config.connections = std::stoul(value);
+        else if (ok && key == "--mode" && (value == "open" || value == "closed"))
+            config.mode = (value == "open") ? LoadMode::Open : LoadMode::Closed;
+        else if (ok && key == "--rate" && std::regex_match(value, real))
+            config.rate = std::stod(value);
+        else if (ok && key == "--duration" && std::regex_match(value, real))
+            config.duration = std::chrono::milliseconds(static_cast<int64_t>(std::stod(value) * 1000.0));
+        else if (ok && key == "--motors" && std::regex_match(value, number))
+            config.motors = std::stoul(value);
+        else if (ok && key == "--in-flight" && std::regex_match(value, number))
+            config.maxInFlight = std::stoul(value);
+        else if (ok && key == "--name")
+            config.name = value;
+        else if (auto mix = ok && key == "--mix" ? CommandMix::parse(value) : std::nullopt; mix.has_value())
+            config.mix = *mix;
+        else
+        {
+            std::cerr << std::format("Invalid argument \"{}\", see the header of loadgen_main.cpp", key)
+                      << std::endl;
+            return 1;
+        }
+        ++i;
+    }
+
+    if (config.mode == LoadMode::Open && config.rate <= 0.0)
+    {
+        std::cerr << "Open loop needs --rate" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::format(
+        "{}:{}, {} connection(s), {} loop, rate {}, {} ms",
+        config.host,
+        config.port,
+        config.connections,
+        config.mode == LoadMode::Open ? "open" : "closed",
+        config.rate > 0.0 ? std::format("{:.1f} req/s", config.rate) : "max",
+        config.duration.count()) << std::endl;
+
+    const LoadReport report = LoadGenerator(config).run();
+    std::cout << report.format();
+    return report.connectionsFailed == config.connections ? 2 : 0;
+}
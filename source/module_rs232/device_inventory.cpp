@@ -0,0 +1,244 @@
+#include "device_inventory.hpp"
+
+#include "logger.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <string_view>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#endif
+
+namespace
+{
+/*
+ * @brief Сокет uevent ядра (то же, что слушает udev), -1 если недоступен
+ * */
+int openHotplugSocket()
+{
+#ifdef __linux__
+    const int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0)
+        return -1;
+
+    sockaddr_nl addr{};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = 1; // события ядра
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+/*
+ * @brief Прочитать все пришедшие uevent
+ * @return true, если среди них есть событие подсистемы usb или tty
+ * */
+bool drainHotplug(int fd)
+{
+    bool relevant = false;
+    char buffer[4096];
+    while (true)
+    {
+        const ssize_t n = ::recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n <= 0)
+            break;
+
+        // Поля события разделены '\0': "add@/devices/...\0ACTION=add\0SUBSYSTEM=usb\0..."
+        const std::string_view event(buffer, static_cast<size_t>(n));
+        if (event.find("SUBSYSTEM=usb") != std::string_view::npos
+            || event.find("SUBSYSTEM=tty") != std::string_view::npos)
+            relevant = true;
+    }
+    return relevant;
+}
+
+void drainPipe(int fd)
+{
+    char buffer[64];
+    while (::read(fd, buffer, sizeof(buffer)) > 0)
+    {
+    }
+}
+} // namespace
+
+DeviceInventory::DeviceInventory(
+    Source source, std::chrono::milliseconds interval, std::chrono::milliseconds hotplugInterval)
+    : m_source(std::move(source))
+    , m_interval(interval)
+    , m_hotplugInterval(hotplugInterval)
+    , m_current(std::make_shared<const Snapshot>())
+    , m_enumerations(MetricsRegistry::instance().counter(
+          "mms_device_enumerations_total", "USB device enumerations made by the device inventory"))
+{}
+
+DeviceInventory::~DeviceInventory()
+{
+    stop();
+}
+
+void DeviceInventory::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running)
+        return;
+
+    if (pipe(m_wakePipe) != 0)
+    {
+        MMS_LOG_ERROR("inventory", "Failed to create wake pipe, device list is refreshed on request");
+        return;
+    }
+    fcntl(m_wakePipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(m_wakePipe[1], F_SETFL, O_NONBLOCK);
+
+    m_hotplugFd = openHotplugSocket();
+    if (m_hotplugFd < 0)
+        MMS_LOG_INFO("inventory", "Hotplug events unavailable, refreshing every {} ms", m_interval.count());
+    else
+        MMS_LOG_INFO("inventory", "Refreshing on hotplug events and every {} ms", m_hotplugInterval.count());
+
+    m_running = true;
+    m_thread = std::thread(&DeviceInventory::workerLoop, this);
+}
+
+void DeviceInventory::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+            return;
+        m_running = false;
+    }
+    wake();
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    for (int *fd : {&m_wakePipe[0], &m_wakePipe[1], &m_hotplugFd})
+    {
+        if (*fd >= 0)
+            close(*fd);
+        *fd = -1;
+    }
+}
+
+std::shared_ptr<const DeviceInventory::Snapshot> DeviceInventory::snapshot()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_stale)
+            return m_current;
+    }
+
+    std::lock_guard<std::mutex> refreshing(m_refreshMutex);
+    {
+        // Пока шло ожидание m_refreshMutex, список мог обновить поток инвентаризации
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_stale)
+            return m_current;
+    }
+    enumerate();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_current;
+}
+
+bool DeviceInventory::refresh()
+{
+    std::lock_guard<std::mutex> refreshing(m_refreshMutex);
+    return enumerate();
+}
+
+void DeviceInventory::invalidate()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+        {
+            m_stale = true;
+            return;
+        }
+    }
+
+    // Перечислит поток инвентаризации, запросы до тех пор получают прежний список
+    wake();
+}
+
+bool DeviceInventory::enumerate()
+{
+    std::vector<std::string> devices;
+    try
+    {
+        devices = m_source();
+    }
+    catch (const std::exception &e)
+    {
+        MMS_LOG_ERROR("inventory", "Device enumeration failed: {}", e.what());
+        return false;
+    }
+    m_enumerations.inc();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stale = false;
+    if (devices == m_current->devices && m_current->generation != 0)
+        return false;
+
+    const uint64_t generation = m_current->generation + 1;
+    m_current = std::make_shared<const Snapshot>(Snapshot{std::move(devices), generation});
+    MMS_LOG_DEBUG("inventory", "Device list changed: {} device(s)", m_current->devices.size());
+    return true;
+}
+
+bool DeviceInventory::hotplug() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_running && m_hotplugFd >= 0;
+}
+
+void DeviceInventory::wake()
+{
+    if (m_wakePipe[1] >= 0)
+    {
+        const char byte = 1;
+        [[maybe_unused]] const ssize_t n = ::write(m_wakePipe[1], &byte, 1);
+    }
+}
+
+void DeviceInventory::workerLoop()
+{
+    // С hotplug-сокетом шину не опрашиваем каждые пару секунд: перечисление мешает открытому устройству
+    const auto interval = (m_hotplugFd >= 0) ? m_hotplugInterval : m_interval;
+    while (true)
+    {
+        refresh();
+
+        // Устройство появляется пачкой событий, а драйвер подхватывает его чуть позже
+        if (waitForChange(interval))
+            waitForChange(HOTPLUG_SETTLE);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+            break;
+    }
+}
+
+bool DeviceInventory::waitForChange(std::chrono::milliseconds timeout)
+{
+    pollfd fds[2] = {{m_wakePipe[0], POLLIN, 0}, {m_hotplugFd, POLLIN, 0}};
+    const nfds_t count = (m_hotplugFd >= 0) ? 2 : 1;
+    if (::poll(fds, count, static_cast<int>(timeout.count())) <= 0)
+        return false;
+
+    if (fds[0].revents & POLLIN)
+        drainPipe(m_wakePipe[0]);
+
+    return count == 2 && (fds[1].revents & POLLIN) && drainHotplug(m_hotplugFd);
+}
@@ -1,4 +1,5 @@
 #include "ft232rl.hpp"
+#include "logger.hpp"
 
 FT232RL::FT232RL() : m_deviceId(-1), m_baudrate(115200), m_connected(false) {}
 FT232RL::~FT232RL()
@@ -14,7 +15,7 @@ bool FT232RL::connect(const int deviceId)
 
     if (FT_STATUS code = FT_Open(deviceId, &ftHandle); code != FT_OK)
     {
-        std::cerr << "Failed to connect to device " << deviceId << ", error: " << code << std::endl;
+        MMS_LOG_ERROR("ft232rl", "Failed to connect to device {}, error: {}", deviceId, code);
         m_connected = false;
         return false;
     }
@@ -23,10 +24,7 @@ bool FT232RL::connect(const int deviceId)
     {
         if (FT_STATUS code = FT_SetBaudRate(ftHandle, m_baudrate); code != FT_OK)
             throw ModuleFT2xxException(code);
-        if (FT_STATUS code = FT_SetUSBParameters(ftHandle, 256, 256); code != FT_OK)
-            throw ModuleFT2xxException(code);
-        if (FT_STATUS code = FT_SetTimeouts(ftHandle, 1000, 1000); code != FT_OK)
-            throw ModuleFT2xxException(code);
+        applyLinkProfile(m_profile);
         getDeviceInfo(deviceId);
         m_connected = true;
         m_deviceId = deviceId;
@@ -64,7 +62,7 @@ std::vector<std::string> FT232RL::listComs() const
     DWORD numDevs;
     if (FT_STATUS code = FT_CreateDeviceInfoList(&numDevs); code != FT_OK)
     {
-        std::cerr << "Failed to get device list, error: " << code << std::endl;
+        MMS_LOG_ERROR("ft232rl", "Failed to get device list, error: {}", code);
         return devices;
     }
 
@@ -115,6 +113,45 @@ void FT232RL::setUSBParameters(const int dwRxSize, const int dwTxSize)
         throw ModuleFT2xxException(code);
 }
 
+void FT232RL::setLinkProfile(const LinkProfile &profile)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (m_connected)
+        applyLinkProfile(profile);
+    m_profile = profile;
+}
+
+LinkProfile FT232RL::getLinkProfile() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return m_profile;
+}
+
+void FT232RL::applyLinkProfile(const LinkProfile &profile)
+{
+    static const std::unordered_map<FlowControl, USHORT> flowControlCodes_ = {
+        {FlowControl::None, FT_FLOW_NONE},
+        {FlowControl::RtsCts, FT_FLOW_RTS_CTS},
+        {FlowControl::DtrDsr, FT_FLOW_DTR_DSR},
+        {FlowControl::XonXoff, FT_FLOW_XON_XOFF}};
+
+    if (FT_STATUS code = FT_SetUSBParameters(ftHandle, profile.rxTransferSize, profile.txTransferSize);
+        code != FT_OK)
+        throw ModuleFT2xxException(code);
+    if (FT_STATUS code = FT_SetLatencyTimer(ftHandle, profile.latencyTimerMs); code != FT_OK)
+        throw ModuleFT2xxException(code);
+    if (FT_STATUS code = FT_SetFlowControl(
+            ftHandle,
+            flowControlCodes_.at(profile.flowControl),
+            profile.xonChar,
+            profile.xoffChar);
+        code != FT_OK)
+        throw ModuleFT2xxException(code);
+    if (FT_STATUS code = FT_SetChars(ftHandle, profile.eventChar, profile.eventCharEnabled, 0, 0); code != FT_OK)
+        throw ModuleFT2xxException(code);
+    if (FT_STATUS code = FT_SetTimeouts(ftHandle, profile.readTimeoutMs, profile.writeTimeoutMs); code != FT_OK)
+        throw ModuleFT2xxException(code);
+}
 
 void FT232RL::setCharacteristics(const uchar wordlenght, const uchar stopbit, const uchar parity)
 {
@@ -138,7 +175,7 @@ void FT232RL::waitWriteSuccess()
     {
         if (FT_STATUS code = FT_GetStatus(ftHandle, &RxBytes, &TxBytes, &SxBytes); code != FT_OK)
             throw ModuleFT2xxException(code);
-        std::cout << RxBytes << ' ' << TxBytes << ' ' << SxBytes << ' ' << BytesWritten << std::endl;
+        MMS_LOG_TRACE("ft232rl", "{} {} {} {}", RxBytes, TxBytes, SxBytes, BytesWritten);
     }
 }
 
@@ -161,18 +198,18 @@ void FT232RL::getDeviceInfo(const int deviceId)
     if (FT_STATUS code = FT_CreateDeviceInfoList(&numDevs); code != FT_OK)
         throw ModuleFT2xxException(code);
 
-    if (((deviceId < 0) and (deviceId >= numDevs)))
+    if ((deviceId < 0) or (static_cast<DWORD>(deviceId) >= numDevs))
         throw ModuleFT2xxException(FT_DEVICE_NOT_FOUND);
 
     FT_STATUS code = FT_GetDeviceInfoDetail(
         deviceId,
-        &device_info_[deviceId].flags_,
-        &device_info_[deviceId].type_,
-        &device_info_[deviceId].id_,
-        &device_info_[deviceId].locId_,
-        device_info_[deviceId].serialNumber_,
-        device_info_[deviceId].description_,
-        &device_info_[deviceId].ftHandleTemp_);
+        &device_info_.flags_,
+        &device_info_.type_,
+        &device_info_.id_,
+        &device_info_.locId_,
+        device_info_.serialNumber_,
+        device_info_.description_,
+        &device_info_.ftHandleTemp_);
 
     if (code != FT_OK)
         throw ModuleFT2xxException(code);
@@ -181,12 +218,12 @@ void FT232RL::getDeviceInfo(const int deviceId)
 std::ostream &operator<<(std::ostream &os, const FT232RL &m_)
 {
     os << std::dec << "Dev " << m_.m_deviceId << ":" << std::endl;
-    os << std::hex << "\tFlags = 0x" << m_.device_info_[m_.m_deviceId].flags_ << std::endl;
-    os << std::hex << "\tType = 0x" << m_.device_info_[m_.m_deviceId].type_ << std::endl;
-    os << std::hex << "\tID = 0x" << m_.device_info_[m_.m_deviceId].id_ << std::endl;
-    os << std::hex << "\tLocId = 0x" << m_.device_info_[m_.m_deviceId].locId_ << std::endl;
-    os << std::dec << "\tSerialNumber = " << m_.device_info_[m_.m_deviceId].serialNumber_ << std::endl;
-    os << std::dec << "\tDescription = " << m_.device_info_[m_.m_deviceId].description_ << std::endl;
+    os << std::hex << "\tFlags = 0x" << m_.device_info_.flags_ << std::endl;
+    os << std::hex << "\tType = 0x" << m_.device_info_.type_ << std::endl;
+    os << std::hex << "\tID = 0x" << m_.device_info_.id_ << std::endl;
+    os << std::hex << "\tLocId = 0x" << m_.device_info_.locId_ << std::endl;
+    os << std::dec << "\tSerialNumber = " << m_.device_info_.serialNumber_ << std::endl;
+    os << std::dec << "\tDescription = " << m_.device_info_.description_ << std::endl;
     os << std::dec << "\tbaudrate = " << m_.m_baudrate << std::endl;
     return os;
 }
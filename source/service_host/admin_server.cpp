@@ -0,0 +1,151 @@
+#include "admin_server.hpp"
+#include "exceptions.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <format>
+
+namespace
+{
+constexpr int POLL_INTERVAL_MS = 200;
+constexpr size_t MAX_REQUEST = 8192;
+
+std::string httpResponse(const std::string &status, const std::string &contentType, const std::string &body)
+{
+    return std::format(
+        "HTTP/1.0 {}\r\nContent-Type: {}\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}",
+        status,
+        contentType,
+        body.size(),
+        body);
+}
+} // namespace
+
+AdminServer::AdminServer(const std::string &ip, int port)
+    : m_ip(ip)
+    , m_port(port)
+{}
+
+AdminServer::~AdminServer()
+{
+    stop();
+}
+
+void AdminServer::start()
+{
+    if (m_running)
+        return;
+
+    m_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_fd == -1)
+        throw SocketNotCreate();
+
+    int reuse = 1;
+    setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(m_ip.c_str());
+    addr.sin_port = htons(m_port);
+    if (bind(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+        close(m_fd);
+        throw BindFailure();
+    }
+
+    if (int listenCode = listen(m_fd, 16); listenCode)
+    {
+        close(m_fd);
+        throw ListenException(listenCode);
+    }
+
+    socklen_t len = sizeof(addr);
+    if (getsockname(m_fd, reinterpret_cast<sockaddr *>(&addr), &len) == 0)
+        m_port = ntohs(addr.sin_port);
+
+    m_running = true;
+    m_thread = std::thread(&AdminServer::serveLoop, this);
+    MMS_LOG_INFO("admin", "Metrics: http://{}:{}/metrics", m_ip, m_port);
+}
+
+void AdminServer::stop()
+{
+    if (!m_running.exchange(false))
+        return;
+
+    if (m_thread.joinable())
+        m_thread.join();
+    close(m_fd);
+    m_fd = -1;
+}
+
+void AdminServer::serveLoop()
+{
+    pollfd listener{m_fd, POLLIN, 0};
+    while (m_running)
+    {
+        if (poll(&listener, 1, POLL_INTERVAL_MS) <= 0 || !(listener.revents & POLLIN))
+            continue;
+
+        int client = accept(m_fd, nullptr, nullptr);
+        if (client < 0)
+            continue;
+
+        serveClient(client);
+        close(client);
+    }
+}
+
+void AdminServer::serveClient(int fd)
+{
+    std::string request;
+    char buffer[1024];
+    pollfd readable{fd, POLLIN, 0};
+
+    // Читаем до конца заголовков, медленный клиент не держит поток дольше одного интервала опроса
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST)
+    {
+        if (poll(&readable, 1, POLL_INTERVAL_MS) <= 0)
+            break;
+
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0)
+            break;
+        request.append(buffer, static_cast<size_t>(n));
+    }
+
+    const std::string response = respond(request);
+    size_t sent = 0;
+    while (sent < response.size())
+    {
+        ssize_t n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            MMS_LOG_WARN("admin", "Failed to send metrics response");
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+std::string AdminServer::respond(const std::string &request)
+{
+    const auto lineEnd = request.find("\r\n");
+    const std::string line = request.substr(0, lineEnd);
+
+    if (line.rfind("GET /metrics ", 0) == 0 || line == "GET /metrics")
+    {
+        return httpResponse(
+            "200 OK", "text/plain; version=0.0.4; charset=utf-8", MetricsRegistry::instance().render());
+    }
+
+    if (line.rfind("GET ", 0) == 0)
+        return httpResponse("404 Not Found", "text/plain", "Not found, try /metrics\n");
+
+    return httpResponse("400 Bad Request", "text/plain", "Bad request\n");
+}
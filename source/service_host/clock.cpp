@@ -0,0 +1,107 @@
+#include "clock.hpp"
+
+#include <thread>
+
+SystemClock &SystemClock::instance()
+{
+    static SystemClock clock;
+    return clock;
+}
+
+void SystemClock::sleepFor(Duration duration)
+{
+    std::this_thread::sleep_for(duration);
+}
+
+bool SystemClock::sleepFor(Duration duration, const std::function<bool()> &interrupted)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return !m_cv.wait_for(lock, duration, interrupted);
+}
+
+void SystemClock::wakeAll()
+{
+    // Под мьютексом: поток, который проверил условие, но еще не уснул, не пропустит пробуждение
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_cv.notify_all();
+}
+
+ManualClock::ManualClock(bool autoAdvance, TimePoint start)
+    : m_autoAdvance(autoAdvance)
+    , m_now(start)
+{}
+
+IClock::TimePoint ManualClock::now() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_now;
+}
+
+void ManualClock::sleepFor(Duration duration)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_autoAdvance)
+    {
+        m_now += duration;
+        m_cv.notify_all();
+        return;
+    }
+
+    const auto deadline = m_now + duration;
+    ++m_sleepers;
+    m_cv.notify_all();
+    m_cv.wait(lock, [this, deadline]() { return m_now >= deadline; });
+    --m_sleepers;
+}
+
+bool ManualClock::sleepFor(Duration duration, const std::function<bool()> &interrupted)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (interrupted())
+        return false;
+
+    if (m_autoAdvance)
+    {
+        m_now += duration;
+        m_cv.notify_all();
+        return true;
+    }
+
+    const auto deadline = m_now + duration;
+    ++m_sleepers;
+    m_cv.notify_all();
+    m_cv.wait(lock, [this, deadline, &interrupted]() { return m_now >= deadline || interrupted(); });
+    --m_sleepers;
+    return m_now >= deadline;
+}
+
+void ManualClock::wakeAll()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_cv.notify_all();
+}
+
+void ManualClock::advance(Duration duration)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_now += duration;
+    }
+    m_cv.notify_all();
+}
+
+size_t ManualClock::sleepers() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sleepers;
+}
+
+bool ManualClock::waitForSleepers(size_t count, std::chrono::milliseconds timeout) const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_cv.wait_for(lock, timeout, [this, count]() { return m_sleepers >= count; });
+}
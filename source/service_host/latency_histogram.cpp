@@ -0,0 +1,209 @@
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+
+void LatencyHistogram::recordNs(uint64_t ns)
+{
+    Shard &shard = m_shards[shardIndex()];
+    shard.buckets[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sumNs.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t max = shard.maxNs.load(std::memory_order_relaxed);
+    while (ns > max && !shard.maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+    {
+    }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    Snapshot result;
+    for (const auto &shard : m_shards)
+    {
+        result.count += shard.count.load(std::memory_order_relaxed);
+        result.sumNs += shard.sumNs.load(std::memory_order_relaxed);
+        result.maxNs = std::max(result.maxNs, shard.maxNs.load(std::memory_order_relaxed));
+        for (size_t i = 0; i < BUCKETS; ++i)
+            result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &shard : m_shards)
+    {
+        for (auto &bucket : shard.buckets)
+            bucket.store(0, std::memory_order_relaxed);
+        shard.count.store(0, std::memory_order_relaxed);
+        shard.sumNs.store(0, std::memory_order_relaxed);
+        shard.maxNs.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t ns)
+{
+    if (ns < SUB_BUCKETS)
+        return static_cast<size_t>(ns);
+
+    const auto exponent = static_cast<size_t>(std::bit_width(ns) - 1);
+    if (exponent > MAX_EXPONENT)
+        return BUCKETS - 1;
+
+    const size_t sub = static_cast<size_t>(ns >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+    if (index < SUB_BUCKETS)
+        return index;
+
+    const size_t shift = index / SUB_BUCKETS - 1; // exponent - SUB_BUCKET_BITS
+    const uint64_t lower = (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return lower + (uint64_t{1} << shift) - 1;
+}
+
+size_t LatencyHistogram::shardIndex()
+{
+    static std::atomic<size_t> next{0};
+    thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return index;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double q) const
+{
+    if (count == 0)
+        return 0;
+
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return std::min(bucketUpperBound(i), maxNs);
+    }
+    return maxNs;
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot &other)
+{
+    count += other.count;
+    sumNs += other.sumNs;
+    maxNs = std::max(maxNs, other.maxNs);
+    for (size_t i = 0; i < BUCKETS; ++i)
+        buckets[i] += other.buckets[i];
+}
+
+LatencyRegistry &LatencyRegistry::instance()
+{
+    static LatencyRegistry registry;
+    return registry;
+}
+
+LatencyRegistry::Stages &LatencyRegistry::scope(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto &stages = m_scopes[name];
+    if (!stages)
+        stages = std::make_unique<Stages>();
+    return *stages;
+}
+
+std::vector<LatencyRegistry::Row> LatencyRegistry::snapshot() const
+{
+    std::vector<Row> rows;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto &[name, stages] : m_scopes)
+        {
+            for (size_t i = 0; i < STAGE_COUNT; ++i)
+            {
+                const auto stage = static_cast<LatencyStage>(i);
+                auto data = (*stages)[stage].snapshot();
+                if (data.count != 0)
+                    rows.push_back(Row{name, stage, std::move(data)});
+            }
+        }
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) {
+        return (a.scope != b.scope) ? a.scope < b.scope : a.stage < b.stage;
+    });
+    return rows;
+}
+
+std::string LatencyRegistry::report() const
+{
+    std::string text = std::format(
+        "{:<12} {:<15} {:>8} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}\n",
+        "scope",
+        "stage",
+        "count",
+        "mean,us",
+        "p50,us",
+        "p90,us",
+        "p99,us",
+        "p99.9,us",
+        "max,us");
+
+    for (const auto &row : snapshot())
+    {
+        const auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+        text += std::format(
+            "{:<12} {:<15} {:>8} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}\n",
+            row.scope,
+            stageName(row.stage),
+            row.data.count,
+            row.data.meanNs() / 1000.0,
+            us(row.data.percentile(0.5)),
+            us(row.data.percentile(0.9)),
+            us(row.data.percentile(0.99)),
+            us(row.data.percentile(0.999)),
+            us(row.data.maxNs));
+    }
+    return text;
+}
+
+void LatencyRegistry::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &[name, stages] : m_scopes)
+    {
+        for (size_t i = 0; i < STAGE_COUNT; ++i)
+            (*stages)[static_cast<LatencyStage>(i)].reset();
+    }
+}
+
+const char *LatencyRegistry::stageName(LatencyStage stage)
+{
+    switch (stage)
+    {
+    case LatencyStage::SocketRead:
+        return "socket_read";
+    case LatencyStage::FrameSplit:
+        return "frame_split";
+    case LatencyStage::Parse:
+        return "parse";
+    case LatencyStage::Validate:
+        return "validate";
+    case LatencyStage::McuWrite:
+        return "mcu_write";
+    case LatencyStage::McuReadiness:
+        return "mcu_readiness";
+    case LatencyStage::McuCompletion:
+        return "mcu_completion";
+    case LatencyStage::Serialize:
+        return "serialize";
+    case LatencyStage::SocketWrite:
+        return "socket_write";
+    case LatencyStage::Total:
+        return "total";
+    default:
+        return "unknown";
+    }
+}
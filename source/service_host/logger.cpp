@@ -0,0 +1,198 @@
+#include "logger.hpp"
+
+#include <algorithm>
+#include <ctime>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+constexpr size_t MASK = Logger::CAPACITY - 1;
+static_assert((Logger::CAPACITY & MASK) == 0, "Logger::CAPACITY must be a power of two");
+} // namespace
+
+Logger &Logger::instance()
+{
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : m_ring(std::make_unique<Record[]>(CAPACITY))
+    , m_sink(stdout)
+{
+    for (size_t i = 0; i < CAPACITY; ++i)
+        m_ring[i].sequence.store(i, std::memory_order_relaxed);
+
+    m_batch.reserve(64 * 1024);
+    m_flusher = std::thread(&Logger::flusherLoop, this);
+}
+
+Logger::~Logger()
+{
+    m_running.store(false, std::memory_order_release);
+    if (m_flusher.joinable())
+        m_flusher.join();
+
+    while (drain())
+    {
+    }
+}
+
+void Logger::setSink(FILE *sink)
+{
+    flush();
+    std::lock_guard<std::mutex> lock(m_sinkMutex);
+    m_sink = sink;
+}
+
+void Logger::write(LogLevel level, const char *tag, std::string_view text)
+{
+    size_t position = 0;
+    Record *record = claim(position);
+    if (record == nullptr)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    std::copy_n(text.data(), std::min(text.size(), MAX_TEXT), record->text);
+    record->size = text.size();
+    publish(*record, position, level, tag);
+}
+
+Logger::Record *Logger::claim(size_t &position)
+{
+    position = m_head.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Record &record = m_ring[position & MASK];
+        const size_t sequence = record.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+        if (diff == 0)
+        {
+            if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                return &record;
+        }
+        else if (diff < 0)
+        {
+            return nullptr; // буфер заполнен, flusher не успевает
+        }
+        else
+        {
+            position = m_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::publish(Record &record, size_t position, LogLevel level, const char *tag)
+{
+    record.level = level;
+    record.tag = tag;
+    record.time = std::chrono::system_clock::now();
+    record.sequence.store(position + 1, std::memory_order_release);
+}
+
+bool Logger::drain()
+{
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    m_batch.clear();
+
+    while (true)
+    {
+        Record &record = m_ring[tail & MASK];
+        if (record.sequence.load(std::memory_order_acquire) != tail + 1)
+            break;
+
+        const auto time = std::chrono::system_clock::to_time_t(record.time);
+        const auto ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(record.time.time_since_epoch()).count() % 1000;
+        std::tm tm{};
+        localtime_r(&time, &tm);
+
+        std::format_to(
+            std::back_inserter(m_batch),
+            "[{:02d}:{:02d}:{:02d}.{:03d}] {} {}: ",
+            tm.tm_hour,
+            tm.tm_min,
+            tm.tm_sec,
+            ms,
+            levelName(record.level),
+            record.tag);
+        m_batch.append(record.text, std::min(record.size, MAX_TEXT));
+        if (record.size > MAX_TEXT)
+            m_batch.append("...");
+        m_batch.push_back('\n');
+
+        record.sequence.store(tail + CAPACITY, std::memory_order_release);
+        ++tail;
+    }
+
+    if (m_batch.empty())
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_sinkMutex);
+        std::fwrite(m_batch.data(), 1, m_batch.size(), m_sink);
+        std::fflush(m_sink);
+    }
+    m_tail.store(tail, std::memory_order_release);
+    return true;
+}
+
+void Logger::flusherLoop()
+{
+    while (m_running.load(std::memory_order_acquire))
+    {
+        if (!drain())
+            std::this_thread::sleep_for(1ms);
+    }
+}
+
+void Logger::flush()
+{
+    const size_t target = m_head.load(std::memory_order_acquire);
+    while (m_tail.load(std::memory_order_acquire) < target && m_running.load(std::memory_order_acquire))
+        std::this_thread::sleep_for(1ms);
+}
+
+bool Logger::parseLevel(std::string_view name, LogLevel &level)
+{
+    static constexpr std::pair<std::string_view, LogLevel> levels[] = {
+        {"trace", LogLevel::Trace},
+        {"debug", LogLevel::Debug},
+        {"info", LogLevel::Info},
+        {"warning", LogLevel::Warning},
+        {"error", LogLevel::Error},
+        {"off", LogLevel::Off}};
+
+    for (const auto &[levelName, value] : levels)
+    {
+        if (levelName == name)
+        {
+            level = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *Logger::levelName(LogLevel level)
+{
+    switch (level)
+    {
+    case LogLevel::Trace:
+        return "TRACE";
+    case LogLevel::Debug:
+        return "DEBUG";
+    case LogLevel::Info:
+        return "INFO";
+    case LogLevel::Warning:
+        return "WARN";
+    case LogLevel::Error:
+        return "ERROR";
+    default:
+        return "OFF";
+    }
+}
@@ -0,0 +1,121 @@
+#include "metrics.hpp"
+#include "latency_histogram.hpp"
+
+#include <format>
+#include <unordered_set>
+
+size_t metrics_detail::threadShard()
+{
+    static std::atomic<size_t> next{0};
+    thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return index;
+}
+
+MetricsRegistry &MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+namespace
+{
+std::string seriesKey(const std::string &name, const std::string &labels)
+{
+    return name + "{" + labels + "}";
+}
+} // namespace
+
+MetricsRegistry::Series *MetricsRegistry::find(const std::string &name, const std::string &labels)
+{
+    auto it = m_index.find(seriesKey(name, labels));
+    return (it != m_index.end()) ? it->second : nullptr;
+}
+
+void MetricsRegistry::add(std::unique_ptr<Series> series)
+{
+    m_index[seriesKey(series->name, series->labels)] = series.get();
+    m_series.push_back(std::move(series));
+}
+
+MetricCounter &MetricsRegistry::counter(const std::string &name, const std::string &help, const std::string &labels)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (Series *series = find(name, labels); series != nullptr && series->counter)
+        return *series->counter;
+
+    auto series = std::make_unique<Series>(Series{name, help, labels, std::make_unique<MetricCounter>(), nullptr});
+    auto &counter = *series->counter;
+    add(std::move(series));
+    return counter;
+}
+
+MetricGauge &MetricsRegistry::gauge(const std::string &name, const std::string &help, const std::string &labels)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (Series *series = find(name, labels); series != nullptr && series->gauge)
+        return *series->gauge;
+
+    auto series = std::make_unique<Series>(Series{name, help, labels, nullptr, std::make_unique<MetricGauge>()});
+    auto &gauge = *series->gauge;
+    add(std::move(series));
+    return gauge;
+}
+
+std::string MetricsRegistry::render() const
+{
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::unordered_set<std::string> described;
+        for (const auto &series : m_series)
+        {
+            if (described.insert(series->name).second)
+            {
+                text += std::format("# HELP {} {}\n", series->name, series->help);
+                text += std::format("# TYPE {} {}\n", series->name, series->counter ? "counter" : "gauge");
+            }
+
+            const std::string labels = series->labels.empty() ? "" : "{" + series->labels + "}";
+            if (series->counter)
+                text += std::format("{}{} {}\n", series->name, labels, series->counter->value());
+            else
+                text += std::format("{}{} {}\n", series->name, labels, series->gauge->value());
+        }
+    }
+
+    const auto rows = LatencyRegistry::instance().snapshot();
+    if (!rows.empty())
+    {
+        text += "# HELP mms_latency_seconds Command pipeline stage latency\n";
+        text += "# TYPE mms_latency_seconds summary\n";
+    }
+
+    for (const auto &row : rows)
+    {
+        const auto labels = std::format("scope=\"{}\",stage=\"{}\"", row.scope, LatencyRegistry::stageName(row.stage));
+        for (double q : {0.5, 0.9, 0.99, 0.999})
+        {
+            text += std::format(
+                "mms_latency_seconds{{{},quantile=\"{}\"}} {:.9f}\n",
+                labels,
+                q,
+                static_cast<double>(row.data.percentile(q)) / 1e9);
+        }
+        text += std::format(
+            "mms_latency_seconds_sum{{{}}} {:.9f}\n", labels, static_cast<double>(row.data.sumNs) / 1e9);
+        text += std::format("mms_latency_seconds_count{{{}}} {}\n", labels, row.data.count);
+    }
+    return text;
+}
+
+ServiceMetrics &ServiceMetrics::instance()
+{
+    auto &registry = MetricsRegistry::instance();
+    static ServiceMetrics metrics{
+        registry.gauge("mms_clients_connected", "Connected TCP clients"),
+        registry.gauge("mms_requests_in_flight", "Commands accepted by the core and not answered yet"),
+        registry.counter("mms_mcu_timeouts_total", "MCU did not answer in time (40511)"),
+        registry.counter("mms_bytes_received_total", "Bytes read from client sockets"),
+        registry.counter("mms_bytes_sent_total", "Bytes written to client sockets")};
+    return metrics;
+}
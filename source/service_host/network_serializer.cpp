@@ -1,4 +1,7 @@
 #include "network_serializer.hpp"
+#include "metrics.hpp"
+
+#include <cerrno>
 
 NetworkSerializer::NetworkSerializer() : MAX_BUFFER_COUNT(1024), socketInterface_(std::make_unique<Socket>())
 {}
@@ -35,17 +38,54 @@ std::string NetworkSerializer::readFromSock(const int socket_)
     }
 
     buffer.clear();
+    ServiceMetrics::instance().bytesReceived.inc(rxData.size());
     return rxData;
 }
 
+bool NetworkSerializer::readAvailable(const int socket_, std::string& buffer)
+{
+    const size_t before = buffer.size();
+    std::vector<char> chunk(MAX_BUFFER_COUNT);
+
+    while (true)
+    {
+        const auto bytesReceived =
+            static_cast<ssize_t>(socketInterface_->read(socket_, chunk.data(), chunk.size()));
+        if (bytesReceived == 0)
+            return false;
+
+        if (bytesReceived < 0)
+        {
+            // Все пришедшее уже прочитано
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+            break;
+        }
+
+        buffer.append(chunk.data(), bytesReceived);
+
+        // Неполное чтение - буфер сокета опустел, лишний вызов read() не нужен
+        if (static_cast<size_t>(bytesReceived) < chunk.size())
+            break;
+    }
+
+    ServiceMetrics::instance().bytesReceived.inc(buffer.size() - before);
+    return true;
+}
+
 void NetworkSerializer::writeToSock(const int socket_, std::string msg)
 {
     if (msg.find("\n\n") != std::string::npos)
         throw NotCorrectMessageToSend();
 
     msg += "\n\n";
-    const char* dataPtr = msg.c_str();
-    size_t dataSize = msg.length();
+    writeFramed(socket_, msg);
+}
+
+void NetworkSerializer::writeFramed(const int socket_, std::string_view frame)
+{
+    const char* dataPtr = frame.data();
+    size_t dataSize = frame.length();
     size_t totalSend = 0;
 
     while (totalSend < dataSize)
@@ -56,6 +96,7 @@ void NetworkSerializer::writeToSock(const int socket_, std::string msg)
 
         totalSend += bytesSend;
     }
+    ServiceMetrics::instance().bytesSent.inc(totalSend);
 }
 
 std::vector<std::string> NetworkSerializer::split(const std::string& message)
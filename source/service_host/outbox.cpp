@@ -0,0 +1,146 @@
+#include "outbox.hpp"
+
+#include <cerrno>
+
+#include <sys/socket.h>
+
+namespace
+{
+// Сокет закрыт клиентом - запись вернет -1 без SIGPIPE; буфер полон - -1 с EAGAIN вместо ожидания
+ssize_t sendNow(int fd, const char *data, size_t count)
+{
+    return ::send(fd, data, count, MSG_NOSIGNAL | MSG_DONTWAIT);
+}
+
+bool wouldBlock()
+{
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+} // namespace
+
+Outbox &Outbox::instance()
+{
+    static Outbox outbox;
+    return outbox;
+}
+
+void Outbox::open(int fd)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queues[fd] = Queue{};
+}
+
+void Outbox::close(int fd)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queues.erase(fd);
+}
+
+bool Outbox::write(int fd, const void *buf, size_t count, size_t &written)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_queues.find(fd);
+    if (it == m_queues.end())
+        return false;
+
+    Queue &queue = it->second;
+    written = static_cast<size_t>(-1);
+    if (queue.broken)
+        return true;
+
+    const char *data = static_cast<const char *>(buf);
+    size_t sent = 0;
+
+    // Очередь пуста - пишем сразу, иначе только в конец очереди: посылки не должны перемешаться
+    if (queue.size() == 0)
+    {
+        const ssize_t n = sendNow(fd, data, count);
+        if (n < 0 && !wouldBlock())
+        {
+            queue.broken = true;
+            return true;
+        }
+        sent = (n > 0) ? static_cast<size_t>(n) : 0;
+    }
+
+    const size_t rest = count - sent;
+    if (rest > 0)
+    {
+        if (queue.size() + rest > MAX_QUEUED_BYTES)
+        {
+            queue.broken = true;
+            return true;
+        }
+        if (queue.size() == 0)
+            queue.progress = std::chrono::steady_clock::now();
+        queue.data.append(data + sent, rest);
+    }
+
+    written = count;
+    return true;
+}
+
+Outbox::State Outbox::flush(int fd)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_queues.find(fd);
+    if (it == m_queues.end())
+        return State::Empty;
+
+    Queue &queue = it->second;
+    if (!queue.broken && !sendQueued(fd, queue))
+        queue.broken = true;
+    return stateOf(queue);
+}
+
+Outbox::State Outbox::state(int fd) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_queues.find(fd);
+    return (it == m_queues.end()) ? State::Empty : stateOf(it->second);
+}
+
+Outbox::TimePoint Outbox::stalledSince(int fd) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_queues.find(fd);
+    if (it == m_queues.end() || it->second.size() == 0)
+        return {};
+    return it->second.progress;
+}
+
+bool Outbox::sendQueued(int fd, Queue &queue)
+{
+    while (queue.size() > 0)
+    {
+        const ssize_t n = sendNow(fd, queue.data.data() + queue.head, queue.size());
+        if (n < 0)
+        {
+            if (!wouldBlock())
+                return false;
+            break;
+        }
+        queue.head += static_cast<size_t>(n);
+        queue.progress = std::chrono::steady_clock::now();
+    }
+
+    // Отправленное начало вырезается, когда занимает больше половины: сдвиг хвоста не на каждой записи
+    if (queue.size() == 0)
+    {
+        queue.data.clear();
+        queue.head = 0;
+    }
+    else if (queue.head > queue.data.size() / 2)
+    {
+        queue.data.erase(0, queue.head);
+        queue.head = 0;
+    }
+    return true;
+}
+
+Outbox::State Outbox::stateOf(const Queue &queue)
+{
+    if (queue.broken)
+        return State::Broken;
+    return (queue.size() > 0) ? State::Pending : State::Empty;
+}
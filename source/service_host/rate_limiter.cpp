@@ -0,0 +1,160 @@
+#include "rate_limiter.hpp"
+
+#include <algorithm>
+#include <format>
+#include <regex>
+
+namespace
+{
+// Значение метки Prometheus: \, " и перевод строки экранируются
+std::string labelValue(const std::string &value)
+{
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value)
+    {
+        if (c == '\n')
+        {
+            escaped += "\\n";
+            continue;
+        }
+        if (c == '\\' || c == '"')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+} // namespace
+
+bool RateLimit::parse(const std::string &text, RateLimit &limit)
+{
+    static const std::regex format("([0-9]+(\\.[0-9]+)?)(/([0-9]+))?");
+    std::smatch match;
+    if (!std::regex_match(text, match, format))
+        return false;
+
+    limit.rate = std::stod(match[1].str());
+    limit.burst = match[4].matched ? std::stod(match[4].str()) : std::max(limit.rate, 1.0);
+    return !limit.enabled() || limit.burst >= 1.0;
+}
+
+TokenBucket::TokenBucket(const RateLimit &limit, TimePoint now)
+    : m_rate(limit.rate)
+    , m_burst(limit.burst)
+    , m_tokens(limit.burst)
+    , m_updated(now)
+{}
+
+bool TokenBucket::tryTake(TimePoint now)
+{
+    if (now > m_updated)
+    {
+        const double elapsed = std::chrono::duration<double>(now - m_updated).count();
+        m_tokens = std::min(m_burst, m_tokens + elapsed * m_rate);
+        m_updated = now;
+    }
+
+    if (m_tokens < 1.0)
+        return false;
+    m_tokens -= 1.0;
+    return true;
+}
+
+bool TokenBucket::full(TimePoint now) const
+{
+    if (m_tokens >= m_burst)
+        return true;
+    const double elapsed = std::chrono::duration<double>(now - m_updated).count();
+    return elapsed > 0.0 && m_tokens + elapsed * m_rate >= m_burst;
+}
+
+void RateLimiter::setLimits(const RateLimit &connection, const RateLimit &client)
+{
+    m_connectionLimit = connection;
+    m_clientLimit = client;
+    m_connections.clear();
+    m_clients.clear();
+}
+
+RateLimiter::Verdict RateLimiter::admit(int fd, const std::string &name, TimePoint now)
+{
+    if (!m_connectionLimit.enabled() && !m_clientLimit.enabled())
+        return Verdict::Allowed;
+
+    Connection &connection =
+        m_connections.try_emplace(fd, Connection{TokenBucket(m_connectionLimit, now), nullptr}).first->second;
+
+    // Имя соединения известно после знакомства и больше не меняется
+    if (connection.client == nullptr && !name.empty())
+    {
+        connection.client = &client(name, now);
+        ++connection.client->second.connections;
+    }
+
+    if (m_connectionLimit.enabled() && !connection.bucket.tryTake(now))
+    {
+        if (connection.client != nullptr)
+            connection.client->second.byConnection->inc();
+        else
+            throttled(name, "connection").inc();
+        return Verdict::ConnectionLimited;
+    }
+
+    // До знакомства имени нет, ограничивает только предел соединения
+    if (m_clientLimit.enabled() && connection.client != nullptr)
+    {
+        Client &state = connection.client->second;
+        if (!state.bucket.tryTake(now))
+        {
+            state.byClient->inc();
+            return Verdict::ClientLimited;
+        }
+    }
+    return Verdict::Allowed;
+}
+
+void RateLimiter::forget(int fd)
+{
+    auto it = m_connections.find(fd);
+    if (it == m_connections.end())
+        return;
+
+    // Корзина имени остается: время последнего запроса хранит она сама, удаляет ее dropIdle()
+    if (auto *client = it->second.client; client != nullptr)
+        --client->second.connections;
+    m_connections.erase(it);
+}
+
+RateLimiter::Clients::value_type &RateLimiter::client(const std::string &name, TimePoint now)
+{
+    auto it = m_clients.find(name);
+    if (it != m_clients.end())
+        return *it;
+
+    dropIdle(now);
+    Client state{
+        TokenBucket(m_clientLimit, now), &throttled(name, "connection"), &throttled(name, "client"), 0};
+    return *m_clients.emplace(name, std::move(state)).first;
+}
+
+void RateLimiter::dropIdle(TimePoint now)
+{
+    for (auto it = m_clients.begin(); it != m_clients.end();)
+    {
+        if (it->second.connections == 0 && it->second.bucket.full(now))
+            it = m_clients.erase(it);
+        else
+            ++it;
+    }
+}
+
+MetricCounter &RateLimiter::throttled(const std::string &name, const char *scope)
+{
+    if (!m_labeled.count(name) && m_labeled.size() < MAX_LABELED_CLIENTS)
+        m_labeled.insert(name);
+    const std::string label = m_labeled.count(name) ? labelValue(name) : "other";
+
+    return MetricsRegistry::instance().counter("mms_requests_throttled_total",
+        "Requests rejected by the rate limit, by client name and limit",
+        std::format("client=\"{}\",scope=\"{}\"", label, scope));
+}
@@ -1,4 +1,6 @@
 #include "server.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
 
 void Server::launchServer()
 {
@@ -8,7 +10,7 @@ void Server::launchServer()
         throw ListenException(listenCode);
     }
     // Пусть будет выводится созданный сервер
-    std::cout << std::format("Server \'{}\' launch: {}:{}", core_->serverName_, ip_, port_) << std::endl;
+    MMS_LOG_INFO("server", "Server \'{}\' launch: {}:{}", core_->serverName_, ip_, port_);
 }
 
 void Server::settingsFileDescriptor()
@@ -28,48 +30,150 @@ void Server::checkingSocketsOnNewConnect()
 {
     if ((fds_[0].revents & POLLIN))
     {
-        clients_fds_[nfds_ - 1] = accept(server_fd_, (struct sockaddr*)&client_addr_, &client_len_);
+        const int fd = accept(server_fd_, (struct sockaddr*)&client_addr_, &client_len_);
+        if (fd < 0)
+        {
+            MMS_LOG_ERROR("server", "\"accept\" in checkingSocketsOnNewContentOrConnect");
+            return;
+        }
 
-        if (clients_fds_[nfds_ - 1] < 0)
-            std::cerr << "---> \"accept\" in checkingSocketsOnNewContentOrConnect" << std::endl;
+        // Слоты закрытых соединений используются снова, nfds_ растет, только когда свободных нет
+        int i = nfds_;
+        if (!freeSlots_.empty())
+        {
+            i = freeSlots_.back();
+            freeSlots_.pop_back();
+        }
+        else if (nfds_ <= MAX_CLIENTS)
+        {
+            ++nfds_;
+        }
+        else
+        {
+            MMS_LOG_WARN("server", "Too many clients ({}), connection refused", MAX_CLIENTS);
+            close(fd);
+            return;
+        }
+        ServiceMetrics::instance().clientsConnected.inc();
+
+        // Ни чтение, ни запись не ждут клиента: ответы, которые не влезли в буфер ядра, ждут в Outbox
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        outbox_.open(fd);
 
-        fds_[nfds_].fd = clients_fds_[(nfds_ - 1)];
-        fds_[nfds_].events = POLLIN;
-        ++nfds_;
+        clients_fds_[i - 1] = fd;
+        fds_[i].fd = fd;
+        fds_[i].events = POLLIN;
+        fds_[i].revents = 0;
+
+        const auto now = std::chrono::steady_clock::now();
+        connections_[i] = Connection{now, {}, 0};
+        if (timeouts_.handshake.count() > 0)
+            timers_.schedule(i, now + timeouts_.handshake);
     }
 }
 
 bool Server::ifMessageEmptyCloseSocket(const int i)
 {
-    for (auto client = clients_name_.begin(); client != clients_name_.end(); ++client)
+    // Соединение могло закрыться до знакомства: имени нет, и вставлять пустое нельзя - дескриптор
+    // достанется следующему клиенту
+    if (auto client = clients_name_.find(fds_[i].fd); client != clients_name_.end())
     {
-        if ((*client).second == clients_name_[fds_[i].fd])
-        {
-            std::cout << std::format("\t[USER-ERASE]({})\n", clients_name_[fds_[i].fd]);
-            clients_name_.erase(client);
-            break;
-        }
+        MMS_LOG_INFO("server", "[USER-ERASE]({})", client->second);
+        clients_name_.erase(client);
     }
+    core_->Disconnected(fds_[i].fd);
+    limiter_.forget(fds_[i].fd);
+    outbox_.close(fds_[i].fd);
     close(fds_[i].fd);
     fds_[i].fd = -1;
+    fds_[i].revents = 0;
+    connections_[i].input.clear();
+    timers_.cancel(i);
+    freeSlots_.push_back(i);
+    ServiceMetrics::instance().clientsConnected.dec();
     return true;
 }
 
+void Server::checkingTimers()
+{
+    const auto now = std::chrono::steady_clock::now();
+    timers_.advance(now, [this, now](size_t i) { checkingConnectionTimeouts(static_cast<int>(i), now); });
+}
+
+void Server::checkingConnectionTimeouts(const int i, std::chrono::steady_clock::time_point now)
+{
+    // Таймер соединения без имени стоит только на сроке знакомства
+    if (!clients_name_.count(fds_[i].fd))
+    {
+        expireConnection(i, "handshake");
+        return;
+    }
+
+    Connection& connection = connections_[i];
+    if (timeouts_.idle.count() > 0 && now - connection.lastActivity >= timeouts_.idle)
+    {
+        expireConnection(i, "idle");
+        return;
+    }
+
+    // Очередь отправки не двигалась весь срок: клиент не читает ответы
+    if (timeouts_.writeStall.count() > 0)
+    {
+        const auto stalledSince = outbox_.stalledSince(fds_[i].fd);
+        if (stalledSince != Outbox::TimePoint{} && now - stalledSince >= timeouts_.writeStall)
+        {
+            expireConnection(i, "write_stall");
+            return;
+        }
+    }
+    armConnectionTimer(i, now);
+}
+
+void Server::armConnectionTimer(const int i, std::chrono::steady_clock::time_point now)
+{
+    // Простой проверяется лениво: посылки только обновляют lastActivity, таймер не переставляется
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    if (timeouts_.idle.count() > 0)
+        deadline = connections_[i].lastActivity + timeouts_.idle;
+    if (timeouts_.writeStall.count() > 0)
+        deadline = std::min(deadline, now + timeouts_.writeStall / 2);
+
+    if (deadline == std::chrono::steady_clock::time_point::max())
+        timers_.cancel(i);
+    else
+        timers_.schedule(i, deadline);
+}
+
+void Server::expireConnection(const int i, const char* reason)
+{
+    auto client = clients_name_.find(fds_[i].fd);
+    MMS_LOG_INFO("server", "[USER-EXPIRE]({}) {}, fd {}",
+        (client != clients_name_.end()) ? client->second : std::string(), reason, fds_[i].fd);
+    MetricsRegistry::instance()
+        .counter("mms_connections_expired_total", "Connections closed by a deadline, by reason",
+            std::format("reason=\"{}\"", reason))
+        .inc();
+
+    // Запись в сокет не блокируется, ждать некого: неотправленная очередь отбрасывается при закрытии
+    ifMessageEmptyCloseSocket(i);
+}
+
 bool Server::get_WhoAmI_Info(const int i, std::string& message)
 {
     if (clients_name_.count(fds_[i].fd))
         return true;
 
-    std::cout << "->" << message << std::endl;
+    MMS_LOG_DEBUG("server", "->{}", message);
     try
     {
         auto aboutNewUser = deserialize<pkg::WhoWantsToTalkToMe>(message);
         clients_name_[fds_[i].fd] = std::move(aboutNewUser.name);
-        std::cout << std::format("\t[USER-ADD]({})\n", clients_name_[fds_[i].fd]);
+        MMS_LOG_INFO("server", "[USER-ADD]({})", clients_name_[fds_[i].fd]);
+        armConnectionTimer(i, std::chrono::steady_clock::now());
     }
     catch (const std::exception& e)
     {
-        std::cout << e.what() << std::endl;
+        MMS_LOG_WARN("server", "{}", e.what());
     }
     catch (...)
     { /* nothing */
@@ -78,6 +182,38 @@ bool Server::get_WhoAmI_Info(const int i, std::string& message)
     return false;
 }
 
+bool Server::admitRequest(const int i)
+{
+    static const std::string unnamed;
+    auto client = clients_name_.find(fds_[i].fd);
+    const std::string& name = (client != clients_name_.end()) ? client->second : unnamed;
+    if (limiter_.admit(fds_[i].fd, name, std::chrono::steady_clock::now()) == RateLimiter::Verdict::Allowed)
+    {
+        connections_[i].rejected = 0;
+        return true;
+    }
+
+    if (++connections_[i].rejected >= MAX_REJECTIONS)
+    {
+        expireConnection(i, "throttled");
+        return false;
+    }
+
+    // Отказ не встает в очередь за ответами: клиент, который их не читает, не увидит и его
+    if (outbox_.state(fds_[i].fd) != Outbox::State::Empty)
+        return false;
+
+    try
+    {
+        writeFramed(fds_[i].fd, throttledFrame_);
+    }
+    catch (const std::exception& emsg)
+    {
+        MMS_LOG_ERROR("server", "{}", emsg.what());
+    }
+    return false;
+}
+
 void Server::processTheRequest([[maybe_unused]] const int i, [[maybe_unused]] std::string& message)
 {
     try
@@ -86,7 +222,7 @@ void Server::processTheRequest([[maybe_unused]] const int i, [[maybe_unused]] st
     }
     catch (const std::exception& emsg)
     {
-        std::cerr << emsg.what() << std::endl;
+        MMS_LOG_ERROR("server", "{}", emsg.what());
     }
 }
 
@@ -94,41 +230,80 @@ void Server::checkingSocketsOnNewContent()
 {
     for (int i = 1; i < nfds_; ++i)
     {
-        if ((fds_[i].revents & POLLIN))
+        if ((fds_[i].revents & POLLOUT) && outbox_.flush(fds_[i].fd) == Outbox::State::Broken)
         {
-            std::string totalMessage = readFromSock(fds_[i].fd);
+            expireConnection(i, "write_failed");
+            continue;
+        }
 
-            // В сообщении приходит бесконечный поток, разибраем его
-            std::vector<std::string> messages = split(std::move(totalMessage));
+        if ((fds_[i].revents & POLLIN))
+        {
+            auto started = std::chrono::steady_clock::now();
+            Connection& connection = connections_[i];
+            connection.lastActivity = started;
+            const bool open = readAvailable(fds_[i].fd, connection.input);
+            auto received = std::chrono::steady_clock::now();
+            latency_[LatencyStage::SocketRead].record(received - started);
 
-            if (messages.empty())
+            // В сообщении приходит бесконечный поток, разбираем законченные посылки, хвост ждет продолжения
+            std::vector<std::string> messages;
+            if (const size_t end = connection.input.rfind("\n\n"); end != std::string::npos)
             {
-                ifMessageEmptyCloseSocket(i);
-                continue;
+                messages = split(connection.input.substr(0, end + 2));
+                connection.input.erase(0, end + 2);
             }
+            latency_[LatencyStage::FrameSplit].record(std::chrono::steady_clock::now() - received);
 
-            for (std::string message : messages)
+            for (std::string& message : messages)
             {
+                // Предел проверяется до разбора: отброшенная посылка не доходит до JSON и ядра
+                if (!admitRequest(i))
+                {
+                    if (fds_[i].fd == -1)
+                        break;
+                    continue;
+                }
+
                 if (get_WhoAmI_Info(i, message))
                 {
-                    std::cout << "=>" << message << std::endl;
+                    MMS_LOG_DEBUG("server", "=>{}", message);
                     processTheRequest(i, message);
                 }
-
-                message.clear();
             }
 
-            totalMessage.clear();
-            messages.clear();
+            if (fds_[i].fd == -1)
+                continue;
+            if (!open)
+                ifMessageEmptyCloseSocket(i);
+            else if (connection.input.size() > MAX_PENDING_INPUT)
+                expireConnection(i, "oversized_frame");
         }
     }
 }
 
+void Server::watchingPendingWrites()
+{
+    for (int i = 1; i < nfds_; ++i)
+    {
+        if (fds_[i].fd == -1)
+            continue;
+
+        const Outbox::State state = outbox_.state(fds_[i].fd);
+        if (state == Outbox::State::Broken)
+        {
+            expireConnection(i, "write_failed");
+            continue;
+        }
+        fds_[i].events = (state == Outbox::State::Pending) ? (POLLIN | POLLOUT) : POLLIN;
+    }
+}
+
 Server::Server(const std::string& IP, const int& PORT, std::unique_ptr<ICore> core)
     : NetworkSerializer()
     , ip_(IP)
     , port_(PORT)
     , core_(std::move(core))
+    , throttledFrame_(serialize(pkg::Status{"Rate limit exceeded", "", 40521}) + "\n\n")
 {
     server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
     if (server_fd_ == -1)
@@ -152,10 +327,23 @@ Server::~Server()
     for (int i = 1; i < nfds_; i++)
     {
         if (fds_[i].fd != -1)
+        {
+            outbox_.close(fds_[i].fd);
             close(fds_[i].fd);
+        }
     }
 }
 
+void Server::setRateLimits(const RateLimit& connection, const RateLimit& client)
+{
+    limiter_.setLimits(connection, client);
+}
+
+void Server::setTimeouts(const ConnectionTimeouts& timeouts)
+{
+    timeouts_ = timeouts;
+}
+
 int Server::run()
 {
     serverWorkStatus_ = false;
@@ -165,11 +353,13 @@ int Server::run()
 
     while (true)
     {
+        watchingPendingWrites();
         if (int ret = poll(fds_.get(), nfds_, 0); ret == -1)
             throw POLLDestroyed();
 
         checkingSocketsOnNewConnect();
         checkingSocketsOnNewContent();
+        checkingTimers();
         core_->Launch();
 
         if (serverWorkStatus_)
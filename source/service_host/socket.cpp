@@ -1,8 +1,16 @@
 #include "socket.hpp"
+#include "outbox.hpp"
+
+#include <sys/socket.h>
 
 size_t Socket::write(int fd, const void* buf, size_t count)
 {
-    return ::write(fd, buf, count);
+    // Сокеты клиентов Server неблокирующие: запись ставит остаток в очередь отправки, а не ждет клиента
+    if (size_t written = 0; Outbox::instance().write(fd, buf, count, written))
+        return written;
+
+    // Клиент мог закрыть соединение или сервер - прервать его по сроку: без SIGPIPE запись вернет -1
+    return ::send(fd, buf, count, MSG_NOSIGNAL);
 }
 
 size_t Socket::read(int fd, void* buf, size_t count)
@@ -0,0 +1,81 @@
+#include "timer_wheel.hpp"
+
+#include <algorithm>
+
+TimerWheel::TimerWheel(size_t capacity, Duration tick, size_t slots, TimePoint now)
+    : m_tick(tick)
+    , m_nodes(capacity)
+    , m_heads(std::max<size_t>(slots, 1), NONE)
+    , m_cursorTime(now)
+{}
+
+void TimerWheel::schedule(size_t key, TimePoint deadline)
+{
+    unlink(key);
+
+    // Тиков до срока с округлением вверх, не меньше одного: текущая ячейка уже обойдена
+    const Duration left = deadline - m_cursorTime;
+    const Duration::rep rounded = (left + m_tick - Duration(1)) / m_tick;
+    const auto ticks = static_cast<uint64_t>(std::max<Duration::rep>(rounded, 1));
+    const size_t slots = m_heads.size();
+    m_nodes[key].rounds = (ticks - 1) / slots;
+    link(key, (m_cursor + ticks) % slots);
+}
+
+void TimerWheel::cancel(size_t key)
+{
+    unlink(key);
+}
+
+bool TimerWheel::scheduled(size_t key) const
+{
+    return m_nodes[key].slot != NONE;
+}
+
+void TimerWheel::collectNextTick()
+{
+    m_cursorTime += m_tick;
+    m_cursor = (m_cursor + 1) % m_heads.size();
+
+    for (size_t key = m_heads[m_cursor]; key != NONE;)
+    {
+        Node &node = m_nodes[key];
+        const size_t next = node.next;
+        if (node.rounds == 0)
+        {
+            unlink(key);
+            m_fired.push_back(key);
+        }
+        else
+        {
+            --node.rounds;
+        }
+        key = next;
+    }
+}
+
+void TimerWheel::link(size_t key, size_t slot)
+{
+    Node &node = m_nodes[key];
+    node.slot = slot;
+    node.prev = NONE;
+    node.next = m_heads[slot];
+    if (node.next != NONE)
+        m_nodes[node.next].prev = key;
+    m_heads[slot] = key;
+}
+
+void TimerWheel::unlink(size_t key)
+{
+    Node &node = m_nodes[key];
+    if (node.slot == NONE)
+        return;
+
+    if (node.prev != NONE)
+        m_nodes[node.prev].next = node.next;
+    else
+        m_heads[node.slot] = node.next;
+    if (node.next != NONE)
+        m_nodes[node.next].prev = node.prev;
+    node = Node{};
+}
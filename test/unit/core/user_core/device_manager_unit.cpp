@@ -0,0 +1,171 @@
+#include "mocks.hpp"
+#include "device_manager.hpp"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+using ::testing::Return;
+using ::testing::Invoke;
+using ::testing::HasSubstr;
+
+namespace
+{
+// Сокет, на котором можно дождаться ответа из потока платы
+class WaitingSocket : public ISocket
+{
+public:
+    size_t write(int, const void *buf, size_t count) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_writes.emplace_back(static_cast<const char *>(buf), count);
+        m_cv.notify_all();
+        return count;
+    }
+
+    size_t read(int, void *, size_t) override
+    {
+        return 0;
+    }
+
+    std::string waitFor(size_t n)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait_for(lock, std::chrono::seconds(10), [this, n]() { return m_writes.size() >= n; });
+        return m_writes.size() >= n ? m_writes[n - 1] : std::string();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<std::string> m_writes;
+};
+
+// Плата сразу отвечает готовностью 0x00 и завершением [x, 0xFF], кадры складываются в writes
+NiceMock<MockModule> *makeBoard(std::vector<std::vector<uchar>> &writes)
+{
+    auto *module = new NiceMock<MockModule>();
+    ON_CALL(*module, isConnected()).WillByDefault(Return(true));
+    ON_CALL(*module, checkRXChannel()).WillByDefault(Return(2));
+    ON_CALL(*module, readData(_)).WillByDefault(Invoke([](std::vector<uchar> &data) {
+        if (data.size() == 1)
+            data[0] = 0x00;
+        else
+            data.back() = 0xFF;
+    }));
+    ON_CALL(*module, writeData(_)).WillByDefault(Invoke([&writes](const std::vector<uchar> &data) {
+        writes.push_back(data);
+    }));
+    return module;
+}
+
+std::string movingMessage(const std::vector<int> &numbers)
+{
+    mms::MotorsSettings settings;
+    settings.mode = "synchronous";
+    for (int number : numbers)
+        settings.motors.push_back(mms::Motor{number, 1000, 2000, 10});
+
+    return NetworkSerializer().serialize(pkg::Message{
+        1,
+        NetworkSerializer().serialize(mms::Manager{"moving", NetworkSerializer().serialize(settings)})});
+}
+} // namespace
+
+TEST(DeviceManager, RejectsOverlappingAndWideRanges)
+{
+    DeviceManager devices;
+    EXPECT_TRUE(devices.add(std::make_unique<NiceMock<MockModule>>(), 0, 1, 10));
+    EXPECT_FALSE(devices.add(std::make_unique<NiceMock<MockModule>>(), 1, 10, 15));
+    EXPECT_FALSE(devices.add(std::make_unique<NiceMock<MockModule>>(), 1, 11, 21));
+    EXPECT_FALSE(devices.add(std::make_unique<NiceMock<MockModule>>(), 0, 11, 20));
+    EXPECT_TRUE(devices.add(std::make_unique<NiceMock<MockModule>>(), 1, 11, 20));
+
+    EXPECT_EQ(devices.size(), 2);
+    EXPECT_EQ(devices.motorCount(), 20);
+    EXPECT_EQ(devices.lastMotor(), 20);
+    ASSERT_NE(devices.findByMotor(11), nullptr);
+    EXPECT_EQ(devices.findByMotor(11)->deviceId(), 1);
+    EXPECT_EQ(devices.findByMotor(11)->localNumber(11), 1);
+    EXPECT_EQ(devices.findByMotor(21), nullptr);
+}
+
+TEST(DeviceManager, ParseBoard)
+{
+    int deviceId = 0, first = 0, last = 0;
+    ASSERT_TRUE(DeviceManager::parseBoard("2:11-20", deviceId, first, last));
+    EXPECT_EQ(deviceId, 2);
+    EXPECT_EQ(first, 11);
+    EXPECT_EQ(last, 20);
+
+    EXPECT_FALSE(DeviceManager::parseBoard("2:11", deviceId, first, last));
+    EXPECT_FALSE(DeviceManager::parseBoard("a:1-10", deviceId, first, last));
+}
+
+TEST(DeviceManager, MovingIsSplitByBoardWithLocalNumbers)
+{
+    std::vector<std::vector<uchar>> writesA, writesB;
+    DeviceManager devices;
+    devices.add(std::unique_ptr<IModule>(makeBoard(writesA)), 0, 1, 10);
+    devices.add(std::unique_ptr<IModule>(makeBoard(writesB)), 1, 11, 20);
+
+    auto *socket = new WaitingSocket();
+    UserCore core(std::move(devices), std::unique_ptr<ISocket>(socket));
+
+    core.Process(1, "cli", movingMessage({2, 11, 12}));
+
+    EXPECT_THAT(socket->waitFor(1), HasSubstr("\"status\":0"));
+    ASSERT_EQ(writesA.size(), 2);
+    EXPECT_EQ(writesA[0], std::vector<uchar>{0x81});
+    EXPECT_EQ(McuTransaction::loadLE32(writesA[1].data()), 2u);
+
+    ASSERT_EQ(writesB.size(), 2);
+    EXPECT_EQ(writesB[0], std::vector<uchar>{0x82});
+    EXPECT_EQ(McuTransaction::loadLE32(writesB[1].data()), 1u);
+    EXPECT_EQ(McuTransaction::loadLE32(writesB[1].data() + McuTransaction::MOTOR_FRAME_SIZE), 2u);
+}
+
+TEST(DeviceManager, MotorOutsideBoardsIsRejected)
+{
+    std::vector<std::vector<uchar>> writesA, writesB;
+    DeviceManager devices;
+    devices.add(std::unique_ptr<IModule>(makeBoard(writesA)), 0, 1, 10);
+    devices.add(std::unique_ptr<IModule>(makeBoard(writesB)), 1, 11, 20);
+
+    auto *socket = new WaitingSocket();
+    UserCore core(std::move(devices), std::unique_ptr<ISocket>(socket));
+
+    core.Process(1, "cli", movingMessage({21}));
+
+    auto answer = socket->waitFor(1);
+    EXPECT_THAT(answer, HasSubstr("40503"));
+    EXPECT_THAT(answer, HasSubstr("must be 1-20"));
+    EXPECT_TRUE(writesA.empty());
+    EXPECT_TRUE(writesB.empty());
+}
+
+TEST(DeviceManager, BoardsRunInParallel)
+{
+    std::vector<std::vector<uchar>> writesA, writesB;
+    DeviceManager devices;
+    devices.add(std::unique_ptr<IModule>(makeBoard(writesA)), 0, 1, 10);
+    devices.add(std::unique_ptr<IModule>(makeBoard(writesB)), 1, 11, 20);
+
+    auto *socket = new WaitingSocket();
+    UserCore core(std::move(devices), std::unique_ptr<ISocket>(socket));
+    core.Init();
+
+    // Каждая часть moving() ждет завершения ~200 мс, на двух платах они должны идти одновременно
+    auto start = std::chrono::steady_clock::now();
+    core.Process(1, "cli", movingMessage({1}));
+    EXPECT_THAT(socket->waitFor(1), HasSubstr("\"status\":0"));
+    auto single = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    core.Process(1, "cli", movingMessage({1, 11}));
+    EXPECT_THAT(socket->waitFor(2), HasSubstr("\"status\":0"));
+    auto both = std::chrono::steady_clock::now() - start;
+
+    core.Stop();
+    EXPECT_LT(both, single * 17 / 10);
+}
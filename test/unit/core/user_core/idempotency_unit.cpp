@@ -0,0 +1,214 @@
+#include "mocks.hpp"
+#include "request_journal.hpp"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <thread>
+using ::testing::Return;
+using ::testing::Invoke;
+using ::testing::HasSubstr;
+
+namespace
+{
+using Waiters = std::vector<RequestJournal::Connection>;
+
+// Соединение с дескриптором fd, номер соединения совпадает с дескриптором
+RequestJournal::Connection on(int fd)
+{
+    return {fd, static_cast<uint64_t>(fd)};
+}
+} // namespace
+
+TEST(RequestJournal, RetryWaitsThenReplays)
+{
+    RequestJournal journal;
+    const auto first = journal.claim("ui", 7, "move", on(3));
+    ASSERT_EQ(first.state, RequestJournal::State::New);
+
+    EXPECT_EQ(journal.claim("ui", 7, "move", on(4)).state, RequestJournal::State::InFlight);
+    EXPECT_EQ(journal.complete(first.token, pkg::Status{"done", "", 0}), Waiters{on(4)});
+
+    const auto retry = journal.claim("ui", 7, "move", on(5));
+    ASSERT_EQ(retry.state, RequestJournal::State::Done);
+    EXPECT_EQ(retry.result.what, "done");
+
+    // Ключ - клиент и id
+    EXPECT_EQ(journal.claim("panel", 7, "move", on(6)).state, RequestJournal::State::New);
+}
+
+TEST(RequestJournal, ReusedIdStartsNewCommand)
+{
+    RequestJournal journal;
+    const auto first = journal.claim("ui", 7, "move 1", on(3));
+    const auto second = journal.claim("ui", 7, "move 2", on(3));
+    ASSERT_EQ(second.state, RequestJournal::State::New);
+
+    // Ответ замененной команды не запоминается
+    EXPECT_TRUE(journal.complete(first.token, pkg::Status{"", "", 40513}).empty());
+    journal.complete(second.token, pkg::Status{"", "", 0});
+    EXPECT_EQ(journal.claim("ui", 7, "move 2", on(3)).result.status, 0u);
+}
+
+// Клиент после перезапуска снова шлет тот же id с тем же текстом: по истечении срока это новая команда
+TEST(RequestJournal, CompletedEntryExpires)
+{
+    ManualClock clock;
+    RequestJournal journal(RequestJournal::DEFAULT_CAPACITY, std::chrono::seconds(30));
+    journal.setClock(clock);
+
+    journal.complete(journal.claim("loadgen-0", 1, "move", on(3)).token, pkg::Status{"", "", 0});
+    clock.advance(std::chrono::seconds(29));
+    EXPECT_EQ(journal.claim("loadgen-0", 1, "move", on(3)).state, RequestJournal::State::Done);
+
+    clock.advance(std::chrono::seconds(1));
+    const auto again = journal.claim("loadgen-0", 1, "move", on(3));
+    ASSERT_EQ(again.state, RequestJournal::State::New);
+
+    // Новая команда снова отвечает на повторы весь срок
+    journal.complete(again.token, pkg::Status{"", "", 0});
+    clock.advance(std::chrono::seconds(29));
+    EXPECT_EQ(journal.claim("loadgen-0", 1, "move", on(3)).state, RequestJournal::State::Done);
+}
+
+// Записи с истекшим сроком вытесняются при следующем ответе, не дожидаясь емкости
+TEST(RequestJournal, ExpiredEntriesAreDropped)
+{
+    ManualClock clock;
+    RequestJournal journal(RequestJournal::DEFAULT_CAPACITY, std::chrono::seconds(30));
+    journal.setClock(clock);
+
+    journal.complete(journal.claim("ui", 1, "move", on(3)).token, pkg::Status{"", "", 0});
+    clock.advance(std::chrono::seconds(31));
+    journal.complete(journal.claim("ui", 2, "move", on(3)).token, pkg::Status{"", "", 0});
+
+    // Запись 1 вытеснена: ее повтор - новая команда, а не ожидание замененной
+    EXPECT_EQ(journal.claim("ui", 1, "move", on(3)).state, RequestJournal::State::New);
+    EXPECT_EQ(journal.claim("ui", 2, "move", on(3)).state, RequestJournal::State::Done);
+}
+
+TEST(RequestJournal, KeepsOnlyRecentResults)
+{
+    RequestJournal journal(2);
+    for (int id = 1; id <= 3; ++id)
+        journal.complete(journal.claim("ui", id, "move", on(3)).token, pkg::Status{"", "", 0});
+
+    EXPECT_EQ(journal.claim("ui", 1, "move", on(3)).state, RequestJournal::State::New);
+    EXPECT_EQ(journal.claim("ui", 3, "move", on(3)).state, RequestJournal::State::Done);
+}
+
+TEST(RequestJournal, ClosedConnectionGetsNoReply)
+{
+    RequestJournal journal;
+    const auto first = journal.claim("ui", 7, "move", on(3));
+    journal.claim("ui", 7, "move", on(4));
+    journal.forget(4);
+    EXPECT_TRUE(journal.complete(first.token, pkg::Status{"", "", 0}).empty());
+}
+
+TEST(RequestJournal, SameConnectionIsNotAWaiter)
+{
+    RequestJournal journal;
+    const auto first = journal.claim("ui", 7, "move", on(3));
+    EXPECT_EQ(journal.claim("ui", 7, "move", on(3)).state, RequestJournal::State::InFlight);
+    journal.claim("ui", 7, "move", on(4));
+    journal.claim("ui", 7, "move", on(4));
+    EXPECT_EQ(journal.complete(first.token, pkg::Status{"", "", 0}), Waiters{on(4)});
+}
+
+TEST(RequestJournal, RetryFromReusedDescriptorIsAWaiter)
+{
+    RequestJournal journal;
+    const auto first = journal.claim("ui", 7, "move", on(3));
+
+    // Клиент переподключился, accept() отдал ему тот же дескриптор
+    journal.forget(3);
+    const RequestJournal::Connection reconnected{3, 9};
+    EXPECT_EQ(journal.claim("ui", 7, "move", reconnected).state, RequestJournal::State::InFlight);
+    EXPECT_EQ(journal.complete(first.token, pkg::Status{"", "", 0}), Waiters{reconnected});
+}
+
+TEST(Idempotency, RetryGetsRecordedResult)
+{
+    auto rig = makeRig();
+    FakeMcu mcu(*rig.module);
+    auto replies = captureWrites(rig);
+
+    rig.core->Process(11, "ui", movingRequest({{1, 2000, 5000, 100}}, 42));
+    rig.core->Process(12, "ui", movingRequest({{1, 2000, 5000, 100}}, 42));
+
+    EXPECT_EQ(mcu.headers().size(), 1u);
+    ASSERT_EQ(replies->repliesTo(11).size(), 1u);
+    ASSERT_EQ(replies->repliesTo(12).size(), 1u);
+    EXPECT_EQ(replies->repliesTo(11)[0], replies->repliesTo(12)[0]);
+    EXPECT_THAT(replies->repliesTo(12)[0], HasSubstr("\"status\":0"));
+}
+
+TEST(Idempotency, RetryWhileRunningWaitsForOriginal)
+{
+    auto rig = makeRig();
+    ManualClock clock;
+    rig.core->setClock(clock);
+    FakeMcu mcu(*rig.module);
+    auto replies = captureWrites(rig);
+    mcu.moving = true;
+
+    // Поток платы не запущен: исходная команда ждет завершения в своем потоке
+    const std::string move = movingRequest({{1, 2000, 5000, 100}}, 42);
+    std::thread original([&rig, &move]() { rig.core->Process(11, "ui", move); });
+    ASSERT_TRUE(clock.waitForSleepers(1));
+
+    // Клиент не дождался ответа и повторил запрос с нового соединения
+    rig.core->Process(12, "ui", move);
+    EXPECT_TRUE(replies->repliesTo(12).empty());
+
+    mcu.moving = false;
+    clock.advance(UserCore::MOVE_SETTLE_DELAY + UserCore::MCU_POLL_INTERVAL);
+    original.join();
+
+    EXPECT_EQ(mcu.headers().size(), 1u);
+    ASSERT_EQ(replies->repliesTo(11).size(), 1u);
+    ASSERT_EQ(replies->repliesTo(12).size(), 1u);
+    EXPECT_THAT(replies->repliesTo(12)[0], HasSubstr("\"status\":0"));
+}
+
+TEST(Idempotency, RetryAfterReconnectOnSameDescriptor)
+{
+    auto rig = makeRig();
+    ManualClock clock;
+    rig.core->setClock(clock);
+    FakeMcu mcu(*rig.module);
+    auto replies = captureWrites(rig);
+    mcu.moving = true;
+
+    const std::string move = movingRequest({{1, 2000, 5000, 100}}, 42);
+    std::thread original([&rig, &move]() { rig.core->Process(11, "ui", move); });
+    ASSERT_TRUE(clock.waitForSleepers(1));
+
+    // Клиент переподключился и получил тот же дескриптор: повтор ждет исходную команду
+    rig.core->Disconnected(11);
+    rig.core->Process(11, "ui", move);
+    EXPECT_TRUE(replies->repliesTo(11).empty());
+
+    mcu.moving = false;
+    clock.advance(UserCore::MOVE_SETTLE_DELAY + UserCore::MCU_POLL_INTERVAL);
+    original.join();
+
+    EXPECT_EQ(mcu.headers().size(), 1u);
+    const auto answers = replies->repliesTo(11);
+    ASSERT_EQ(answers.size(), 1u);
+    EXPECT_THAT(answers[0], HasSubstr("\"status\":0"));
+}
+
+TEST(Idempotency, NewIdOrZeroIdRunsAgain)
+{
+    auto rig = makeRig();
+    FakeMcu mcu(*rig.module);
+    auto replies = captureWrites(rig);
+
+    rig.core->Process(11, "ui", movingRequest({{1, 2000, 5000, 100}}, 42));
+    rig.core->Process(11, "ui", movingRequest({{1, 2000, 5000, 100}}, 43));
+    rig.core->Process(11, "ui", movingRequest({{1, 2000, 5000, 100}}, 0));
+    rig.core->Process(11, "ui", movingRequest({{1, 2000, 5000, 100}}, 0));
+
+    EXPECT_EQ(mcu.headers().size(), 4u);
+    EXPECT_EQ(replies->repliesTo(11).size(), 4u);
+}
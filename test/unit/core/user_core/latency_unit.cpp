@@ -0,0 +1,72 @@
+#include "mocks.hpp"
+#include "latency_histogram.hpp"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+using ::testing::Return;
+using ::testing::Invoke;
+
+namespace
+{
+uint64_t stageCount(const std::string &command, LatencyStage stage)
+{
+    return LatencyRegistry::instance().scope(command)[stage].snapshot().count;
+}
+} // namespace
+
+TEST(Latency, MovingRecordsEveryStage)
+{
+    LatencyRegistry::instance().reset();
+
+    auto rig = makeRig();
+    ON_CALL(*rig.module, checkRXChannel()).WillByDefault(Return(2));
+    ON_CALL(*rig.module, readData(_)).WillByDefault(Invoke([](std::vector<uchar> &data) {
+        if (data.size() == 1)
+            data[0] = 0x00;
+        else
+            data.back() = 0xFF;
+    }));
+
+    mms::MotorsSettings settings;
+    settings.mode = "synchronous";
+    settings.motors.push_back(mms::Motor{1, 1000, 2000, 10});
+    rig.core->Process(
+        1,
+        "cli",
+        NetworkSerializer().serialize(pkg::Message{
+            1,
+            NetworkSerializer().serialize(mms::Manager{"moving", NetworkSerializer().serialize(settings)})}));
+
+    for (auto stage :
+         {LatencyStage::Parse,
+          LatencyStage::Validate,
+          LatencyStage::McuWrite,
+          LatencyStage::McuReadiness,
+          LatencyStage::McuCompletion,
+          LatencyStage::Serialize,
+          LatencyStage::SocketWrite,
+          LatencyStage::Total})
+    {
+        EXPECT_EQ(stageCount("moving", stage), 1) << LatencyRegistry::stageName(stage);
+    }
+
+    // Полное время включает ожидание завершения MCU (~200 мс)
+    auto total = LatencyRegistry::instance().scope("moving")[LatencyStage::Total].snapshot();
+    EXPECT_GE(total.maxNs, 200'000'000u);
+    EXPECT_EQ(stageCount("version", LatencyStage::Total), 0);
+}
+
+TEST(Latency, ValidationErrorIsCountedInTotalOnly)
+{
+    LatencyRegistry::instance().reset();
+
+    auto rig = makeRig();
+    rig.core->Process(
+        1,
+        "cli",
+        NetworkSerializer().serialize(
+            pkg::Message{1, NetworkSerializer().serialize(mms::Manager{"version", "not empty"})}));
+
+    EXPECT_EQ(stageCount("version", LatencyStage::Parse), 1);
+    EXPECT_EQ(stageCount("version", LatencyStage::Total), 1);
+    EXPECT_EQ(stageCount("version", LatencyStage::McuWrite), 0);
+}
@@ -0,0 +1,172 @@
+#include "mocks.hpp"
+#include "link_supervisor.hpp"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <atomic>
+using ::testing::Return;
+using ::testing::Invoke;
+using ::testing::HasSubstr;
+
+namespace
+{
+// Кабель, который можно выдернуть: linked - есть ли связь, первые failConnects подключений не удаются
+struct Cable
+{
+    std::atomic<bool> linked{true};
+    std::atomic<int> connects{0};
+    std::atomic<int> failConnects{0};
+};
+
+void plug(NiceMock<MockModule> &module, Cable &cable)
+{
+    ON_CALL(module, isConnected()).WillByDefault(Invoke([&cable]() -> bool { return cable.linked; }));
+    ON_CALL(module, disconnect()).WillByDefault(Invoke([&cable]() { cable.linked = false; }));
+    ON_CALL(module, connect(_)).WillByDefault(Invoke([&cable](int) {
+        ++cable.connects;
+        if (cable.failConnects > 0)
+        {
+            --cable.failConnects;
+            return false;
+        }
+        cable.linked = true;
+        return true;
+    }));
+    ON_CALL(module, checkRXChannel()).WillByDefault(Return(1));
+    ON_CALL(module, readData(_)).WillByDefault(Invoke([](std::vector<uchar> &data) { data[0] = 0x13; }));
+}
+
+struct SupervisedBoard
+{
+    NiceMock<MockModule> *module = new NiceMock<MockModule>();
+    Cable cable;
+    DeviceManager devices;
+    int lost = 0;
+    int restored = 0;
+    LinkSupervisor supervisor{
+        devices, [this](DeviceChannel &) { ++lost; }, [this](DeviceChannel &) { ++restored; }};
+
+    explicit SupervisedBoard(IClock &clock)
+    {
+        plug(*module, cable);
+        devices.add(std::unique_ptr<IModule>(module), 0, 1, 10);
+        supervisor.setClock(clock);
+        supervisor.watch(devices.primary());
+    }
+};
+} // namespace
+
+TEST(LinkSupervisor, HealthyLinkIsOnlyPolled)
+{
+    ManualClock clock;
+    SupervisedBoard board(clock);
+    EXPECT_CALL(*board.module, checkRXChannel()).Times(2);
+    EXPECT_CALL(*board.module, writeData(_)).Times(0);
+
+    board.supervisor.tick(); // срок первой проверки еще не подошел
+    clock.advance(LinkSupervisor::HEARTBEAT_INTERVAL);
+    board.supervisor.tick();
+    board.supervisor.tick();
+    clock.advance(LinkSupervisor::HEARTBEAT_INTERVAL);
+    board.supervisor.tick();
+
+    EXPECT_EQ(board.lost, 0);
+    EXPECT_EQ(board.cable.connects, 0);
+}
+
+TEST(LinkSupervisor, ReconnectsWithBackoff)
+{
+    ManualClock clock(true);
+    SupervisedBoard board(clock);
+    board.cable.failConnects = 3;
+
+    board.cable.linked = false;
+    clock.advance(LinkSupervisor::HEARTBEAT_INTERVAL);
+    const auto lostAt = clock.now();
+    board.supervisor.tick();
+
+    // Попытки сразу, через 100, 200 и 400 мс - в пределах RECONNECT_GRACE, одним заданием
+    EXPECT_EQ(board.lost, 1);
+    EXPECT_EQ(board.restored, 1);
+    EXPECT_EQ(board.cable.connects, 4);
+    EXPECT_EQ(clock.now() - lostAt, std::chrono::milliseconds(700));
+    EXPECT_TRUE(board.cable.linked);
+    EXPECT_FALSE(board.supervisor.reconnecting(board.devices.primary()));
+}
+
+TEST(LinkSupervisor, KeepsRetryingAfterGrace)
+{
+    ManualClock clock(true);
+    SupervisedBoard board(clock);
+    board.cable.failConnects = 100;
+
+    board.cable.linked = false;
+    clock.advance(LinkSupervisor::HEARTBEAT_INTERVAL);
+    const auto lostAt = clock.now();
+    board.supervisor.tick();
+
+    // Через 0, 100, 300, 700 и 1500 мс; следующая пауза 1600 мс выходит за RECONNECT_GRACE
+    EXPECT_EQ(board.cable.connects, 5);
+    EXPECT_TRUE(board.supervisor.reconnecting(board.devices.primary()));
+    clock.advance(lostAt + LinkSupervisor::RECONNECT_GRACE - clock.now());
+    EXPECT_FALSE(board.supervisor.reconnecting(board.devices.primary()));
+
+    board.supervisor.tick();
+    EXPECT_EQ(board.cable.connects, 5);
+    clock.advance(std::chrono::milliseconds(1100));
+    board.supervisor.tick();
+    EXPECT_EQ(board.cable.connects, 6);
+
+    board.cable.failConnects = 0;
+    clock.advance(std::chrono::milliseconds(3200));
+    board.supervisor.tick();
+    EXPECT_EQ(board.cable.connects, 7);
+    EXPECT_EQ(board.lost, 1);
+    EXPECT_EQ(board.restored, 1);
+}
+
+TEST(LinkSupervisor, ReleasedBoardIsLeftAlone)
+{
+    ManualClock clock(true);
+    SupervisedBoard board(clock);
+    board.supervisor.release(board.devices.primary());
+
+    board.cable.linked = false;
+    clock.advance(LinkSupervisor::HEARTBEAT_INTERVAL);
+    board.supervisor.tick();
+    EXPECT_EQ(board.lost, 0);
+    EXPECT_EQ(board.cable.connects, 0);
+}
+
+TEST(LinkSupervisor, CommandsWaitForReconnect)
+{
+    auto rig = makeRig();
+    ManualClock clock;
+    rig.core->setClock(clock);
+    auto replies = captureWrites(rig);
+
+    Cable cable;
+    plug(*rig.module, cable);
+    cable.linked = false;
+
+    rig.core->Init();
+    rig.core->Process(1, "cli", request("reconnect", NetworkSerializer().serialize(mms::Device{0})));
+    ASSERT_THAT(replies->waitFor(1, 1).at(0), HasSubstr("\"status\":0"));
+
+    // Кабель выдернут: проверка в простое замечает это, первая попытка не удается
+    cable.failConnects = 1;
+    cable.linked = false;
+    clock.advance(LinkSupervisor::HEARTBEAT_INTERVAL);
+    ASSERT_TRUE(clock.waitForSleepers(1, std::chrono::milliseconds(2000)));
+
+    // Команда не отклоняется, а ждет переподключения в очереди платы
+    rig.core->Process(2, "cli", request("version", ""));
+    EXPECT_TRUE(replies->waitFor(2, 0).empty());
+
+    clock.advance(LinkSupervisor::MIN_BACKOFF);
+    const auto answer = replies->waitFor(2, 1);
+    rig.core->Stop();
+
+    ASSERT_EQ(answer.size(), 1u);
+    EXPECT_THAT(answer[0], HasSubstr("mms::Version"));
+    EXPECT_EQ(cable.connects, 3);
+}
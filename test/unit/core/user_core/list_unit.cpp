@@ -1,9 +1,13 @@
 #include "mocks.hpp"
+#include "device_inventory.hpp"
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <atomic>
+#include <thread>
 using ::testing::Return;
 using ::testing::Invoke;
 using ::testing::HasSubstr;
+using ::testing::Not;
 
 TEST(ListConnect_Group, Success)
 {
@@ -18,6 +22,154 @@ TEST(ListConnect_Group, Success)
     EXPECT_THAT(*rig.lastWrite, HasSubstr("COM1"));
 }
 
+namespace
+{
+std::string listRequest()
+{
+    return NetworkSerializer().serialize(
+        pkg::Message{9, NetworkSerializer().serialize(mms::Manager{"listconnect", ""})});
+}
+
+// Источник для DeviceInventory: список можно менять из теста, вызовы считаются
+struct FakeBus
+{
+    std::mutex mutex;
+    std::vector<std::string> devices{"Device 0: FT232R USB UART - A1"};
+    std::atomic<size_t> calls{0};
+
+    DeviceInventory::Source source()
+    {
+        return [this]() {
+            ++calls;
+            std::lock_guard<std::mutex> lock(mutex);
+            return devices;
+        };
+    }
+
+    void plug(const std::string &device)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        devices.push_back(device);
+    }
+};
+
+bool waitUntil(const std::function<bool()> &condition)
+{
+    for (int i = 0; i < 200 && !condition(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return condition();
+}
+} // namespace
+
+TEST(DeviceInventory, EnumeratesOnceUntilInvalidated)
+{
+    FakeBus bus;
+    DeviceInventory inventory(bus.source());
+
+    const auto first = inventory.snapshot();
+    EXPECT_EQ(first->generation, 1u);
+    EXPECT_EQ(first->devices, bus.devices);
+    EXPECT_EQ(inventory.snapshot(), first);
+    EXPECT_EQ(bus.calls, 1u);
+
+    // Тот же список: перечисление было, generation прежний
+    inventory.invalidate();
+    EXPECT_EQ(inventory.snapshot()->generation, 1u);
+    EXPECT_EQ(bus.calls, 2u);
+
+    bus.plug("Device 1: FT232R USB UART - B2");
+    EXPECT_TRUE(inventory.refresh());
+    EXPECT_EQ(inventory.snapshot()->generation, 2u);
+    EXPECT_EQ(inventory.snapshot()->devices.size(), 2u);
+    EXPECT_EQ(bus.calls, 3u);
+}
+
+TEST(DeviceInventory, ThreadRefreshesOnTimer)
+{
+    FakeBus bus;
+    DeviceInventory inventory(bus.source(), std::chrono::milliseconds(10), std::chrono::milliseconds(10));
+    inventory.start();
+    ASSERT_TRUE(waitUntil([&bus]() { return bus.calls >= 1; }));
+
+    bus.plug("Device 1: FT232R USB UART - B2");
+    EXPECT_TRUE(waitUntil([&inventory]() { return inventory.snapshot()->devices.size() == 2; }));
+    inventory.stop();
+}
+
+// С hotplug-сокетом короткий таймер не действует: шина перечисляется по событиям и редкому таймеру
+TEST(DeviceInventory, HotplugReplacesFastPoll)
+{
+    FakeBus bus;
+    DeviceInventory inventory(bus.source(), std::chrono::milliseconds(10), std::chrono::hours(1));
+    inventory.start();
+    if (!inventory.hotplug())
+    {
+        inventory.stop();
+        GTEST_SKIP() << "netlink uevent socket is unavailable";
+    }
+    ASSERT_TRUE(waitUntil([&bus]() { return bus.calls >= 1; }));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(bus.calls, 1u);
+
+    // Явная инвалидация по-прежнему будит поток
+    bus.plug("Device 1: FT232R USB UART - B2");
+    inventory.invalidate();
+    EXPECT_TRUE(waitUntil([&inventory]() { return inventory.snapshot()->devices.size() == 2; }));
+    inventory.stop();
+}
+
+TEST(DeviceInventory, InvalidateWakesThread)
+{
+    FakeBus bus;
+    DeviceInventory inventory(bus.source(), std::chrono::hours(1));
+    inventory.start();
+    ASSERT_TRUE(waitUntil([&bus]() { return bus.calls >= 1; }));
+
+    bus.plug("Device 1: FT232R USB UART - B2");
+    inventory.invalidate();
+    EXPECT_TRUE(waitUntil([&inventory]() { return inventory.snapshot()->devices.size() == 2; }));
+
+    // stop() не ждет таймера в час
+    inventory.stop();
+}
+
+TEST(ListConnect, ServedFromCache)
+{
+    auto rig = makeRig();
+    EXPECT_CALL(*rig.module, listComs()).Times(1).WillOnce(Return(std::vector<std::string>{"COM0"}));
+
+    rig.core->Process(1, "cli", listRequest());
+    rig.core->Process(2, "cli", listRequest());
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("COM0"));
+}
+
+TEST(ListConnect, ReenumeratesAfterDisconnect)
+{
+    auto rig = makeRig();
+    EXPECT_CALL(*rig.module, listComs())
+        .WillOnce(Return(std::vector<std::string>{"COM0"}))
+        .WillOnce(Return(std::vector<std::string>{"COM0", "COM1"}));
+
+    rig.core->Process(1, "cli", listRequest());
+    EXPECT_THAT(*rig.lastWrite, Not(HasSubstr("COM1")));
+
+    rig.core->Process(1, "cli", NetworkSerializer().serialize(
+        pkg::Message{10, NetworkSerializer().serialize(mms::Manager{"disconnect", ""})}));
+    rig.core->Process(1, "cli", listRequest());
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("COM1"));
+}
+
+TEST(ListConnect, CleansDeviceNames)
+{
+    auto rig = makeRig();
+    EXPECT_CALL(*rig.module, listComs())
+        .WillOnce(Return(std::vector<std::string>{"`COM\xC3\xA9" "0`", "\xC3\xA9"}));
+
+    rig.core->Process(1, "cli", listRequest());
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("[\\\"COM0\\\"]"));
+}
+
 #if 0 // TODO: #003
 TEST(ListConnect, NonEmptyMessage)
 {
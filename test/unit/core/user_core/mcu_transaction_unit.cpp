@@ -0,0 +1,184 @@
+#include "mocks.hpp"
+#include "mcu_transaction.hpp"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+using ::testing::Return;
+using ::testing::Invoke;
+using ::testing::HasSubstr;
+
+namespace
+{
+mms::MotorsSettings twoMotors(const std::string &mode)
+{
+    mms::MotorsSettings settings;
+    settings.mode = mode;
+    settings.motors.push_back(mms::Motor{1, 2000, 5000, 100});
+    settings.motors.push_back(mms::Motor{2, 1500, 4500, -50});
+    return settings;
+}
+
+// Ответы MCU: байт готовности 0x00, затем завершение [x, 0xFF]
+void answerReadyAndDone(MockModule &module)
+{
+    ON_CALL(module, checkRXChannel()).WillByDefault(Return(2));
+    ON_CALL(module, readData(_)).WillByDefault(Invoke([](std::vector<uchar> &data) {
+        if (data.size() == 1)
+            data[0] = 0x00;
+        else
+            data.back() = 0xFF;
+    }));
+}
+
+// MCU с прошивкой versionByte: на запрос версии отвечает этим байтом, на кадры движения - как
+// answerReadyAndDone. Записи в модуль запоминаются
+std::shared_ptr<std::vector<std::vector<uchar>>> answerFirmware(MockModule &module, uint8_t versionByte)
+{
+    auto writes = std::make_shared<std::vector<std::vector<uchar>>>();
+    ON_CALL(module, writeData(_)).WillByDefault(Invoke([writes](const std::vector<uchar> &data) {
+        writes->push_back(data);
+    }));
+    ON_CALL(module, checkRXChannel()).WillByDefault(Return(2));
+    ON_CALL(module, readData(_)).WillByDefault(Invoke([writes, versionByte](std::vector<uchar> &data) {
+        if (writes->back() == std::vector<uchar>{McuTransaction::VERSION_REQUEST})
+            data[0] = versionByte;
+        else if (data.size() == 1)
+            data[0] = 0x00;
+        else
+            data.back() = 0xFF;
+    }));
+    return writes;
+}
+} // namespace
+
+TEST(McuTransaction, EncodesHeaderAndLittleEndianPayload)
+{
+    McuTransaction transaction;
+    transaction.encode(twoMotors("synchronous"));
+
+    ASSERT_EQ(transaction.frame().size(), 1 + 2 * McuTransaction::MOTOR_FRAME_SIZE);
+    EXPECT_EQ(transaction.header(), 0x82);
+    EXPECT_EQ(transaction.motorCount(), 2);
+
+    const auto payload = transaction.payload();
+    ASSERT_EQ(payload.size(), 32);
+
+    // Мотор 1: number = 1, acceleration = 2000 (0x07D0)
+    EXPECT_EQ(payload[0], 0x01);
+    EXPECT_EQ(payload[1], 0x00);
+    EXPECT_EQ(payload[4], 0xD0);
+    EXPECT_EQ(payload[5], 0x07);
+
+    // Мотор 2: step = -50 (0xFFFFFFCE)
+    EXPECT_EQ(payload[28], 0xCE);
+    EXPECT_EQ(payload[29], 0xFF);
+    EXPECT_EQ(payload[30], 0xFF);
+    EXPECT_EQ(payload[31], 0xFF);
+    EXPECT_EQ(static_cast<int32_t>(McuTransaction::loadLE32(payload.data() + 28)), -50);
+}
+
+TEST(McuTransaction, AsynchronousHeaderAndReencode)
+{
+    McuTransaction transaction;
+    transaction.encode(twoMotors("asynchronous"));
+    EXPECT_EQ(transaction.header(), 0x42);
+
+    mms::MotorsSettings one;
+    one.mode = "synchronous";
+    one.motors.push_back(mms::Motor{10, 1, 1, 0});
+    transaction.encode(one);
+
+    EXPECT_EQ(transaction.header(), 0x81);
+    EXPECT_EQ(transaction.payload().size(), McuTransaction::MOTOR_FRAME_SIZE);
+    EXPECT_EQ(McuTransaction::loadLE32(transaction.payload().data()), 10u);
+}
+
+TEST(McuTransaction, SupportsCoalescedByVersionByte)
+{
+    EXPECT_FALSE(McuTransaction::supportsCoalesced(0x12));
+    EXPECT_FALSE(McuTransaction::supportsCoalesced(0x1F));
+    EXPECT_TRUE(McuTransaction::supportsCoalesced(0x20));
+    EXPECT_TRUE(McuTransaction::supportsCoalesced(0x31));
+}
+
+TEST(McuTransaction, LegacyFirmwareUsesTwoWrites)
+{
+    auto rig = makeRig();
+    answerReadyAndDone(*rig.module);
+
+    std::vector<std::vector<uchar>> writes;
+    ON_CALL(*rig.module, writeData(_)).WillByDefault(Invoke([&writes](const std::vector<uchar> &data) {
+        writes.push_back(data);
+    }));
+
+    auto msg = NetworkSerializer().serialize(pkg::Message{
+        1,
+        NetworkSerializer().serialize(
+            mms::Manager{"moving", NetworkSerializer().serialize(twoMotors("synchronous"))})});
+    rig.core->Process(1, "cli", msg);
+
+    ASSERT_EQ(writes.size(), 2);
+    EXPECT_EQ(writes[0], std::vector<uchar>{0x82});
+    EXPECT_EQ(writes[1].size(), 32);
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+}
+
+TEST(McuTransaction, FramingDetectedAtInit)
+{
+    auto rig = makeRig();
+    auto writes = answerFirmware(*rig.module, 0x20);
+    auto replies = captureWrites(rig);
+
+    // Прошивка 2.0 объявляет поддержку объединенной записи через байт версии, прочитанный в Init()
+    rig.core->Init();
+    rig.core->Process(1, "cli", request("moving", NetworkSerializer().serialize(twoMotors("asynchronous"))));
+    const auto answer = replies->waitFor(1, 1);
+    rig.core->Stop();
+
+    ASSERT_EQ(answer.size(), 1u);
+    EXPECT_THAT(answer[0], HasSubstr("\"status\":0"));
+    ASSERT_EQ(writes->size(), 2u);
+    EXPECT_EQ(writes->at(0), std::vector<uchar>{McuTransaction::VERSION_REQUEST});
+    ASSERT_EQ(writes->at(1).size(), 33u);
+    EXPECT_EQ(writes->at(1)[0], 0x42);
+    EXPECT_EQ(writes->at(1)[1], 0x01);
+}
+
+TEST(McuTransaction, FramingDetectedAtReconnect)
+{
+    auto rig = makeRig();
+    auto writes = answerFirmware(*rig.module, 0x21);
+    bool connected = false;
+    ON_CALL(*rig.module, isConnected()).WillByDefault(Invoke([&connected]() { return connected; }));
+    ON_CALL(*rig.module, connect(_)).WillByDefault(Invoke([&connected](int) { return connected = true; }));
+
+    rig.core->Process(1, "cli", request("reconnect", NetworkSerializer().serialize(mms::Device{0})));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+    ASSERT_EQ(writes->size(), 1u);
+
+    rig.core->Process(1, "cli", request("moving", NetworkSerializer().serialize(twoMotors("synchronous"))));
+    ASSERT_EQ(writes->size(), 2u);
+    EXPECT_EQ(writes->at(1).size(), 33u);
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+}
+
+TEST(McuTransaction, UnreadFirmwareKeepsTwoWrites)
+{
+    auto rig = makeRig();
+    auto writes = answerFirmware(*rig.module, 0x20);
+    bool connected = false;
+    ON_CALL(*rig.module, isConnected()).WillByDefault(Invoke([&connected]() { return connected; }));
+    ON_CALL(*rig.module, connect(_)).WillByDefault(Invoke([&connected](int) { return connected = true; }));
+    EXPECT_CALL(*rig.module, checkRXChannel())
+        .WillOnce(Invoke([]() -> size_t { throw ModuleFT2xxException(4); }))
+        .WillRepeatedly(Return(2));
+
+    // Версия не прочитана, но плата подключена: reconnect отвечает успехом
+    rig.core->Process(1, "cli", request("reconnect", NetworkSerializer().serialize(mms::Device{0})));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+
+    rig.core->Process(1, "cli", request("moving", NetworkSerializer().serialize(twoMotors("synchronous"))));
+    ASSERT_EQ(writes->size(), 3u);
+    EXPECT_EQ(writes->at(1), std::vector<uchar>{0x82});
+    EXPECT_EQ(writes->at(2).size(), 32u);
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+}
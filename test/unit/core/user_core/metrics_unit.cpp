@@ -0,0 +1,45 @@
+#include "mocks.hpp"
+#include "metrics.hpp"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace
+{
+uint64_t counterValue(const std::string &name, const std::string &labels)
+{
+    return MetricsRegistry::instance().counter(name, "", labels).value();
+}
+
+std::string command(const std::string &name, const std::string &message)
+{
+    return NetworkSerializer().serialize(
+        pkg::Message{1, NetworkSerializer().serialize(mms::Manager{name, message})});
+}
+} // namespace
+
+TEST(CoreMetrics, CommandsAndErrorsAreCounted)
+{
+    auto rig = makeRig();
+    const auto versions = counterValue("mms_commands_total", "command=\"version\"");
+    const auto unknown = counterValue("mms_commands_total", "command=\"unknown\"");
+    const auto notEmpty = counterValue("mms_errors_total", "code=\"40506\"");
+
+    rig.core->Process(1, "cli", command("version", "not empty"));
+    rig.core->Process(1, "cli", command("no-such-command", ""));
+
+    EXPECT_EQ(counterValue("mms_commands_total", "command=\"version\"") - versions, 1);
+    EXPECT_EQ(counterValue("mms_commands_total", "command=\"unknown\"") - unknown, 1);
+    EXPECT_EQ(counterValue("mms_errors_total", "code=\"40506\"") - notEmpty, 1);
+    EXPECT_EQ(ServiceMetrics::instance().requestsInFlight.value(), 0);
+}
+
+TEST(CoreMetrics, RenderedWithLatency)
+{
+    auto rig = makeRig();
+    rig.core->Process(1, "cli", command("listconnect", ""));
+
+    const auto text = MetricsRegistry::instance().render();
+    EXPECT_NE(text.find("mms_commands_total{command=\"listconnect\"}"), std::string::npos);
+    EXPECT_NE(text.find("mms_latency_seconds_count{scope=\"listconnect\",stage=\"total\"}"), std::string::npos);
+    EXPECT_NE(text.find("mms_bytes_sent_total"), std::string::npos);
+}
@@ -1,12 +1,17 @@
 #pragma once
 
 #include "user_core.hpp"
+#include "clock.hpp"
 #include "i_module.hpp"
 #include "i_socket.hpp"
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <atomic>
+#include <condition_variable>
+#include <map>
 #include <memory>
+#include <mutex>
 
 using ::testing::Return;
 using ::testing::NiceMock;
@@ -25,6 +30,8 @@ public:
     MOCK_METHOD(int, getBaudRate, (), (override));
     MOCK_METHOD(void, setUSBParameters, (const int, const int), (override));
     MOCK_METHOD(void, setCharacteristics, (const uchar, const uchar, const uchar), (override));
+    MOCK_METHOD(void, setLinkProfile, (const LinkProfile&), (override));
+    MOCK_METHOD(LinkProfile, getLinkProfile, (), (const, override));
     MOCK_METHOD(void, waitWriteSuccess, (), (override));
     MOCK_METHOD(size_t, checkRXChannel, (), (const, override));
     MOCK_METHOD(void, writeData, (const std::vector<uchar>& data), (override));
@@ -46,6 +53,8 @@ public:
 
 struct TestRig
 {
+    // Виртуальное время: таймауты и паузы опроса MCU проходят мгновенно
+    std::shared_ptr<ManualClock> clock;
     NiceMock<MockModule>* module;
     NiceMock<MockSocket>* socket;
     std::unique_ptr<UserCore> core;
@@ -67,7 +76,169 @@ inline TestRig makeRig()
 
     ON_CALL(*rig.module, isConnected()).WillByDefault(Return(true));
 
+    rig.clock = std::make_shared<ManualClock>(true);
     rig.core = std::make_unique<UserCore>(std::move(modulePtr), std::move(socketPtr));
+    rig.core->setClock(*rig.clock);
     return rig;
 }
 
+
+inline std::string request(const std::string &command, const std::string &message, int id = 1)
+{
+    NetworkSerializer serializer;
+    return serializer.serialize(pkg::Message{id, serializer.serialize(mms::Manager{command, message})});
+}
+
+inline std::string movingRequest(const std::vector<mms::Motor> &motors, int id = 1)
+{
+    mms::MotorsSettings settings;
+    settings.mode = "synchronous";
+    settings.motors = motors;
+    return request("moving", NetworkSerializer().serialize(settings), id);
+}
+
+// MCU сразу отвечает готовностью 0x00, а затем завершением [0x00, completion]. Записи в модуль запоминаются
+inline std::shared_ptr<std::vector<std::vector<uchar>>> answerMoves(TestRig &rig, uint8_t completion = 0xFF)
+{
+    auto writes = std::make_shared<std::vector<std::vector<uchar>>>();
+    ON_CALL(*rig.module, writeData(_)).WillByDefault(Invoke([writes](const std::vector<uchar> &data) {
+        writes->push_back(data);
+    }));
+    ON_CALL(*rig.module, checkRXChannel()).WillByDefault(Return(2));
+    ON_CALL(*rig.module, readData(_)).WillByDefault(Invoke([completion](std::vector<uchar> &data) {
+        if (data.size() == 1)
+            data[0] = 0x00;
+        else
+            data = {0x00, completion};
+    }));
+    return writes;
+}
+
+/*
+ * @brief MCU платы: готовность 0x00 приходит сразу (или когда ready), завершение [0x00, completion] - когда
+ * движение не moving, или [0x00, 0x0B] после байта остановки. Все записи в модуль запоминаются
+ * */
+struct FakeMcu
+{
+    std::atomic<bool> ready{true};
+    std::atomic<bool> moving{false}; // движение не завершается до байта остановки
+    std::atomic<bool> stopped{false};
+    std::atomic<uint8_t> completion{0xFF};
+
+    std::mutex mutex;
+    std::vector<std::vector<uchar>> written;
+
+    explicit FakeMcu(NiceMock<MockModule> &module)
+    {
+        ON_CALL(module, isConnected()).WillByDefault(Return(true));
+        ON_CALL(module, writeData(_)).WillByDefault(Invoke([this](const std::vector<uchar> &data) {
+            std::lock_guard<std::mutex> lock(mutex);
+            written.push_back(data);
+            if (data.back() == McuTransaction::EMERGENCY_STOP)
+                stopped = true;
+        }));
+        ON_CALL(module, checkRXChannel()).WillByDefault(Invoke([this]() -> size_t {
+            if (!moving || stopped)
+                return 2;
+            return ready ? 1 : 0;
+        }));
+        ON_CALL(module, readData(_)).WillByDefault(Invoke([this](std::vector<uchar> &data) {
+            if (data.size() == 1)
+                data[0] = 0x00;
+            else
+                data = {0x00, stopped ? McuTransaction::STOPPED : completion.load()};
+        }));
+    }
+
+    std::vector<std::vector<uchar>> writes()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return written;
+    }
+
+    // Заголовки кадров движения: однобайтовые записи, кроме остановки и запроса версии
+    std::vector<uchar> headers()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<uchar> result;
+        for (const auto &data : written)
+        {
+            if (data.size() == 1 && data[0] != McuTransaction::EMERGENCY_STOP &&
+                data[0] != McuTransaction::VERSION_REQUEST)
+                result.push_back(data[0]);
+        }
+        return result;
+    }
+};
+
+// Все записи в сокеты ядра по дескрипторам, с ожиданием из тестового потока
+struct Writes
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::map<int, std::vector<std::string>> byFd;
+
+    std::vector<std::string> repliesTo(int fd)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return byFd[fd];
+    }
+
+    std::vector<std::string> waitFor(int fd, size_t count)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::seconds(5), [&]() { return byFd[fd].size() >= count; });
+        return byFd[fd];
+    }
+
+    std::vector<mms::Event> events(int fd)
+    {
+        NetworkSerializer serializer;
+        std::vector<mms::Event> result;
+        for (const auto &frame : repliesTo(fd))
+        {
+            for (const auto &text : serializer.split(frame))
+            {
+                const auto status = serializer.deserialize<pkg::Status>(text);
+                if (status.what == "mms::Event")
+                    result.push_back(serializer.deserialize<mms::Event>(status.subMessage));
+            }
+        }
+        return result;
+    }
+
+    // Разобранные ответы на запросы, без событий
+    std::vector<pkg::Status> statuses(int fd)
+    {
+        NetworkSerializer serializer;
+        std::vector<pkg::Status> result;
+        for (const auto &frame : repliesTo(fd))
+        {
+            for (const auto &text : serializer.split(frame))
+            {
+                auto status = serializer.deserialize<pkg::Status>(text);
+                if (status.what != "mms::Event")
+                    result.push_back(std::move(status));
+            }
+        }
+        return result;
+    }
+};
+
+inline std::shared_ptr<Writes> captureWrites(NiceMock<MockSocket> &socket)
+{
+    auto writes = std::make_shared<Writes>();
+    ON_CALL(socket, write(_, _, _))
+        .WillByDefault(Invoke([writes](int fd, const void *buf, size_t count) {
+            std::lock_guard<std::mutex> lock(writes->mutex);
+            writes->byFd[fd].emplace_back(static_cast<const char *>(buf), count);
+            writes->cv.notify_all();
+            return count;
+        }));
+    return writes;
+}
+
+inline std::shared_ptr<Writes> captureWrites(TestRig &rig)
+{
+    return captureWrites(*rig.socket);
+}
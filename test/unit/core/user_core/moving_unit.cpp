@@ -166,3 +166,25 @@ TEST(Moving, ZeroMaxSpeed)
     EXPECT_THAT(*rig.lastWrite, HasSubstr("40505"));
 }
 
+
+TEST(Moving, McuTimeoutRunsInVirtualTime)
+{
+    auto rig = makeRig();
+    ON_CALL(*rig.module, checkRXChannel()).WillByDefault(Return(0));
+
+    mms::MotorsSettings settings;
+    settings.mode = "synchronous";
+    settings.motors.push_back(mms::Motor{1, 1000, 2000, 10});
+    auto msg = NetworkSerializer().serialize(pkg::Message{
+        14,
+        NetworkSerializer().serialize(mms::Manager{"moving", NetworkSerializer().serialize(settings)})});
+
+    const auto virtualStart = rig.clock->now();
+    const auto realStart = std::chrono::steady_clock::now();
+    rig.core->Process(1, "cli", msg);
+
+    // Готовность не пришла, завершение не пришло: два таймаута по 5 с и пауза 200 мс - без реального ожидания
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40511"));
+    EXPECT_GE(rig.clock->now() - virtualStart, 2 * UserCore::MCU_TIMEOUT + UserCore::MOVE_SETTLE_DELAY);
+    EXPECT_LT(std::chrono::steady_clock::now() - realStart, std::chrono::seconds(1));
+}
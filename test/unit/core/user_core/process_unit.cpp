@@ -1,6 +1,7 @@
 #include "mocks.hpp"
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <thread>
 using ::testing::Return;
 using ::testing::Invoke;
 using ::testing::HasSubstr;
@@ -18,3 +19,30 @@ TEST(Process, UnknownCommand)
     EXPECT_EQ(rig.lastWrite->size(), 0);
 }
 
+
+TEST(Process, ReplyToClosedConnectionIsDropped)
+{
+    auto rig = makeRig();
+    ManualClock clock;
+    rig.core->setClock(clock);
+    FakeMcu mcu(*rig.module);
+    mcu.moving = true;
+    auto replies = captureWrites(rig);
+
+    // Поток платы не запущен: команда ждет завершения движения в своем потоке
+    std::thread mover([&rig]() { rig.core->Process(11, "operator", movingRequest({{1, 2000, 5000, 100}})); });
+    ASSERT_TRUE(clock.waitForSleepers(1));
+
+    // Клиент закрыл соединение, accept() отдал тот же дескриптор новому клиенту
+    rig.core->Disconnected(11);
+    rig.core->Process(11, "panel", request("status", ""));
+
+    mcu.moving = false;
+    clock.advance(UserCore::MOVE_SETTLE_DELAY + UserCore::MCU_POLL_INTERVAL);
+    mover.join();
+
+    // Новый клиент получил только ответ на свой запрос
+    const auto answers = replies->repliesTo(11);
+    ASSERT_EQ(answers.size(), 1u);
+    EXPECT_THAT(answers[0], HasSubstr("mms::MotorsState"));
+}
@@ -0,0 +1,184 @@
+#include "mocks.hpp"
+#include "device_manager.hpp"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <thread>
+using ::testing::Return;
+using ::testing::Invoke;
+using ::testing::HasSubstr;
+
+namespace
+{
+mms::MotorsSettings step(const std::vector<int> &numbers)
+{
+    mms::MotorsSettings settings;
+    settings.mode = "synchronous";
+    for (int number : numbers)
+        settings.motors.push_back(mms::Motor{number, 2000, 5000, 100});
+    return settings;
+}
+
+std::string programRequest(const std::vector<mms::MotorsSettings> &steps)
+{
+    return request("program", NetworkSerializer().serialize(mms::Program{steps}));
+}
+} // namespace
+
+TEST(Program, NotConnected)
+{
+    auto rig = makeRig();
+    ON_CALL(*rig.module, isConnected()).WillByDefault(Return(false));
+    EXPECT_CALL(*rig.module, writeData(_)).Times(0);
+    rig.core->Process(1, "cli", programRequest({step({1})}));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40507"));
+}
+
+TEST(Program, InvalidJson)
+{
+    auto rig = makeRig();
+    EXPECT_CALL(*rig.module, writeData(_)).Times(0);
+    rig.core->Process(1, "cli", request("program", "{\"steps\": 1"));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40404"));
+}
+
+TEST(Program, StepCountIsLimited)
+{
+    auto rig = makeRig();
+    EXPECT_CALL(*rig.module, writeData(_)).Times(0);
+
+    rig.core->Process(1, "cli", programRequest({}));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40517"));
+
+    const std::vector<mms::MotorsSettings> steps(UserCore::MAX_PROGRAM_STEPS + 1, step({1}));
+    rig.core->Process(1, "cli", programRequest(steps));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40517"));
+}
+
+TEST(Program, InvalidStepRejectsWholeProgram)
+{
+    auto rig = makeRig();
+    EXPECT_CALL(*rig.module, writeData(_)).Times(0);
+
+    auto bad = step({2});
+    bad.mode = "sideways";
+    rig.core->Process(1, "cli", programRequest({step({1}), bad, step({3})}));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40501"));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("step 2"));
+}
+
+TEST(Program, StepsRunBackToBack)
+{
+    auto rig = makeRig();
+    FakeMcu board(*rig.module);
+    auto frames = captureWrites(rig);
+
+    rig.core->Process(10, "dashboard", request("subscribe", ""));
+    const auto started = rig.clock->now();
+    rig.core->Process(11, "operator", programRequest({step({1}), step({2, 3}), step({4})}));
+
+    // Шаги уходят в MCU по порядку и без паузы MOVE_SETTLE_DELAY между ними
+    EXPECT_EQ(board.headers(), (std::vector<uchar>{0x81, 0x82, 0x81}));
+    EXPECT_LT(rig.clock->now() - started, UserCore::MOVE_SETTLE_DELAY);
+
+    const auto progress = frames->events(11);
+    ASSERT_EQ(progress.size(), 3u);
+    for (size_t i = 0; i < progress.size(); ++i)
+    {
+        EXPECT_EQ(progress[i].type, "progress");
+        EXPECT_EQ(progress[i].command, "program");
+        EXPECT_EQ(progress[i].what, std::format("step {}/3", i + 1));
+        EXPECT_EQ(progress[i].status, 0u);
+    }
+    ASSERT_EQ(progress[1].motors.size(), 2u);
+    EXPECT_EQ(progress[1].motors[0].number, 2);
+    EXPECT_FALSE(progress[1].motors[0].busy);
+
+    const auto replies = frames->statuses(11);
+    ASSERT_EQ(replies.size(), 1u);
+    EXPECT_EQ(replies[0].status, 0u);
+
+    // Подписчики видят прогресс и итог программы
+    const auto events = frames->events(10);
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(events[2].what, "step 3/3");
+    EXPECT_EQ(events[3].type, "completed");
+    EXPECT_EQ(events[3].command, "program");
+}
+
+TEST(Program, FailedStepEndsProgram)
+{
+    auto rig = makeRig();
+    FakeMcu board(*rig.module);
+    auto frames = captureWrites(rig);
+
+    // Второй шаг завершается ошибкой MCU, третий не отправляется
+    ON_CALL(*rig.module, readData(_)).WillByDefault(Invoke([&board](std::vector<uchar> &data) {
+        if (data.size() == 1)
+            data[0] = 0x00;
+        else
+            data = {0x00, static_cast<uchar>(board.headers().size() == 2 ? 0x07 : 0xFF)};
+    }));
+    rig.core->Process(11, "operator", programRequest({step({1}), step({2}), step({3})}));
+
+    EXPECT_EQ(board.headers().size(), 2u);
+    const auto progress = frames->events(11);
+    ASSERT_EQ(progress.size(), 2u);
+    EXPECT_EQ(progress[1].status, 40513u);
+
+    const auto replies = frames->statuses(11);
+    ASSERT_EQ(replies.size(), 1u);
+    EXPECT_EQ(replies[0].status, 40513u);
+    EXPECT_THAT(replies[0].what, HasSubstr("at step 2/3"));
+}
+
+TEST(Program, StopCancelsRemainingSteps)
+{
+    auto rig = makeRig();
+    ManualClock clock;
+    rig.core->setClock(clock);
+    FakeMcu board(*rig.module);
+    auto frames = captureWrites(rig);
+    board.moving = true;
+
+    // Поток платы не запущен: программа идет в своем потоке, stop() приходит из тестового
+    const std::string program = programRequest({step({1}), step({2})});
+    std::thread runner([&rig, &program]() { rig.core->Process(11, "operator", program); });
+    ASSERT_TRUE(clock.waitForSleepers(1));
+    rig.core->Process(12, "panel", request("stop", ""));
+    runner.join();
+
+    EXPECT_EQ(board.headers(), std::vector<uchar>{0x81});
+    const auto replies = frames->statuses(11);
+    ASSERT_EQ(replies.size(), 1u);
+    EXPECT_EQ(replies[0].status, 40516u);
+    EXPECT_THAT(replies[0].what, HasSubstr("at step 1/2"));
+}
+
+TEST(Program, StepSpansBoards)
+{
+    auto *moduleA = new NiceMock<MockModule>();
+    auto *moduleB = new NiceMock<MockModule>();
+    auto *socket = new NiceMock<MockSocket>();
+    FakeMcu boardA(*moduleA), boardB(*moduleB);
+    auto frames = captureWrites(*socket);
+
+    DeviceManager devices;
+    devices.add(std::unique_ptr<IModule>(moduleA), 0, 1, 10);
+    devices.add(std::unique_ptr<IModule>(moduleB), 1, 11, 20);
+    UserCore core(std::move(devices), std::unique_ptr<ISocket>(socket));
+    ManualClock clock(true);
+    core.setClock(clock);
+
+    core.Process(11, "operator", programRequest({step({2, 11, 12}), step({13})}));
+
+    EXPECT_EQ(boardA.headers(), std::vector<uchar>{0x81});
+    EXPECT_EQ(boardB.headers(), (std::vector<uchar>{0x82, 0x81}));
+
+    const auto progress = frames->events(11);
+    ASSERT_EQ(progress.size(), 2u);
+    EXPECT_EQ(progress[0].motors.size(), 3u);
+
+    const auto replies = frames->statuses(11);
+    ASSERT_EQ(replies.size(), 1u);
+    EXPECT_EQ(replies[0].status, 0u);
+}
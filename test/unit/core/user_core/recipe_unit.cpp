@@ -0,0 +1,152 @@
+#include "mocks.hpp"
+#include "move_cache.hpp"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+using ::testing::Return;
+using ::testing::Invoke;
+using ::testing::HasSubstr;
+
+namespace
+{
+mms::MotorsSettings settings(const std::vector<mms::Motor> &motors, const std::string &mode = "synchronous")
+{
+    mms::MotorsSettings result;
+    result.mode = mode;
+    result.motors = motors;
+    return result;
+}
+
+std::string recipeRequest(const std::string &name, const mms::MotorsSettings &settings)
+{
+    return request("save_recipe", NetworkSerializer().serialize(mms::Recipe{name, settings}));
+}
+
+uint64_t counterValue(const std::string &name)
+{
+    return MetricsRegistry::instance().counter(name, "").value();
+}
+
+std::shared_ptr<const CompiledMove> compiled(int motors)
+{
+    auto move = std::make_shared<CompiledMove>();
+    move->motors.resize(static_cast<size_t>(motors));
+    return move;
+}
+} // namespace
+
+TEST(MoveCache, EvictsLeastRecentlyUsed)
+{
+    MoveCache cache(2);
+    cache.insert("a", compiled(1));
+    cache.insert("b", compiled(2));
+    ASSERT_NE(cache.find("a"), nullptr); // "b" теперь самая старая
+
+    cache.insert("c", compiled(3));
+    EXPECT_EQ(cache.find("b"), nullptr);
+    ASSERT_NE(cache.find("a"), nullptr);
+    ASSERT_NE(cache.find("c"), nullptr);
+    EXPECT_EQ(cache.find("c")->motors.size(), 3u);
+}
+
+TEST(MoveCache, RecipesAreLimitedButReplaceable)
+{
+    MoveCache cache(0);
+    for (size_t i = 0; i < MoveCache::MAX_RECIPES; ++i)
+        ASSERT_TRUE(cache.storeRecipe(std::format("r{}", i), compiled(1)));
+
+    EXPECT_FALSE(cache.storeRecipe("extra", compiled(1)));
+    EXPECT_TRUE(cache.storeRecipe("r0", compiled(2)));
+    EXPECT_EQ(cache.recipe("r0")->motors.size(), 2u);
+    EXPECT_EQ(cache.recipe("extra"), nullptr);
+
+    // Без емкости кэш moving() ничего не хранит
+    cache.insert("a", compiled(1));
+    EXPECT_EQ(cache.find("a"), nullptr);
+}
+
+TEST(Moving, RepeatedSettingsAreServedFromCache)
+{
+    auto rig = makeRig();
+    auto writes = answerMoves(rig);
+    const std::string text = NetworkSerializer().serialize(settings({{4, 2000, 5000, 100}}));
+    const auto hits = counterValue("mms_move_cache_hits_total");
+    const auto misses = counterValue("mms_move_cache_misses_total");
+
+    // Разные id: это новая команда с теми же настройками, а не повтор запроса
+    rig.core->Process(1, "cli", request("moving", text, 1));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+    rig.core->Process(1, "cli", request("moving", text, 2));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+
+    EXPECT_EQ(counterValue("mms_move_cache_misses_total") - misses, 1u);
+    EXPECT_EQ(counterValue("mms_move_cache_hits_total") - hits, 1u);
+
+    // Кадр из кэша тот же, что закодирован для первого запроса
+    ASSERT_EQ(writes->size(), 4u);
+    EXPECT_EQ((*writes)[0], (*writes)[2]);
+    EXPECT_EQ((*writes)[1], (*writes)[3]);
+    EXPECT_EQ(McuTransaction::loadLE32((*writes)[3].data()), 4u);
+}
+
+TEST(Moving, InvalidSettingsAreNotCached)
+{
+    auto rig = makeRig();
+    EXPECT_CALL(*rig.module, writeData(_)).Times(0);
+    const std::string move =
+        request("moving", NetworkSerializer().serialize(settings({{1, 2000, 5000, 100}}, "sideways")));
+
+    rig.core->Process(1, "cli", move);
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40501"));
+    rig.core->Process(1, "cli", move);
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40501"));
+}
+
+TEST(Moving, CachedMoveChecksConnection)
+{
+    auto rig = makeRig();
+    answerMoves(rig);
+    const std::string text = NetworkSerializer().serialize(settings({{1, 2000, 5000, 100}}));
+    rig.core->Process(1, "cli", request("moving", text, 1));
+
+    ON_CALL(*rig.module, isConnected()).WillByDefault(Return(false));
+    rig.core->Process(1, "cli", request("moving", text, 2));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40507"));
+}
+
+TEST(Recipe, SaveAndRun)
+{
+    auto rig = makeRig();
+    auto writes = answerMoves(rig);
+
+    const auto home = settings({{2, 2000, 5000, -100}, {3, 2000, 5000, -100}});
+    rig.core->Process(1, "cli", recipeRequest("home", home));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+    EXPECT_TRUE(writes->empty());
+
+    rig.core->Process(2, "panel", request("run_recipe", "home"));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+    ASSERT_EQ(writes->size(), 2u);
+    EXPECT_EQ((*writes)[0], std::vector<uchar>{0x82});
+    EXPECT_EQ(McuTransaction::loadLE32((*writes)[1].data()), 2u);
+
+    rig.core->Process(2, "panel", request("status", ""));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("-100"));
+}
+
+TEST(Recipe, Errors)
+{
+    auto rig = makeRig();
+    EXPECT_CALL(*rig.module, writeData(_)).Times(0);
+
+    rig.core->Process(1, "cli", request("save_recipe", "{\"name\": 1"));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40405"));
+
+    rig.core->Process(1, "cli", recipeRequest("", settings({{1, 2000, 5000, 100}})));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40519"));
+
+    // Неверные настройки не сохраняются
+    rig.core->Process(1, "cli", recipeRequest("calibrate", settings({{1, 0, 5000, 100}})));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40504"));
+    rig.core->Process(1, "cli", request("run_recipe", "calibrate"));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40518"));
+}
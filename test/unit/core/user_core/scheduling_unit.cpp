@@ -0,0 +1,142 @@
+#include "mocks.hpp"
+#include "fair_queue.hpp"
+#include "device_channel.hpp"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <format>
+#include <future>
+using ::testing::Return;
+using ::testing::Invoke;
+using ::testing::HasSubstr;
+using ::testing::ElementsAre;
+
+namespace
+{
+std::string drain(FairQueue<std::string> &queue)
+{
+    std::string order;
+    for (std::string item; queue.pop(item);)
+        order += item;
+    return order;
+}
+} // namespace
+
+TEST(FairQueue, AlternatesClients)
+{
+    FairQueue<std::string> queue;
+    for (const char *item : {"a1", "a2", "a3", "a4"})
+        queue.push("a", item);
+    queue.push("b", "b1");
+    queue.push("c", "c1");
+    queue.push("c", "c2");
+
+    EXPECT_EQ(queue.size(), 7u);
+    EXPECT_EQ(queue.size("c"), 2u);
+    EXPECT_EQ(drain(queue), "a1b1c1a2c2a3a4");
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(FairQueue, WeightGivesConsecutiveTurns)
+{
+    FairQueue<std::string> queue;
+    queue.setWeight("a", 2);
+    queue.setWeight("b", 0); // не меньше 1
+    for (const char *item : {"a1", "a2", "a3", "a4", "a5"})
+        queue.push("a", item);
+    queue.push("b", "b1");
+    queue.push("b", "b2");
+
+    EXPECT_EQ(drain(queue), "a1a2b1a3a4b2a5");
+}
+
+TEST(FairQueue, IdleClientDoesNotSaveUpTurns)
+{
+    FairQueue<std::string> queue;
+    queue.setWeight("a", 3);
+    queue.push("a", "a1");
+    queue.push("b", "b1");
+    queue.push("b", "b2");
+    EXPECT_EQ(drain(queue), "a1b1b2");
+
+    // Неиспользованные два задания кванта "a" не переходят в следующий круг
+    for (const char *item : {"a2", "a3", "a4", "a5"})
+        queue.push("a", item);
+    queue.push("b", "b3");
+    EXPECT_EQ(drain(queue), "a2a3a4b3a5");
+}
+
+TEST(FairQueue, DrainedClientIsForgotten)
+{
+    FairQueue<std::string> queue;
+    queue.setWeight("a", 2);
+    for (int i = 0; i < 100; ++i)
+        queue.push(std::format("once-{}", i), "x");
+    queue.push("a", "a1");
+    EXPECT_EQ(queue.clients(), 101u);
+
+    std::string popped;
+    while (queue.pop(popped))
+        ;
+    EXPECT_EQ(queue.clients(), 0u);
+
+    // Вес переживает удаление клиента
+    for (const char *item : {"a2", "a3", "a4"})
+        queue.push("a", item);
+    queue.push("b", "b1");
+    EXPECT_EQ(drain(queue), "a2a3b1a4");
+}
+
+TEST(DeviceChannel, LightClientIsNotBehindHeavyQueue)
+{
+    DeviceChannel channel(std::make_unique<NiceMock<MockModule>>(), 0, 1, 10);
+    channel.start();
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::vector<std::string> order;
+    channel.post([released](DeviceChannel &) { released.wait(); });
+    for (int i = 1; i <= 5; ++i)
+        channel.post([&order, i](DeviceChannel &) { order.push_back(std::format("heavy{}", i)); }, "heavy");
+    channel.post([&order](DeviceChannel &) { order.push_back("light"); }, "light");
+
+    EXPECT_EQ(channel.pending("heavy"), 5u);
+    EXPECT_EQ(channel.pending("light"), 1u);
+    release.set_value();
+    channel.stop();
+
+    EXPECT_THAT(order, ElementsAre("heavy1", "light", "heavy2", "heavy3", "heavy4", "heavy5"));
+}
+
+TEST(Scheduling, ClientQueueLimit)
+{
+    auto rig = makeRig();
+    ManualClock clock;
+    rig.core->setClock(clock);
+    rig.core->setClientQueueLimit(2);
+    FakeMcu mcu(*rig.module);
+    mcu.moving = true;
+    auto replies = captureWrites(rig);
+    rig.core->Init();
+
+    // Первая команда выполняется, еще две ждут в очереди платы
+    rig.core->Process(11, "operator", movingRequest({{1, 2000, 5000, 100}}, 1));
+    ASSERT_TRUE(clock.waitForSleepers(1));
+    rig.core->Process(11, "operator", movingRequest({{2, 2000, 5000, 100}}, 2));
+    rig.core->Process(11, "operator", movingRequest({{3, 2000, 5000, 100}}, 3));
+    EXPECT_TRUE(replies->repliesTo(11).empty());
+
+    rig.core->Process(11, "operator", movingRequest({{4, 2000, 5000, 100}}, 4));
+    ASSERT_EQ(replies->repliesTo(11).size(), 1u);
+    EXPECT_THAT(replies->repliesTo(11)[0], HasSubstr("40520"));
+
+    // Предел - на клиента: очередь другого клиента не заполнена
+    rig.core->Process(13, "panel", movingRequest({{5, 2000, 5000, 100}}, 1));
+    EXPECT_TRUE(replies->repliesTo(13).empty());
+
+    rig.core->Process(12, "panel", request("stop", "", 2));
+    rig.core->Stop();
+
+    EXPECT_EQ(replies->repliesTo(11).size(), 4u);
+    ASSERT_EQ(replies->repliesTo(13).size(), 1u);
+    EXPECT_THAT(replies->repliesTo(13)[0], HasSubstr("Stopped before start"));
+}
@@ -0,0 +1,153 @@
+#include "mocks.hpp"
+#include "motor_state_table.hpp"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <thread>
+using ::testing::Return;
+using ::testing::Invoke;
+using ::testing::HasSubstr;
+
+namespace
+{
+mms::MotorsState readStatus(TestRig &rig)
+{
+    rig.core->Process(1, "cli", request("status", ""));
+    NetworkSerializer serializer;
+    const auto reply = serializer.deserialize<pkg::Status>(*rig.lastWrite);
+    EXPECT_EQ(reply.status, 0u);
+    EXPECT_EQ(reply.what, "mms::MotorsState");
+    return serializer.deserialize<mms::MotorsState>(reply.subMessage);
+}
+} // namespace
+
+TEST(MotorStateTable, AcceptAndComplete)
+{
+    MotorStateTable table(1, 10);
+    EXPECT_TRUE(table.contains(10));
+    EXPECT_FALSE(table.contains(11));
+
+    const mms::Motor motor{3, 2000, 5000, -50};
+    table.accept(motor);
+    auto state = table.get(3);
+    EXPECT_TRUE(state.busy);
+    EXPECT_EQ(state.step, -50);
+    EXPECT_EQ(state.acceleration, 2000u);
+    EXPECT_EQ(state.position, 0);
+
+    table.complete(motor, 0);
+    state = table.get(3);
+    EXPECT_FALSE(state.busy);
+    EXPECT_EQ(state.position, -50);
+    EXPECT_EQ(state.error, 0u);
+
+    // Ошибка не сдвигает позицию
+    table.accept(motor);
+    table.complete(motor, 40513);
+    state = table.get(3);
+    EXPECT_EQ(state.position, -50);
+    EXPECT_EQ(state.error, 40513u);
+}
+
+TEST(MotorStateTable, QueuedCommandsKeepMotorBusy)
+{
+    MotorStateTable table(11, 20);
+    const mms::Motor first{11, 100, 100, 10};
+    const mms::Motor second{11, 200, 200, 20};
+
+    table.accept(first);
+    table.accept(second);
+    table.complete(first, 0);
+    EXPECT_TRUE(table.get(11).busy);
+    EXPECT_EQ(table.get(11).step, 20);
+
+    table.complete(second, 0);
+    EXPECT_FALSE(table.get(11).busy);
+    EXPECT_EQ(table.get(11).position, 30);
+}
+
+TEST(MotorStateTable, ReaderNeverSeesTornState)
+{
+    MotorStateTable table(1, 1);
+    std::atomic<bool> done{false};
+
+    // Писатель держит acceleration == maxSpeed == step: разорванное чтение их разведет
+    std::thread writer([&table, &done]() {
+        for (uint32_t i = 1; i <= 20000; ++i)
+        {
+            table.accept(mms::Motor{1, i, i, static_cast<int32_t>(i)});
+            table.complete(mms::Motor{1, i, i, static_cast<int32_t>(i)}, 0);
+        }
+        done = true;
+    });
+
+    size_t reads = 0;
+    while (!done || reads == 0)
+    {
+        const auto state = table.get(1);
+        ASSERT_EQ(state.acceleration, state.maxSpeed);
+        ASSERT_EQ(static_cast<uint32_t>(state.step), state.acceleration);
+        ++reads;
+    }
+    writer.join();
+    EXPECT_EQ(table.get(1).position, 20000LL * 20001 / 2);
+}
+
+TEST(Status, EmptyBeforeAnyMove)
+{
+    auto rig = makeRig();
+    const auto state = readStatus(rig);
+    ASSERT_EQ(state.motors.size(), 10u);
+    EXPECT_EQ(state.motors.front().number, 1);
+    EXPECT_EQ(state.motors.back().number, 10);
+    EXPECT_EQ(state.motors.front().position, 0);
+    EXPECT_FALSE(state.motors.front().busy);
+}
+
+TEST(Status, NonEmptyMessage)
+{
+    auto rig = makeRig();
+    rig.core->Process(1, "cli", request("status", "1"));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40506"));
+}
+
+TEST(Status, DoesNotTouchModule)
+{
+    auto rig = makeRig();
+    EXPECT_CALL(*rig.module, isConnected()).Times(0);
+    EXPECT_CALL(*rig.module, writeData(_)).Times(0);
+    readStatus(rig);
+}
+
+TEST(Status, TracksCompletedMoves)
+{
+    auto rig = makeRig();
+    answerMoves(rig);
+
+    rig.core->Process(1, "cli", movingRequest({{2, 2000, 5000, 100}, {5, 1500, 4500, -30}}));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+    rig.core->Process(1, "cli", movingRequest({{2, 1000, 3000, 50}}));
+
+    const auto state = readStatus(rig);
+    EXPECT_EQ(state.motors[1].position, 150);
+    EXPECT_EQ(state.motors[1].step, 50);
+    EXPECT_EQ(state.motors[1].acceleration, 1000u);
+    EXPECT_EQ(state.motors[1].maxSpeed, 3000u);
+    EXPECT_FALSE(state.motors[1].busy);
+    EXPECT_EQ(state.motors[4].position, -30);
+    EXPECT_EQ(state.motors[0].position, 0);
+}
+
+TEST(Status, RecordsExecutionError)
+{
+    auto rig = makeRig();
+    answerMoves(rig, 0x06);
+
+    rig.core->Process(1, "cli", movingRequest({{7, 2000, 5000, 100}}));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40513"));
+
+    const auto state = readStatus(rig);
+    EXPECT_EQ(state.motors[6].position, 0);
+    EXPECT_EQ(state.motors[6].step, 100);
+    EXPECT_EQ(state.motors[6].error, 40513u);
+    EXPECT_FALSE(state.motors[6].busy);
+}
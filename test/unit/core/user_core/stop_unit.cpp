@@ -0,0 +1,147 @@
+#include "mocks.hpp"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <future>
+#include <thread>
+using ::testing::Return;
+using ::testing::Invoke;
+using ::testing::HasSubstr;
+
+TEST(Stop, NonEmptyMessage)
+{
+    auto rig = makeRig();
+    EXPECT_CALL(*rig.module, writeData(_)).Times(0);
+    rig.core->Process(1, "cli", request("stop", "now"));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40506"));
+}
+
+TEST(Stop, NotConnected)
+{
+    auto rig = makeRig();
+    ON_CALL(*rig.module, isConnected()).WillByDefault(Return(false));
+    EXPECT_CALL(*rig.module, writeData(_)).Times(0);
+    rig.core->Process(1, "cli", request("stop", ""));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40507"));
+}
+
+TEST(Stop, WritesStopByteImmediately)
+{
+    auto rig = makeRig();
+    EXPECT_CALL(*rig.module, writeData(std::vector<uchar>{McuTransaction::EMERGENCY_STOP})).Times(1);
+    rig.core->Process(1, "cli", request("stop", ""));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+}
+
+TEST(Stop, InterruptsCompletionWait)
+{
+    auto rig = makeRig();
+    ManualClock clock;
+    rig.core->setClock(clock);
+    FakeMcu mcu(*rig.module);
+    mcu.moving = true;
+    auto replies = captureWrites(rig);
+
+    // Поток платы не запущен: moving() ждет завершения в своем потоке, stop() приходит из тестового
+    std::thread mover([&rig]() { rig.core->Process(11, "operator", movingRequest({{1, 2000, 5000, 100}})); });
+    ASSERT_TRUE(clock.waitForSleepers(1));
+
+    rig.core->Process(12, "panel", request("stop", ""));
+    mover.join();
+
+    // Виртуальное время не сдвигалось: ожидание прервано, а не досижено до срока
+    EXPECT_EQ(clock.now(), IClock::TimePoint{});
+    ASSERT_EQ(replies->repliesTo(11).size(), 1u);
+    EXPECT_THAT(replies->repliesTo(11)[0], HasSubstr("40516"));
+    ASSERT_EQ(replies->repliesTo(12).size(), 1u);
+    EXPECT_THAT(replies->repliesTo(12)[0], HasSubstr("\"status\":0"));
+}
+
+TEST(Stop, CancelsQueuedMoves)
+{
+    auto rig = makeRig();
+    ManualClock clock;
+    rig.core->setClock(clock);
+    FakeMcu mcu(*rig.module);
+    mcu.moving = true;
+    auto replies = captureWrites(rig);
+    rig.core->Init();
+
+    rig.core->Process(11, "operator", movingRequest({{1, 2000, 5000, 100}}));
+    ASSERT_TRUE(clock.waitForSleepers(1));
+    rig.core->Process(11, "operator", movingRequest({{2, 2000, 5000, 100}}));
+    rig.core->Process(12, "panel", request("stop", ""));
+    rig.core->Stop();
+
+    const auto answers = replies->repliesTo(11);
+    ASSERT_EQ(answers.size(), 2u);
+    EXPECT_THAT(answers[0], HasSubstr("40516"));
+    EXPECT_THAT(answers[1], HasSubstr("Stopped before start"));
+
+    // Вторая команда до MCU не дошла: запрос версии из Init(), заголовок, параметры первой и байт
+    // остановки
+    const auto writes = mcu.writes();
+    ASSERT_EQ(writes.size(), 4u);
+    EXPECT_EQ(writes[0], std::vector<uchar>{McuTransaction::VERSION_REQUEST});
+    EXPECT_EQ(writes[1], std::vector<uchar>{0x81});
+    EXPECT_EQ(writes[3], std::vector<uchar>{McuTransaction::EMERGENCY_STOP});
+}
+
+TEST(Stop, WaitsForOpenFrame)
+{
+    auto rig = makeRig();
+    ManualClock clock;
+    rig.core->setClock(clock);
+    FakeMcu mcu(*rig.module);
+    mcu.moving = true;
+    auto replies = captureWrites(rig);
+    mcu.ready = false;
+
+    // Заголовок записан, MCU ждет параметры: байт остановки посреди кадра был бы принят за параметр
+    std::thread mover([&rig]() { rig.core->Process(11, "operator", movingRequest({{1, 2000, 5000, 100}})); });
+    ASSERT_TRUE(clock.waitForSleepers(1));
+    rig.core->Process(12, "panel", request("stop", ""));
+    EXPECT_EQ(mcu.writes().size(), 1u);
+
+    mcu.ready = true;
+    clock.advance(UserCore::MCU_POLL_INTERVAL);
+    mover.join();
+
+    const auto writes = mcu.writes();
+    ASSERT_EQ(writes.size(), 2u);
+    EXPECT_EQ(writes[1].size(), McuTransaction::MOTOR_FRAME_SIZE + 1);
+    EXPECT_EQ(writes[1].back(), McuTransaction::EMERGENCY_STOP);
+    EXPECT_THAT(replies->repliesTo(11).at(0), HasSubstr("40516"));
+}
+
+TEST(Stop, InterruptsReadinessWait)
+{
+    auto rig = makeRig();
+    ManualClock clock;
+    rig.core->setClock(clock);
+    FakeMcu mcu(*rig.module);
+    mcu.moving = true;
+    auto replies = captureWrites(rig);
+    mcu.ready = false;
+
+    auto mover = std::async(std::launch::async, [&rig]() {
+        rig.core->Process(11, "operator", movingRequest({{1, 2000, 5000, 100}}));
+    });
+    ASSERT_TRUE(clock.waitForSleepers(1));
+
+    // Готовность пришла, пока поток платы спит в паузе опроса: stop() будит его, параметры и STOP
+    // уходят сразу, а не после паузы
+    mcu.ready = true;
+    rig.core->Process(12, "panel", request("stop", ""));
+    const bool woken = mover.wait_for(std::chrono::seconds(1)) == std::future_status::ready;
+    if (!woken)
+        clock.advance(UserCore::MCU_POLL_INTERVAL);
+    mover.get();
+    ASSERT_TRUE(woken);
+
+    EXPECT_EQ(clock.now(), IClock::TimePoint{});
+    const auto writes = mcu.writes();
+    ASSERT_EQ(writes.size(), 2u);
+    EXPECT_EQ(writes[1].size(), McuTransaction::MOTOR_FRAME_SIZE + 1);
+    EXPECT_EQ(writes[1].back(), McuTransaction::EMERGENCY_STOP);
+    EXPECT_THAT(replies->repliesTo(11).at(0), HasSubstr("40516"));
+}
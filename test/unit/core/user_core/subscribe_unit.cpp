@@ -0,0 +1,163 @@
+#include "mocks.hpp"
+#include "event_hub.hpp"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <algorithm>
+using ::testing::Return;
+using ::testing::Invoke;
+using ::testing::HasSubstr;
+
+TEST(EventHub, FansOutOneFrame)
+{
+    std::vector<std::pair<int, std::string>> written;
+    EventHub hub([&written](int fd, std::string_view frame) {
+        written.emplace_back(fd, std::string(frame));
+        return true;
+    });
+    EXPECT_TRUE(hub.empty());
+
+    EXPECT_TRUE(hub.subscribe(3, "a"));
+    EXPECT_TRUE(hub.subscribe(4, "b"));
+    EXPECT_FALSE(hub.subscribe(3, "a"));
+    EXPECT_FALSE(hub.empty());
+
+    hub.publish("one\n\n");
+    hub.publish("two\n\n", 3);
+    std::sort(written.begin(), written.end());
+    const std::vector<std::pair<int, std::string>> expected{{3, "one\n\n"}, {4, "one\n\n"}, {4, "two\n\n"}};
+    EXPECT_EQ(written, expected);
+
+    EXPECT_TRUE(hub.unsubscribe(3));
+    EXPECT_FALSE(hub.unsubscribe(3));
+}
+
+TEST(EventHub, FailedWriteUnsubscribes)
+{
+    size_t attempts = 0;
+    EventHub hub([&attempts](int, std::string_view) {
+        ++attempts;
+        return false;
+    });
+    hub.subscribe(5, "gone");
+    hub.publish("x\n\n");
+    hub.publish("y\n\n");
+    EXPECT_EQ(attempts, 1u);
+    EXPECT_TRUE(hub.empty());
+}
+
+TEST(EventHub, ThreadKeepsOrderAndDrainsOnStop)
+{
+    std::mutex mutex;
+    std::vector<std::string> written;
+    EventHub hub([&](int, std::string_view frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        written.emplace_back(frame);
+        return true;
+    });
+    hub.subscribe(7, "dashboard");
+    hub.start();
+    for (int i = 0; i < 100; ++i)
+        hub.publish(std::to_string(i));
+    hub.stop();
+
+    ASSERT_EQ(written.size(), 100u);
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(written[static_cast<size_t>(i)], std::to_string(i));
+}
+
+TEST(EventHub, SlowSubscriberLosesOldest)
+{
+    std::mutex gate;
+    std::vector<std::string> written;
+    EventHub hub([&](int, std::string_view frame) {
+        std::lock_guard<std::mutex> lock(gate);
+        written.emplace_back(frame);
+        return true;
+    });
+    hub.subscribe(8, "slow");
+
+    {
+        // Поток рассылки стоит на первом кадре, остальные копятся в очереди
+        std::unique_lock<std::mutex> lock(gate);
+        hub.start();
+        hub.publish("first");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        for (size_t i = 0; i < EventHub::MAX_QUEUED + 10; ++i)
+            hub.publish(std::to_string(i));
+    }
+    hub.stop();
+
+    ASSERT_EQ(written.size(), EventHub::MAX_QUEUED + 1);
+    EXPECT_EQ(written[1], "10");
+    EXPECT_EQ(written.back(), std::to_string(EventHub::MAX_QUEUED + 9));
+}
+
+TEST(Subscribe, NonEmptyMessage)
+{
+    auto rig = makeRig();
+    rig.core->Process(1, "cli", request("subscribe", "x"));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("40506"));
+}
+
+TEST(Subscribe, ReceivesOtherClientsCommands)
+{
+    auto rig = makeRig();
+    auto writes = captureWrites(rig);
+    answerMoves(rig);
+
+    rig.core->Process(10, "dashboard", request("subscribe", ""));
+    rig.core->Process(11, "operator", movingRequest({{3, 2000, 5000, 100}}));
+    rig.core->Process(11, "operator", request("status", ""));
+
+    const auto events = writes->events(10);
+    ASSERT_EQ(events.size(), 3u);
+
+    EXPECT_EQ(events[0].type, "motors");
+    EXPECT_EQ(events[0].source, "operator");
+    ASSERT_EQ(events[0].motors.size(), 1u);
+    EXPECT_TRUE(events[0].motors[0].busy);
+
+    EXPECT_EQ(events[1].type, "motors");
+    EXPECT_FALSE(events[1].motors[0].busy);
+    EXPECT_EQ(events[1].motors[0].position, 100);
+
+    EXPECT_EQ(events[2].type, "completed");
+    EXPECT_EQ(events[2].command, "moving");
+    EXPECT_EQ(events[2].status, 0u);
+
+    // Автор команды получает только свои ответы
+    EXPECT_TRUE(writes->events(11).empty());
+}
+
+TEST(Subscribe, ErrorsAndDevices)
+{
+    auto rig = makeRig();
+    auto writes = captureWrites(rig);
+
+    rig.core->Process(10, "dashboard", request("subscribe", ""));
+    rig.core->Process(11, "operator", movingRequest({{42, 2000, 5000, 100}}));
+    rig.core->Process(11, "operator", request("disconnect", ""));
+
+    const auto events = writes->events(10);
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].type, "error");
+    EXPECT_EQ(events[0].status, 40503u);
+    EXPECT_EQ(events[1].type, "disconnected");
+    EXPECT_EQ(events[2].type, "completed");
+    EXPECT_EQ(events[2].command, "disconnect");
+}
+
+TEST(Subscribe, UnsubscribeAndDisconnectStopEvents)
+{
+    auto rig = makeRig();
+    auto writes = captureWrites(rig);
+
+    rig.core->Process(10, "a", request("subscribe", ""));
+    rig.core->Process(12, "b", request("subscribe", ""));
+    rig.core->Process(10, "a", request("unsubscribe", ""));
+    rig.core->Disconnected(12);
+    rig.core->Process(11, "operator", request("listconnect", ""));
+
+    EXPECT_TRUE(writes->events(10).empty());
+    EXPECT_TRUE(writes->events(12).empty());
+}
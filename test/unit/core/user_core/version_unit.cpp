@@ -1,10 +1,34 @@
 #include "mocks.hpp"
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <mutex>
 using ::testing::Return;
 using ::testing::Invoke;
 using ::testing::HasSubstr;
 
+namespace
+{
+float repliedVersion(const std::string &reply)
+{
+    NetworkSerializer serializer;
+    const auto status = serializer.deserialize<pkg::Status>(reply);
+    return serializer.deserialize<mms::Version>(status.subMessage).version;
+}
+
+// Модуль отвечает на запрос версии байтом versionByte, запросы версии считаются в requests
+void answerVersion(TestRig &rig, uint8_t versionByte, int &requests)
+{
+    ON_CALL(*rig.module, checkRXChannel()).WillByDefault(Return(1));
+    ON_CALL(*rig.module, readData(_)).WillByDefault(Invoke([versionByte](std::vector<uchar> &data) {
+        data.assign(1, versionByte);
+    }));
+    ON_CALL(*rig.module, writeData(_)).WillByDefault(Invoke([&requests](const std::vector<uchar> &data) {
+        if (data == std::vector<uchar>{McuTransaction::VERSION_REQUEST})
+            ++requests;
+    }));
+}
+} // namespace
+
 TEST(Version, Success)
 {
     auto rig = makeRig();
@@ -54,3 +78,93 @@ TEST(Version, NotConnected)
     EXPECT_THAT(*rig.lastWrite, HasSubstr("40507"));
 }
 
+
+TEST(Version, ReadOnceAfterReconnect)
+{
+    auto rig = makeRig();
+    int requests = 0;
+    answerVersion(rig, 0x13, requests);
+    EXPECT_CALL(*rig.module, isConnected()).WillOnce(Return(false)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*rig.module, connect(0)).WillOnce(Return(true));
+
+    rig.core->Process(1, "cli", request("reconnect", NetworkSerializer().serialize(mms::Device{0})));
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+    EXPECT_EQ(requests, 1);
+
+    // Опрос версии как heartbeat не обращается к MCU
+    for (int i = 0; i < 3; ++i)
+    {
+        rig.core->Process(1, "cli", request("version", ""));
+        EXPECT_FLOAT_EQ(repliedVersion(*rig.lastWrite), 1.3f);
+    }
+    EXPECT_EQ(requests, 1);
+}
+
+TEST(Version, RefreshQueriesMcu)
+{
+    auto rig = makeRig();
+    int requests = 0;
+    answerVersion(rig, 0x13, requests);
+
+    rig.core->Process(1, "cli", request("version", ""));
+    rig.core->Process(1, "cli", request("version", ""));
+    EXPECT_EQ(requests, 1);
+
+    answerVersion(rig, 0x21, requests);
+    rig.core->Process(1, "cli", request("version", "refresh"));
+    EXPECT_EQ(requests, 2);
+    EXPECT_FLOAT_EQ(repliedVersion(*rig.lastWrite), 2.1f);
+
+    rig.core->Process(1, "cli", request("version", ""));
+    EXPECT_EQ(requests, 2);
+    EXPECT_FLOAT_EQ(repliedVersion(*rig.lastWrite), 2.1f);
+}
+
+TEST(Version, DisconnectForgetsVersion)
+{
+    auto rig = makeRig();
+    int requests = 0;
+    answerVersion(rig, 0x13, requests);
+
+    rig.core->Process(1, "cli", request("version", ""));
+    rig.core->Process(1, "cli", request("disconnect", ""));
+    rig.core->Process(1, "cli", request("version", ""));
+    EXPECT_EQ(requests, 2);
+}
+
+TEST(Version, InitReadsFirmwareBeforeMoving)
+{
+    auto rig = makeRig();
+
+    // Первое чтение - ответ на запрос версии, дальше готовность 0x00 и завершение [0x00, 0xFF]
+    int reads = 0;
+    ON_CALL(*rig.module, checkRXChannel()).WillByDefault(Return(2));
+    ON_CALL(*rig.module, readData(_)).WillByDefault(Invoke([&reads](std::vector<uchar> &data) {
+        if (reads++ == 0)
+            data[0] = 0x20;
+        else if (data.size() == 1)
+            data[0] = 0x00;
+        else
+            data = {0x00, 0xFF};
+    }));
+
+    std::vector<std::vector<uchar>> writes;
+    std::mutex mutex;
+    ON_CALL(*rig.module, writeData(_)).WillByDefault(Invoke([&](const std::vector<uchar> &data) {
+        std::lock_guard<std::mutex> lock(mutex);
+        writes.push_back(data);
+    }));
+    rig.core->Init();
+
+    mms::MotorsSettings settings;
+    settings.mode = "synchronous";
+    settings.motors = {mms::Motor{1, 2000, 5000, 100}};
+    rig.core->Process(1, "cli", request("moving", NetworkSerializer().serialize(settings)));
+    rig.core->Stop();
+    EXPECT_THAT(*rig.lastWrite, HasSubstr("\"status\":0"));
+
+    // Прошивка 2.0 известна до первой команды: заголовок и параметры уходят одной записью
+    ASSERT_EQ(writes.size(), 2u);
+    EXPECT_EQ(writes[0], std::vector<uchar>{McuTransaction::VERSION_REQUEST});
+    EXPECT_EQ(writes[1].size(), McuTransaction::MOTOR_FRAME_SIZE + 1);
+}
@@ -0,0 +1,168 @@
+#include "load_generator.hpp"
+#include "dataframe.hpp"
+#include "server.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace
+{
+/*
+ * @brief Ядро, отвечающее как UserCore: version/listconnect - со структурой в subMessage,
+ * moving - пустым успешным ответом, остальное - ошибкой
+ * */
+class ReplyCore : public ICore, public NetworkSerializer
+{
+public:
+    ReplyCore() : ICore("ReplyCore") {}
+
+    void Init() override {}
+    void Launch() override {}
+    void Stop() override {}
+
+    void Process(const int fd, const std::string &, const std::string &message) override
+    {
+        const auto manager = deserialize<mms::Manager>(deserialize<pkg::Message>(message).text);
+        pkg::Status status{"", "", 0};
+        if (manager.command == "version")
+            status = pkg::Status{"mms::Version", serialize(mms::Version{2.0f, "Squid"}), 0};
+        else if (manager.command == "listconnect")
+            status = pkg::Status{"mms::ListConnect", serialize(mms::ListConnect{{"COM0"}}), 0};
+        else if (manager.command != "moving")
+            status = pkg::Status{"unknown", "", 40401};
+        writeToSock(fd, serialize(status));
+    }
+};
+
+struct RunningServer
+{
+    int port = 0;
+    std::unique_ptr<Server> server;
+    std::thread thread;
+
+    RunningServer()
+    {
+        static std::mt19937 gen(std::random_device{}());
+        std::uniform_int_distribution<> ports(49152, 65535);
+        while (!server)
+        {
+            try
+            {
+                port = ports(gen);
+                server = std::make_unique<Server>("127.0.0.1", port, std::make_unique<ReplyCore>());
+            }
+            catch (const BindFailure &)
+            {}
+        }
+        thread = std::thread([this]() { server->run(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    ~RunningServer()
+    {
+        server->stop();
+        thread.join();
+    }
+};
+} // namespace
+
+TEST(CommandMix, Parse)
+{
+    const auto mix = CommandMix::parse("version=5,listconnect=3,moving=1");
+    ASSERT_TRUE(mix.has_value());
+    EXPECT_EQ(mix->version, 5);
+    EXPECT_EQ(mix->listconnect, 3);
+    EXPECT_EQ(mix->moving, 1);
+
+    EXPECT_FALSE(CommandMix::parse("version=0").has_value());
+    EXPECT_FALSE(CommandMix::parse("stop=1").has_value());
+    EXPECT_FALSE(CommandMix::parse("version=-1").has_value());
+    EXPECT_FALSE(CommandMix::parse("version").has_value());
+}
+
+TEST(CommandMix, PickKeepsProportions)
+{
+    const CommandMix mix{5, 3, 1};
+    size_t counts[3]{};
+    for (uint64_t n = 0; n < 900; ++n)
+        ++counts[static_cast<size_t>(mix.pick(n))];
+
+    EXPECT_EQ(counts[0], 500);
+    EXPECT_EQ(counts[1], 300);
+    EXPECT_EQ(counts[2], 100);
+
+    // Веса перемешаны, а не идут подряд
+    EXPECT_NE(mix.pick(0), mix.pick(1));
+}
+
+TEST(LoadGenerator, RequestIsValidMessage)
+{
+    NetworkSerializer serializer;
+    const auto request = LoadGenerator::request(LoadCommand::Moving, 7, 3);
+    const auto message = serializer.deserialize<pkg::Message>(request);
+    EXPECT_EQ(message.id, 7);
+
+    const auto manager = serializer.deserialize<mms::Manager>(message.text);
+    EXPECT_EQ(manager.command, "moving");
+    const auto settings = serializer.deserialize<mms::MotorsSettings>(manager.message);
+    EXPECT_EQ(settings.motors.size(), 3);
+    EXPECT_EQ(settings.motors[2].number, 3);
+
+    EXPECT_EQ(
+        serializer.deserialize<mms::Manager>(
+            serializer.deserialize<pkg::Message>(LoadGenerator::request(LoadCommand::ListConnect, 1, 3)).text)
+            .message,
+        "");
+}
+
+TEST(LoadGenerator, Classify)
+{
+    EXPECT_EQ(LoadGenerator::classify("mms::Version", "{}", 0), LoadCommand::Version);
+    EXPECT_EQ(LoadGenerator::classify("mms::ListConnect", "{}", 0), LoadCommand::ListConnect);
+    EXPECT_EQ(LoadGenerator::classify("", "", 0), LoadCommand::Moving);
+    EXPECT_FALSE(LoadGenerator::classify("[cli][40511]: Timeout", "", 40511).has_value());
+}
+
+TEST(LoadGenerator, ClosedLoopAgainstServer)
+{
+    RunningServer server;
+
+    LoadConfig config;
+    config.port = server.port;
+    config.connections = 4;
+    config.duration = std::chrono::milliseconds(300);
+    config.mix = CommandMix{1, 1, 1};
+
+    const auto report = LoadGenerator(config).run();
+    EXPECT_EQ(report.connectionsFailed, 0);
+    EXPECT_GT(report.completed, 0);
+    EXPECT_EQ(report.completed, report.sent);
+    EXPECT_EQ(report.errors, 0);
+    EXPECT_EQ(report.unanswered, 0);
+    EXPECT_EQ(report.service.count, report.completed);
+    EXPECT_GT(report.throughput(), 0.0);
+    EXPECT_GT(report.perCommand[static_cast<size_t>(LoadCommand::Moving)], 0);
+}
+
+TEST(LoadGenerator, OpenLoopKeepsRate)
+{
+    RunningServer server;
+
+    LoadConfig config;
+    config.port = server.port;
+    config.connections = 2;
+    config.mode = LoadMode::Open;
+    config.rate = 200.0;
+    config.duration = std::chrono::milliseconds(500);
+    config.mix = CommandMix{0, 1, 0};
+
+    const auto report = LoadGenerator(config).run();
+    EXPECT_NEAR(static_cast<double>(report.sent), 100.0, 5.0);
+    EXPECT_EQ(report.completed, report.sent);
+    EXPECT_EQ(report.corrected.count, report.completed);
+
+    // Скорректированная задержка отсчитывается от расписания и не может быть меньше фактической
+    EXPECT_GE(report.corrected.percentile(0.5), report.service.percentile(0.5));
+    EXPECT_NE(report.format().find("corrected"), std::string::npos);
+}
@@ -0,0 +1,204 @@
+#include "fault_profile.hpp"
+#include "mock_mcu.hpp"
+#include "virtual_link.hpp"
+#include "mcu_transaction.hpp"
+#include "exceptions.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+FaultProfile parsed(const std::string &text)
+{
+    std::string error;
+    const auto profile = FaultProfile::parse(text, error);
+    EXPECT_TRUE(profile.has_value()) << error;
+    return profile.value_or(FaultProfile{});
+}
+
+std::vector<uchar> readAll(IModule &module)
+{
+    std::vector<uchar> data(module.checkRXChannel());
+    module.readData(data);
+    return data;
+}
+
+/*
+ * @brief MockMCU в объединенном режиме на VirtualLink, время задает тест
+ * */
+struct Board
+{
+    VirtualLink link;
+    std::unique_ptr<IModule> host = link.hostEnd();
+    MockMCU mcu;
+    const MockMCU::Clock::time_point start = MockMCU::Clock::now();
+
+    explicit Board(const std::string &faults)
+    {
+        mcu.setMotionModel(MotionModel(), 0.0);
+        mcu.setCoalescedMode(true);
+        mcu.setFaultProfile(parsed(faults));
+        EXPECT_TRUE(mcu.initialize(link.mcuEnd()));
+    }
+
+    // Команда движения одного мотора целиком: заголовок и параметры
+    void move(std::chrono::milliseconds at = 0ms)
+    {
+        mms::MotorsSettings settings;
+        settings.mode = "synchronous";
+        settings.motors.push_back(mms::Motor{1, 2000, 5000, 100});
+
+        McuTransaction transaction;
+        transaction.encode(settings);
+        const auto frame = transaction.frame();
+        host->writeData({frame.begin(), frame.end()});
+        mcu.poll(start + at);
+    }
+
+    std::vector<uchar> at(std::chrono::milliseconds offset)
+    {
+        mcu.poll(start + offset);
+        return readAll(*host);
+    }
+};
+} // namespace
+
+TEST(FaultProfile, ParsesSpec)
+{
+    const auto profile = parsed("execution-error=0.05:0x06, readiness-error=0.02,\n"
+                                "readiness-delay=0.1:300 # поздний байт готовности\n"
+                                "truncated-completion=0.01,drop-byte=0.001\n"
+                                "stall=0.01:2000,disconnect=0.005:1000,seed=42");
+
+    EXPECT_DOUBLE_EQ(profile.executionErrorRate, 0.05);
+    EXPECT_EQ(profile.executionErrorCode, 0x06);
+    EXPECT_DOUBLE_EQ(profile.readinessErrorRate, 0.02);
+    EXPECT_EQ(profile.readinessErrorCode, 0);
+    EXPECT_EQ(profile.readinessDelay, 300ms);
+    EXPECT_DOUBLE_EQ(profile.truncatedCompletionRate, 0.01);
+    EXPECT_DOUBLE_EQ(profile.dropByteRate, 0.001);
+    EXPECT_EQ(profile.stallDuration, 2000ms);
+    EXPECT_EQ(profile.disconnectDuration, 1000ms);
+    EXPECT_EQ(profile.seed, 42u);
+    EXPECT_TRUE(profile.enabled());
+    EXPECT_FALSE(parsed("# пусто\nseed=3").enabled());
+}
+
+TEST(FaultProfile, RejectsBadEntries)
+{
+    for (const std::string text : {"execution-error", "execution-error=1.5", "readiness-error=0.1:0x0B",
+                                   "stall=0.1", "drop-byte=0.1:5", "seed=-1", "jitter=0.1"})
+    {
+        std::string error;
+        EXPECT_FALSE(FaultProfile::parse(text, error).has_value()) << text;
+        EXPECT_FALSE(error.empty()) << text;
+    }
+}
+
+TEST(FaultProfile, DescribeRoundTrips)
+{
+    const auto profile = parsed("execution-error=0.25:0x06,readiness-delay=0.5:300,stall=1:20,seed=9");
+    const auto again = parsed(profile.describe());
+    EXPECT_EQ(again.describe(), profile.describe());
+    EXPECT_EQ(again.readinessDelay, 300ms);
+    EXPECT_EQ(again.seed, 9u);
+}
+
+TEST(FaultProfile, LoadsFile)
+{
+    const std::string path = "fault_profile_unit.faults";
+    {
+        std::ofstream file(path);
+        file << "# стенд с плохим кабелем\ndrop-byte=0.01\nseed=5\n";
+    }
+
+    std::string error;
+    const auto profile = FaultProfile::load(path, error);
+    std::remove(path.c_str());
+    ASSERT_TRUE(profile.has_value()) << error;
+    EXPECT_DOUBLE_EQ(profile->dropByteRate, 0.01);
+    EXPECT_EQ(profile->seed, 5u);
+
+    EXPECT_FALSE(FaultProfile::load("no-such-file.faults", error).has_value());
+}
+
+TEST(MockMCUFaults, ReadinessError)
+{
+    Board board("readiness-error=1:0x03");
+    board.move();
+    EXPECT_EQ(board.at(0ms), std::vector<uchar>{0x03});
+    EXPECT_EQ(board.mcu.getStatistics().faultsInjected, 1);
+}
+
+TEST(MockMCUFaults, ReadinessDelay)
+{
+    Board board("readiness-delay=1:300");
+    board.move();
+    EXPECT_EQ(board.at(299ms), std::vector<uchar>{});
+    EXPECT_EQ(board.at(300ms), (std::vector<uchar>{0x00, 0x00, 0xFF}));
+}
+
+TEST(MockMCUFaults, TruncatedCompletion)
+{
+    Board board("truncated-completion=1");
+    board.move();
+    EXPECT_EQ(board.at(0ms), (std::vector<uchar>{0x00, 0x00}));
+}
+
+TEST(MockMCUFaults, DropByteLosesEveryByte)
+{
+    Board board("drop-byte=1");
+    board.move();
+    EXPECT_EQ(board.at(0ms), std::vector<uchar>{});
+    EXPECT_EQ(board.mcu.getStatistics().faultsInjected, 3);
+}
+
+TEST(MockMCUFaults, StallHoldsCompletion)
+{
+    Board board("stall=1:500");
+    board.move();
+    EXPECT_EQ(board.at(0ms), std::vector<uchar>{0x00});
+    EXPECT_EQ(board.at(499ms), std::vector<uchar>{});
+    EXPECT_EQ(board.at(500ms), (std::vector<uchar>{0x00, 0xFF}));
+}
+
+TEST(MockMCUFaults, DisconnectAndReconnect)
+{
+    Board board("disconnect=1:1000");
+    board.move();
+    EXPECT_FALSE(board.host->isConnected());
+    EXPECT_THROW(board.host->writeData({0x20}), ModuleFT2xxException);
+
+    board.mcu.poll(board.start + 999ms);
+    EXPECT_FALSE(board.host->isConnected());
+
+    // После переподключения плата отвечает как новая
+    board.mcu.poll(board.start + 1000ms);
+    ASSERT_TRUE(board.host->isConnected());
+    board.host->writeData({0x20});
+    EXPECT_EQ(board.at(1000ms), std::vector<uchar>{0x20});
+}
+
+TEST(MockMCUFaults, SameSeedSameFaults)
+{
+    const auto run = [](const std::string &faults) {
+        Board board(faults);
+        std::vector<uchar> answers;
+        for (int i = 0; i < 20; ++i)
+        {
+            board.move(std::chrono::milliseconds(i));
+            const auto bytes = board.at(std::chrono::milliseconds(i));
+            answers.insert(answers.end(), bytes.begin(), bytes.end());
+        }
+        return answers;
+    };
+
+    const std::string faults = "execution-error=0.3,readiness-error=0.3,seed=11";
+    EXPECT_EQ(run(faults), run(faults));
+    EXPECT_NE(run(faults), run("seed=11"));
+}
@@ -0,0 +1,284 @@
+#include "mcu_farm.hpp"
+#include "virtual_link.hpp"
+#include "mcu_transaction.hpp"
+#include "user_core.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <condition_variable>
+
+using ::testing::HasSubstr;
+
+namespace
+{
+mms::MotorsSettings settings(const std::vector<int> &numbers)
+{
+    mms::MotorsSettings result;
+    result.mode = "synchronous";
+    for (int number : numbers)
+        result.motors.push_back(mms::Motor{number, 2000, 5000, 100});
+    return result;
+}
+
+std::vector<uchar> readAll(IModule &module)
+{
+    std::vector<uchar> data(module.checkRXChannel());
+    module.readData(data);
+    return data;
+}
+
+std::unique_ptr<MockMCU> makeMcu(VirtualLink &link, double timeScale = 0.0)
+{
+    auto mcu = std::make_unique<MockMCU>();
+    mcu->setMotionModel(MotionModel(), timeScale);
+    EXPECT_TRUE(mcu->initialize(link.mcuEnd()));
+    return mcu;
+}
+
+// Сокет, на котором можно дождаться ответа из потока платы
+class WaitingSocket : public ISocket
+{
+public:
+    size_t write(int, const void *buf, size_t count) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_writes.emplace_back(static_cast<const char *>(buf), count);
+        m_cv.notify_all();
+        return count;
+    }
+
+    size_t read(int, void *, size_t) override
+    {
+        return 0;
+    }
+
+    std::string waitFor(size_t n)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait_for(lock, std::chrono::seconds(10), [this, n]() { return m_writes.size() >= n; });
+        return m_writes.size() >= n ? m_writes[n - 1] : std::string();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<std::string> m_writes;
+};
+
+std::string movingMessage(const std::vector<int> &numbers)
+{
+    NetworkSerializer serializer;
+    return serializer.serialize(pkg::Message{
+        1,
+        serializer.serialize(mms::Manager{"moving", serializer.serialize(settings(numbers))})});
+}
+
+/*
+ * @brief boards плат по 10 моторов на VirtualLink, платы MCU - на McuFarm с threads потоками
+ * */
+struct Cell
+{
+    McuFarm farm;
+    WaitingSocket *socket = new WaitingSocket();
+    std::unique_ptr<UserCore> core;
+
+    Cell(size_t boards, size_t threads, const std::vector<FaultProfile> &faults = {}, double timeScale = 0.0)
+        : farm(threads)
+    {
+        DeviceManager devices;
+        for (size_t i = 0; i < boards; ++i)
+        {
+            VirtualLink link("Virtual MCU " + std::to_string(i));
+            auto mcu = makeMcu(link, timeScale);
+            if (i < faults.size())
+                mcu->setFaultProfile(faults[i]);
+            farm.add(std::move(mcu));
+            const int first = static_cast<int>(i * 10 + 1);
+            devices.add(link.hostEnd(), static_cast<int>(i), first, first + 9);
+        }
+        farm.start();
+
+        core = std::make_unique<UserCore>(std::move(devices), std::unique_ptr<ISocket>(socket));
+        core->Init();
+    }
+
+    ~Cell()
+    {
+        core->Stop();
+        farm.stop();
+    }
+};
+} // namespace
+
+TEST(VirtualLink, BytesCrossInOrder)
+{
+    VirtualLink link;
+    auto host = link.hostEnd();
+    auto mcu = link.mcuEnd();
+
+    host->writeData({0x81, 0x01});
+    host->writeData({0x02});
+    EXPECT_EQ(host->checkRXChannel(), 0);
+    ASSERT_EQ(mcu->checkRXChannel(), 3);
+
+    std::vector<uchar> first(2);
+    mcu->readData(first);
+    EXPECT_EQ(first, (std::vector<uchar>{0x81, 0x01}));
+    EXPECT_EQ(readAll(*mcu), std::vector<uchar>{0x02});
+
+    mcu->writeData({0x00});
+    EXPECT_EQ(readAll(*host), std::vector<uchar>{0x00});
+
+    host->disconnect();
+    EXPECT_THROW(host->writeData({0x20}), ModuleFT2xxException);
+    EXPECT_TRUE(host->connect(0));
+}
+
+TEST(MockMCU, PollAnswersTwoStageMoving)
+{
+    VirtualLink link;
+    auto host = link.hostEnd();
+    auto mcu = makeMcu(link);
+    const auto now = MockMCU::Clock::now();
+
+    host->writeData({0x20});
+    EXPECT_TRUE(mcu->poll(now));
+    EXPECT_EQ(readAll(*host), std::vector<uchar>{0x12});
+
+    McuTransaction transaction;
+    transaction.encode(settings({1, 2}));
+    host->writeData({transaction.header()});
+    mcu->poll(now);
+    EXPECT_EQ(readAll(*host), std::vector<uchar>{0x00});
+
+    const auto payload = transaction.payload();
+    host->writeData({payload.begin(), payload.end()});
+    mcu->poll(now);
+    ASSERT_TRUE(mcu->nextDeadline().has_value());
+    mcu->poll(*mcu->nextDeadline());
+    EXPECT_EQ(readAll(*host), (std::vector<uchar>{0x00, 0xFF}));
+    EXPECT_FALSE(mcu->nextDeadline().has_value());
+
+    const auto stats = mcu->getStatistics();
+    EXPECT_EQ(stats.versionRequests, 1);
+    EXPECT_EQ(stats.motorCommands, 1);
+    EXPECT_EQ(stats.commandsProcessed, 1);
+}
+
+TEST(MockMCU, CompletionWaitsForMotionModel)
+{
+    VirtualLink link;
+    auto host = link.hostEnd();
+    auto mcu = makeMcu(link, 1.0);
+    mcu->setCoalescedMode(true);
+    const auto now = MockMCU::Clock::now();
+
+    // 100 шагов: треугольный профиль 2 * sqrt(100 / 2000) с = 447 мс
+    McuTransaction transaction;
+    transaction.encode(settings({1}));
+    const auto frame = transaction.frame();
+    host->writeData({frame.begin(), frame.end()});
+    host->writeData({0x20}); // Следующая команда ждет конца движения
+
+    mcu->poll(now);
+    EXPECT_EQ(readAll(*host), std::vector<uchar>{0x00});
+
+    mcu->poll(now + std::chrono::milliseconds(440));
+    EXPECT_EQ(host->checkRXChannel(), 0);
+
+    mcu->poll(now + std::chrono::milliseconds(450));
+    EXPECT_EQ(readAll(*host), (std::vector<uchar>{0x00, 0xFF, 0x20}));
+}
+
+TEST(MockMCU, EmergencyStopAbortsMotion)
+{
+    VirtualLink link;
+    auto host = link.hostEnd();
+    auto mcu = makeMcu(link, 1.0);
+    mcu->setCoalescedMode(true);
+    const auto now = MockMCU::Clock::now();
+
+    // Остановка без движения игнорируется и не дает ответа
+    host->writeData({ProtocolHandler::EMERGENCY_STOP});
+    mcu->poll(now);
+    EXPECT_EQ(host->checkRXChannel(), 0);
+
+    McuTransaction transaction;
+    transaction.encode(settings({1}));
+    const auto frame = transaction.frame();
+    host->writeData({frame.begin(), frame.end()});
+    mcu->poll(now);
+    EXPECT_EQ(readAll(*host), std::vector<uchar>{0x00});
+
+    host->writeData({ProtocolHandler::EMERGENCY_STOP});
+    mcu->poll(now + std::chrono::milliseconds(10));
+    EXPECT_EQ(readAll(*host), (std::vector<uchar>{0x00, ProtocolHandler::STOPPED}));
+    EXPECT_FALSE(mcu->nextDeadline().has_value());
+
+    // Запланированное завершение отменено
+    mcu->poll(now + std::chrono::seconds(1));
+    EXPECT_EQ(host->checkRXChannel(), 0);
+    EXPECT_EQ(mcu->getStatistics().emergencyStops, 1);
+}
+
+TEST(McuFarm, BoardsShareThreads)
+{
+    Cell cell(6, 2);
+    EXPECT_EQ(cell.farm.size(), 6);
+
+    std::vector<int> numbers;
+    for (int board = 0; board < 6; ++board)
+        numbers.push_back(board * 10 + 1 + board);
+
+    cell.core->Process(1, "cli", movingMessage(numbers));
+    EXPECT_THAT(cell.socket->waitFor(1), HasSubstr("\"status\":0"));
+
+    for (size_t i = 0; i < cell.farm.size(); ++i)
+    {
+        // Версия прошивки читается один раз при запуске ядра, дальше только moving()
+        EXPECT_EQ(cell.farm[i].getStatistics().versionRequests, 1) << i;
+        EXPECT_EQ(cell.farm[i].getStatistics().motorCommands, 1) << i;
+        EXPECT_EQ(cell.farm[i].getStatistics().commandsProcessed, 1) << i;
+    }
+    EXPECT_EQ(cell.farm.totalStatistics().motorCommands, 6);
+}
+
+TEST(McuFarm, FaultProfilesArePerBoard)
+{
+    Cell cell(3, 1, {FaultProfile{}, FaultProfile{1.0, 0x06, 7}});
+
+    cell.core->Process(1, "cli", movingMessage({1, 21}));
+    EXPECT_THAT(cell.socket->waitFor(1), HasSubstr("\"status\":0"));
+
+    cell.core->Process(1, "cli", movingMessage({1, 11}));
+    const auto answer = cell.socket->waitFor(2);
+    EXPECT_THAT(answer, HasSubstr("40513"));
+    EXPECT_THAT(answer, HasSubstr("0x06"));
+
+    EXPECT_EQ(cell.farm[0].getStatistics().faultsInjected, 0);
+    EXPECT_EQ(cell.farm[1].getStatistics().faultsInjected, 1);
+    EXPECT_EQ(cell.farm[2].getStatistics().faultsInjected, 0);
+}
+
+TEST(McuFarm, StopPreemptsMoving)
+{
+    // В реальном времени: 200000 шагов идут больше 5 секунд таймаута ожидания MCU
+    Cell cell(2, 1, {}, 1.0);
+    NetworkSerializer serializer;
+    mms::MotorsSettings longMove;
+    longMove.mode = "synchronous";
+    longMove.motors = {mms::Motor{1, 2000, 5000, 200000}, mms::Motor{11, 2000, 5000, 200000}};
+    const auto started = std::chrono::steady_clock::now();
+    cell.core->Process(1, "cli", serializer.serialize(pkg::Message{
+        1, serializer.serialize(mms::Manager{"moving", serializer.serialize(longMove)})}));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    cell.core->Process(2, "panel", serializer.serialize(pkg::Message{
+        2, serializer.serialize(mms::Manager{"stop", ""})}));
+    EXPECT_THAT(cell.socket->waitFor(1), HasSubstr("\"status\":0"));
+    EXPECT_THAT(cell.socket->waitFor(2), HasSubstr("40516"));
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(2));
+
+    EXPECT_EQ(cell.farm.totalStatistics().emergencyStops, 2);
+}
@@ -0,0 +1,86 @@
+#include "motion_model.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+ProtocolHandler::MotorData motor(int32_t step, uint32_t maxSpeed = 5000, uint32_t acceleration = 2000)
+{
+    return {1, acceleration, maxSpeed, step};
+}
+
+double seconds(MotionModel::Duration duration)
+{
+    return std::chrono::duration<double>(duration).count();
+}
+} // namespace
+
+TEST(MotionModel, TrapezoidalWithCruise)
+{
+    // Разгон и торможение по 2.5 с (12500 шагов), 7500 шагов на maxSpeed - 1.5 с
+    const MotionModel model;
+    EXPECT_NEAR(seconds(model.moveTime(motor(20000))), 6.5, 1e-6);
+    EXPECT_NEAR(seconds(model.moveTime(motor(-20000))), 6.5, 1e-6);
+}
+
+TEST(MotionModel, TriangularOnShortMove)
+{
+    const MotionModel model;
+    EXPECT_NEAR(seconds(model.moveTime(motor(10000))), 2.0 * std::sqrt(5.0), 1e-6);
+    EXPECT_NEAR(seconds(model.moveTime(motor(12500))), 5.0, 1e-6);
+}
+
+TEST(MotionModel, ZeroMoveTakesNoTime)
+{
+    const MotionModel model;
+    EXPECT_EQ(model.moveTime(motor(0)).count(), 0);
+    EXPECT_EQ(model.moveTime(motor(100, 0)).count(), 0);
+    EXPECT_EQ(model.moveTime(motor(100, 5000, 0)).count(), 0);
+}
+
+TEST(MotionModel, SCurveAddsJerkTime)
+{
+    // С крейсерским участком S-кривая длиннее трапеции ровно на acceleration / jerk
+    const MotionModel model(MotionModel::Profile::SCurve, 100000.0);
+    EXPECT_NEAR(seconds(model.moveTime(motor(20000))), 6.5 + 0.02, 1e-6);
+}
+
+TEST(MotionModel, SCurveIsContinuousAndNotFasterThanTrapezoidal)
+{
+    const MotionModel trapezoidal;
+    // Малый рывок: границы режимов (16000 и 22500 шагов) попадают в проверяемый диапазон
+    const MotionModel sCurve(MotionModel::Profile::SCurve, 1000.0);
+
+    double previous = seconds(sCurve.moveTime(motor(1000)));
+    for (int32_t step = 1000; step <= 40000; step += 7)
+    {
+        const double current = seconds(sCurve.moveTime(motor(step)));
+        EXPECT_GE(current, seconds(trapezoidal.moveTime(motor(step))) - 1e-9) << step;
+        EXPECT_GE(current, previous - 1e-9) << step;
+        EXPECT_LT(current - previous, 0.01) << step;
+        previous = current;
+    }
+}
+
+TEST(MotionModel, SynchronousMotorsFinishTogether)
+{
+    const MotionModel model;
+    const std::vector<ProtocolHandler::MotorData> motors{motor(20000), motor(12500)};
+
+    const auto sync = model.plan(motors, true);
+    EXPECT_NEAR(seconds(sync.total), 6.5, 1e-6);
+    EXPECT_EQ(sync.finish[0], sync.total);
+    EXPECT_EQ(sync.finish[1], sync.total);
+
+    const auto async = model.plan(motors, false);
+    EXPECT_EQ(async.total, sync.total);
+    EXPECT_NEAR(seconds(async.finish[1]), 5.0, 1e-6);
+}
+
+TEST(MotionModel, ParseProfile)
+{
+    EXPECT_EQ(MotionModel::parseProfile("trapezoidal"), MotionModel::Profile::Trapezoidal);
+    EXPECT_EQ(MotionModel::parseProfile("scurve"), MotionModel::Profile::SCurve);
+    EXPECT_FALSE(MotionModel::parseProfile("linear").has_value());
+    EXPECT_STREQ(MotionModel::profileName(MotionModel::Profile::SCurve), "scurve");
+}
@@ -0,0 +1,261 @@
+#include "simulated_module.hpp"
+#include "mcu_transaction.hpp"
+#include "protocol_handler.hpp"
+#include "user_core.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace
+{
+mms::MotorsSettings settings(size_t motors, uint32_t acceleration = 2000)
+{
+    mms::MotorsSettings result;
+    result.mode = "synchronous";
+    for (size_t i = 0; i < motors; ++i)
+        result.motors.push_back(mms::Motor{static_cast<int>(i + 1), acceleration, 5000, 100});
+    return result;
+}
+
+std::vector<uchar> bytes(std::span<const uint8_t> span)
+{
+    return {span.begin(), span.end()};
+}
+
+std::vector<uchar> readAll(SimulatedModule &module)
+{
+    std::vector<uchar> data(module.checkRXChannel());
+    module.readData(data);
+    return data;
+}
+
+class CaptureSocket : public ISocket
+{
+public:
+    explicit CaptureSocket(std::shared_ptr<std::string> last) : m_last(std::move(last)) {}
+
+    size_t write(int, const void *buf, size_t count) override
+    {
+        m_last->assign(static_cast<const char *>(buf), count);
+        return count;
+    }
+
+    size_t read(int, void *, size_t) override
+    {
+        return 0;
+    }
+
+private:
+    std::shared_ptr<std::string> m_last;
+};
+
+uint32_t movingStatus(std::unique_ptr<SimulatedModule> module)
+{
+    auto last = std::make_shared<std::string>();
+    UserCore core(std::move(module), std::make_unique<CaptureSocket>(last));
+
+    NetworkSerializer serializer;
+    const auto manager = mms::Manager{"moving", serializer.serialize(settings(2))};
+    core.Process(1, "sim", serializer.serialize(pkg::Message{1, serializer.serialize(manager)}));
+
+    return serializer.deserialize<pkg::Status>(last->substr(0, last->size() - 2)).status;
+}
+} // namespace
+
+TEST(SimulatedModule, Version)
+{
+    SimulatedModule module;
+    module.writeData({0x20});
+    EXPECT_EQ(readAll(module), std::vector<uchar>{0x12});
+
+    module.setFirmwareVersion(0x20);
+    module.writeData({0x20});
+    EXPECT_EQ(readAll(module), std::vector<uchar>{0x20});
+    EXPECT_EQ(module.getStatistics().versionRequests, 2);
+}
+
+TEST(SimulatedModule, TwoStageMoving)
+{
+    SimulatedModule module;
+    McuTransaction transaction;
+    transaction.encode(settings(3));
+
+    module.writeData({transaction.header()});
+    EXPECT_EQ(readAll(module), std::vector<uchar>{0x00});
+
+    // Параметры могут прийти несколькими записями
+    const auto payload = bytes(transaction.payload());
+    module.writeData({payload.begin(), payload.begin() + 20});
+    EXPECT_EQ(module.checkRXChannel(), 0);
+    module.writeData({payload.begin() + 20, payload.end()});
+    EXPECT_EQ(readAll(module), (std::vector<uchar>{0x00, 0xFF}));
+}
+
+TEST(SimulatedModule, CoalescedMoving)
+{
+    SimulatedModule module;
+    McuTransaction transaction;
+    transaction.encode(settings(10));
+
+    module.writeData(bytes(transaction.frame()));
+    EXPECT_EQ(readAll(module), (std::vector<uchar>{0x00, 0x00, 0xFF}));
+}
+
+TEST(SimulatedModule, InvalidParametersReported)
+{
+    SimulatedModule module;
+    McuTransaction transaction;
+    transaction.encode(settings(1, 0));
+
+    module.writeData(bytes(transaction.frame()));
+    const auto reply = readAll(module);
+    ASSERT_EQ(reply.size(), 3);
+    EXPECT_NE(reply[2], 0xFF);
+}
+
+TEST(SimulatedModule, LatencyDelaysReplies)
+{
+    SimulatedModule module(SimulatedModule::Latency{
+        std::chrono::microseconds(0), std::chrono::microseconds(0), std::chrono::milliseconds(50)});
+    McuTransaction transaction;
+    transaction.encode(settings(1));
+
+    module.writeData(bytes(transaction.frame()));
+    EXPECT_EQ(module.checkRXChannel(), 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    EXPECT_EQ(module.checkRXChannel(), 3);
+}
+
+TEST(SimulatedModule, LatencyInVirtualTime)
+{
+    ManualClock clock;
+    SimulatedModule module(SimulatedModule::Latency{
+        std::chrono::microseconds(0), std::chrono::microseconds(0), std::chrono::seconds(10)});
+    module.setClock(clock);
+    McuTransaction transaction;
+    transaction.encode(settings(1));
+
+    module.writeData(bytes(transaction.frame()));
+    EXPECT_EQ(module.checkRXChannel(), 1);
+
+    clock.advance(std::chrono::seconds(10));
+    EXPECT_EQ(module.checkRXChannel(), 3);
+}
+
+TEST(SimulatedModule, MotionModelDelaysCompletion)
+{
+    ManualClock clock;
+    SimulatedModule module;
+    module.setClock(clock);
+    module.setMotionModel(MotionModel(), 10.0);
+
+    // 2 мотора по 100 шагов: треугольный профиль 2 * sqrt(100 / 2000) с = 447 мс, в масштабе 1:10
+    McuTransaction transaction;
+    transaction.encode(settings(2));
+    module.writeData(bytes(transaction.frame()));
+    EXPECT_EQ(module.checkRXChannel(), 1);
+
+    clock.advance(std::chrono::milliseconds(44));
+    EXPECT_EQ(module.checkRXChannel(), 1);
+    clock.advance(std::chrono::milliseconds(1));
+    EXPECT_EQ(module.checkRXChannel(), 3);
+}
+
+TEST(SimulatedModule, EmergencyStopReplacesCompletion)
+{
+    ManualClock clock;
+    SimulatedModule module;
+    module.setClock(clock);
+    module.setMotionModel(MotionModel(), 1.0);
+
+    // Без движения остановка ничего не отвечает
+    module.writeData({ProtocolHandler::EMERGENCY_STOP});
+    EXPECT_EQ(module.checkRXChannel(), 0);
+
+    McuTransaction transaction;
+    transaction.encode(settings(1));
+    module.writeData(bytes(transaction.frame()));
+    EXPECT_EQ(readAll(module), std::vector<uchar>{0x00});
+
+    clock.advance(std::chrono::milliseconds(100));
+    module.writeData({ProtocolHandler::EMERGENCY_STOP});
+    EXPECT_EQ(readAll(module), (std::vector<uchar>{0x00, ProtocolHandler::STOPPED}));
+
+    clock.advance(std::chrono::seconds(1));
+    EXPECT_EQ(module.checkRXChannel(), 0);
+    EXPECT_EQ(module.getStatistics().emergencyStops, 1);
+}
+
+TEST(SimulatedModule, InjectedFaults)
+{
+    SimulatedModule module;
+    McuTransaction transaction;
+    transaction.encode(settings(1));
+    const auto frame = bytes(transaction.frame());
+
+    module.injectFault(SimulatedFault::ReadinessError, 0x03);
+    module.injectFault(SimulatedFault::ExecutionError, 0x0B);
+    module.injectFault(SimulatedFault::NoCompletion);
+
+    module.writeData({transaction.header()});
+    EXPECT_EQ(readAll(module), std::vector<uchar>{0x03});
+
+    module.writeData(frame);
+    EXPECT_EQ(readAll(module), (std::vector<uchar>{0x00, 0x00, 0x0B}));
+
+    module.writeData(frame);
+    EXPECT_EQ(readAll(module), std::vector<uchar>{0x00});
+
+    // Очередь сбоев кончилась
+    module.writeData(frame);
+    EXPECT_EQ(readAll(module), (std::vector<uchar>{0x00, 0x00, 0xFF}));
+    EXPECT_EQ(module.getStatistics().faultsInjected, 3);
+}
+
+TEST(SimulatedModule, DisconnectAndRestore)
+{
+    SimulatedModule module;
+    McuTransaction transaction;
+    transaction.encode(settings(1));
+
+    module.injectFault(SimulatedFault::Disconnect);
+    module.writeData(bytes(transaction.frame()));
+    EXPECT_FALSE(module.isConnected());
+    EXPECT_THROW(module.checkRXChannel(), ModuleFT2xxException);
+    EXPECT_FALSE(module.connect(0));
+
+    module.restore();
+    EXPECT_TRUE(module.connect(0));
+    module.writeData(bytes(transaction.frame()));
+    EXPECT_EQ(readAll(module), (std::vector<uchar>{0x00, 0x00, 0xFF}));
+}
+
+TEST(SimulatedModule, FaultProbability)
+{
+    SimulatedModule module;
+    McuTransaction transaction;
+    transaction.encode(settings(1));
+
+    module.setFaultProbability(SimulatedFault::ExecutionError, 1.0, 0x07);
+    module.writeData(bytes(transaction.frame()));
+    EXPECT_EQ(readAll(module).back(), 0x07);
+
+    module.setFaultProbability(SimulatedFault::ExecutionError, 0.0);
+    module.writeData(bytes(transaction.frame()));
+    EXPECT_EQ(readAll(module).back(), 0xFF);
+}
+
+TEST(SimulatedModule, DrivesUserCore)
+{
+    EXPECT_EQ(movingStatus(std::make_unique<SimulatedModule>()), 0);
+
+    auto readiness = std::make_unique<SimulatedModule>();
+    readiness->injectFault(SimulatedFault::ReadinessError, 0x03);
+    EXPECT_EQ(movingStatus(std::move(readiness)), 40512);
+
+    auto execution = std::make_unique<SimulatedModule>();
+    execution->injectFault(SimulatedFault::ExecutionError, 0x05);
+    EXPECT_EQ(movingStatus(std::move(execution)), 40513);
+}
@@ -204,6 +204,36 @@ TEST(FT232RLTest, OutputOperator)
     module2.disconnect();
 }
 
+// Тест профилей канала
+TEST(FT232RLTest, LinkProfile)
+{
+    FT232RL module1;
+    FT232RL module2;
+
+    // До подключения профиль только запоминается и применяется в connect
+    EXPECT_EQ(module1.getLinkProfile().name, "default");
+    EXPECT_NO_THROW(module1.setLinkProfile(LinkProfile::lowLatency()));
+    EXPECT_EQ(module1.getLinkProfile().latencyTimerMs, 2);
+
+    ASSERT_TRUE(module1.connect(0));
+    ASSERT_TRUE(module2.connect(1));
+
+    // После подключения профиль применяется сразу
+    EXPECT_NO_THROW(module2.setLinkProfile(LinkProfile::bulk()));
+    EXPECT_EQ(module2.getLinkProfile().rxTransferSize, 4096);
+    EXPECT_NO_THROW(module1.setLinkProfile(LinkProfile::defaults()));
+    EXPECT_EQ(module1.getLinkProfile().latencyTimerMs, 16);
+
+    LinkProfile profile;
+    EXPECT_TRUE(LinkProfile::fromName("low-latency", profile));
+    EXPECT_EQ(profile.name, "low-latency");
+    EXPECT_FALSE(LinkProfile::fromName("turbo", profile));
+    EXPECT_EQ(profile.name, "low-latency");
+
+    module1.disconnect();
+    module2.disconnect();
+}
+
 // Тест работы с исключениями при неправильных операциях
 TEST(FT232RLTest, ExceptionHandling)
 {
@@ -0,0 +1,131 @@
+#include "fake_ftd2xx.hpp"
+
+#include <cstring>
+
+namespace
+{
+int handleStorage = 0;
+
+FT_STATUS record(const char *function, std::vector<unsigned long> args = {})
+{
+    auto &fake = FakeD2xx::instance();
+    fake.calls.push_back({function, std::move(args)});
+    return fake.failOn == function ? FT_OTHER_ERROR : FT_OK;
+}
+} // namespace
+
+FakeD2xx &FakeD2xx::instance()
+{
+    static FakeD2xx fake;
+    return fake;
+}
+
+std::vector<unsigned long> FakeD2xx::last(const std::string &function) const
+{
+    for (auto it = calls.rbegin(); it != calls.rend(); ++it)
+    {
+        if (it->function == function)
+            return it->args;
+    }
+    return {};
+}
+
+FT_STATUS WINAPI FT_Open(int deviceNumber, FT_HANDLE *pHandle)
+{
+    *pHandle = &handleStorage;
+    return record("FT_Open", {static_cast<unsigned long>(deviceNumber)});
+}
+
+FT_STATUS WINAPI FT_Close(FT_HANDLE)
+{
+    return record("FT_Close");
+}
+
+FT_STATUS WINAPI FT_CreateDeviceInfoList(LPDWORD lpdwNumDevs)
+{
+    *lpdwNumDevs = static_cast<DWORD>(FakeD2xx::instance().devices);
+    return record("FT_CreateDeviceInfoList");
+}
+
+FT_STATUS WINAPI FT_GetDeviceInfoList(FT_DEVICE_LIST_INFO_NODE *, LPDWORD lpdwNumDevs)
+{
+    *lpdwNumDevs = 0;
+    return record("FT_GetDeviceInfoList");
+}
+
+FT_STATUS WINAPI FT_GetDeviceInfoDetail(
+    DWORD dwIndex, LPDWORD lpdwFlags, LPDWORD lpdwType, LPDWORD lpdwID, LPDWORD lpdwLocId,
+    LPVOID lpSerialNumber, LPVOID lpDescription, FT_HANDLE *pftHandle)
+{
+    *lpdwFlags = *lpdwType = *lpdwID = *lpdwLocId = 0;
+    std::strcpy(static_cast<char *>(lpSerialNumber), "FAKE");
+    std::strcpy(static_cast<char *>(lpDescription), "FakeD2xx");
+    *pftHandle = nullptr;
+    return record("FT_GetDeviceInfoDetail", {dwIndex});
+}
+
+FT_STATUS WINAPI FT_SetBaudRate(FT_HANDLE, ULONG dwBaudRate)
+{
+    return record("FT_SetBaudRate", {dwBaudRate});
+}
+
+FT_STATUS WINAPI FT_SetUSBParameters(FT_HANDLE, ULONG ulInTransferSize, ULONG ulOutTransferSize)
+{
+    return record("FT_SetUSBParameters", {ulInTransferSize, ulOutTransferSize});
+}
+
+FT_STATUS WINAPI FT_SetLatencyTimer(FT_HANDLE, UCHAR ucLatency)
+{
+    return record("FT_SetLatencyTimer", {ucLatency});
+}
+
+FT_STATUS WINAPI FT_SetFlowControl(FT_HANDLE, USHORT usFlowControl, UCHAR uXonChar, UCHAR uXoffChar)
+{
+    return record("FT_SetFlowControl", {usFlowControl, uXonChar, uXoffChar});
+}
+
+FT_STATUS WINAPI FT_SetChars(
+    FT_HANDLE, UCHAR uEventChar, UCHAR uEventCharEnabled, UCHAR uErrorChar, UCHAR uErrorCharEnabled)
+{
+    return record("FT_SetChars", {uEventChar, uEventCharEnabled, uErrorChar, uErrorCharEnabled});
+}
+
+FT_STATUS WINAPI FT_SetTimeouts(FT_HANDLE, ULONG dwReadTimeout, ULONG dwWriteTimeout)
+{
+    return record("FT_SetTimeouts", {dwReadTimeout, dwWriteTimeout});
+}
+
+FT_STATUS WINAPI FT_SetDataCharacteristics(FT_HANDLE, UCHAR uWordLength, UCHAR uStopBits, UCHAR uParity)
+{
+    return record("FT_SetDataCharacteristics", {uWordLength, uStopBits, uParity});
+}
+
+FT_STATUS WINAPI FT_GetQueueStatus(FT_HANDLE, DWORD *lpdwAmountInRxQueue)
+{
+    *lpdwAmountInRxQueue = 0;
+    return record("FT_GetQueueStatus");
+}
+
+FT_STATUS WINAPI FT_GetStatus(
+    FT_HANDLE, DWORD *lpdwAmountInRxQueue, DWORD *lpdwAmountInTxQueue, DWORD *lpdwEventStatus)
+{
+    *lpdwAmountInRxQueue = *lpdwAmountInTxQueue = *lpdwEventStatus = 0;
+    return record("FT_GetStatus");
+}
+
+FT_STATUS WINAPI FT_Purge(FT_HANDLE, ULONG ulMask)
+{
+    return record("FT_Purge", {ulMask});
+}
+
+FT_STATUS WINAPI FT_Read(FT_HANDLE, LPVOID, DWORD, LPDWORD lpdwBytesReturned)
+{
+    *lpdwBytesReturned = 0;
+    return record("FT_Read");
+}
+
+FT_STATUS WINAPI FT_Write(FT_HANDLE, LPVOID, DWORD dwBytesToWrite, LPDWORD lpdwBytesWritten)
+{
+    *lpdwBytesWritten = dwBytesToWrite;
+    return record("FT_Write", {dwBytesToWrite});
+}
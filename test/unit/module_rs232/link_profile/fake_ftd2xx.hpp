@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ftd2xx.h"
+
+#include <string>
+#include <vector>
+
+/*
+ * @brief Подмена D2XX для тестов без устройств: FT232RL собирается с этими функциями вместо
+ * libftd2xx. Каждый вызов записывается в calls, failOn - имя функции, которая вернет ошибку
+ * */
+struct FakeD2xx
+{
+    struct Call
+    {
+        std::string function;
+        std::vector<unsigned long> args;
+    };
+
+    std::vector<Call> calls;
+    std::string failOn;
+    unsigned long devices = 2;
+
+    static FakeD2xx &instance();
+
+    void reset()
+    {
+        *this = FakeD2xx{};
+    }
+
+    // Аргументы последнего вызова function, пусто - вызова не было
+    std::vector<unsigned long> last(const std::string &function) const;
+};
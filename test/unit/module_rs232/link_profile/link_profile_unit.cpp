@@ -0,0 +1,94 @@
+#include "fake_ftd2xx.hpp"
+#include "ft232rl.hpp"
+#include "link_profile.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+using Args = std::vector<unsigned long>;
+
+class LinkProfileTest : public ::testing::Test
+{
+protected:
+    FakeD2xx &d2xx = FakeD2xx::instance();
+
+    void SetUp() override
+    {
+        d2xx.reset();
+    }
+};
+} // namespace
+
+TEST(LinkProfile, Presets)
+{
+    // defaults() - параметры, прежде зашитые в FT232RL::connect
+    const auto defaults = LinkProfile::defaults();
+    EXPECT_EQ(defaults.name, "default");
+    EXPECT_EQ(defaults.latencyTimerMs, 16);
+    EXPECT_EQ(defaults.rxTransferSize, 256u);
+    EXPECT_EQ(defaults.txTransferSize, 256u);
+    EXPECT_EQ(defaults.flowControl, FlowControl::None);
+    EXPECT_FALSE(defaults.eventCharEnabled);
+    EXPECT_EQ(defaults.readTimeoutMs, 1000u);
+
+    const auto fast = LinkProfile::lowLatency();
+    EXPECT_EQ(fast.latencyTimerMs, 2);
+    EXPECT_EQ(fast.rxTransferSize, 64u);
+    EXPECT_EQ(fast.txTransferSize, 64u);
+    EXPECT_EQ(fast.readTimeoutMs, 100u);
+
+    const auto bulk = LinkProfile::bulk();
+    EXPECT_EQ(bulk.latencyTimerMs, 16);
+    EXPECT_EQ(bulk.rxTransferSize, 4096u);
+
+    LinkProfile profile;
+    EXPECT_TRUE(LinkProfile::fromName("low-latency", profile));
+    EXPECT_EQ(profile.name, "low-latency");
+    EXPECT_FALSE(LinkProfile::fromName("turbo", profile));
+    EXPECT_EQ(profile.name, "low-latency");
+}
+
+TEST_F(LinkProfileTest, StoredUntilConnect)
+{
+    FT232RL module;
+    module.setLinkProfile(LinkProfile::lowLatency());
+    EXPECT_TRUE(d2xx.calls.empty());
+    EXPECT_EQ(module.getLinkProfile().name, "low-latency");
+
+    ASSERT_TRUE(module.connect(0));
+    EXPECT_EQ(d2xx.last("FT_SetLatencyTimer"), Args{2});
+    EXPECT_EQ(d2xx.last("FT_SetUSBParameters"), (Args{64, 64}));
+    EXPECT_EQ(d2xx.last("FT_SetFlowControl"), (Args{FT_FLOW_NONE, 0x11, 0x13}));
+    EXPECT_EQ(d2xx.last("FT_SetTimeouts"), (Args{100, 100}));
+    module.disconnect();
+}
+
+TEST_F(LinkProfileTest, AppliedImmediatelyWhenConnected)
+{
+    FT232RL module;
+    ASSERT_TRUE(module.connect(1));
+    EXPECT_EQ(d2xx.last("FT_SetLatencyTimer"), Args{16});
+
+    auto profile = LinkProfile::bulk();
+    profile.flowControl = FlowControl::RtsCts;
+    profile.eventCharEnabled = true;
+    profile.eventChar = '\n';
+    module.setLinkProfile(profile);
+
+    EXPECT_EQ(d2xx.last("FT_SetUSBParameters"), (Args{4096, 4096}));
+    EXPECT_EQ(d2xx.last("FT_SetFlowControl"), (Args{FT_FLOW_RTS_CTS, 0x11, 0x13}));
+    EXPECT_EQ(d2xx.last("FT_SetChars"), (Args{'\n', 1, 0, 0}));
+    EXPECT_EQ(module.getLinkProfile().name, "bulk");
+    module.disconnect();
+}
+
+TEST_F(LinkProfileTest, RejectedProfileClosesDevice)
+{
+    FT232RL module;
+    d2xx.failOn = "FT_SetLatencyTimer";
+
+    EXPECT_THROW(module.connect(0), std::runtime_error);
+    EXPECT_FALSE(module.isConnected());
+    EXPECT_EQ(d2xx.calls.back().function, "FT_Close");
+}
@@ -0,0 +1,69 @@
+#include "clock.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(ManualClock, StandsStillUntilAdvanced)
+{
+    ManualClock clock;
+    const auto start = clock.now();
+    EXPECT_EQ(clock.now(), start);
+
+    clock.advance(5s);
+    EXPECT_EQ(clock.now() - start, 5s);
+}
+
+TEST(ManualClock, AutoAdvanceSleepsInstantly)
+{
+    ManualClock clock(true);
+    const auto start = clock.now();
+    const auto realStart = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < 50; ++i)
+        clock.sleepFor(100ms);
+
+    EXPECT_EQ(clock.now() - start, 5s);
+    EXPECT_LT(std::chrono::steady_clock::now() - realStart, 1s);
+    EXPECT_EQ(clock.sleepers(), 0);
+}
+
+TEST(ManualClock, SleeperWakesOnAdvance)
+{
+    ManualClock clock;
+    std::atomic<bool> woke{false};
+    std::thread sleeper([&]() {
+        clock.sleepFor(200ms);
+        woke = true;
+    });
+
+    ASSERT_TRUE(clock.waitForSleepers(1));
+    clock.advance(100ms);
+    std::this_thread::sleep_for(10ms);
+    EXPECT_FALSE(woke);
+
+    clock.advance(100ms);
+    sleeper.join();
+    EXPECT_TRUE(woke);
+    EXPECT_EQ(clock.sleepers(), 0);
+}
+
+TEST(ManualClock, SleepUntilPastDeadlineReturns)
+{
+    ManualClock clock;
+    clock.advance(1s);
+    clock.sleepUntil(clock.now() - 1ms);
+    clock.sleepFor(0ms);
+    EXPECT_FALSE(clock.waitForSleepers(1, 10ms));
+}
+
+TEST(SystemClock, SleepsForReal)
+{
+    auto &clock = SystemClock::instance();
+    const auto start = clock.now();
+    clock.sleepFor(5ms);
+    EXPECT_GE(clock.now() - start, 5ms);
+}
@@ -0,0 +1,84 @@
+#include "latency_histogram.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+TEST(LatencyHistogram, SmallValuesAreExact)
+{
+    for (uint64_t ns = 0; ns < 16; ++ns)
+    {
+        const auto index = LatencyHistogram::bucketIndex(ns);
+        EXPECT_EQ(LatencyHistogram::bucketUpperBound(index), ns);
+    }
+}
+
+TEST(LatencyHistogram, RelativeErrorIsBounded)
+{
+    for (uint64_t ns : {100ull, 1'000ull, 123'456ull, 200'000'000ull, 5'000'000'000ull})
+    {
+        const auto upper = LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketIndex(ns));
+        EXPECT_GE(upper, ns);
+        EXPECT_LE(upper - ns, ns / LatencyHistogram::SUB_BUCKETS);
+    }
+
+    EXPECT_EQ(LatencyHistogram::bucketIndex(~0ull), LatencyHistogram::BUCKETS - 1);
+}
+
+TEST(LatencyHistogram, Percentiles)
+{
+    LatencyHistogram histogram;
+    for (uint64_t us = 1; us <= 1000; ++us)
+        histogram.recordNs(us * 1000);
+
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 1000);
+    EXPECT_EQ(snapshot.maxNs, 1'000'000);
+    EXPECT_NEAR(snapshot.meanNs(), 500'500.0, 1.0);
+    EXPECT_NEAR(static_cast<double>(snapshot.percentile(0.5)), 500'000.0, 500'000.0 / 8);
+    EXPECT_NEAR(static_cast<double>(snapshot.percentile(0.99)), 990'000.0, 990'000.0 / 8);
+    EXPECT_EQ(snapshot.percentile(1.0), 1'000'000);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.snapshot().count, 0);
+    EXPECT_EQ(histogram.snapshot().percentile(0.5), 0);
+}
+
+TEST(LatencyHistogram, ConcurrentRecordsAreAllCounted)
+{
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&histogram, t]() {
+            for (int i = 0; i < 10000; ++i)
+                histogram.recordNs(static_cast<uint64_t>(t * 1000 + i));
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(histogram.snapshot().count, 80000);
+    EXPECT_EQ(histogram.snapshot().maxNs, 7000 + 9999);
+}
+
+TEST(LatencyRegistry, SnapshotSkipsEmptyStagesAndReports)
+{
+    auto &registry = LatencyRegistry::instance();
+    registry.reset();
+
+    auto &stages = registry.scope("unit-test");
+    EXPECT_EQ(&stages, &registry.scope("unit-test"));
+    stages[LatencyStage::McuReadiness].record(std::chrono::milliseconds(3));
+
+    auto rows = registry.snapshot();
+    ASSERT_EQ(rows.size(), 1);
+    EXPECT_EQ(rows[0].scope, "unit-test");
+    EXPECT_EQ(rows[0].stage, LatencyStage::McuReadiness);
+    EXPECT_EQ(rows[0].data.count, 1);
+
+    const auto report = registry.report();
+    EXPECT_NE(report.find("unit-test"), std::string::npos);
+    EXPECT_NE(report.find("mcu_readiness"), std::string::npos);
+}
@@ -0,0 +1,133 @@
+#include "logger.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// Лог пишется во временный файл, содержимое читается после flush()
+class LoggerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_file = std::tmpfile();
+        ASSERT_NE(m_file, nullptr);
+        Logger::instance().setSink(m_file);
+        Logger::instance().setLevel(LogLevel::Trace);
+    }
+
+    void TearDown() override
+    {
+        Logger::instance().setSink(stdout);
+        Logger::instance().setLevel(LogLevel::Info);
+        std::fclose(m_file);
+    }
+
+    std::string contents()
+    {
+        Logger::instance().flush();
+        std::rewind(m_file);
+
+        std::string text;
+        char buffer[4096];
+        while (size_t n = std::fread(buffer, 1, sizeof(buffer), m_file))
+            text.append(buffer, n);
+        return text;
+    }
+
+    std::vector<std::string> lines()
+    {
+        std::vector<std::string> result;
+        std::istringstream stream(contents());
+        for (std::string line; std::getline(stream, line);)
+            result.push_back(line);
+        return result;
+    }
+
+    FILE *m_file = nullptr;
+};
+} // namespace
+
+TEST_F(LoggerTest, FormatsLevelTagAndMessage)
+{
+    MMS_LOG_INFO("server", "[USER-ADD]({})", "cli");
+    MMS_LOG_ERROR("ft232rl", "Failed to connect to device {}, error: {}", 3, 2);
+
+    auto out = lines();
+    ASSERT_EQ(out.size(), 2);
+    EXPECT_NE(out[0].find("] INFO server: [USER-ADD](cli)"), std::string::npos);
+    EXPECT_NE(out[1].find("] ERROR ft232rl: Failed to connect to device 3, error: 2"), std::string::npos);
+    EXPECT_EQ(out[0].front(), '[');
+}
+
+TEST_F(LoggerTest, LevelFilter)
+{
+    Logger::instance().setLevel(LogLevel::Warning);
+    MMS_LOG_INFO("core", "hidden");
+    MMS_LOG_WARN("core", "shown");
+
+    auto out = lines();
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_NE(out[0].find("shown"), std::string::npos);
+}
+
+TEST_F(LoggerTest, TraceIsCompiledOutByDefault)
+{
+    MMS_LOG_TRACE("core", "poll {}", 1);
+    MMS_LOG_DEBUG("core", "debug {}", 2);
+
+    auto out = lines();
+#if MMS_LOG_COMPILE_LEVEL <= 0
+    EXPECT_EQ(out.size(), 2);
+#else
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_NE(out[0].find("debug 2"), std::string::npos);
+#endif
+}
+
+TEST_F(LoggerTest, LongMessageIsTruncated)
+{
+    Logger::instance().write(LogLevel::Info, "core", std::string(Logger::MAX_TEXT * 2, 'x'));
+
+    auto out = lines();
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_NE(out[0].find(std::string(Logger::MAX_TEXT, 'x') + "..."), std::string::npos);
+    EXPECT_EQ(out[0].find(std::string(Logger::MAX_TEXT + 1, 'x')), std::string::npos);
+}
+
+TEST_F(LoggerTest, ConcurrentWritersLoseNothingButDrops)
+{
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 2000;
+    const auto droppedBefore = Logger::instance().dropped();
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        writers.emplace_back([t]() {
+            for (int i = 0; i < PER_THREAD; ++i)
+                MMS_LOG_INFO("bench", "{}:{}", t, i);
+        });
+    }
+    for (auto &writer : writers)
+        writer.join();
+
+    const auto dropped = Logger::instance().dropped() - droppedBefore;
+    EXPECT_EQ(lines().size() + dropped, static_cast<size_t>(THREADS * PER_THREAD));
+}
+
+TEST(LoggerLevel, ParseLevel)
+{
+    LogLevel level = LogLevel::Info;
+    EXPECT_TRUE(Logger::parseLevel("debug", level));
+    EXPECT_EQ(level, LogLevel::Debug);
+    EXPECT_TRUE(Logger::parseLevel("off", level));
+    EXPECT_EQ(level, LogLevel::Off);
+    EXPECT_FALSE(Logger::parseLevel("verbose", level));
+    EXPECT_STREQ(Logger::levelName(LogLevel::Warning), "WARN");
+}
@@ -0,0 +1,102 @@
+#include "admin_server.hpp"
+#include "metrics.hpp"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+std::string httpGet(int port, const std::string &path)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = htons(port);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+        close(fd);
+        return "";
+    }
+
+    const std::string request = "GET " + path + " HTTP/1.0\r\n\r\n";
+    send(fd, request.data(), request.size(), 0);
+
+    std::string response;
+    char buffer[4096];
+    for (ssize_t n; (n = read(fd, buffer, sizeof(buffer))) > 0;)
+        response.append(buffer, static_cast<size_t>(n));
+    close(fd);
+    return response;
+}
+} // namespace
+
+TEST(Metrics, CountersAggregateAcrossThreads)
+{
+    auto &counter = MetricsRegistry::instance().counter("test_events_total", "Test events", "kind=\"a\"");
+    EXPECT_EQ(&counter, &MetricsRegistry::instance().counter("test_events_total", "Test events", "kind=\"a\""));
+
+    const auto before = counter.value();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&counter]() {
+            for (int i = 0; i < 1000; ++i)
+                counter.inc();
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(counter.value() - before, 8000);
+}
+
+TEST(Metrics, GaugeGoesUpAndDown)
+{
+    auto &gauge = MetricsRegistry::instance().gauge("test_queue_depth", "Test queue", "board=\"1-10\"");
+    gauge.inc(3);
+    gauge.dec();
+    EXPECT_EQ(gauge.value(), 2);
+    gauge.dec(2);
+}
+
+TEST(Metrics, RenderPrometheusText)
+{
+    MetricsRegistry::instance().counter("test_render_total", "Rendered", "code=\"40507\"").inc(5);
+    MetricsRegistry::instance().counter("test_render_total", "Rendered", "code=\"40511\"").inc();
+
+    const auto text = MetricsRegistry::instance().render();
+    EXPECT_NE(text.find("# TYPE test_render_total counter\n"), std::string::npos);
+    EXPECT_NE(text.find("test_render_total{code=\"40507\"} 5\n"), std::string::npos);
+    EXPECT_NE(text.find("test_render_total{code=\"40511\"} 1\n"), std::string::npos);
+
+    // HELP/TYPE выводятся один раз на имя метрики
+    EXPECT_EQ(text.find("# HELP test_render_total"), text.rfind("# HELP test_render_total"));
+}
+
+TEST(AdminServer, Routes)
+{
+    EXPECT_EQ(AdminServer::respond("GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n").rfind("HTTP/1.0 200 OK", 0), 0);
+    EXPECT_EQ(AdminServer::respond("GET / HTTP/1.1\r\n\r\n").rfind("HTTP/1.0 404", 0), 0);
+    EXPECT_EQ(AdminServer::respond("garbage").rfind("HTTP/1.0 400", 0), 0);
+}
+
+TEST(AdminServer, ServesMetricsOverHttp)
+{
+    MetricsRegistry::instance().counter("test_http_total", "Http test").inc(7);
+
+    AdminServer admin("127.0.0.1", 0);
+    admin.start();
+    ASSERT_NE(admin.port(), 0);
+
+    const auto response = httpGet(admin.port(), "/metrics");
+    EXPECT_NE(response.find("text/plain; version=0.0.4"), std::string::npos);
+    EXPECT_NE(response.find("test_http_total 7\n"), std::string::npos);
+    admin.stop();
+}
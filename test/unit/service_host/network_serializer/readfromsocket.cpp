@@ -121,3 +121,53 @@ TEST(readFromSockTest, WriteError)
     EXPECT_THROW(server.readFromSock(1), ErrorReadingFromSocket);
 }
 
+
+//// Тесты для readAvailable
+
+// Посылка пришла частями: хвост дописывается к уже прочитанному, пустой сокет - не ошибка
+TEST(readAvailableTest, AppendsUntilSocketIsEmpty)
+{
+    auto mockSocket = std::make_unique<SocketMock>();
+    SocketMock* mockPtr = mockSocket.get();
+
+    EXPECT_CALL(*mockPtr, read(testing::_, testing::_, testing::_))
+        .WillOnce(testing::Invoke([]([[maybe_unused]] int fd, void* buf, [[maybe_unused]] size_t count) {
+            memcpy(buf, "_data\n\n", 7);
+            return static_cast<ssize_t>(7);
+        }))
+        .WillOnce(testing::Invoke([]([[maybe_unused]] int fd, [[maybe_unused]] void* buf,
+                                      [[maybe_unused]] size_t count) {
+            errno = EAGAIN;
+            return static_cast<ssize_t>(-1);
+        }));
+
+    NetworkSerializer server(std::move(mockSocket));
+
+    std::string buffer = "test";
+    EXPECT_TRUE(server.readAvailable(0, buffer));
+    EXPECT_EQ(buffer, "test_data\n\n");
+    EXPECT_TRUE(server.readAvailable(0, buffer));
+    EXPECT_EQ(buffer, "test_data\n\n");
+}
+
+// Клиент закрыл соединение или чтение сломалось
+TEST(readAvailableTest, ClosedOrError)
+{
+    auto mockSocket = std::make_unique<SocketMock>();
+    SocketMock* mockPtr = mockSocket.get();
+
+    EXPECT_CALL(*mockPtr, read(testing::_, testing::_, testing::_))
+        .WillOnce(testing::Return(0))
+        .WillOnce(testing::Invoke([]([[maybe_unused]] int fd, [[maybe_unused]] void* buf,
+                                      [[maybe_unused]] size_t count) {
+            errno = ECONNRESET;
+            return static_cast<ssize_t>(-1);
+        }));
+
+    NetworkSerializer server(std::move(mockSocket));
+
+    std::string buffer;
+    EXPECT_FALSE(server.readAvailable(0, buffer));
+    EXPECT_FALSE(server.readAvailable(0, buffer));
+    EXPECT_TRUE(buffer.empty());
+}
@@ -0,0 +1,126 @@
+#include "outbox.hpp"
+#include "socket.hpp"
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+
+namespace
+{
+// Пара связанных сокетов: first - неблокирующий сокет "сервера" с очередью, second - "клиент"
+class Pair
+{
+public:
+    Pair()
+    {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, m_fds) != 0)
+            throw std::runtime_error("socketpair");
+        fcntl(m_fds[0], F_SETFL, fcntl(m_fds[0], F_GETFL) | O_NONBLOCK);
+        Outbox::instance().open(m_fds[0]);
+    }
+
+    ~Pair()
+    {
+        Outbox::instance().close(m_fds[0]);
+        close(m_fds[0]);
+        if (m_fds[1] != -1)
+            close(m_fds[1]);
+    }
+
+    int server() const
+    {
+        return m_fds[0];
+    }
+
+    void closeClient()
+    {
+        close(m_fds[1]);
+        m_fds[1] = -1;
+    }
+
+    // Прочитать все, что уже пришло клиенту
+    std::string drain()
+    {
+        std::string received;
+        char chunk[4096];
+        ssize_t n;
+        while ((n = recv(m_fds[1], chunk, sizeof(chunk), MSG_DONTWAIT)) > 0)
+            received.append(chunk, n);
+        return received;
+    }
+
+private:
+    int m_fds[2];
+};
+
+std::string pattern(size_t size)
+{
+    std::string data(size, '\0');
+    for (size_t i = 0; i < size; ++i)
+        data[i] = static_cast<char>('a' + i % 26);
+    return data;
+}
+} // namespace
+
+TEST(Outbox, UnknownDescriptorIsWrittenDirectly)
+{
+    size_t written = 0;
+    EXPECT_FALSE(Outbox::instance().write(12345, "x", 1, written));
+    EXPECT_EQ(Outbox::instance().state(12345), Outbox::State::Empty);
+}
+
+TEST(Outbox, WritesThroughWhenBufferHasRoom)
+{
+    Pair pair;
+    Socket socket;
+    EXPECT_EQ(socket.write(pair.server(), "hello", 5), 5u);
+    EXPECT_EQ(Outbox::instance().state(pair.server()), Outbox::State::Empty);
+    EXPECT_EQ(Outbox::instance().stalledSince(pair.server()), Outbox::TimePoint{});
+    EXPECT_EQ(pair.drain(), "hello");
+}
+
+// Клиент не читает: запись не ждет его, остаток уходит по flush() в исходном порядке
+TEST(Outbox, QueuesWhileClientDoesNotRead)
+{
+    Pair pair;
+    Socket socket;
+    const std::string data = pattern(4 * 1024 * 1024);
+    EXPECT_EQ(socket.write(pair.server(), data.data(), data.size()), data.size());
+    EXPECT_EQ(socket.write(pair.server(), "tail", 4), 4u);
+    EXPECT_EQ(Outbox::instance().state(pair.server()), Outbox::State::Pending);
+    EXPECT_NE(Outbox::instance().stalledSince(pair.server()), Outbox::TimePoint{});
+
+    std::string received;
+    for (int i = 0; i < 100000 && Outbox::instance().state(pair.server()) != Outbox::State::Empty; ++i)
+    {
+        received += pair.drain();
+        Outbox::instance().flush(pair.server());
+    }
+    received += pair.drain();
+
+    EXPECT_EQ(Outbox::instance().state(pair.server()), Outbox::State::Empty);
+    EXPECT_EQ(Outbox::instance().stalledSince(pair.server()), Outbox::TimePoint{});
+    EXPECT_EQ(received, data + "tail");
+}
+
+TEST(Outbox, OverflowBreaksConnection)
+{
+    Pair pair;
+    Socket socket;
+    const std::string data = pattern(Outbox::MAX_QUEUED_BYTES + 1024 * 1024);
+    EXPECT_EQ(socket.write(pair.server(), data.data(), data.size()), static_cast<size_t>(-1));
+    EXPECT_EQ(Outbox::instance().state(pair.server()), Outbox::State::Broken);
+
+    // Дальнейшие записи не принимаются
+    EXPECT_EQ(socket.write(pair.server(), "x", 1), static_cast<size_t>(-1));
+}
+
+TEST(Outbox, ClosedClientBreaksConnection)
+{
+    Pair pair;
+    Socket socket;
+    pair.closeClient();
+    EXPECT_EQ(socket.write(pair.server(), "hello", 5), static_cast<size_t>(-1));
+    EXPECT_EQ(Outbox::instance().state(pair.server()), Outbox::State::Broken);
+}
@@ -0,0 +1,156 @@
+#include "rate_limiter.hpp"
+#include "metrics.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+const RateLimiter::TimePoint start{};
+
+uint64_t throttled(const std::string &client, const std::string &scope)
+{
+    return MetricsRegistry::instance()
+        .counter("mms_requests_throttled_total", "", std::format("client=\"{}\",scope=\"{}\"", client, scope))
+        .value();
+}
+} // namespace
+
+TEST(RateLimit, Parse)
+{
+    RateLimit limit;
+    ASSERT_TRUE(RateLimit::parse("20", limit));
+    EXPECT_DOUBLE_EQ(limit.rate, 20.0);
+    EXPECT_DOUBLE_EQ(limit.burst, 20.0);
+
+    ASSERT_TRUE(RateLimit::parse("0.5/4", limit));
+    EXPECT_DOUBLE_EQ(limit.rate, 0.5);
+    EXPECT_DOUBLE_EQ(limit.burst, 4.0);
+
+    ASSERT_TRUE(RateLimit::parse("0.5", limit));
+    EXPECT_DOUBLE_EQ(limit.burst, 1.0);
+
+    ASSERT_TRUE(RateLimit::parse("0", limit));
+    EXPECT_FALSE(limit.enabled());
+
+    EXPECT_FALSE(RateLimit::parse("10/0", limit));
+    EXPECT_FALSE(RateLimit::parse("-1", limit));
+    EXPECT_FALSE(RateLimit::parse("fast", limit));
+}
+
+TEST(TokenBucket, BurstThenRate)
+{
+    TokenBucket bucket(RateLimit{10.0, 3.0}, start);
+    EXPECT_TRUE(bucket.tryTake(start));
+    EXPECT_TRUE(bucket.tryTake(start));
+    EXPECT_TRUE(bucket.tryTake(start));
+    EXPECT_FALSE(bucket.tryTake(start));
+
+    // 10 запросов в секунду: токен за 100 мс
+    EXPECT_FALSE(bucket.tryTake(start + 50ms));
+    EXPECT_TRUE(bucket.tryTake(start + 100ms));
+    EXPECT_FALSE(bucket.tryTake(start + 100ms));
+
+    // Простой не копит больше burst
+    for (int i = 0; i < 3; ++i)
+        EXPECT_TRUE(bucket.tryTake(start + 10s));
+    EXPECT_FALSE(bucket.tryTake(start + 10s));
+}
+
+TEST(TokenBucket, FullAfterRefill)
+{
+    TokenBucket bucket(RateLimit{10.0, 3.0}, start);
+    EXPECT_TRUE(bucket.full(start));
+    EXPECT_TRUE(bucket.tryTake(start));
+    EXPECT_TRUE(bucket.tryTake(start));
+    EXPECT_FALSE(bucket.full(start + 100ms));
+    EXPECT_TRUE(bucket.full(start + 200ms));
+}
+
+TEST(RateLimiter, UnlimitedByDefault)
+{
+    RateLimiter limiter;
+    for (int i = 0; i < 1000; ++i)
+        ASSERT_EQ(limiter.admit(3, "ui", start), RateLimiter::Verdict::Allowed);
+}
+
+TEST(RateLimiter, ConnectionLimitIsPerSocket)
+{
+    RateLimiter limiter;
+    limiter.setLimits(RateLimit{1.0, 2.0}, RateLimit{});
+    const auto before = throttled("script", "connection");
+
+    EXPECT_EQ(limiter.admit(3, "script", start), RateLimiter::Verdict::Allowed);
+    EXPECT_EQ(limiter.admit(3, "script", start), RateLimiter::Verdict::Allowed);
+    EXPECT_EQ(limiter.admit(3, "script", start), RateLimiter::Verdict::ConnectionLimited);
+    EXPECT_EQ(limiter.admit(4, "script", start), RateLimiter::Verdict::Allowed);
+    EXPECT_EQ(throttled("script", "connection") - before, 1u);
+
+    // Дескриптор закрытого соединения достается новому клиенту с полной корзиной
+    limiter.forget(3);
+    EXPECT_EQ(limiter.admit(3, "panel", start), RateLimiter::Verdict::Allowed);
+}
+
+TEST(RateLimiter, ClientLimitIsSharedByConnections)
+{
+    RateLimiter limiter;
+    limiter.setLimits(RateLimit{}, RateLimit{1.0, 2.0});
+    const auto before = throttled("bot", "client");
+
+    EXPECT_EQ(limiter.admit(3, "bot", start), RateLimiter::Verdict::Allowed);
+    EXPECT_EQ(limiter.admit(4, "bot", start), RateLimiter::Verdict::Allowed);
+    EXPECT_EQ(limiter.admit(5, "bot", start), RateLimiter::Verdict::ClientLimited);
+    EXPECT_EQ(limiter.admit(6, "operator", start), RateLimiter::Verdict::Allowed);
+    EXPECT_EQ(throttled("bot", "client") - before, 1u);
+
+    // До знакомства имени нет: предел клиента не применяется
+    for (int i = 0; i < 10; ++i)
+        EXPECT_EQ(limiter.admit(7, "", start), RateLimiter::Verdict::Allowed);
+
+    EXPECT_EQ(limiter.admit(3, "bot", start + 1s), RateLimiter::Verdict::Allowed);
+}
+
+TEST(RateLimiter, ClientBucketOutlivesConnections)
+{
+    RateLimiter limiter;
+    limiter.setLimits(RateLimit{}, RateLimit{0.001, 1.0});
+
+    EXPECT_EQ(limiter.admit(3, "bot", start), RateLimiter::Verdict::Allowed);
+    EXPECT_EQ(limiter.admit(4, "bot", start), RateLimiter::Verdict::ClientLimited);
+
+    // Открыто еще одно соединение с тем же именем: корзина остается пустой
+    limiter.forget(3);
+    EXPECT_EQ(limiter.admit(4, "bot", start), RateLimiter::Verdict::ClientLimited);
+
+    // Закрыто последнее: переподключение не получает полную корзину
+    limiter.forget(4);
+    EXPECT_EQ(limiter.admit(5, "bot", start + 1s), RateLimiter::Verdict::ClientLimited);
+    limiter.forget(5);
+
+    // Токен за 1000 с: пополнившаяся корзина удаляется при появлении нового имени, "bot" начинает заново
+    EXPECT_EQ(limiter.admit(6, "other-bot", start + 1001s), RateLimiter::Verdict::Allowed);
+    EXPECT_EQ(limiter.admit(7, "bot", start + 1001s), RateLimiter::Verdict::Allowed);
+    EXPECT_EQ(limiter.admit(7, "bot", start + 1001s), RateLimiter::Verdict::ClientLimited);
+}
+
+TEST(RateLimiter, ClientLabelsAreCapped)
+{
+    RateLimiter limiter;
+    limiter.setLimits(RateLimit{}, RateLimit{0.001, 1.0});
+    const auto before = throttled("other", "client");
+
+    const size_t extra = 5;
+    for (size_t i = 0; i < RateLimiter::MAX_LABELED_CLIENTS + extra; ++i)
+    {
+        const std::string name = std::format("capped-{}", i);
+        limiter.admit(static_cast<int>(i), name, start);
+        EXPECT_EQ(limiter.admit(static_cast<int>(i), name, start), RateLimiter::Verdict::ClientLimited);
+    }
+
+    EXPECT_EQ(throttled("other", "client") - before, extra);
+    const std::string text = MetricsRegistry::instance().render();
+    EXPECT_NE(text.find("client=\"capped-0\""), std::string::npos);
+    const std::string unlabeled = std::format("client=\"capped-{}\"", RateLimiter::MAX_LABELED_CLIENTS);
+    EXPECT_EQ(text.find(unlabeled), std::string::npos);
+}
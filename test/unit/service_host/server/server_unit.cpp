@@ -1,4 +1,5 @@
 #include "server.hpp"
+#include "metrics.hpp"
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -80,8 +81,31 @@ public:
         const std::string serverMessage = packMessage(200, text);
         writeToSock(sock_, serverMessage);
     }
+
+    // Сервер закрыл соединение: чтение без ожидания видит конец потока после непрочитанных ответов
+    bool closedByServer() const
+    {
+        char buffer[4096];
+        ssize_t n;
+        while ((n = recv(sock_, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0)
+            ;
+        return n == 0;
+    }
 };
 
+// Подключение без знакомства
+int connectSilently(const int port)
+{
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+        throw std::runtime_error("connect");
+    return sock;
+}
+
 class MockCore : public ICore
 {
 public:
@@ -145,3 +169,195 @@ TEST(ServerTest, MethodCallsAndClose)
     std::this_thread::sleep_for(std::chrono::milliseconds(500));
 }
 
+TEST(ServerTest, RateLimitDropsRequestsBeforeCore)
+{
+    auto mockCore = std::make_unique<MockCore>();
+    int testPort = getRandomPort();
+
+    MockCore* mockPtr = mockCore.get();
+    EXPECT_CALL(*mockPtr, Process(testing::_, testing::_, testing::_)).Times(1);
+
+    Server server("127.0.0.1", testPort, std::move(mockCore));
+    server.setRateLimits(RateLimit{}, RateLimit{0.001, 1.0});
+    std::future<int> server_status = std::async(std::launch::async, [&]() { return server.run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    Writer user_("127.0.0.1", testPort, "user");
+    user_.write("123456789");
+    user_.write("123456789");
+    user_.write("123456789");
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    server.stop();
+    const int status = server_status.get();
+    EXPECT_EQ(status, 0);
+}
+
+TEST(ServerTest, RepeatedRejectionsCloseConnection)
+{
+    auto mockCore = std::make_unique<MockCore>();
+    int testPort = getRandomPort();
+
+    MockCore* mockPtr = mockCore.get();
+    EXPECT_CALL(*mockPtr, Process(testing::_, testing::_, testing::_)).Times(1);
+
+    auto& expired = MetricsRegistry::instance().counter(
+        "mms_connections_expired_total", "", "reason=\"throttled\"");
+    const auto before = expired.value();
+
+    Server server("127.0.0.1", testPort, std::move(mockCore));
+    server.setRateLimits(RateLimit{}, RateLimit{0.001, 1.0});
+    std::future<int> server_status = std::async(std::launch::async, [&]() { return server.run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    Writer user_("127.0.0.1", testPort, "user");
+    for (int i = 0; i < 10; ++i)
+        user_.write("123456789");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_FALSE(user_.closedByServer());
+
+    for (int i = 0; i < 100; ++i)
+        user_.write("123456789");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_TRUE(user_.closedByServer());
+    EXPECT_EQ(expired.value() - before, 1u);
+
+    server.stop();
+    const int status = server_status.get();
+    EXPECT_EQ(status, 0);
+}
+
+TEST(ServerTest, HandshakeDeadlineClosesSilentConnection)
+{
+    auto mockCore = std::make_unique<MockCore>();
+    int testPort = getRandomPort();
+
+    MockCore* mockPtr = mockCore.get();
+    EXPECT_CALL(*mockPtr, Process(testing::_, testing::_, testing::_)).Times(1);
+
+    Server server("127.0.0.1", testPort, std::move(mockCore));
+    ConnectionTimeouts timeouts;
+    timeouts.handshake = std::chrono::milliseconds(200);
+    server.setTimeouts(timeouts);
+    std::future<int> server_status = std::async(std::launch::async, [&]() { return server.run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const int silent = connectSilently(testPort);
+    Writer user_("127.0.0.1", testPort, "user");
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+
+    char byte;
+    EXPECT_EQ(recv(silent, &byte, 1, MSG_DONTWAIT), 0);
+    close(silent);
+
+    // Представившийся клиент остается, слот молчавшего свободен для нового подключения
+    EXPECT_FALSE(user_.closedByServer());
+    user_.write("123456789");
+    Writer next_("127.0.0.1", testPort, "next");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    server.stop();
+    const int status = server_status.get();
+    EXPECT_EQ(status, 0);
+}
+
+TEST(ServerTest, IdleTimeoutClosesConnection)
+{
+    auto mockCore = std::make_unique<MockCore>();
+    int testPort = getRandomPort();
+
+    MockCore* mockPtr = mockCore.get();
+    EXPECT_CALL(*mockPtr, Process(testing::_, testing::_, testing::_)).Times(1);
+
+    Server server("127.0.0.1", testPort, std::move(mockCore));
+    ConnectionTimeouts timeouts;
+    timeouts.idle = std::chrono::milliseconds(300);
+    server.setTimeouts(timeouts);
+    std::future<int> server_status = std::async(std::launch::async, [&]() { return server.run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    Writer user_("127.0.0.1", testPort, "user");
+    user_.write("123456789");
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    EXPECT_FALSE(user_.closedByServer());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    EXPECT_TRUE(user_.closedByServer());
+
+    server.stop();
+    const int status = server_status.get();
+    EXPECT_EQ(status, 0);
+}
+
+TEST(ServerTest, WriteStallClosesConnectionWithoutBlockingOthers)
+{
+    auto mockCore = std::make_unique<MockCore>();
+    int testPort = getRandomPort();
+
+    // Ответ больше буферов ядра обеих сторон: клиент, который не читает, оставляет его в очереди
+    NetworkSerializer replies;
+    const std::string reply = std::string(12 * 1024 * 1024, 'x') + "\n\n";
+
+    MockCore* mockPtr = mockCore.get();
+    EXPECT_CALL(*mockPtr, Process(testing::_, std::string("stalled"), testing::_))
+        .WillOnce(testing::Invoke([&](const int fd, const std::string&, const std::string&) {
+            replies.writeFramed(fd, reply);
+        }));
+    EXPECT_CALL(*mockPtr, Process(testing::_, std::string("reader"), testing::_)).Times(1);
+
+    auto& expired = MetricsRegistry::instance().counter(
+        "mms_connections_expired_total", "", "reason=\"write_stall\"");
+    const auto before = expired.value();
+
+    Server server("127.0.0.1", testPort, std::move(mockCore));
+    ConnectionTimeouts timeouts;
+    timeouts.writeStall = std::chrono::milliseconds(300);
+    server.setTimeouts(timeouts);
+    std::future<int> server_status = std::async(std::launch::async, [&]() { return server.run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    Writer stalled_("127.0.0.1", testPort, "stalled");
+    stalled_.write("123456789");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Поток сервера не стоит в записи: запрос другого клиента доходит до ядра
+    Writer reader_("127.0.0.1", testPort, "reader");
+    reader_.write("123456789");
+    std::this_thread::sleep_for(std::chrono::milliseconds(900));
+
+    EXPECT_EQ(expired.value() - before, 1u);
+    EXPECT_FALSE(reader_.closedByServer());
+
+    server.stop();
+    const int status = server_status.get();
+    EXPECT_EQ(status, 0);
+}
+
+// Посылка пришла частями: ядро получает ее целиком, когда придет \n\n
+TEST(ServerTest, PartialFrameWaitsForRest)
+{
+    auto mockCore = std::make_unique<MockCore>();
+    int testPort = getRandomPort();
+
+    MockCore* mockPtr = mockCore.get();
+    EXPECT_CALL(*mockPtr, Process(testing::_, std::string("user"), std::string("{\"id\":1}"))).Times(1);
+
+    Server server("127.0.0.1", testPort, std::move(mockCore));
+    std::future<int> server_status = std::async(std::launch::async, [&]() { return server.run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const int sock = connectSilently(testPort);
+    const std::string frames = "{\"name\":\"user\"}\n\n{\"id\":1}\n\n";
+    const size_t half = frames.size() - 5;
+    ASSERT_EQ(send(sock, frames.data(), half, 0), static_cast<ssize_t>(half));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    const size_t rest = frames.size() - half;
+    ASSERT_EQ(send(sock, frames.data() + half, rest, 0), static_cast<ssize_t>(rest));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    close(sock);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    server.stop();
+    const int status = server_status.get();
+    EXPECT_EQ(status, 0);
+}
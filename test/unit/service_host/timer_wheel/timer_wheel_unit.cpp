@@ -0,0 +1,81 @@
+#include "timer_wheel.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+const TimerWheel::TimePoint start{};
+
+std::vector<size_t> advance(TimerWheel &wheel, TimerWheel::TimePoint now)
+{
+    std::vector<size_t> fired;
+    wheel.advance(now, [&fired](size_t key) { fired.push_back(key); });
+    return fired;
+}
+} // namespace
+
+TEST(TimerWheel, FiresOnRoundedUpTick)
+{
+    TimerWheel wheel(4, 100ms, 8, start);
+    wheel.schedule(1, start + 250ms);
+    EXPECT_TRUE(wheel.scheduled(1));
+
+    EXPECT_TRUE(advance(wheel, start + 299ms).empty());
+    EXPECT_EQ(advance(wheel, start + 300ms), std::vector<size_t>{1});
+    EXPECT_FALSE(wheel.scheduled(1));
+    EXPECT_TRUE(advance(wheel, start + 10s).empty());
+}
+
+TEST(TimerWheel, DeadlinesBeyondOneTurn)
+{
+    // Оборот колеса - 800 мс
+    TimerWheel wheel(4, 100ms, 8, start);
+    wheel.schedule(0, start + 800ms);
+    wheel.schedule(1, start + 900ms);
+    wheel.schedule(2, start + 2500ms);
+
+    EXPECT_TRUE(advance(wheel, start + 700ms).empty());
+    EXPECT_EQ(advance(wheel, start + 800ms), std::vector<size_t>{0});
+    EXPECT_EQ(advance(wheel, start + 900ms), std::vector<size_t>{1});
+    EXPECT_TRUE(advance(wheel, start + 2400ms).empty());
+    EXPECT_EQ(advance(wheel, start + 2500ms), std::vector<size_t>{2});
+}
+
+TEST(TimerWheel, RescheduleAndCancel)
+{
+    TimerWheel wheel(4, 100ms, 8, start);
+    wheel.schedule(0, start + 200ms);
+    wheel.schedule(1, start + 200ms);
+    wheel.schedule(2, start + 200ms);
+
+    wheel.schedule(1, start + 500ms);
+    wheel.cancel(2);
+    wheel.cancel(3);
+    EXPECT_EQ(advance(wheel, start + 400ms), std::vector<size_t>{0});
+    EXPECT_EQ(advance(wheel, start + 500ms), std::vector<size_t>{1});
+
+    // Прошедший срок срабатывает на следующем тике
+    wheel.schedule(3, start);
+    EXPECT_EQ(advance(wheel, start + 600ms), std::vector<size_t>{3});
+}
+
+TEST(TimerWheel, HandlerMayRescheduleItsKey)
+{
+    TimerWheel wheel(2, 100ms, 4, start);
+    wheel.schedule(0, start + 100ms);
+
+    size_t fired = 0;
+    auto now = start;
+    for (int tick = 1; tick <= 10; ++tick)
+    {
+        now += 100ms;
+        wheel.advance(now, [&](size_t key) {
+            ++fired;
+            wheel.schedule(key, now + 200ms);
+        });
+    }
+    // Срабатывания на 100, 300, 500, 700, 900 мс
+    EXPECT_EQ(fired, 5u);
+}